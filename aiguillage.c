@@ -0,0 +1,371 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "aiguillage.h"
+#include "dictionnaire.h"
+#include "tableSymboles.h"
+
+// groupe de cas voisins : une table de sauts, ou un seul cas
+typedef struct Groupe {
+    int debut;          // cas[debut .. fin[
+    int fin;
+    int table;
+} Groupe;
+
+typedef struct Emetteur {
+    tableQuads *t;
+    int *qc;
+    const Aiguillage *a;
+    CasAiguillage **cas;        // tries par valeur
+    StringId defaut;            // Default, sinon fin du Switch
+    int profondeur;             // tests < sur le plus long chemin
+} Emetteur;
+
+static void emettre(Emetteur *e, const char *operateur, StringId a1, StringId a2, StringId r) {
+    insererQuadrepletId(e->t, internString(operateur), a1, a2, r, (*e->qc)++);
+}
+
+static void poserEtiquette(Emetteur *e, StringId etiquette) {
+    insererQuadrepletId(e->t, etiquette, STRING_ID_NONE, STRING_ID_NONE, STRING_ID_NONE, (*e->qc)++);
+}
+
+// temporaire du prochain quad, comme emitBinary
+static StringId temporaire(const Emetteur *e) {
+    char nom[24];
+    snprintf(nom, sizeof(nom), "$t%d", *e->qc);
+    return internString(nom);
+}
+
+static StringId nombre(unsigned long long n) {
+    char texte[24];
+    snprintf(texte, sizeof(texte), "%llu", n);
+    return internString(texte);
+}
+
+// operande d'une valeur ; les litteraux des quads n'ont pas de signe, un
+// negatif passe par UMINUS
+static StringId entier(Emetteur *e, int64_t v) {
+    if (v >= 0) {
+        return nombre((unsigned long long)v);
+    }
+    // -INT64_MIN n'existe pas : -(2^63 - 1) - 1
+    StringId t = temporaire(e);
+    emettre(e, "UMINUS", nombre(v == INT64_MIN ? (unsigned long long)INT64_MAX : -(unsigned long long)v),
+            STRING_ID_NONE, t);
+    if (v == INT64_MIN) {
+        StringId u = temporaire(e);
+        emettre(e, "-", t, internString("1"), u);
+        t = u;
+    }
+    return t;
+}
+
+static StringId reel(Emetteur *e, double f) {
+    char texte[40];
+    snprintf(texte, sizeof(texte), "%.17g", fabs(f));
+    if (!strpbrk(texte, ".eE")) {
+        strcat(texte, ".0");
+    }
+    if (!(f < 0)) {
+        return internString(texte);
+    }
+    StringId t = temporaire(e);
+    emettre(e, "UMINUS", internString(texte), STRING_ID_NONE, t);
+    return t;
+}
+
+static StringId valeur(Emetteur *e, const CasAiguillage *c) {
+    switch (e->a->type) {
+        case TYPE_INTEGER: return entier(e, c->i);
+        case TYPE_FLOAT:   return reel(e, c->f);
+        case TYPE_BOOLEAN: return internString(c->i ? "true" : "false");
+        default: {
+            size_t n = internedLength(c->s);
+            char *texte = (char *)malloc(n + 2);
+            if (!texte) {
+                return STRING_ID_NONE;
+            }
+            texte[0] = '"';
+            memcpy(texte + 1, internedString(c->s), n);
+            texte[n + 1] = '"';
+            StringId id = internStringN(texte, n + 2);
+            free(texte);
+            return id;
+        }
+    }
+}
+
+// selecteur == valeur du cas : saut vers son corps
+static int tester(Emetteur *e, const CasAiguillage *c) {
+    StringId v = valeur(e, c);
+    if (v == STRING_ID_NONE) {
+        return -1;
+    }
+    StringId t = temporaire(e);
+    emettre(e, "==", e->a->selecteur, v, t);
+    emettre(e, "BNZ", c->etiquette, STRING_ID_NONE, t);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Ordre des valeurs : celui de < dans vm.c
+
+static int comparerEntiers(const void *x, const void *y) {
+    int64_t a = (*(CasAiguillage *const *)x)->i, b = (*(CasAiguillage *const *)y)->i;
+    return (a > b) - (a < b);
+}
+
+static int comparerReels(const void *x, const void *y) {
+    double a = (*(CasAiguillage *const *)x)->f, b = (*(CasAiguillage *const *)y)->f;
+    return (a > b) - (a < b);
+}
+
+static int comparerChaines(const void *x, const void *y) {
+    StringId a = (*(CasAiguillage *const *)x)->s, b = (*(CasAiguillage *const *)y)->s;
+    size_t la = internedLength(a), lb = internedLength(b);
+    int c = memcmp(internedString(a), internedString(b), la < lb ? la : lb);
+    return c ? (c > 0) - (c < 0) : (la > lb) - (la < lb);
+}
+
+// ---------------------------------------------------------------------------
+// Tables de sauts et recherche binaire
+
+// Groupes de gauche a droite : a partir de cas[i], la table va jusqu'au
+// dernier cas qui garde la densite, si elle a assez de cas ; sinon cas[i]
+// reste isole. Retourne le nombre de groupes
+static int grouper(Emetteur *e, Groupe *groupes, FILE *trace) {
+    CasAiguillage **cas = e->cas;
+    int n = e->a->nbCas, nb = 0, isoles = 0;
+    for (int i = 0; i < n; nb++) {
+        int fin = i + 1;
+        for (int k = i + 1; k < n && e->a->type == TYPE_INTEGER; k++) {
+            uint64_t ecart = (uint64_t)cas[k]->i - (uint64_t)cas[i]->i;
+            if (ecart >= AIGUILLAGE_TABLE_MAX) {
+                break;
+            }
+            if ((uint64_t)(k - i + 1) * 100 >= AIGUILLAGE_DENSITE_MIN * (ecart + 1)) {
+                fin = k + 1;
+            }
+        }
+        Groupe *g = &groupes[nb];
+        g->debut = i;
+        g->table = fin - i >= AIGUILLAGE_TABLE_MIN;
+        g->fin = g->table ? fin : i + 1;
+        if (g->table) {
+            uint64_t entrees = (uint64_t)cas[fin - 1]->i - (uint64_t)cas[i]->i + 1;
+            fprintf(trace, "\t %-13s [%lld .. %lld] : %d cas, %llu entree(s), densite %llu%%\n", "table",
+                    (long long)cas[i]->i, (long long)cas[fin - 1]->i, fin - i, (unsigned long long)entrees,
+                    (unsigned long long)(fin - i) * 100 / entrees);
+        } else {
+            isoles++;
+        }
+        i = g->fin;
+    }
+    if (isoles > 0 && e->a->type == TYPE_INTEGER) {
+        fprintf(trace, "\t %-13s %d cas (moins de %d cas voisins a %d%% de densite)\n", "isoles", isoles,
+                AIGUILLAGE_TABLE_MIN, AIGUILLAGE_DENSITE_MIN);
+    }
+    return nb;
+}
+
+// SWITCH sel , min , n puis une entree CASE par valeur de [min, min + n[
+static int emettreTable(Emetteur *e, const Groupe *g) {
+    CasAiguillage **cas = e->cas;
+    int64_t min = cas[g->debut]->i;
+    uint64_t n = (uint64_t)cas[g->fin - 1]->i - (uint64_t)min + 1;
+    StringId base = entier(e, min);
+    emettre(e, "SWITCH", e->a->selecteur, base, nombre((unsigned long long)n));
+    int k = g->debut;
+    for (uint64_t x = 0; x < n; x++) {
+        int present = (uint64_t)cas[k]->i - (uint64_t)min == x;
+        emettre(e, "CASE", present ? cas[k]->etiquette : e->defaut, STRING_ID_NONE, STRING_ID_NONE);
+        k += present;
+    }
+    emettre(e, "BR", STRING_ID_NONE, STRING_ID_NONE, e->defaut);
+    return 0;
+}
+
+// Recherche binaire sur les groupes : selecteur < premiere valeur du
+// groupe du milieu, moitie droite a la suite, gauche sous SWITCH_LOW ;
+// quelques cas isoles se testent l'un apres l'autre
+static int rechercher(Emetteur *e, const Groupe *g, int nb, int profondeur) {
+    int tables = 0;
+    for (int k = 0; k < nb; k++) {
+        tables |= g[k].table;
+    }
+    if (nb == 1 && tables) {
+        e->profondeur = profondeur > e->profondeur ? profondeur : e->profondeur;
+        return emettreTable(e, g);
+    }
+    if (!tables && nb <= AIGUILLAGE_SUITE_MAX) {
+        e->profondeur = profondeur > e->profondeur ? profondeur : e->profondeur;
+        for (int k = 0; k < nb; k++) {
+            if (tester(e, e->cas[g[k].debut]) < 0) {
+                return -1;
+            }
+        }
+        emettre(e, "BR", STRING_ID_NONE, STRING_ID_NONE, e->defaut);
+        return 0;
+    }
+    int milieu = nb / 2;
+    StringId v = valeur(e, e->cas[g[milieu].debut]);
+    if (v == STRING_ID_NONE) {
+        return -1;
+    }
+    StringId t = temporaire(e);
+    emettre(e, "<", e->a->selecteur, v, t);
+    char nom[32];
+    snprintf(nom, sizeof(nom), "SWITCH_LOW_%d", *e->qc);
+    StringId gauche = internString(nom);
+    emettre(e, "BNZ", gauche, STRING_ID_NONE, t);
+    if (rechercher(e, g + milieu, nb - milieu, profondeur + 1) < 0) {
+        return -1;
+    }
+    poserEtiquette(e, gauche);
+    return rechercher(e, g, milieu, profondeur + 1);
+}
+
+// ---------------------------------------------------------------------------
+// Chaines hachees
+
+// HASH sel , m , h ; SWITCH h , 0 , m ; une entree par case, vers la suite
+// de tests == de ses chaines (SWITCH_SLOT) ou vers le Default si vide
+static int hacher(Emetteur *e, FILE *trace) {
+    int n = e->a->nbCas;
+    uint64_t *haches = (uint64_t *)malloc(n * sizeof(uint64_t));
+    uint32_t *debut = (uint32_t *)malloc((2 * (size_t)n + 1) * sizeof(uint32_t));
+    uint32_t *curseur = (uint32_t *)malloc((2 * (size_t)n + 1) * sizeof(uint32_t));
+    int *ordre = (int *)malloc(n * sizeof(int));
+    if (!haches || !debut || !curseur || !ordre) {
+        free(haches);
+        free(debut);
+        free(curseur);
+        free(ordre);
+        return -1;
+    }
+    for (int k = 0; k < n; k++) {
+        StringId s = e->cas[k]->s;
+        haches[k] = dictHash(internedString(s), internedLength(s));
+    }
+    // au plus 33 tailles essayees entre n et 2n
+    uint32_t m = (uint32_t)n, pire = UINT32_MAX, pas = (uint32_t)n / 32 + 1;
+    for (uint32_t essai = (uint32_t)n; essai <= 2 * (uint32_t)n && pire > 1; essai += pas) {
+        uint32_t plein = 0;
+        memset(curseur, 0, essai * sizeof(uint32_t));
+        for (int k = 0; k < n; k++) {
+            uint32_t c = ++curseur[dictBucket(haches[k], essai)];
+            plein = c > plein ? c : plein;
+        }
+        if (plein < pire) {
+            pire = plein;
+            m = essai;
+        }
+    }
+    // cas ranges par case (tri par comptage) : debut[c] .. debut[c + 1]
+    memset(debut, 0, (m + 1) * sizeof(uint32_t));
+    for (int k = 0; k < n; k++) {
+        debut[dictBucket(haches[k], m) + 1]++;
+    }
+    uint32_t occupees = 0;
+    for (uint32_t c = 0; c < m; c++) {
+        occupees += debut[c + 1] > 0;
+        debut[c + 1] += debut[c];
+        curseur[c] = debut[c];
+    }
+    for (int k = 0; k < n; k++) {
+        ordre[curseur[dictBucket(haches[k], m)]++] = k;
+    }
+    fprintf(trace, "\t %-13s %u case(s) pour %d chaine(s), %u occupee(s), au plus %u test(s) == par case\n",
+            "hachage", m, n, occupees, pire);
+
+    StringId h = temporaire(e);
+    emettre(e, "HASH", e->a->selecteur, nombre(m), h);
+    int base = *e->qc;
+    char nom[48];
+    emettre(e, "SWITCH", h, internString("0"), nombre(m));
+    for (uint32_t c = 0; c < m; c++) {
+        snprintf(nom, sizeof(nom), "SWITCH_SLOT_%d_%u", base, c);
+        emettre(e, "CASE", debut[c + 1] > debut[c] ? internString(nom) : e->defaut, STRING_ID_NONE,
+                STRING_ID_NONE);
+    }
+    emettre(e, "BR", STRING_ID_NONE, STRING_ID_NONE, e->defaut);
+    int status = 0;
+    for (uint32_t c = 0; c < m && status == 0; c++) {
+        if (debut[c + 1] == debut[c]) {
+            continue;
+        }
+        snprintf(nom, sizeof(nom), "SWITCH_SLOT_%d_%u", base, c);
+        poserEtiquette(e, internString(nom));
+        for (uint32_t k = debut[c]; k < debut[c + 1] && status == 0; k++) {
+            status = tester(e, e->cas[ordre[k]]);
+        }
+        emettre(e, "BR", STRING_ID_NONE, STRING_ID_NONE, e->defaut);
+    }
+    free(haches);
+    free(debut);
+    free(curseur);
+    free(ordre);
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+
+int emettreAiguillage(tableQuads *t, int *qc, const Aiguillage *a, FILE *trace) {
+    static const char *const types[] = { "booleen(s)", "entier(s)", "reel(s)", "chaine(s)" };
+    int n = a->nbCas;
+    Emetteur e;
+    memset(&e, 0, sizeof(e));
+    e.t = t;
+    e.qc = qc;
+    e.a = a;
+    if (a->defaut != STRING_ID_NONE) {
+        e.defaut = a->defaut;
+    } else {
+        char nom[32];
+        snprintf(nom, sizeof(nom), "SWITCH_END_%d", a->id);
+        e.defaut = internString(nom);
+    }
+    CasAiguillage **cas = (CasAiguillage **)malloc((n + 1) * sizeof(CasAiguillage *));
+    Groupe *groupes = (Groupe *)malloc((n + 1) * sizeof(Groupe));
+    if (!cas || !groupes) {
+        free(cas);
+        free(groupes);
+        return -1;
+    }
+    int k = n;
+    for (CasAiguillage *c = a->cas; c; c = c->suivant) {
+        cas[--k] = c;
+    }
+    int (*comparer)(const void *, const void *) = a->type == TYPE_FLOAT ? comparerReels :
+                                                  a->type == TYPE_STRING ? comparerChaines : comparerEntiers;
+    qsort(cas, n, sizeof(CasAiguillage *), comparer);
+    for (k = 1; k < n; k++) {
+        if (comparer(&cas[k - 1], &cas[k]) == 0) {
+            free(cas);
+            free(groupes);
+            return AIGUILLAGE_DOUBLON;
+        }
+    }
+    e.cas = cas;
+
+    fprintf(trace, "Switch SWITCH_TEST_%d : %d cas %s%s\n", a->id, n, types[a->type],
+            a->defaut != STRING_ID_NONE ? " et Default" : "");
+    int status = 0;
+    if (a->type == TYPE_STRING && n >= AIGUILLAGE_HACHAGE_MIN) {
+        status = hacher(&e, trace);
+    } else if (n == 0) {
+        emettre(&e, "BR", STRING_ID_NONE, STRING_ID_NONE, e.defaut);
+    } else {
+        int nb = grouper(&e, groupes, trace);
+        status = rechercher(&e, groupes, nb, 0);
+        if (nb > AIGUILLAGE_SUITE_MAX || (nb > 1 && n > nb)) {
+            fprintf(trace, "\t %-13s %d groupe(s), au plus %d test(s) <\n", "recherche", nb, e.profondeur);
+        } else if (n == nb) {
+            fprintf(trace, "\t %-13s %d test(s) ==\n", "suite", n);
+        }
+    }
+    free(cas);
+    free(groupes);
+    // un quad refuse faute de memoire (voir insererQuadrepletId)
+    return status == 0 && t->echec ? -1 : status;
+}
@@ -0,0 +1,61 @@
+#ifndef AIGUILLAGE_H
+#define AIGUILLAGE_H
+#include <stdio.h>
+#include <stdint.h>
+#include "quadruplets.h"
+
+// Traduction des Switch (syntaxique.y).
+//
+// Le Switch commence par un saut vers SWITCH_TEST_id ; les corps suivent
+// dans l'ordre du source, chacun sous son etiquette (SWITCH_CASE_n,
+// SWITCH_DEFAULT_id) et termine par un saut vers SWITCH_END_id. Une fois
+// toutes les valeurs connues, emettreAiguillage place sous SWITCH_TEST_id
+// le choix du cas, selon les valeurs :
+//   - entiers : triees puis groupees de gauche a droite ; un groupe d'au
+//     moins AIGUILLAGE_TABLE_MIN cas qui occupe au moins
+//     AIGUILLAGE_DENSITE_MIN % de son intervalle (AIGUILLAGE_TABLE_MAX
+//     valeurs au plus) devient une table de sauts : "SWITCH sel , min , n"
+//     suivi de n quads "CASE etiquette" (un trou va au Default) ;
+//   - chaines, a partir de AIGUILLAGE_HACHAGE_MIN cas : "HASH sel , m , h"
+//     donne dictBucket(dictHash(sel), m) (dictionnaire.h), une table sur
+//     les m cases mene a la comparaison (==) des seules chaines de la
+//     case. m, entre n et 2n, est celui qui laisse le moins de chaines
+//     dans la case la plus chargee ;
+//   - le reste (cas isoles, reels, booleens, peu de chaines) : recherche
+//     binaire par < sur les valeurs triees, les tables servant de feuilles ;
+//     AIGUILLAGE_SUITE_MAX cas isoles au plus se testent par == a la suite.
+// La decision et ses raisons sont ecrites sur la trace de la compilation.
+
+#define AIGUILLAGE_TABLE_MIN 4          // cas d'une table de sauts
+#define AIGUILLAGE_DENSITE_MIN 40       // % de l'intervalle occupe par ses cas
+#define AIGUILLAGE_TABLE_MAX 4096       // entrees d'une table
+#define AIGUILLAGE_HACHAGE_MIN 4        // chaines a partir desquelles on hache
+#define AIGUILLAGE_SUITE_MAX 3          // cas isoles testes l'un apres l'autre
+
+#define AIGUILLAGE_DOUBLON (-2)         // deux cas de meme valeur
+
+// valeur d'un Case, deja convertie au type du selecteur
+typedef struct CasAiguillage {
+    int64_t i;                  // entier ou booleen
+    double f;
+    StringId s;
+    StringId etiquette;         // SWITCH_CASE_n
+    struct CasAiguillage *suivant;
+} CasAiguillage;
+
+// Switch ouvert ; englobant : Switch dans lequel il est imbrique
+typedef struct Aiguillage {
+    int id;                     // numero du saut vers SWITCH_TEST_id
+    int type;                   // TYPE_INTEGER, TYPE_FLOAT, TYPE_BOOLEAN ou TYPE_STRING
+    StringId selecteur;         // place de l'expression du Switch
+    CasAiguillage *cas;         // du dernier au premier
+    int nbCas;
+    StringId defaut;            // SWITCH_DEFAULT_id, STRING_ID_NONE sans Default
+    struct Aiguillage *englobant;
+} Aiguillage;
+
+// ajoute les quads du choix a t (numeros *qc, *qc + 1, ...) ; 0,
+// AIGUILLAGE_DOUBLON ou -1 si la memoire manque
+int emettreAiguillage(tableQuads *t, int *qc, const Aiguillage *a, FILE *trace);
+
+#endif
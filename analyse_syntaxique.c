@@ -346,7 +346,7 @@ bool reconnaissance(Table_analyse* table, const char* input, SymbolTable* symTab
         {
             printf("La chaine est syntaxiquement correcte !\n");
             if (type_courant != NULL && id_courant != NULL) {
-                insertSymbol(symTable, id_courant, type_courant, NULL, 1);
+                insertSymbol(symTable, internString(id_courant), symbolTypeFromName(type_courant), NULL, 1, false, false);
             }
             return true;
         }
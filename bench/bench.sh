@@ -0,0 +1,182 @@
+#!/bin/sh
+# Banc de mesure du compilateur sur des programmes generes
+# (bench/generateur.c, graine fixe : les memes programmes d'une machine et
+# d'une execution a l'autre). Chaque forme est compilee a 4 tailles (x1, x2,
+# x4, x8), sans puis avec -O. bench_mesure (bench/mesure.c) donne le
+# meilleur temps de R executions et la memoire residente maximale ; le
+# debit en octets et en lignes de source par seconde en decoule, et
+# l'exposant de croissance (log(t8 / t1) / log 8 : 1 lineaire, 2
+# quadratique) resume la courbe. analyse_syntaxique, qui lit une seule
+# declaration par execution, est mesure ligne par ligne.
+#
+# Les resultats vont dans un fichier JSON (une mesure par ligne) ;
+# --comparer signale les mesures qui se sont degradees entre deux fichiers
+# de plus de SEUIL % (25 par defaut) et de plus de 5 ms ou 1 Mio.
+#
+#   make bench            (ou : sh bench/bench.sh [-s graine] [-r repetitions]
+#                          [-f facteur] [-o resultats.json] [-c ./compiler]
+#                          [-a ./analyse_syntaxique])
+#   sh bench/bench.sh --comparer ancien.json nouveau.json [SEUIL]
+
+comparer() {
+    awk -v seuil="${3:-25}" '
+        function champ(ligne, nom,    m) {
+            if (match(ligne, "\"" nom "\": (\"[^\"]*\"|[0-9.]+)")) {
+                m = substr(ligne, RSTART + length(nom) + 4, RLENGTH - length(nom) - 4);
+                gsub("\"", "", m);
+                return m;
+            }
+            return "";
+        }
+        function cle(ligne) {
+            return sprintf("%-18s %-3s %-14s %8s", champ(ligne, "outil"), champ(ligne, "options"),
+                           champ(ligne, "forme"), champ(ligne, "taille"));
+        }
+        FNR == 1 { fichier++ }
+        !/"ms":/ { next }
+        fichier == 1 { ms[cle($0)] = champ($0, "ms") + 0; kio[cle($0)] = champ($0, "kio_max") + 0; next }
+        {
+            k = cle($0);
+            if (!(k in ms)) { printf "%s  nouvelle mesure\n", k; next }
+            m = champ($0, "ms") + 0; q = champ($0, "kio_max") + 0;
+            pire = "";
+            if (m > ms[k] * (1 + seuil / 100) && m - ms[k] > 5) pire = pire " temps";
+            if (q > kio[k] * (1 + seuil / 100) && q - kio[k] > 1024) pire = pire " memoire";
+            printf "%s  %9.1f -> %9.1f ms (%+6.1f%%)  %7d -> %7d Kio%s\n", k, ms[k], m,
+                   (ms[k] > 0 ? (m - ms[k]) * 100 / ms[k] : 0), kio[k], q, (pire ? "  DEGRADATION" pire : "");
+            if (pire) degradations++;
+        }
+        END {
+            if (fichier < 2) { print "fichiers de resultats manquants"; exit 2 }
+            if (degradations) { printf "%d mesure(s) degradee(s) de plus de %d%%\n", degradations, seuil; exit 1 }
+            print "aucune degradation";
+        }' "$1" "$2"
+}
+
+if [ "$1" = "--comparer" ]; then
+    [ -r "$2" ] && [ -r "$3" ] || { echo "usage: $0 --comparer ancien.json nouveau.json [seuil]"; exit 2; }
+    comparer "$2" "$3" "$4"
+    exit $?
+fi
+
+GRAINE=42
+REPETITIONS=3
+FACTEUR=1
+RESULTATS=bench_resultats.json
+COMPILER=./compiler
+ANALYSE=./analyse_syntaxique
+GENERATEUR=./bench_generateur
+MESURE=./bench_mesure
+while [ $# -gt 1 ]; do
+    case "$1" in
+        -s) GRAINE=$2 ;;
+        -r) REPETITIONS=$2 ;;
+        -f) FACTEUR=$2 ;;
+        -o) RESULTATS=$2 ;;
+        -c) COMPILER=$2 ;;
+        -a) ANALYSE=$2 ;;
+        *) echo "option inconnue : $1"; exit 2 ;;
+    esac
+    shift 2
+done
+for outil in "$COMPILER" "$GENERATEUR" "$MESURE"; do
+    [ -x "$outil" ] || { echo "$outil introuvable (make bench)"; exit 2; }
+done
+
+TMP=${TMPDIR:-/tmp}/bench.$$
+mkdir -p "$TMP" || exit 1
+trap 'rm -rf "$TMP"' EXIT
+: > "$TMP/mesures"
+: > "$TMP/croissance"
+
+# forme et taille de base (x1)
+FORMES="declarations:2500 conditions:500 boucles:500 tableaux:50000 dictionnaires:10000 chaines:500 switch:500 mixte:1000"
+
+# mesure OUTIL OPTIONS FORME TAILLE FICHIER MS KIO : une ligne de resultats
+mesure() {
+    octets=$(wc -c < "$5")
+    lignes=$(wc -l < "$5")
+    awk -v outil="$1" -v options="$2" -v forme="$3" -v taille="$4" -v octets="$octets" \
+        -v lignes="$lignes" -v ms="$6" -v kio="$7" 'BEGIN {
+        s = (ms > 0 ? ms : 0.001) / 1000;
+        printf "    {\"outil\": \"%s\", \"options\": \"%s\", \"forme\": \"%s\", \"taille\": %d, \"octets\": %d, " \
+               "\"lignes\": %d, \"ms\": %.3f, \"kio_max\": %d, \"octets_par_s\": %.0f, \"lignes_par_s\": %.0f}\n",
+               outil, options, forme, taille, octets, lignes, ms, kio, octets / s, lignes / s;
+    }' >> "$TMP/mesures"
+    printf "%-18s %-3s %-14s %8d %10d o %10.1f ms %8d Kio\n" "$1" "$2" "$3" "$4" "$octets" "$6" "$7"
+}
+
+echo "graine $GRAINE, $REPETITIONS repetition(s), facteur $FACTEUR"
+outil=$(basename "$COMPILER")
+for f in $FORMES; do
+    forme=${f%%:*}
+    base=$((${f#*:} * FACTEUR))
+    for options in "" -O; do
+        premier=0
+        for x in 1 2 4 8; do
+            taille=$((base * x))
+            programme="$TMP/$forme.$taille.txt"
+            [ -f "$programme" ] || "$GENERATEUR" -s "$GRAINE" "$forme" "$taille" > "$programme" || exit 1
+            # le programme doit compiler sans erreur avant d'etre mesure
+            "$COMPILER" $options "$programme" < /dev/null > /dev/null 2> "$TMP/erreurs"
+            if [ $? -ne 0 ] || [ -s "$TMP/erreurs" ]; then
+                echo "$forme $taille $options : echec de la compilation"
+                head -n 3 "$TMP/erreurs"
+                exit 1
+            fi
+            set -- $("$MESURE" -n "$REPETITIONS" "$COMPILER" $options "$programme")
+            mesure "$outil" "$options" "$forme" "$taille" "$programme" "$1" "$2"
+            [ "$premier" != 0 ] || premier=$1
+            dernier=$1
+        done
+        awk -v outil="$outil" -v options="$options" -v forme="$forme" -v t1="$premier" -v t8="$dernier" \
+            -v debut="$base" -v fin="$taille" 'BEGIN {
+            e = log((t8 > 0 ? t8 : 0.001) / (t1 > 0 ? t1 : 0.001)) / log(8);
+            printf "    {\"outil\": \"%s\", \"options\": \"%s\", \"forme\": \"%s\", \"tailles\": [%d, %d], " \
+                   "\"exposant\": %.2f}\n", outil, options, forme, debut, fin, e >> "/dev/stderr";
+            printf "%-18s %-3s %-14s croissance x%.1f pour x8, exposant %.2f\n", outil, options, forme,
+                   t8 / (t1 > 0 ? t1 : 0.001), e;
+        }' 2>> "$TMP/croissance"
+    done
+    rm -f "$TMP/$forme".*.txt
+done
+
+# analyse_syntaxique : une execution par declaration
+if [ -x "$ANALYSE" ]; then
+    lignes=$((32 * FACTEUR))
+    "$GENERATEUR" -s "$GRAINE" analyse "$lignes" > "$TMP/analyse.txt" || exit 1
+    total=0
+    kio=0
+    n=0
+    while read -r declaration; do
+        echo "$declaration" > "$TMP/ligne"
+        if [ $n -eq 0 ] && ! "$ANALYSE" < "$TMP/ligne" | grep -q "syntaxiquement correcte"; then
+            echo "analyse_syntaxique refuse \"$declaration\""
+            exit 1
+        fi
+        set -- $("$MESURE" -n "$REPETITIONS" -i "$TMP/ligne" "$ANALYSE")
+        total=$(awk -v a="$total" -v b="$1" 'BEGIN { printf "%.3f", a + b }')
+        [ "$2" -le "$kio" ] || kio=$2
+        n=$((n + 1))
+    done < "$TMP/analyse.txt"
+    mesure "$(basename "$ANALYSE")" "" analyse "$lignes" "$TMP/analyse.txt" "$total" "$kio"
+else
+    echo "$ANALYSE introuvable : non mesure"
+fi
+
+{
+    echo "{"
+    echo "  \"graine\": $GRAINE,"
+    echo "  \"repetitions\": $REPETITIONS,"
+    echo "  \"facteur\": $FACTEUR,"
+    echo "  \"date\": \"$(date -u +%Y-%m-%dT%H:%M:%SZ)\","
+    echo "  \"machine\": \"$(uname -m) $(uname -s) $(uname -r)\","
+    echo "  \"mesures\": ["
+    sed '$!s/$/,/' "$TMP/mesures"
+    echo "  ],"
+    echo "  \"croissance\": ["
+    sed '$!s/$/,/' "$TMP/croissance"
+    echo "  ]"
+    echo "}"
+} > "$RESULTATS"
+echo "resultats dans $RESULTATS"
@@ -0,0 +1,51 @@
+#!/bin/sh
+# Test de charge des litteraux de tableaux : compile et execute (--run)
+# "Let Array a be [0, 1, ..., N-1]" puis "Print sum(a)" pour N de 125 000 a
+# 1 000 000 elements. Le temps doit rester lineaire en N : d'un N au
+# suivant (x2) il ne doit pas plus que tripler, et le total 1M / 125k rester
+# sous x16 (x8 attendu, x64 pour un cout quadratique).
+#
+#   make bench-litteraux            (ou : sh bench/bench_litteraux.sh ./compiler)
+
+COMPILER=${1:-./compiler}
+TMP=${TMPDIR:-/tmp}/bench_litteraux.$$
+mkdir -p "$TMP" || exit 1
+trap 'rm -rf "$TMP"' EXIT
+
+ms() {
+    echo $(( $(date +%s%N) / 1000000 ))
+}
+
+premier=0
+precedent=0
+for n in 125000 250000 500000 1000000; do
+    awk -v n=$n 'BEGIN {
+        printf "Let Array a be [";
+        for (i = 0; i < n; i++) printf (i ? ", %d" : "%d"), i;
+        print "]";
+        print "Print sum(a)";
+    }' > "$TMP/litteral.txt"
+    debut=$(ms)
+    "$COMPILER" --run "$TMP/litteral.txt" < /dev/null > "$TMP/sortie" 2>&1
+    fin=$(ms)
+    duree=$((fin - debut))
+    [ $duree -gt 0 ] || duree=1
+    attendu=$((n * (n - 1) / 2))
+    if [ "$(tail -n 1 "$TMP/sortie")" != "$attendu" ]; then
+        echo "$n elements : resultat faux (attendu $attendu)"
+        tail -n 3 "$TMP/sortie"
+        exit 1
+    fi
+    printf "%8d elements  %6d ms  %6d ns/element\n" $n $duree $((duree * 1000000 / n))
+    if [ $precedent -gt 0 ] && [ $duree -gt $((3 * precedent + 50)) ]; then
+        echo "croissance non lineaire entre $((n / 2)) et $n elements"
+        exit 1
+    fi
+    [ $premier -gt 0 ] || premier=$duree
+    precedent=$duree
+done
+if [ $precedent -gt $((16 * premier + 100)) ]; then
+    echo "croissance non lineaire : x$((precedent / premier)) pour 8 fois plus d'elements"
+    exit 1
+fi
+echo "litteraux OK (x$((precedent / premier)) pour 8 fois plus d'elements)"
@@ -0,0 +1,65 @@
+// Microbenchmark de la table des symboles : debit des recherches par nom
+// et des mises a jour par id pour 1K, 100K et 1M symboles.
+//
+//   make bench-symboles && ./bench_symboles
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../tableSymboles.h"
+
+#define NB_RECHERCHES 4000000
+
+static double maintenant(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void mesurer(int taille) {
+    StringId *noms = malloc(taille * sizeof(StringId));
+    char nom[32];
+    for (int i = 0; i < taille; i++) {
+        snprintf(nom, sizeof(nom), "var_%d", i);
+        noms[i] = internString(nom);
+    }
+
+    SymbolTable *table = createSymbolTable();
+    double debut = maintenant();
+    for (int i = 0; i < taille; i++) {
+        insertSymbol(table, noms[i], TYPE_INTEGER, "0", 0, false, true);
+    }
+    double insertion = maintenant() - debut;
+
+    // acces pseudo-aleatoires pour ne pas profiter de l'ordre d'insertion
+    unsigned int graine = 12345;
+    long trouves = 0;
+    debut = maintenant();
+    for (int i = 0; i < NB_RECHERCHES; i++) {
+        graine = graine * 1103515245u + 12345u;
+        trouves += lookupSymbolByName(table, noms[graine % taille], 0) != NULL;
+    }
+    double recherche = maintenant() - debut;
+
+    debut = maintenant();
+    for (int i = 0; i < NB_RECHERCHES; i++) {
+        graine = graine * 1103515245u + 12345u;
+        updateSymbolValue(table, graine % taille, "1", 0);
+    }
+    double miseAJour = maintenant() - debut;
+
+    printf("%8d symboles : insertion %7.2f Mops/s | recherche %7.2f Mops/s | maj par id %7.2f Mops/s (%ld trouves)\n",
+           taille, taille / insertion / 1e6, NB_RECHERCHES / recherche / 1e6,
+           NB_RECHERCHES / miseAJour / 1e6, trouves);
+
+    freeSymbolTable(table);
+    free(noms);
+}
+
+int main(void) {
+    initInterner();
+    mesurer(1000);
+    mesurer(100000);
+    mesurer(1000000);
+    freeInterner();
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Microbenchmark des noyaux de vecteurs.h : debit (Go/s lus et ecrits)
+// des operations element par element et des reductions sur des tableaux
+// de NB_ELEMENTS, face a une boucle scalaire equivalente.
+//
+//   make bench-vecteurs && ./bench_vecteurs && HS_SIMD=sse2 ./bench_vecteurs
+//
+// HS_SIMD=sse2 impose la version SSE2 meme si le processeur a AVX2.
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../vecteurs.h"
+
+#define NB_ELEMENTS (1 << 22)
+#define NB_REPETITIONS 20
+
+static double maintenant(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void *tampon(size_t taille) {
+    void *p = aligned_alloc(VEC_ALIGNMENT, taille);
+    if (!p) {
+        fprintf(stderr, "memoire insuffisante\n");
+        exit(1);
+    }
+    return p;
+}
+
+static void afficher(const char *nom, double secondes, size_t octets, double reference) {
+    printf("%-22s %8.2f Go/s", nom, octets * (double)NB_REPETITIONS / secondes / 1e9);
+    if (reference > 0) {
+        printf("   x%.1f", reference / secondes);
+    }
+    putchar('\n');
+}
+
+// empeche le compilateur de supprimer les boucles scalaires
+static volatile double puits;
+
+int main(void) {
+    size_t n = NB_ELEMENTS;
+    int64_t *a = tampon(n * sizeof(int64_t)), *b = tampon(n * sizeof(int64_t)), *c = tampon(n * sizeof(int64_t));
+    double *x = tampon(n * sizeof(double)), *y = tampon(n * sizeof(double)), *z = tampon(n * sizeof(double));
+    bool *m = tampon(n);
+    srand(42);
+    for (size_t k = 0; k < n; k++) {
+        a[k] = rand() - RAND_MAX / 2;
+        b[k] = rand() % 1000;
+        x[k] = rand() / (double)RAND_MAX;
+        y[k] = rand() / (double)RAND_MAX + 0.5;
+    }
+    printf("noyaux : %s, %zu elements\n", vecTarget(), n);
+
+    double t0 = maintenant();
+    for (int r = 0; r < NB_REPETITIONS; r++) {
+        for (size_t k = 0; k < n; k++) c[k] = a[k] + b[k];
+        puits += c[r];
+    }
+    double scalaire = maintenant() - t0;
+    afficher("int + int (scalaire)", scalaire, 3 * n * sizeof(int64_t), 0);
+    t0 = maintenant();
+    for (int r = 0; r < NB_REPETITIONS; r++) vecInt(VEC_ADD, c, a, 1, b, 1, n);
+    afficher("int + int", maintenant() - t0, 3 * n * sizeof(int64_t), scalaire);
+
+    t0 = maintenant();
+    for (int r = 0; r < NB_REPETITIONS; r++) {
+        for (size_t k = 0; k < n; k++) z[k] = x[k] / y[k];
+        puits += z[r];
+    }
+    scalaire = maintenant() - t0;
+    afficher("float / float (scal.)", scalaire, 3 * n * sizeof(double), 0);
+    t0 = maintenant();
+    for (int r = 0; r < NB_REPETITIONS; r++) vecFloat(VEC_DIV, z, x, 1, y, 1, n);
+    afficher("float / float", maintenant() - t0, 3 * n * sizeof(double), scalaire);
+
+    t0 = maintenant();
+    for (int r = 0; r < NB_REPETITIONS; r++) vecCompareFloat(VEC_LT, m, x, 1, y, 0, n);
+    afficher("float < scalaire", maintenant() - t0, n * (sizeof(double) + 1), 0);
+
+    t0 = maintenant();
+    for (int r = 0; r < NB_REPETITIONS; r++) {
+        double s = 0;
+        for (size_t k = 0; k < n; k++) s += x[k];
+        puits += s;
+    }
+    scalaire = maintenant() - t0;
+    afficher("sum float (scalaire)", scalaire, n * sizeof(double), 0);
+    t0 = maintenant();
+    for (int r = 0; r < NB_REPETITIONS; r++) puits += vecSumFloat(x, n);
+    afficher("sum float", maintenant() - t0, n * sizeof(double), scalaire);
+
+    t0 = maintenant();
+    for (int r = 0; r < NB_REPETITIONS; r++) puits += (double)vecSumInt(a, n);
+    afficher("sum int", maintenant() - t0, n * sizeof(int64_t), 0);
+    t0 = maintenant();
+    for (int r = 0; r < NB_REPETITIONS; r++) puits += (double)vecMinInt(a, n);
+    afficher("min int", maintenant() - t0, n * sizeof(int64_t), 0);
+    t0 = maintenant();
+    for (int r = 0; r < NB_REPETITIONS; r++) puits += vecMaxFloat(x, n);
+    afficher("max float", maintenant() - t0, n * sizeof(double), 0);
+
+    free(a); free(b); free(c); free(x); free(y); free(z); free(m);
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Microbenchmark de la machine virtuelle : debit d'execution (quads/s) sur
+// les boucles While et Repeat telles que les produit syntaxique.y (voir les
+// exemples de input.txt), avec N iterations.
+//
+//   make bench-vm && ./bench_vm && ./bench_vm_switch
+//
+// bench_vm_switch est compile avec -DVM_SWITCH_DISPATCH (switch au lieu du
+// goto calcule). La variante "dynamique" execute la meme boucle sans types
+// declares : toutes les operations passent par les versions generiques.
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../vm.h"
+
+#define NB_ITERATIONS 5000000
+#define NB_REPETITIONS 3
+
+static double maintenant(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int qc;
+
+static void emettre(tableQuads *t, const char *op, const char *a, const char *b, const char *r) {
+    insererQuadreplet(t, op, a, b, r, qc++);
+}
+
+static void declarer(SymbolTable *table, const char *nom, int type) {
+    insertSymbol(table, internString(nom), type, type == TYPE_FLOAT ? "0.0" : "0", 0, false, true);
+}
+
+// Let int e be 0 / Let int s be 0
+// While e < N:  s == s + e * 2 - e // 3   e == e + 1  EndWhile
+static void boucleWhile(tableQuads *t, SymbolTable *table, int types) {
+    char limite[32];
+    snprintf(limite, sizeof(limite), "%d", NB_ITERATIONS);
+    if (types) {
+        declarer(table, "e", TYPE_INTEGER);
+        declarer(table, "s", TYPE_INTEGER);
+    }
+    emettre(t, ":=", "0", "", "e");
+    emettre(t, ":=", "0", "", "s");
+    emettre(t, "WHILE_COND_3", "", "", "");
+    emettre(t, "<", "e", limite, "t4");
+    emettre(t, "BZ", "WHILE_END_3", "", "t4");
+    emettre(t, "*", "e", "2", "t6");
+    emettre(t, "+", "s", "t6", "t7");
+    emettre(t, "DIV", "e", "3", "t8");
+    emettre(t, "-", "t7", "t8", "t9");
+    emettre(t, ":=", "t9", "", "s");
+    emettre(t, "+", "e", "1", "t11");
+    emettre(t, ":=", "t11", "", "e");
+    emettre(t, "BR", "", "", "WHILE_COND_3");
+    emettre(t, "WHILE_END_3", "", "", "");
+}
+
+// Let int c be 0 / Let float x be 0.0
+// Repeat:  x == x * 0.5 + 1.25   c == c + 1  Until c >= N EndRepeat
+static void boucleRepeat(tableQuads *t, SymbolTable *table, int types) {
+    char limite[32];
+    snprintf(limite, sizeof(limite), "%d", NB_ITERATIONS);
+    if (types) {
+        declarer(table, "c", TYPE_INTEGER);
+        declarer(table, "x", TYPE_FLOAT);
+    }
+    emettre(t, ":=", "0", "", "c");
+    emettre(t, ":=", "0.0", "", "x");
+    emettre(t, "REPEAT_START_3", "", "", "");
+    emettre(t, "*", "x", "0.5", "t4");
+    emettre(t, "+", "t4", "1.25", "t5");
+    emettre(t, ":=", "t5", "", "x");
+    emettre(t, "+", "c", "1", "t7");
+    emettre(t, ":=", "t7", "", "c");
+    emettre(t, ">=", "c", limite, "t9");
+    emettre(t, "BZ", "REPEAT_START_3", "", "t9");
+    emettre(t, "REPEAT_END_3", "", "", "");
+}
+
+static void mesurer(const char *nom, void (*construire)(tableQuads *, SymbolTable *, int), int types) {
+    tableQuads quads;
+    initQuads(&quads);
+    SymbolTable *table = createSymbolTable();
+    qc = 1;
+    construire(&quads, table, types);
+
+    VmProgram programme;
+    if (vmLoad(&programme, &quads, table, stderr) < 0) {
+        exit(1);
+    }
+    double meilleur = 1e30;
+    for (int i = 0; i < NB_REPETITIONS; i++) {
+        double debut = maintenant();
+        vmRun(&programme, NULL, stdout, stderr);
+        double duree = maintenant() - debut;
+        if (duree < meilleur) {
+            meilleur = duree;
+        }
+    }
+    printf("%-18s %10ld quads en %7.2f ms : %8.1f Mquads/s\n",
+           nom, programme.executed, meilleur * 1e3, programme.executed / meilleur / 1e6);
+
+    vmFree(&programme);
+    freeSymbolTable(table);
+    libererQuads(&quads);
+}
+
+int main(void) {
+    initInterner();
+    mesurer("while (types)", boucleWhile, 1);
+    mesurer("while (dynamique)", boucleWhile, 0);
+    mesurer("repeat (types)", boucleRepeat, 1);
+    mesurer("repeat (dynamique)", boucleRepeat, 0);
+    freeInterner();
+    return 0;
+}
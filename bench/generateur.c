@@ -0,0 +1,321 @@
+// Generateur de programmes HumanScript pour le banc de mesure du
+// compilateur (bench/bench.sh). Meme graine, meme forme et meme taille :
+// meme programme, octet pour octet, sur toutes les machines (splitmix64,
+// pas de rand()).
+//
+//   make bench-outils && ./bench_generateur [-s graine] forme taille > prog.txt
+//
+// Formes (taille : ce qui grandit) :
+//   declarations   Let / const de tous les types, chacune lisant les precedentes
+//   conditions     taille if / elseIf / else imbriques, par blocs de 48 niveaux
+//   boucles        taille boucles While et Repeat, corps tires au sort
+//   tableaux       litteral [..] de taille elements, puis sum / min / max
+//   dictionnaires  litteral Dict de taille cles, puis des lectures
+//   chaines        concatenation de taille morceaux de chaines
+//   switch         Switch de taille cas, denses puis epars
+//   mixte          taille instructions de toutes les formes melangees
+//   analyse        taille lignes "type nom" pour analyse_syntaxique
+// Les programmes sont corrects et s'executent sans Input (--run).
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define INDENTATION_MAX 12      // niveaux indentes, au-dela le texte reste a plat
+#define PROFONDEUR_MAX 48       // if imbriques d'un meme bloc
+#define CORPS_MAX 6             // instructions tirees au sort par corps de boucle
+
+static uint64_t graine;
+
+static uint64_t aleatoire(void) {
+    uint64_t z = (graine += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// entier dans [0, n[
+static long tirer(long n) {
+    return (long)(aleatoire() % (uint64_t)n);
+}
+
+static void indenter(int niveau) {
+    for (int k = 0; k < niveau && k < INDENTATION_MAX; k++) {
+        fputs("    ", stdout);
+    }
+}
+
+static const char *const mots[] = {
+    "alpha", "beta", "gamma", "delta", "omega", "sigma", "kappa", "lambda",
+};
+#define NB_MOTS ((int)(sizeof(mots) / sizeof(mots[0])))
+
+// ---------------------------------------------------------------------------
+
+// v<k> : entier, f<k> : reel, b<k> : booleen, s<k> : chaine, selon k % 4
+static void declarations(long n) {
+    for (long k = 0; k < n; k++) {
+        // une declaration sur huit est une constante
+        const char *genre = tirer(8) == 0 ? "const" : "Let";
+        long j = k >= 4 ? k - 4 * (1 + tirer(k / 4 < 16 ? k / 4 : 16)) : -1;
+        switch (k % 4) {
+            case 0:
+                if (j >= 0) {
+                    printf("%s int v%ld be v%ld * %ld + %ld\n", genre, k, j, 1 + tirer(9), tirer(100));
+                } else {
+                    printf("%s int v%ld be %ld\n", genre, k, tirer(1000));
+                }
+                break;
+            case 1:
+                if (j >= 0) {
+                    printf("%s float f%ld be f%ld / 2 + %ld.5\n", genre, k, j, tirer(10));
+                } else {
+                    printf("%s float f%ld be %ld.25\n", genre, k, tirer(100));
+                }
+                break;
+            case 2:
+                if (j >= 0) {
+                    printf("%s bool b%ld be v%ld > %ld and not b%ld\n", genre, k, j - 2, tirer(1000), j);
+                } else {
+                    printf("%s bool b%ld be %s\n", genre, k, tirer(2) ? "true" : "false");
+                }
+                break;
+            default:
+                printf("%s str s%ld be \"%s\" + \"%ld\"\n", genre, k, mots[tirer(NB_MOTS)], k);
+                break;
+        }
+    }
+    if (n > 0) {
+        printf("Print v%ld\n", (n - 1) / 4 * 4);
+    }
+}
+
+// chaque niveau s'ouvre dans la premiere branche du precedent, par blocs
+// de PROFONDEUR_MAX niveaux (la pile du parseur, pile.h, garde deux
+// entrees par if ouvert)
+static void conditions(long n) {
+    puts("Let int x be 0");
+    puts("Let int y be 0");
+    puts("Let int n be 0");
+    for (long bloc = 0; bloc < n; bloc += PROFONDEUR_MAX) {
+        long profondeur = n - bloc < PROFONDEUR_MAX ? n - bloc : PROFONDEUR_MAX;
+        for (long k = 0; k < profondeur; k++) {
+            indenter((int)k);
+            switch (tirer(3)) {
+                case 0: printf("if x < %ld :\n", profondeur - k + tirer(4)); break;
+                case 1: printf("if x >= 0 and y != %ld :\n", 1 + tirer(1000)); break;
+                default: printf("if not (x > %ld) or y == %ld :\n", profondeur + tirer(10), tirer(5)); break;
+            }
+            indenter((int)k + 1);
+            printf("n == n + %ld\n", 1 + tirer(9));
+        }
+        for (long k = profondeur - 1; k >= 0; k--) {
+            indenter((int)k);
+            printf("elseIf y > %ld :\n", tirer(100));
+            indenter((int)k + 1);
+            puts("n == n - 1");
+            indenter((int)k);
+            puts("else:");
+            indenter((int)k + 1);
+            puts("y == y + 1");
+            indenter((int)k);
+            puts("EndIf");
+        }
+        puts("x == x + 1");
+    }
+    puts("Print n");
+    puts("Print y");
+}
+
+static void corps(long k, int niveau) {
+    long nb = 1 + tirer(CORPS_MAX);
+    for (long i = 0; i < nb; i++) {
+        indenter(niveau);
+        switch (tirer(4)) {
+            case 0: printf("s == s + i%ld * %ld\n", k, 1 + tirer(7)); break;
+            case 1: printf("s == s - i%ld // %ld\n", k, 1 + tirer(7)); break;
+            case 2: printf("x == x * 0.5 + %ld.0\n", tirer(10)); break;
+            default: printf("if i%ld %% %ld == 0 :\n", k, 2 + tirer(5));
+                     indenter(niveau + 1);
+                     puts("s == s + 1");
+                     indenter(niveau);
+                     puts("EndIf");
+                     break;
+        }
+    }
+}
+
+static void boucles(long n) {
+    puts("Let int s be 0");
+    puts("Let float x be 0.0");
+    for (long k = 0; k < n; k++) {
+        long tours = 1 + tirer(20);
+        printf("Let int i%ld be 0\n", k);
+        if (k % 2 == 0) {
+            printf("While i%ld < %ld:\n", k, tours);
+            corps(k, 1);
+            printf("    i%ld == i%ld + 1\n", k, k);
+            puts("EndWhile");
+        } else {
+            puts("Repeat:");
+            corps(k, 1);
+            printf("    i%ld == i%ld + 1\n", k, k);
+            printf("Until i%ld >= %ld\n", k, tours);
+            puts("EndRepeat");
+        }
+    }
+    puts("Print s");
+    puts("Print x");
+}
+
+static void tableaux(long n) {
+    fputs("Let Array a be [", stdout);
+    for (long k = 0; k < n; k++) {
+        printf(k ? ", %ld" : "%ld", tirer(1000000));
+    }
+    puts("]");
+    puts("Print sum(a)");
+    puts("Print min(a)");
+    puts("Print max(a)");
+}
+
+static void dictionnaires(long n) {
+    fputs("Let Dict d be {", stdout);
+    for (long k = 0; k < n; k++) {
+        printf(k ? ", \"%s%ld\": %ld" : "\"%s%ld\": %ld", mots[k % NB_MOTS], k, tirer(1000));
+    }
+    puts("}");
+    puts("Let int somme be 0");
+    for (long k = 0; k < 16 && n > 0; k++) {
+        long cle = tirer(n);
+        printf("somme == somme + d[\"%s%ld\"]\n", mots[cle % NB_MOTS], cle);
+    }
+    puts("Print somme");
+}
+
+// une seule expression, coupee en lignes de huit morceaux
+static void chaines(long n) {
+    fputs("Let str s be \"\"", stdout);
+    for (long k = 0; k < n; k++) {
+        printf(" + \"%s\"%s", mots[tirer(NB_MOTS)], k % 8 == 7 ? "\n" : "");
+    }
+    puts("");
+    puts("Print s");
+}
+
+// la premiere moitie des cas est dense (0, 1, 2, ...), la seconde eparse
+// (un cas tous les 50 en moyenne)
+static void aiguillage(long n) {
+    long dense = n / 2, maximum = dense + 50 * (n - dense);
+    puts("Let int i be 0");
+    puts("Let int s be 0");
+    printf("While i < %ld:\n", n < 64 ? n : 64);
+    printf("    Switch i * %ld %% %ld:\n", 1 + tirer(97), maximum + 1);
+    for (long k = 0; k < n; k++) {
+        long valeur = k < dense ? k : dense + 50 * (k - dense) + tirer(50);
+        printf("        Case %ld: s == s + %ld\n", valeur, tirer(100));
+    }
+    puts("        Default: s == s - 1");
+    puts("    EndSwitch");
+    puts("    i == i + 1");
+    puts("EndWhile");
+    puts("Print s");
+}
+
+// les formes tour a tour, a petite taille, sur des noms prefixes m<k>_
+static void mixte(long n) {
+    puts("Let int s be 0");
+    puts("Let float x be 0.0");
+    for (long k = 0; k < n; k++) {
+        switch (tirer(5)) {
+            case 0:
+                printf("Let int m%ld be s * %ld + %ld\n", k, 1 + tirer(9), tirer(100));
+                break;
+            case 1:
+                printf("if s > %ld and x < %ld.0 :\n    s == s + 1\nelseIf not (s == %ld) :\n"
+                       "    x == x + 1.0\nEndIf\n", tirer(100), tirer(100), tirer(100));
+                break;
+            case 2:
+                printf("Let int i%ld be 0\nWhile i%ld < %ld:\n", k, k, 1 + tirer(10));
+                corps(k, 1);
+                printf("    i%ld == i%ld + 1\nEndWhile\n", k, k);
+                break;
+            case 3:
+                printf("Let Array a%ld be [%ld, %ld, %ld, %ld]\ns == s + sum(a%ld)\n", k, tirer(100), tirer(100),
+                       tirer(100), tirer(100), k);
+                break;
+            default:
+                printf("Let str c%ld be \"%s\" + \"%s\" + \"%ld\"\n", k, mots[tirer(NB_MOTS)],
+                       mots[tirer(NB_MOTS)], k);
+                break;
+        }
+    }
+    puts("Print s");
+    puts("Print x");
+}
+
+// analyse_syntaxique lit une declaration "type nom" par execution
+static void analyse(long n) {
+    static const char *const types[] = { "int", "float", "bool", "str", "array", "dict", "const" };
+    for (long k = 0; k < n; k++) {
+        printf("%s nom%ld\n", types[tirer(7)], k);
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+typedef struct Forme {
+    const char *nom;
+    void (*generer)(long n);
+} Forme;
+
+static const Forme formes[] = {
+    { "declarations", declarations },
+    { "conditions", conditions },
+    { "boucles", boucles },
+    { "tableaux", tableaux },
+    { "dictionnaires", dictionnaires },
+    { "chaines", chaines },
+    { "switch", aiguillage },
+    { "mixte", mixte },
+    { "analyse", analyse },
+};
+#define NB_FORMES ((int)(sizeof(formes) / sizeof(formes[0])))
+
+static void usage(void) {
+    fprintf(stderr, "Usage: bench_generateur [-s seed] shape size\nshapes:");
+    for (int k = 0; k < NB_FORMES; k++) {
+        fprintf(stderr, " %s", formes[k].nom);
+    }
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv) {
+    int arg = 1;
+    graine = 42;
+    if (arg + 1 < argc && strcmp(argv[arg], "-s") == 0) {
+        graine = strtoull(argv[arg + 1], NULL, 10);
+        arg += 2;
+    }
+    if (argc - arg != 2) {
+        usage();
+        return 2;
+    }
+    char *fin;
+    long taille = strtol(argv[arg + 1], &fin, 10);
+    if (*fin || taille < 0) {
+        fprintf(stderr, "Error: invalid size '%s'\n", argv[arg + 1]);
+        return 2;
+    }
+    for (int k = 0; k < NB_FORMES; k++) {
+        if (strcmp(argv[arg], formes[k].nom) == 0) {
+            // chaque forme a sa propre suite : ajouter une forme ne change pas les autres
+            graine ^= (uint64_t)(k + 1) * 0xD1B54A32D192ED03ull;
+            formes[k].generer(taille);
+            return fflush(stdout) == 0 ? 0 : 1;
+        }
+    }
+    fprintf(stderr, "Error: unknown shape '%s'\n", argv[arg]);
+    usage();
+    return 2;
+}
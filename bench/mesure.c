@@ -0,0 +1,88 @@
+// Mesure d'une commande pour le banc du compilateur (bench/bench.sh) :
+// lancee n fois (entree /dev/null ou le fichier de -i, sorties jetees),
+// elle donne sur une ligne
+//
+//   ms kio statut
+//
+// le meilleur temps reel en millisecondes, la memoire residente maximale
+// en Kio (ru_maxrss de wait4, la plus grande des n executions) et le code
+// de retour de la derniere (128 + signal si elle a ete tuee).
+//
+//   bench_mesure [-n repetitions] [-i entree] commande [arguments...]
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+static double maintenant(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// une execution ; -1 si le processus n'a pas pu etre lance
+static int executer(char **commande, const char *entree, double *secondes, long *kio) {
+    double debut = maintenant();
+    pid_t pid = fork();
+    if (pid < 0) {
+        return -1;
+    }
+    if (pid == 0) {
+        int in = open(entree, O_RDONLY);
+        int out = open("/dev/null", O_WRONLY);
+        if (in < 0 || out < 0 || dup2(in, 0) < 0 || dup2(out, 1) < 0 || dup2(out, 2) < 0) {
+            _exit(127);
+        }
+        execvp(commande[0], commande);
+        _exit(127);
+    }
+    int statut;
+    struct rusage usage;
+    if (wait4(pid, &statut, 0, &usage) < 0) {
+        return -1;
+    }
+    *secondes = maintenant() - debut;
+    *kio = usage.ru_maxrss;
+    return WIFEXITED(statut) ? WEXITSTATUS(statut) : 128 + WTERMSIG(statut);
+}
+
+int main(int argc, char **argv) {
+    int repetitions = 1;
+    const char *entree = "/dev/null";
+    int arg = 1;
+    while (arg + 1 < argc && argv[arg][0] == '-') {
+        if (strcmp(argv[arg], "-n") == 0) {
+            repetitions = atoi(argv[arg + 1]);
+        } else if (strcmp(argv[arg], "-i") == 0) {
+            entree = argv[arg + 1];
+        } else {
+            break;
+        }
+        arg += 2;
+    }
+    if (arg >= argc || repetitions < 1) {
+        fprintf(stderr, "Usage: bench_mesure [-n repetitions] [-i input] command [arguments...]\n");
+        return 2;
+    }
+    double meilleur = 0;
+    long kioMax = 0;
+    int statut = 0;
+    for (int r = 0; r < repetitions; r++) {
+        double secondes;
+        long kio;
+        statut = executer(argv + arg, entree, &secondes, &kio);
+        if (statut < 0) {
+            perror("bench_mesure");
+            return 2;
+        }
+        meilleur = r == 0 || secondes < meilleur ? secondes : meilleur;
+        kioMax = kio > kioMax ? kio : kioMax;
+    }
+    printf("%.3f %ld %d\n", meilleur * 1000, kioMax, statut);
+    return 0;
+}
@@ -0,0 +1,52 @@
+#ifndef BITSET_H
+#define BITSET_H
+#include <stdint.h>
+#include <string.h>
+
+// Ensembles de bits de taille fixe pour les analyses de flot de donnees
+// (cfg.c, optimizer.c) : un ensemble de n elements occupe BITSET_WORDS(n)
+// mots de 64 bits consecutifs.
+
+#define BITSET_WORDS(n) (((n) + 63) / 64)
+
+static inline void bitsetAdd(uint64_t *s, int i) {
+    s[i >> 6] |= (uint64_t)1 << (i & 63);
+}
+
+static inline void bitsetRemove(uint64_t *s, int i) {
+    s[i >> 6] &= ~((uint64_t)1 << (i & 63));
+}
+
+static inline int bitsetHas(const uint64_t *s, int i) {
+    return (int)((s[i >> 6] >> (i & 63)) & 1);
+}
+
+static inline void bitsetClearAll(uint64_t *s, int words) {
+    memset(s, 0, words * sizeof(uint64_t));
+}
+
+static inline void bitsetFillAll(uint64_t *s, int words) {
+    memset(s, 0xff, words * sizeof(uint64_t));
+}
+
+static inline void bitsetCopy(uint64_t *dst, const uint64_t *src, int words) {
+    memcpy(dst, src, words * sizeof(uint64_t));
+}
+
+static inline void bitsetUnion(uint64_t *dst, const uint64_t *src, int words) {
+    for (int w = 0; w < words; w++) dst[w] |= src[w];
+}
+
+static inline void bitsetIntersect(uint64_t *dst, const uint64_t *src, int words) {
+    for (int w = 0; w < words; w++) dst[w] &= src[w];
+}
+
+static inline void bitsetSubtract(uint64_t *dst, const uint64_t *src, int words) {
+    for (int w = 0; w < words; w++) dst[w] &= ~src[w];
+}
+
+static inline int bitsetEqual(const uint64_t *a, const uint64_t *b, int words) {
+    return memcmp(a, b, words * sizeof(uint64_t)) == 0;
+}
+
+#endif
@@ -0,0 +1,427 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bytecode.h"
+#include "idmap.h"
+
+// ---------------------------------------------------------------------------
+// Ecriture
+
+#define BYTECODE_OPCODE_NAME(name, text) text,
+static const char *const opcodeNames[BYTECODE_OPCODE_COUNT] = { BYTECODE_OPCODES(BYTECODE_OPCODE_NAME) };
+
+typedef struct PoolBuilder {
+    IdMap indices;
+    BytecodeString *strings;
+    uint32_t count;
+    uint32_t dataSize;
+    StringId *ids;          // chaine de chaque indice, dans l'ordre
+} PoolBuilder;
+
+typedef struct Writer {
+    const tableQuads *quads;
+    PoolBuilder pool;
+    IdMap opcodes;          // operateur -> code
+    IdMap labels;           // etiquette -> indice de son quad
+    IdMap literals;         // texte du litteral -> constante
+    BytecodeConstant *constants;
+    uint32_t constantCount;
+} Writer;
+
+static uint32_t poolIndex(PoolBuilder *pool, StringId id) {
+    int32_t index = idMapGet(&pool->indices, id, -1);
+    if (index >= 0) {
+        return (uint32_t)index;
+    }
+    uint32_t length = (uint32_t)internedLength(id);
+    pool->strings[pool->count].offset = pool->dataSize;
+    pool->strings[pool->count].length = length;
+    pool->ids[pool->count] = id;
+    pool->dataSize += length + 1;
+    idMapPut(&pool->indices, id, (int32_t)pool->count);
+    return pool->count++;
+}
+
+static uint32_t align4(uint32_t n) {
+    return (n + 3) & ~3u;
+}
+
+static BytecodeOperand makeOperand(uint32_t kind, uint32_t index) {
+    return (index << 3) | kind;
+}
+
+// texte d'une constante numerique tel que l'ecrit valuePlace (semantic.c)
+static void formatNumber(const BytecodeConstant *c, char *buffer, size_t size) {
+    if (c->type == BYTECODE_CONSTANT_INT) {
+        snprintf(buffer, size, "%lld", (long long)c->as.i);
+        return;
+    }
+    snprintf(buffer, size, "%.15g", c->as.f);
+    if (strtod(buffer, NULL) != c->as.f) {
+        snprintf(buffer, size, "%.17g", c->as.f);
+    }
+    if (!strpbrk(buffer, ".eEni")) {
+        strncat(buffer, ".0", size - strlen(buffer) - 1);
+    }
+}
+
+// 1 si text est un litteral (memes regles que parseLiteral dans vm.c). Un
+// nombre dont le texte ne se reecrit pas a l'identique reste un nom : le
+// programme relu doit s'afficher comme l'original
+static int parseConstant(PoolBuilder *pool, StringId id, BytecodeConstant *c) {
+    const char *text = internedString(id);
+    size_t length = internedLength(id);
+    memset(c, 0, sizeof(*c));
+    if (length >= 2 && text[0] == '"' && text[length - 1] == '"') {
+        c->type = BYTECODE_CONSTANT_STRING;
+        c->string = poolIndex(pool, internStringN(text + 1, length - 2));
+        return 1;
+    }
+    if (strcmp(text, "true") == 0 || strcmp(text, "false") == 0) {
+        c->type = BYTECODE_CONSTANT_BOOL;
+        c->as.i = text[0] == 't';
+        return 1;
+    }
+    if (!isdigit((unsigned char)text[0]) || length >= 64) {
+        return 0;
+    }
+    if (strpbrk(text, ".eE")) {
+        c->type = BYTECODE_CONSTANT_FLOAT;
+        c->as.f = strtod(text, NULL);
+    } else {
+        c->type = BYTECODE_CONSTANT_INT;
+        c->as.i = strtoll(text, NULL, 10);
+    }
+    char buffer[64];
+    formatNumber(c, buffer, sizeof(buffer));
+    return strcmp(buffer, text) == 0;
+}
+
+// branch : l'operande est la cible d'un branchement (etiquette ou numero
+// de quad apres -O)
+static BytecodeOperand encodeOperand(Writer *w, StringId id, int branch) {
+    if (id == STRING_ID_NONE) {
+        return BYTECODE_OPERAND_NONE;
+    }
+    if (branch) {
+        int cible = indiceCible(w->quads, id);
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "%d", w->quads->premier + cible);
+        if (cible >= 0 && strcmp(buffer, internedString(id)) == 0) {
+            return makeOperand(BYTECODE_OPERAND_QUAD, (uint32_t)cible);
+        }
+        int32_t label = idMapGet(&w->labels, id, -1);
+        if (label >= 0) {
+            return makeOperand(BYTECODE_OPERAND_LABEL, (uint32_t)label);
+        }
+    }
+    int32_t constant = idMapGet(&w->literals, id, -1);
+    if (constant >= 0) {
+        return makeOperand(BYTECODE_OPERAND_CONSTANT, (uint32_t)constant);
+    }
+    BytecodeConstant c;
+    if (parseConstant(&w->pool, id, &c)) {
+        w->constants[w->constantCount] = c;
+        idMapPut(&w->literals, id, (int32_t)w->constantCount);
+        return makeOperand(BYTECODE_OPERAND_CONSTANT, w->constantCount++);
+    }
+    return makeOperand(BYTECODE_OPERAND_NAME, poolIndex(&w->pool, id));
+}
+
+static void freeWriter(Writer *w, BytecodeQuad *code, BytecodeSymbol *symbols) {
+    freeIdMap(&w->pool.indices);
+    freeIdMap(&w->opcodes);
+    freeIdMap(&w->labels);
+    freeIdMap(&w->literals);
+    free(w->pool.strings);
+    free(w->pool.ids);
+    free(w->constants);
+    free(code);
+    free(symbols);
+}
+
+int bytecodeWrite(FILE *out, tableQuads *quads, SymbolTable *table) {
+    int symbolCount = 0;
+    for (int id = 0; id < table->nextId; id++) {
+        symbolCount += table->byId[id] != NULL;
+    }
+    for (int i = 0; i < quads->taille; i++) {
+        if (quads->quads[i].qc != quads->premier + i) {
+            fprintf(stderr, "Error: quads are not numbered consecutively\n");
+            return -1;
+        }
+    }
+
+    // chaque operande ajoute au plus une chaine (ou une constante et sa chaine)
+    uint32_t maxStrings = 1 + 3 * (uint32_t)quads->taille + 2 * (uint32_t)symbolCount;
+    uint32_t maxConstants = 3 * (uint32_t)quads->taille;
+    Writer w;
+    memset(&w, 0, sizeof(w));
+    w.quads = quads;
+    BytecodeQuad *code = (BytecodeQuad *)calloc(quads->taille + 1, sizeof(BytecodeQuad));
+    BytecodeSymbol *symbols = (BytecodeSymbol *)calloc(symbolCount + 1, sizeof(BytecodeSymbol));
+    w.pool.strings = (BytecodeString *)malloc(maxStrings * sizeof(BytecodeString));
+    w.pool.ids = (StringId *)malloc(maxStrings * sizeof(StringId));
+    w.constants = (BytecodeConstant *)malloc((maxConstants + 1) * sizeof(BytecodeConstant));
+    int ok = code && symbols && w.pool.strings && w.pool.ids && w.constants &&
+             initIdMap(&w.pool.indices, maxStrings) == 0 &&
+             initIdMap(&w.opcodes, BYTECODE_OPCODE_COUNT) == 0 &&
+             initIdMap(&w.labels, (uint32_t)quads->taille) == 0 &&
+             initIdMap(&w.literals, maxConstants) == 0;
+    if (!ok) {
+        fprintf(stderr, "Error: Out of memory while writing bytecode\n");
+        freeWriter(&w, code, symbols);
+        return -1;
+    }
+    if (maxStrings > BYTECODE_MAX_INDEX || (uint32_t)quads->taille > BYTECODE_MAX_INDEX) {
+        fprintf(stderr, "Error: program too large for the bytecode format\n");
+        freeWriter(&w, code, symbols);
+        return -1;
+    }
+    poolIndex(&w.pool, STRING_ID_NONE);
+    for (int op = BYTECODE_OP_LABEL + 1; op < BYTECODE_OPCODE_COUNT; op++) {
+        idMapPut(&w.opcodes, internString(opcodeNames[op]), op);
+    }
+
+    // etiquettes : pseudo-quads dont seul l'operateur est renseigne
+    for (int i = 0; i < quads->taille; i++) {
+        quad *q = &quads->quads[i];
+        if (q->operande1 == STRING_ID_NONE && q->operande2 == STRING_ID_NONE &&
+            q->resultat == STRING_ID_NONE && idMapGet(&w.opcodes, q->operateur, -1) < 0 &&
+            idMapGet(&w.labels, q->operateur, -1) < 0) {
+            idMapPut(&w.labels, q->operateur, i);
+        }
+    }
+
+    for (int i = 0; i < quads->taille; i++) {
+        quad *q = &quads->quads[i];
+        int op = idMapGet(&w.opcodes, q->operateur, -1);
+        if (op < 0) {
+            if (q->operande1 != STRING_ID_NONE || q->operande2 != STRING_ID_NONE ||
+                q->resultat != STRING_ID_NONE) {
+                fprintf(stderr, "Error: unknown operator '%s' in quad %d\n", internedString(q->operateur), q->qc);
+                freeWriter(&w, code, symbols);
+                return -1;
+            }
+            code[i].opcode = BYTECODE_OP_LABEL;
+            code[i].operande1 = makeOperand(BYTECODE_OPERAND_NAME, poolIndex(&w.pool, q->operateur));
+            continue;
+        }
+        code[i].opcode = (uint16_t)op;
+        code[i].operande1 = encodeOperand(&w, q->operande1, op == BYTECODE_OP_BZ || op == BYTECODE_OP_BNZ ||
+                                                            op == BYTECODE_OP_CASE);
+        code[i].operande2 = encodeOperand(&w, q->operande2, 0);
+        code[i].resultat = encodeOperand(&w, q->resultat, op == BYTECODE_OP_BR);
+    }
+
+    int n = 0;
+    for (int id = 0; id < table->nextId; id++) {
+        SymbolEntry *e = table->byId[id];
+        if (!e) {
+            continue;
+        }
+        symbols[n].id = e->id;
+        symbols[n].name = poolIndex(&w.pool, e->name);
+        symbols[n].value = poolIndex(&w.pool, e->value);
+        symbols[n].scopeLevel = e->scopeLevel;
+        symbols[n].type = e->type;
+        symbols[n].flags = (e->isConst ? BYTECODE_SYMBOL_CONST : 0) |
+                           (e->isInitialized ? BYTECODE_SYMBOL_INITIALIZED : 0);
+        n++;
+    }
+
+    // en-tete et quads de 16 octets : les constantes restent alignees sur 8
+    BytecodeHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BYTECODE_MAGIC, 4);
+    header.versionMajor = BYTECODE_VERSION_MAJOR;
+    header.versionMinor = BYTECODE_VERSION_MINOR;
+    header.premier = quads->premier;
+    header.quadCount = (uint32_t)quads->taille;
+    header.quadOffset = sizeof(BytecodeHeader);
+    header.constantCount = w.constantCount;
+    header.constantOffset = header.quadOffset + header.quadCount * sizeof(BytecodeQuad);
+    header.symbolCount = (uint32_t)symbolCount;
+    header.symbolOffset = header.constantOffset + header.constantCount * sizeof(BytecodeConstant);
+    header.stringCount = w.pool.count;
+    header.stringOffset = header.symbolOffset + header.symbolCount * sizeof(BytecodeSymbol);
+    header.stringDataSize = align4(w.pool.dataSize);
+    header.stringDataOffset = header.stringOffset + header.stringCount * sizeof(BytecodeString);
+    header.fileSize = header.stringDataOffset + header.stringDataSize;
+
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(code, sizeof(BytecodeQuad), quads->taille, out);
+    fwrite(w.constants, sizeof(BytecodeConstant), w.constantCount, out);
+    fwrite(symbols, sizeof(BytecodeSymbol), symbolCount, out);
+    fwrite(w.pool.strings, sizeof(BytecodeString), w.pool.count, out);
+    for (uint32_t i = 0; i < w.pool.count; i++) {
+        fwrite(internedString(w.pool.ids[i]), 1, w.pool.strings[i].length + 1, out);
+    }
+    static const char padding[4];
+    fwrite(padding, 1, header.stringDataSize - w.pool.dataSize, out);
+
+    freeWriter(&w, code, symbols);
+    return ferror(out) ? -1 : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Lecture : projection du fichier et controle des bornes des sections
+// (aucun decodage, les enregistrements sont utilises en place)
+
+static int sectionFits(uint32_t offset, uint32_t count, size_t size, uint32_t alignment, uint32_t fileSize) {
+    return offset % alignment == 0 && offset <= fileSize && (uint64_t)count * size <= fileSize - offset;
+}
+
+int bytecodeMap(Bytecode *bc, const char *path) {
+    memset(bc, 0, sizeof(*bc));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(BytecodeHeader)) {
+        close(fd);
+        return -1;
+    }
+    void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+
+    const BytecodeHeader *h = (const BytecodeHeader *)base;
+    const char *data = (const char *)base;
+    int valid = memcmp(h->magic, BYTECODE_MAGIC, 4) == 0 &&
+                h->versionMajor == BYTECODE_VERSION_MAJOR &&
+                h->fileSize == (uint64_t)st.st_size &&
+                sectionFits(h->quadOffset, h->quadCount, sizeof(BytecodeQuad), 4, h->fileSize) &&
+                sectionFits(h->constantOffset, h->constantCount, sizeof(BytecodeConstant), 8, h->fileSize) &&
+                sectionFits(h->symbolOffset, h->symbolCount, sizeof(BytecodeSymbol), 4, h->fileSize) &&
+                sectionFits(h->stringOffset, h->stringCount, sizeof(BytecodeString), 4, h->fileSize) &&
+                sectionFits(h->stringDataOffset, h->stringDataSize, 1, 4, h->fileSize) &&
+                h->stringDataSize > 0 && h->stringCount > 0 &&
+                data[h->stringDataOffset + h->stringDataSize - 1] == '\0';
+    if (!valid) {
+        munmap(base, st.st_size);
+        return -1;
+    }
+
+    bc->header = h;
+    bc->quads = (const BytecodeQuad *)(data + h->quadOffset);
+    bc->constants = (const BytecodeConstant *)(data + h->constantOffset);
+    bc->symbols = (const BytecodeSymbol *)(data + h->symbolOffset);
+    bc->strings = (const BytecodeString *)(data + h->stringOffset);
+    bc->stringData = data + h->stringDataOffset;
+    bc->mappedLength = st.st_size;
+    return 0;
+}
+
+void bytecodeUnmap(Bytecode *bc) {
+    if (bc->header) {
+        munmap((void *)bc->header, bc->mappedLength);
+    }
+    memset(bc, 0, sizeof(*bc));
+}
+
+// la zone des chaines se termine par '\0' : tout decalage valide donne une
+// chaine terminee, meme si le fichier a ete altere
+const char *bytecodeString(const Bytecode *bc, uint32_t index) {
+    if (index >= bc->header->stringCount || bc->strings[index].offset >= bc->header->stringDataSize) {
+        return "";
+    }
+    return bc->stringData + bc->strings[index].offset;
+}
+
+const BytecodeConstant *bytecodeConstant(const Bytecode *bc, uint32_t index) {
+    return index < bc->header->constantCount ? &bc->constants[index] : NULL;
+}
+
+const char *bytecodeOpcodeName(int opcode) {
+    return opcode >= 0 && opcode < BYTECODE_OPCODE_COUNT ? opcodeNames[opcode] : "?";
+}
+
+// operande tel que l'ecrit ecrireQuads
+static void dumpOperand(FILE *out, const Bytecode *bc, BytecodeOperand operand) {
+    uint32_t index = BYTECODE_OPERAND_INDEX(operand);
+    switch (BYTECODE_OPERAND_KIND(operand)) {
+        case BYTECODE_OPERAND_NAME:
+            fputs(bytecodeString(bc, index), out);
+            break;
+        case BYTECODE_OPERAND_CONSTANT: {
+            const BytecodeConstant *c = bytecodeConstant(bc, index);
+            char buffer[64];
+            if (!c) {
+                fputs("?", out);
+            } else if (c->type == BYTECODE_CONSTANT_STRING) {
+                fprintf(out, "\"%s\"", bytecodeString(bc, c->string));
+            } else if (c->type == BYTECODE_CONSTANT_BOOL) {
+                fputs(c->as.i ? "true" : "false", out);
+            } else {
+                formatNumber(c, buffer, sizeof(buffer));
+                fputs(buffer, out);
+            }
+            break;
+        }
+        case BYTECODE_OPERAND_LABEL:
+            // nom porte par le quad LABEL vise
+            if (index < bc->header->quadCount && bc->quads[index].opcode == BYTECODE_OP_LABEL &&
+                BYTECODE_OPERAND_KIND(bc->quads[index].operande1) == BYTECODE_OPERAND_NAME) {
+                fputs(bytecodeString(bc, BYTECODE_OPERAND_INDEX(bc->quads[index].operande1)), out);
+            }
+            break;
+        case BYTECODE_OPERAND_QUAD:
+            fprintf(out, "%d", bc->header->premier + (int)index);
+            break;
+        default:
+            break;
+    }
+}
+
+// meme presentation que printSymbolTable puis ecrireQuads, pour comparer un
+// programme recharge a la sortie texte du compilateur
+void bytecodeDump(FILE *out, const Bytecode *bc) {
+    const BytecodeHeader *h = bc->header;
+
+    fprintf(out, "\nSymbol Table Contents:\n");
+    fprintf(out, "ID\tName\tType\tScope\tValue\n");
+    fprintf(out, "----------------------------------------\n");
+    for (uint32_t i = 0; i < h->symbolCount; i++) {
+        const BytecodeSymbol *s = &bc->symbols[i];
+        int initialized = (s->flags & BYTECODE_SYMBOL_INITIALIZED) != 0;
+        fprintf(out, "%d\t%s\t%s\t%d\t%s\n",
+            s->id,
+            bytecodeString(bc, s->name),
+            symbolTypeName(s->type),
+            s->scopeLevel,
+            initialized || s->type == TYPE_ARRAY ? bytecodeString(bc, s->value) : "(uninitialized)");
+    }
+
+    fprintf(out, "\n=============  Affichage des quadruplets =============\n");
+    if (h->quadCount == 0) {
+        fprintf(out, "\n\n \t\t quad *Vide \n");
+    } else {
+        fprintf(out, "___________________________________________________\n\n");
+        for (uint32_t i = 0; i < h->quadCount; i++) {
+            const BytecodeQuad *q = &bc->quads[i];
+            fprintf(out, "\t Quad[%d]=[ ", h->premier + (int)i);
+            if (q->opcode == BYTECODE_OP_LABEL) {
+                dumpOperand(out, bc, q->operande1);
+                fputs(" ,  ,  ,  ] \n", out);
+                continue;
+            }
+            fprintf(out, "%s , ", bytecodeOpcodeName(q->opcode));
+            dumpOperand(out, bc, q->operande1);
+            fputs(" , ", out);
+            dumpOperand(out, bc, q->operande2);
+            fputs(" , ", out);
+            dumpOperand(out, bc, q->resultat);
+            fputs(" ] \n", out);
+        }
+    }
+    fprintf(out, "___________________________________________________\n");
+}
@@ -0,0 +1,141 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "tableSymboles.h"
+#include "quadruplets.h"
+
+// Format binaire du programme compile (fichier .hsb, option -o).
+//
+// Le fichier est concu pour etre projete en memoire (mmap) et utilise tel
+// quel : toutes les sections sont des tableaux d'enregistrements de taille
+// fixe, alignes sur 4 octets (8 pour les constantes), reperes par leur
+// position dans l'en-tete.
+//
+//   BytecodeHeader
+//   BytecodeQuad[quadCount]         instructions, qc = premier + indice
+//   BytecodeConstant[constantCount] litteraux des operandes, dedoublonnes
+//   BytecodeSymbol[symbolCount]     table des symboles, dans l'ordre des ids
+//   BytecodeString[stringCount]     index du pool de chaines
+//   char[stringDataSize]            chaines terminees par '\0'
+//
+// L'operateur est un code (BytecodeOpcode). Un operande (BytecodeOperand)
+// est soit un nom du pool (variable, temporaire, texte d'un tableau ou d'un
+// dictionnaire), soit une constante typee deja decodee (entier, reel,
+// booleen, chaine), soit l'indice du quad vise par un branchement (BR, BZ,
+// BNZ, CASE) : rien n'est a relire sous forme de texte au chargement. Les
+// noms, valeurs de la table des symboles et chaines sont des indices dans
+// un pool dedoublonne ; l'indice 0 est la chaine vide.
+// Entiers au format natif (petit-boutiste sur les cibles habituelles).
+
+#define BYTECODE_MAGIC "HSBC"
+#define BYTECODE_VERSION_MAJOR 2    // change incompatible du format (2 : codes, constantes typees)
+#define BYTECODE_VERSION_MINOR 0    // ajout compatible
+
+// operateurs des quads (ceux de vm.c) ; LABEL : etiquette, son nom en operande1
+#define BYTECODE_OPCODES(X) \
+    X(LABEL, "") X(MOVE, ":=") X(BR, "BR") X(BZ, "BZ") X(BNZ, "BNZ") \
+    X(ADD, "+") X(SUB, "-") X(MUL, "*") X(DIV, "/") X(IDIV, "DIV") X(MOD, "MOD") \
+    X(EQ, "==") X(NE, "!=") X(LT, "<") X(LE, "<=") X(GT, ">") X(GE, ">=") \
+    X(AND, "AND") X(OR, "OR") X(NOT, "NOT") X(NEG, "UMINUS") X(CONCAT, "CONCAT") \
+    X(ARRAY, "ARRAY_DECL") X(PRINT, "PRINT") X(INPUT, "INPUT") \
+    X(VADD, "VADD") X(VSUB, "VSUB") X(VMUL, "VMUL") X(VDIV, "VDIV") X(VIDIV, "VIDIV") X(VMOD, "VMOD") \
+    X(VEQ, "VEQ") X(VNE, "VNE") X(VLT, "VLT") X(VLE, "VLE") X(VGT, "VGT") X(VGE, "VGE") \
+    X(VAND, "VAND") X(VOR, "VOR") X(VNOT, "VNOT") X(VNEG, "VNEG") \
+    X(SUM, "SUM") X(MIN, "MIN") X(MAX, "MAX") \
+    X(DICT, "DICT_DECL") X(INDEX, "INDEX") X(SWITCH, "SWITCH") X(CASE, "CASE") X(HASH, "HASH")
+
+#define BYTECODE_OPCODE_ENUM(name, text) BYTECODE_OP_##name,
+typedef enum BytecodeOpcode {
+    BYTECODE_OPCODES(BYTECODE_OPCODE_ENUM)
+    BYTECODE_OPCODE_COUNT
+} BytecodeOpcode;
+
+// Operande sur 32 bits : genre dans les 3 bits de poids faible, indice
+// au-dessus (pool, constante ou quad selon le genre)
+typedef uint32_t BytecodeOperand;
+
+#define BYTECODE_OPERAND_NONE 0     // absent
+#define BYTECODE_OPERAND_NAME 1     // chaine du pool
+#define BYTECODE_OPERAND_CONSTANT 2 // BytecodeConstant
+#define BYTECODE_OPERAND_LABEL 3    // etiquette : indice de son quad LABEL
+#define BYTECODE_OPERAND_QUAD 4     // numero de quad (cibles apres -O) : indice du quad
+#define BYTECODE_OPERAND_KIND(operand) ((operand) & 7u)
+#define BYTECODE_OPERAND_INDEX(operand) ((operand) >> 3)
+#define BYTECODE_MAX_INDEX ((1u << 29) - 1)
+
+typedef struct BytecodeHeader {
+    char magic[4];
+    uint16_t versionMajor;
+    uint16_t versionMinor;
+    uint32_t fileSize;
+    int32_t premier;
+    uint32_t quadCount, quadOffset;
+    uint32_t constantCount, constantOffset;
+    uint32_t symbolCount, symbolOffset;
+    uint32_t stringCount, stringOffset;
+    uint32_t stringDataSize, stringDataOffset;
+} BytecodeHeader;
+
+typedef struct BytecodeQuad {
+    uint16_t opcode;        // BytecodeOpcode
+    uint16_t reserved;
+    BytecodeOperand operande1;
+    BytecodeOperand operande2;
+    BytecodeOperand resultat;
+} BytecodeQuad;
+
+#define BYTECODE_CONSTANT_INT 1
+#define BYTECODE_CONSTANT_FLOAT 2
+#define BYTECODE_CONSTANT_BOOL 3
+#define BYTECODE_CONSTANT_STRING 4
+
+typedef struct BytecodeConstant {
+    uint32_t type;          // BYTECODE_CONSTANT_INT ... BYTECODE_CONSTANT_STRING
+    uint32_t string;        // STRING : indice du texte (sans guillemets) dans le pool
+    union {
+        int64_t i;          // INT ; BOOL : 0 ou 1
+        double f;           // FLOAT
+    } as;
+} BytecodeConstant;
+
+typedef struct BytecodeSymbol {
+    int32_t id;
+    uint32_t name;
+    uint32_t value;
+    int32_t scopeLevel;
+    int8_t type;
+    uint8_t flags;          // BYTECODE_SYMBOL_CONST | BYTECODE_SYMBOL_INITIALIZED
+    uint16_t reserved;
+} BytecodeSymbol;
+
+#define BYTECODE_SYMBOL_CONST 1
+#define BYTECODE_SYMBOL_INITIALIZED 2
+
+typedef struct BytecodeString {
+    uint32_t offset;        // dans la zone des chaines
+    uint32_t length;
+} BytecodeString;
+
+// programme projete en lecture seule
+typedef struct Bytecode {
+    const BytecodeHeader *header;
+    const BytecodeQuad *quads;
+    const BytecodeConstant *constants;
+    const BytecodeSymbol *symbols;
+    const BytecodeString *strings;
+    const char *stringData;
+    size_t mappedLength;
+} Bytecode;
+
+int bytecodeWrite(FILE *out, tableQuads *quads, SymbolTable *table);
+int bytecodeMap(Bytecode *bc, const char *path);
+void bytecodeUnmap(Bytecode *bc);
+const char *bytecodeString(const Bytecode *bc, uint32_t index);
+// NULL si l'indice est hors de la section
+const BytecodeConstant *bytecodeConstant(const Bytecode *bc, uint32_t index);
+const char *bytecodeOpcodeName(int opcode);
+void bytecodeDump(FILE *out, const Bytecode *bc);
+
+#endif
@@ -0,0 +1,340 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "cache.h"
+
+// la date de construction fait partie de la version : un compilateur
+// reconstruit n'utilise jamais les entrees d'un autre
+static const char versionTag[] = COMPILER_VERSION " " __DATE__ " " __TIME__;
+
+typedef struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    char key[CACHE_KEY_LENGTH];
+    uint32_t symbols;
+    uint32_t quads;
+    int32_t premier;
+    uint64_t sourceLength;
+    uint64_t sourceHash;
+} CacheHeader;
+
+typedef struct CacheEntry {
+    char *path;
+    long long size;
+    double used;            // date de derniere utilisation
+} CacheEntry;
+
+int cacheOpen(CompileCache *cache, const char *directory, long long maxBytes) {
+    cache->directory = directory;
+    cache->maxBytes = maxBytes;
+    // appele avant le lancement des threads : umask() n'a pas de lecture seule
+    mode_t mask = umask(0);
+    umask(mask);
+    cache->mode = 0666 & ~mask;
+    if (mkdir(directory, 0777) < 0 && errno != EEXIST) {
+        perror(directory);
+        return -1;
+    }
+    return 0;
+}
+
+// FNV-1a et djb2 sur 64 bits, prefixes par la version du compilateur
+void cacheKey(const char *data, size_t length, char key[CACHE_KEY_LENGTH + 1]) {
+    uint64_t fnv = 14695981039346656037ull;
+    uint64_t djb = 5381;
+    for (size_t i = 0; i < sizeof(versionTag); i++) {
+        fnv = (fnv ^ (unsigned char)versionTag[i]) * 1099511628211ull;
+        djb = djb * 33 ^ (unsigned char)versionTag[i];
+    }
+    for (size_t i = 0; i < length; i++) {
+        fnv = (fnv ^ (unsigned char)data[i]) * 1099511628211ull;
+        djb = djb * 33 ^ (unsigned char)data[i];
+    }
+    snprintf(key, CACHE_KEY_LENGTH + 1, "%016llx%016llx%08x",
+             (unsigned long long)fnv, (unsigned long long)djb, (unsigned)length);
+}
+
+// verification du contenu : hachage de type Murmur64A, independant de
+// ceux de la cle
+static uint64_t sourceHash(const char *data, size_t length) {
+    const uint64_t m = 0xc6a4a7935bd1e995ull;
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ (length * m);
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t k;
+        memcpy(&k, data + i, sizeof(k));
+        k *= m;
+        k ^= k >> 47;
+        k *= m;
+        h = (h ^ k) * m;
+    }
+    for (int shift = 0; i < length; i++, shift += 8) {
+        h ^= (uint64_t)(unsigned char)data[i] << shift;
+    }
+    h *= m;
+    h ^= h >> 47;
+    h *= m;
+    return h ^ (h >> 47);
+}
+
+static void entryPath(const CompileCache *cache, const char *key, char *path, size_t size) {
+    snprintf(path, size, "%s/%s.hsc", cache->directory, key);
+}
+
+// ---------------------------------------------------------------------------
+// Ecriture : en-tete, symboles dans l'ordre des ids, puis quadruplets.
+// Chaine = longueur sur 32 bits suivie des octets (sans le zero final)
+
+static void writeString(FILE *f, StringId id) {
+    uint32_t length = (uint32_t)internedLength(id);
+    fwrite(&length, sizeof(length), 1, f);
+    fwrite(internedString(id), 1, length, f);
+}
+
+int cacheStore(const CompileCache *cache, const char *key, const char *source, size_t length,
+               SymbolTable *table, tableQuads *quads) {
+    char path[4096], temp[4096];
+    entryPath(cache, key, path, sizeof(path));
+    snprintf(temp, sizeof(temp), "%s/.tmp-XXXXXX", cache->directory);
+    int fd = mkstemp(temp);
+    if (fd < 0) {
+        return -1;
+    }
+    // mkstemp cree en 0600 : l'entree doit rester lisible comme un fichier ordinaire
+    if (fchmod(fd, cache->mode) < 0) {
+        close(fd);
+        unlink(temp);
+        return -1;
+    }
+    FILE *f = fdopen(fd, "wb");
+    if (!f) {
+        close(fd);
+        unlink(temp);
+        return -1;
+    }
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, 4);
+    header.version = CACHE_FORMAT_VERSION;
+    memcpy(header.key, key, CACHE_KEY_LENGTH);
+    for (int id = 0; id < table->nextId; id++) {
+        header.symbols += table->byId[id] != NULL;
+    }
+    header.quads = (uint32_t)quads->taille;
+    header.premier = quads->premier;
+    header.sourceLength = length;
+    header.sourceHash = sourceHash(source, length);
+    fwrite(&header, sizeof(header), 1, f);
+
+    for (int id = 0; id < table->nextId; id++) {
+        SymbolEntry *e = table->byId[id];
+        if (!e) {
+            continue;
+        }
+        int32_t fields[2] = { e->id, e->scopeLevel };
+        unsigned char flags[3] = { (unsigned char)e->type, e->isConst, e->isInitialized };
+        fwrite(fields, sizeof(fields), 1, f);
+        fwrite(flags, sizeof(flags), 1, f);
+        writeString(f, e->name);
+        writeString(f, e->value);
+    }
+    for (int i = 0; i < quads->taille; i++) {
+        quad *q = &quads->quads[i];
+        int32_t qc = q->qc;
+        fwrite(&qc, sizeof(qc), 1, f);
+        writeString(f, q->operateur);
+        writeString(f, q->operande1);
+        writeString(f, q->operande2);
+        writeString(f, q->resultat);
+    }
+
+    int failed = ferror(f);
+    failed |= fclose(f) != 0;
+    if (failed || rename(temp, path) < 0) {
+        unlink(temp);
+        return -1;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Lecture : l'entree est lue en entier puis decodee avec verification des
+// bornes ; une entree illisible est supprimee et comptee comme un echec
+
+typedef struct Reader {
+    const char *data;
+    size_t length;
+    size_t pos;
+} Reader;
+
+static int readBytes(Reader *r, void *dest, size_t size) {
+    if (r->length - r->pos < size) {
+        return -1;
+    }
+    memcpy(dest, r->data + r->pos, size);
+    r->pos += size;
+    return 0;
+}
+
+static int readString(Reader *r, StringId *id) {
+    uint32_t length;
+    if (readBytes(r, &length, sizeof(length)) < 0 || r->length - r->pos < length) {
+        return -1;
+    }
+    *id = internStringN(r->data + r->pos, length);
+    r->pos += length;
+    return 0;
+}
+
+static int decodeEntry(Reader *r, const char *key, const char *source, size_t length,
+                       SymbolTable *table, tableQuads *quads) {
+    CacheHeader header;
+    if (readBytes(r, &header, sizeof(header)) < 0 ||
+        memcmp(header.magic, CACHE_MAGIC, 4) != 0 ||
+        header.version != CACHE_FORMAT_VERSION ||
+        memcmp(header.key, key, CACHE_KEY_LENGTH) != 0 ||
+        header.sourceLength != length || header.sourceHash != sourceHash(source, length)) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < header.symbols; i++) {
+        int32_t fields[2];
+        unsigned char flags[3];
+        StringId name, value;
+        if (readBytes(r, fields, sizeof(fields)) < 0 || readBytes(r, flags, sizeof(flags)) < 0 ||
+            readString(r, &name) < 0 || readString(r, &value) < 0 || fields[0] < table->nextId) {
+            return -1;
+        }
+        restoreSymbol(table, fields[0], name, (signed char)flags[0], internedString(value),
+                      fields[1], flags[1], flags[2]);
+    }
+    for (uint32_t i = 0; i < header.quads; i++) {
+        int32_t qc;
+        StringId operateur, operande1, operande2, resultat;
+        if (readBytes(r, &qc, sizeof(qc)) < 0 || readString(r, &operateur) < 0 ||
+            readString(r, &operande1) < 0 || readString(r, &operande2) < 0 || readString(r, &resultat) < 0) {
+            return -1;
+        }
+        if (insererQuadrepletId(quads, operateur, operande1, operande2, resultat, qc) < 0) {
+            return -1;
+        }
+    }
+    if (header.quads == 0) {
+        quads->premier = header.premier;
+    }
+    return r->pos == r->length ? 0 : -1;
+}
+
+// 1 si l'entree existe, correspond au source et a ete chargee dans table et
+// quads (supposes vides)
+int cacheLoad(const CompileCache *cache, const char *key, const char *source, size_t length,
+              SymbolTable *table, tableQuads *quads) {
+    char path[4096];
+    entryPath(cache, key, path, sizeof(path));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    char *data = NULL;
+    int ok = fstat(fd, &st) == 0 && (data = (char *)malloc(st.st_size ? st.st_size : 1)) != NULL &&
+             read(fd, data, st.st_size) == st.st_size;
+    close(fd);
+
+    Reader reader = { data, ok ? (size_t)st.st_size : 0, 0 };
+    if (!ok || decodeEntry(&reader, key, source, length, table, quads) < 0) {
+        free(data);
+        clearSymbolTable(table);
+        viderQuads(quads);
+        unlink(path);
+        return 0;
+    }
+    free(data);
+
+    // rafraichir la date d'utilisation pour l'eviction LRU
+    utimensat(AT_FDCWD, path, NULL, 0);
+    return 1;
+}
+
+// ---------------------------------------------------------------------------
+// Eviction : parcours du repertoire, suppression des fichiers temporaires
+// abandonnes (ecriture interrompue) puis des entrees les plus anciennes
+// jusqu'a repasser sous la limite. Un temporaire recent est peut-etre en
+// cours d'ecriture : il compte dans la taille mais n'est pas supprime.
+// Retourne le nombre de fichiers supprimes
+
+static int compareUsage(const void *a, const void *b) {
+    const CacheEntry *x = (const CacheEntry *)a, *y = (const CacheEntry *)b;
+    return (x->used > y->used) - (x->used < y->used);
+}
+
+int cacheEvict(const CompileCache *cache) {
+    DIR *dir = opendir(cache->directory);
+    if (!dir) {
+        return 0;
+    }
+    CacheEntry *entries = NULL;
+    int count = 0, capacity = 0;
+    long long total = 0;
+    int evicted = 0;
+    time_t now = time(NULL);
+    struct dirent *d;
+    while ((d = readdir(dir)) != NULL) {
+        size_t length = strlen(d->d_name);
+        int temporary = strncmp(d->d_name, ".tmp-", 5) == 0;
+        if (!temporary && (length < 4 || strcmp(d->d_name + length - 4, ".hsc") != 0)) {
+            continue;
+        }
+        char path[4096];
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", cache->directory, d->d_name);
+        if (stat(path, &st) < 0) {
+            continue;
+        }
+        if (temporary) {
+            if (now - st.st_mtime > CACHE_TEMP_MAX_AGE && unlink(path) == 0) {
+                evicted++;
+            } else {
+                total += st.st_size;
+            }
+            continue;
+        }
+        if (count == capacity) {
+            capacity = capacity ? 2 * capacity : 64;
+            CacheEntry *grown = (CacheEntry *)realloc(entries, capacity * sizeof(CacheEntry));
+            if (!grown) {
+                break;
+            }
+            entries = grown;
+        }
+        entries[count].path = strdup(path);
+        entries[count].size = st.st_size;
+        entries[count].used = st.st_mtim.tv_sec + st.st_mtim.tv_nsec / 1e9;
+        total += st.st_size;
+        count++;
+    }
+    closedir(dir);
+
+    if (total > cache->maxBytes) {
+        qsort(entries, count, sizeof(CacheEntry), compareUsage);
+        for (int i = 0; i < count && total > cache->maxBytes; i++) {
+            if (entries[i].path && unlink(entries[i].path) == 0) {
+                total -= entries[i].size;
+                evicted++;
+            }
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        free(entries[i].path);
+    }
+    free(entries);
+    return evicted;
+}
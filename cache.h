@@ -0,0 +1,45 @@
+#ifndef CACHE_H
+#define CACHE_H
+#include <stddef.h>
+#include "tableSymboles.h"
+#include "quadruplets.h"
+
+// Cache de compilation sur disque (option --cache) : le resultat d'une
+// compilation reussie (table des symboles + quadruplets) est range sous une
+// cle calculee sur le contenu du fichier source et la version du
+// compilateur. Un fichier inchange n'est plus ni analyse ni parse.
+//
+// Chaque entree est un fichier <cle>.hsc du repertoire de cache, ecrit dans
+// un fichier temporaire puis renomme (rename atomique) : plusieurs
+// compilations, threads ou processus peuvent partager le meme repertoire.
+// Au-dela de maxBytes, les entrees les moins recemment utilisees (date de
+// modification, rafraichie a chaque succes) sont supprimees, ainsi que les
+// fichiers temporaires abandonnes depuis plus de CACHE_TEMP_MAX_AGE secondes.
+//
+// L'entree garde la taille et un troisieme hachage du source, verifies au
+// chargement : une collision de cle donne un echec, jamais les quads d'un
+// autre fichier. Les entrees sont creees avec les droits 0666 moins l'umask.
+
+#define COMPILER_VERSION "1.0"
+#define CACHE_FORMAT_VERSION 4
+#define CACHE_MAGIC "HSCC"
+#define CACHE_DEFAULT_DIRECTORY ".hscache"
+#define CACHE_DEFAULT_MAX_BYTES (64LL << 20)
+#define CACHE_KEY_LENGTH 40         // 2 hachages de 64 bits + taille, en hexadecimal
+#define CACHE_TEMP_MAX_AGE 600      // secondes avant qu'un .tmp-* soit considere abandonne
+
+typedef struct CompileCache {
+    const char *directory;
+    long long maxBytes;
+    unsigned mode;          // droits des entrees (0666 moins l'umask)
+} CompileCache;
+
+int cacheOpen(CompileCache *cache, const char *directory, long long maxBytes);
+void cacheKey(const char *data, size_t length, char key[CACHE_KEY_LENGTH + 1]);
+int cacheLoad(const CompileCache *cache, const char *key, const char *source, size_t length,
+              SymbolTable *table, tableQuads *quads);
+int cacheStore(const CompileCache *cache, const char *key, const char *source, size_t length,
+               SymbolTable *table, tableQuads *quads);
+int cacheEvict(const CompileCache *cache);
+
+#endif
@@ -0,0 +1,511 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "cfg.h"
+
+typedef struct CfgOperator {
+    const char *name;
+    QuadKind kind;
+} CfgOperator;
+
+// operateurs des quads produits par syntaxique.y (voir aussi vm.c)
+static const CfgOperator cfgOperators[] = {
+    { "BR", QUAD_BR }, { "BZ", QUAD_BZ }, { "BNZ", QUAD_BNZ }, { ":=", QUAD_COPY },
+    { "SWITCH", QUAD_SWITCH }, { "CASE", QUAD_CASE },
+    { "+", QUAD_PURE }, { "-", QUAD_PURE }, { "*", QUAD_PURE },
+    { "==", QUAD_PURE }, { "!=", QUAD_PURE }, { "<", QUAD_PURE }, { "<=", QUAD_PURE },
+    { ">", QUAD_PURE }, { ">=", QUAD_PURE },
+    { "AND", QUAD_PURE }, { "OR", QUAD_PURE }, { "NOT", QUAD_PURE }, { "UMINUS", QUAD_PURE },
+    { "CONCAT", QUAD_PURE },
+    // HASH : le selecteur d'un Switch sur chaines est toujours une chaine
+    { "HASH", QUAD_PURE },
+    { "/", QUAD_TRAP }, { "DIV", QUAD_TRAP }, { "MOD", QUAD_TRAP },
+    // tableaux : longueurs differentes, division par zero, tableau vide
+    { "VADD", QUAD_TRAP }, { "VSUB", QUAD_TRAP }, { "VMUL", QUAD_TRAP }, { "VDIV", QUAD_TRAP },
+    { "VIDIV", QUAD_TRAP }, { "VMOD", QUAD_TRAP }, { "VEQ", QUAD_TRAP }, { "VNE", QUAD_TRAP },
+    { "VLT", QUAD_TRAP }, { "VLE", QUAD_TRAP }, { "VGT", QUAD_TRAP }, { "VGE", QUAD_TRAP },
+    { "VAND", QUAD_TRAP }, { "VOR", QUAD_TRAP }, { "VNOT", QUAD_TRAP }, { "VNEG", QUAD_TRAP },
+    { "SUM", QUAD_TRAP }, { "MIN", QUAD_TRAP }, { "MAX", QUAD_TRAP },
+    // dictionnaires : cle absente
+    { "INDEX", QUAD_TRAP },
+    { "ARRAY_DECL", QUAD_ARRAY }, { "DICT_DECL", QUAD_ARRAY }, { "PRINT", QUAD_PRINT }, { "INPUT", QUAD_INPUT },
+};
+
+#define CFG_OPERATOR_COUNT (int)(sizeof(cfgOperators) / sizeof(cfgOperators[0]))
+
+int cfgIsLiteral(StringId id) {
+    const char *text = internedString(id);
+    if (text[0] == '"' || text[0] == '[' || text[0] == '{' || isdigit((unsigned char)text[0])) {
+        return 1;
+    }
+    if (text[0] == '-' && isdigit((unsigned char)text[1])) {
+        return 1;
+    }
+    return strcmp(text, "true") == 0 || strcmp(text, "false") == 0;
+}
+
+int cfgName(const Cfg *cfg, StringId id) {
+    return idMapGet(&cfg->names, id, -1);
+}
+
+StringId cfgBranchLabel(const Cfg *cfg, int i) {
+    quad *q = &cfg->quads->quads[i];
+    return cfg->kinds[i] == QUAD_BR ? q->resultat : q->operande1;
+}
+
+StringId *cfgDefField(const Cfg *cfg, int i) {
+    quad *q = &cfg->quads->quads[i];
+    switch (cfg->kinds[i]) {
+        case QUAD_COPY:
+        case QUAD_PURE:
+        case QUAD_TRAP:
+        case QUAD_INPUT:
+        case QUAD_OTHER:
+            return &q->resultat;
+        case QUAD_ARRAY:
+            return &q->operande1;
+        default:
+            return NULL;
+    }
+}
+
+StringId cfgDef(const Cfg *cfg, int i) {
+    StringId *field = cfgDefField(cfg, i);
+    return field ? *field : STRING_ID_NONE;
+}
+
+int cfgUseFields(const Cfg *cfg, int i, StringId *fields[CFG_MAX_USES]) {
+    quad *q = &cfg->quads->quads[i];
+    switch (cfg->kinds[i]) {
+        case QUAD_BZ:
+        case QUAD_BNZ:
+            fields[0] = &q->resultat;
+            return 1;
+        case QUAD_SWITCH:
+            fields[0] = &q->operande1;
+            fields[1] = &q->operande2;
+            return 2;
+        case QUAD_COPY:
+        case QUAD_PRINT:
+        case QUAD_INPUT:
+            fields[0] = &q->operande1;
+            return 1;
+        case QUAD_PURE:
+        case QUAD_TRAP:
+        case QUAD_OTHER:
+            fields[0] = &q->operande1;
+            fields[1] = &q->operande2;
+            return 2;
+        case QUAD_ARRAY:
+            // un tableau deja construit : copie ; sinon noms du texte
+            if (internedString(q->operande2)[0] != '[' && internedString(q->operande2)[0] != '{') {
+                fields[0] = &q->operande2;
+                return 1;
+            }
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Noms
+
+static int addName(Cfg *cfg, StringId id) {
+    if (id == STRING_ID_NONE || cfgIsLiteral(id)) {
+        return -1;
+    }
+    int n = idMapGet(&cfg->names, id, -1);
+    if (n < 0) {
+        n = cfg->nameCount++;
+        cfg->nameIds[n] = id;
+        idMapPut(&cfg->names, id, n);
+    }
+    return n;
+}
+
+// elements du texte "[e1,e2,...]" ou "{"k1":e1,...}" (decoupe comme
+// arraySlot et dictSlot dans vm.c) ; les noms sont ajoutes a la liste des
+// lectures du quad
+static int scanArrayText(Cfg *cfg, const char *text, size_t length, int *count, int *capacity) {
+    size_t start = 1;
+    int depth = 0, quoted = 0;
+    for (size_t i = 1; i < length && length > 2; i++) {
+        char c = text[i];
+        if (quoted) {
+            if (c == '\\' && i + 1 < length) i++;
+            else if (c == '"') quoted = 0;
+            continue;
+        }
+        if (c == '"') quoted = 1;
+        else if (c == '[') depth++;
+        else if (c == ']' && depth > 0) depth--;
+        else if ((c == ',' && depth == 0) || i == length - 1) {
+            const char *item = text + start;
+            size_t n = i - start;
+            start = i + 1;
+            if (text[0] == '{') {
+                // "cle":valeur
+                size_t key = 1;
+                while (key < n && item[key] != '"') key += item[key] == '\\' ? 2 : 1;
+                key = key + 2 < n ? key + 2 : n;
+                item += key;
+                n -= key;
+            }
+            if (n > 0 && item[0] == '[') {
+                if (scanArrayText(cfg, item, n, count, capacity) < 0) {
+                    return -1;
+                }
+                continue;
+            }
+            int name = n > 0 ? addName(cfg, internStringN(item, n)) : -1;
+            if (name < 0) {
+                continue;
+            }
+            if (*count == *capacity) {
+                *capacity = *capacity ? 2 * *capacity : 64;
+                int *grown = (int *)realloc(cfg->arrayUses, *capacity * sizeof(int));
+                if (!grown) {
+                    return -1;
+                }
+                cfg->arrayUses = grown;
+            }
+            cfg->arrayUses[(*count)++] = name;
+        }
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Construction
+
+static int branchement(int kind) {
+    return kind == QUAD_BR || kind == QUAD_BZ || kind == QUAD_BNZ || kind == QUAD_CASE;
+}
+
+int cfgBuild(Cfg *cfg, tableQuads *quads) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->quads = quads;
+    int n = quads->taille;
+
+    // borne du nombre de noms : trois par quad plus les elements des tableaux
+    uint32_t names = 16;
+    for (int i = 0; i < n; i++) {
+        const char *text = internedString(quads->quads[i].operande2);
+        names += 3;
+        if (text[0] == '[' || text[0] == '{') {
+            for (; *text; text++) {
+                names += *text == ',' || *text == '[';
+            }
+        }
+    }
+
+    IdMap operators;
+    char *cible = (char *)calloc(n + 1, 1);     // quads vises par un numero
+    if (!cible || initIdMap(&operators, CFG_OPERATOR_COUNT) < 0) {
+        freeIdMap(&operators);
+        free(cible);
+        return -1;
+    }
+    for (int k = 0; k < CFG_OPERATOR_COUNT; k++) {
+        idMapPut(&operators, internString(cfgOperators[k].name), cfgOperators[k].kind);
+    }
+
+    cfg->kinds = (unsigned char *)malloc(n + 1);
+    cfg->blockOf = (int *)malloc((n + 1) * sizeof(int));
+    cfg->arrayUseStart = (int *)malloc((n + 1) * sizeof(int));
+    cfg->nameIds = (StringId *)malloc(names * sizeof(StringId));
+    int status = cfg->kinds && cfg->blockOf && cfg->arrayUseStart && cfg->nameIds &&
+                 initIdMap(&cfg->labels, (uint32_t)n) == 0 && initIdMap(&cfg->names, names) == 0 ? 0 : -1;
+
+    // classement des quads
+    for (int i = 0; i < n && status == 0; i++) {
+        quad *q = &quads->quads[i];
+        int kind = idMapGet(&operators, q->operateur, -1);
+        if (kind < 0) {
+            int empty = q->operande1 == STRING_ID_NONE && q->operande2 == STRING_ID_NONE &&
+                        q->resultat == STRING_ID_NONE;
+            kind = empty ? QUAD_LABEL : QUAD_OTHER;
+        }
+        cfg->kinds[i] = (unsigned char)kind;
+        int k = branchement(kind) ? indiceCible(quads, cfgBranchLabel(cfg, i)) : -1;
+        if (k >= 0) {
+            cible[k] = 1;
+        }
+    }
+
+    // noms, et numerotation des blocs (leaders)
+    int arrayUseCount = 0, arrayUseCapacity = 0;
+    int blocks = 0;
+    for (int i = 0; i < n && status == 0; i++) {
+        quad *q = &quads->quads[i];
+        int kind = cfg->kinds[i];
+        int leader = i == 0 || kind == QUAD_LABEL || cible[i] || branchement(cfg->kinds[i - 1]);
+        // une suite d'etiquettes forme un seul bloc
+        if (leader && i > 0 && kind == QUAD_LABEL && cfg->kinds[i - 1] == QUAD_LABEL && !cible[i]) {
+            leader = 0;
+        }
+        blocks += leader;
+        cfg->blockOf[i] = blocks - 1;
+        if (kind == QUAD_LABEL && idMapGet(&cfg->labels, q->operateur, -1) < 0) {
+            idMapPut(&cfg->labels, q->operateur, blocks - 1);
+        }
+
+        addName(cfg, cfgDef(cfg, i));
+        StringId *fields[CFG_MAX_USES];
+        int uses = cfgUseFields(cfg, i, fields);
+        for (int k = 0; k < uses; k++) {
+            addName(cfg, *fields[k]);
+        }
+        cfg->arrayUseStart[i] = arrayUseCount;
+        if (kind == QUAD_ARRAY && uses == 0) {
+            const char *text = internedString(q->operande2);
+            status = scanArrayText(cfg, text, strlen(text), &arrayUseCount, &arrayUseCapacity);
+        }
+    }
+    if (cfg->arrayUseStart) {
+        cfg->arrayUseStart[n] = arrayUseCount;
+    }
+    // un numero de quad designe son bloc comme une etiquette (la fin du
+    // programme reste absente : sortie)
+    for (int i = 0; i < n && status == 0; i++) {
+        int k = branchement(cfg->kinds[i]) ? indiceCible(quads, cfgBranchLabel(cfg, i)) : -1;
+        if (k >= 0 && k < n) {
+            idMapPut(&cfg->labels, cfgBranchLabel(cfg, i), cfg->blockOf[k]);
+        }
+    }
+    freeIdMap(&operators);
+    free(cible);
+
+    cfg->blockCount = blocks;
+    cfg->blocks = status == 0 ? (BasicBlock *)calloc(blocks + 1, sizeof(BasicBlock)) : NULL;
+    cfg->preds = status == 0 ? (int *)malloc((2 * blocks + 1) * sizeof(int)) : NULL;
+    if (!cfg->blocks || !cfg->preds) {
+        cfgFree(cfg);
+        return -1;
+    }
+
+    // limites et successeurs
+    for (int i = 0; i < n; i++) {
+        BasicBlock *b = &cfg->blocks[cfg->blockOf[i]];
+        if (i == 0 || cfg->blockOf[i - 1] != cfg->blockOf[i]) {
+            b->first = i;
+        }
+        b->last = i + 1;
+    }
+    for (int k = 0; k < blocks; k++) {
+        BasicBlock *b = &cfg->blocks[k];
+        int end = b->last - 1;
+        int next = k + 1 < blocks ? k + 1 : -1;
+        b->succ[0] = next;
+        b->succ[1] = -1;
+        if (branchement(cfg->kinds[end])) {
+            int target = idMapGet(&cfg->labels, cfgBranchLabel(cfg, end), -1);
+            if (cfg->kinds[end] == QUAD_BR) {
+                b->succ[0] = target;
+            } else if (target != next) {
+                b->succ[1] = target;
+            }
+        }
+    }
+
+    // predecesseurs, ranges bloc par bloc
+    for (int k = 0; k < blocks; k++) {
+        for (int s = 0; s < 2; s++) {
+            if (cfg->blocks[k].succ[s] >= 0) {
+                cfg->blocks[cfg->blocks[k].succ[s]].predCount++;
+            }
+        }
+    }
+    int start = 0;
+    for (int k = 0; k < blocks; k++) {
+        cfg->blocks[k].predStart = start;
+        start += cfg->blocks[k].predCount;
+        cfg->blocks[k].predCount = 0;
+    }
+    for (int k = 0; k < blocks; k++) {
+        for (int s = 0; s < 2; s++) {
+            int succ = cfg->blocks[k].succ[s];
+            if (succ >= 0) {
+                BasicBlock *b = &cfg->blocks[succ];
+                cfg->preds[b->predStart + b->predCount++] = k;
+            }
+        }
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Dominateurs
+
+static int intersect(const Cfg *cfg, const int *rank, int a, int b) {
+    while (a != b) {
+        while (rank[a] > rank[b]) a = cfg->idom[a];
+        while (rank[b] > rank[a]) b = cfg->idom[b];
+    }
+    return a;
+}
+
+int cfgDominators(Cfg *cfg) {
+    int n = cfg->blockCount;
+    free(cfg->idom);
+    free(cfg->order);
+    cfg->idom = (int *)malloc((n + 1) * sizeof(int));
+    cfg->order = (int *)malloc((n + 1) * sizeof(int));
+    cfg->orderCount = 0;
+    int *rank = (int *)malloc((n + 1) * sizeof(int));
+    int *pile = (int *)malloc((n + 1) * sizeof(int));
+    int *etape = (int *)malloc((n + 1) * sizeof(int));
+    if (!cfg->idom || !cfg->order || !rank || !pile || !etape) {
+        free(rank);
+        free(pile);
+        free(etape);
+        return -1;
+    }
+    for (int b = 0; b < n; b++) {
+        cfg->idom[b] = -1;
+        rank[b] = -1;
+    }
+
+    // parcours en profondeur en ordre postfixe, puis retourne
+    int sommet = 0, vus = 0;
+    if (n > 0) {
+        pile[sommet] = 0;
+        etape[sommet++] = 0;
+        rank[0] = vus++;
+    }
+    while (sommet > 0) {
+        int b = pile[sommet - 1];
+        if (etape[sommet - 1] < 2) {
+            int s = cfg->blocks[b].succ[etape[sommet - 1]++];
+            if (s >= 0 && rank[s] < 0) {
+                rank[s] = vus++;
+                pile[sommet] = s;
+                etape[sommet++] = 0;
+            }
+        } else {
+            cfg->order[cfg->orderCount++] = b;
+            sommet--;
+        }
+    }
+    for (int k = 0; k < vus / 2; k++) {
+        int b = cfg->order[k];
+        cfg->order[k] = cfg->order[vus - 1 - k];
+        cfg->order[vus - 1 - k] = b;
+    }
+    for (int k = 0; k < vus; k++) {
+        rank[cfg->order[k]] = k;
+    }
+
+    if (vus > 0) {
+        cfg->idom[0] = 0;
+    }
+    int change = 1;
+    while (change) {
+        change = 0;
+        for (int k = 1; k < vus; k++) {
+            int b = cfg->order[k];
+            BasicBlock *bloc = &cfg->blocks[b];
+            int nouveau = -1;
+            for (int p = 0; p < bloc->predCount; p++) {
+                int pred = cfg->preds[bloc->predStart + p];
+                if (cfg->idom[pred] >= 0) {
+                    nouveau = nouveau < 0 ? pred : intersect(cfg, rank, pred, nouveau);
+                }
+            }
+            if (cfg->idom[b] != nouveau) {
+                cfg->idom[b] = nouveau;
+                change = 1;
+            }
+        }
+    }
+    if (vus > 0) {
+        cfg->idom[0] = -1;
+    }
+    free(rank);
+    free(pile);
+    free(etape);
+    return 0;
+}
+
+int *cfgFrontiers(const Cfg *cfg, int **start) {
+    int blocks = cfg->blockCount;
+    int *cles = NULL, *valeurs = NULL, *dernier = (int *)malloc((blocks + 1) * sizeof(int));
+    int count = 0, capacity = 0;
+    int *grouped = NULL;
+    *start = (int *)calloc(blocks + 1, sizeof(int));
+    if (!dernier || !*start) {
+        goto fin;
+    }
+    for (int b = 0; b < blocks; b++) {
+        dernier[b] = -1;
+    }
+    for (int b = 1; b < blocks; b++) {
+        BasicBlock *bloc = &cfg->blocks[b];
+        if (cfg->idom[b] < 0 || bloc->predCount < 2) {
+            continue;
+        }
+        for (int p = 0; p < bloc->predCount; p++) {
+            int runner = cfg->preds[bloc->predStart + p];
+            if (runner != 0 && cfg->idom[runner] < 0) {
+                continue;
+            }
+            while (runner >= 0 && runner != cfg->idom[b]) {
+                if (dernier[runner] != b) {
+                    dernier[runner] = b;
+                    if (count == capacity) {
+                        capacity = capacity ? 2 * capacity : 64;
+                        int *c = (int *)realloc(cles, capacity * sizeof(int));
+                        int *v = c ? (int *)realloc(valeurs, capacity * sizeof(int)) : NULL;
+                        if (c) cles = c;
+                        if (v) valeurs = v;
+                        if (!c || !v) {
+                            goto fin;
+                        }
+                    }
+                    cles[count] = runner;
+                    valeurs[count++] = b;
+                    (*start)[runner + 1]++;
+                }
+                runner = cfg->idom[runner];
+            }
+        }
+    }
+    // rangees par bloc
+    grouped = (int *)malloc((count + 1) * sizeof(int));
+    if (!grouped) {
+        goto fin;
+    }
+    for (int b = 0; b < blocks; b++) {
+        (*start)[b + 1] += (*start)[b];
+        dernier[b] = (*start)[b];
+    }
+    for (int k = 0; k < count; k++) {
+        grouped[dernier[cles[k]]++] = valeurs[k];
+    }
+fin:
+    if (!grouped) {
+        free(*start);
+        *start = NULL;
+    }
+    free(cles);
+    free(valeurs);
+    free(dernier);
+    return grouped;
+}
+
+void cfgFree(Cfg *cfg) {
+    free(cfg->idom);
+    free(cfg->order);
+    free(cfg->kinds);
+    free(cfg->blockOf);
+    free(cfg->blocks);
+    free(cfg->preds);
+    freeIdMap(&cfg->labels);
+    freeIdMap(&cfg->names);
+    free(cfg->nameIds);
+    free(cfg->arrayUses);
+    free(cfg->arrayUseStart);
+    memset(cfg, 0, sizeof(*cfg));
+}
@@ -0,0 +1,98 @@
+#ifndef CFG_H
+#define CFG_H
+#include <stdint.h>
+#include "quadruplets.h"
+#include "idmap.h"
+
+// Graphe de flot de controle du programme en quadruplets.
+//
+// Les blocs de base sont decoupes aux etiquettes (qui commencent un bloc)
+// et apres chaque branchement (qui termine le leur). Un branchement deja
+// resolu vise un numero de quad : ce quad commence alors un bloc. Un bloc a au plus deux
+// successeurs : la cible du branchement et/ou le bloc suivant. Le bloc 0
+// est l'entree ; un successeur -1 est la sortie du programme. Les n
+// entrees CASE d'une table SWITCH forment une chaine de blocs : chacune
+// continue vers la suivante ou saute a sa cible, ce qui couvre tous les
+// sauts possibles de la table.
+//
+// Chaque quad est classe une fois pour toutes (QuadKind) et ses operandes
+// sont ramenes a un role unique : le nom qu'il definit et les noms qu'il
+// lit, quel que soit le champ qui les porte (BZ lit resultat, ARRAY_DECL
+// definit operande1...). Les noms (variables et temporaires, pas les
+// litteraux) recoivent un indice dense pour les ensembles de bits.
+
+typedef enum QuadKind {
+    QUAD_LABEL,     // etiquette : operateur = nom, aucun operande
+    QUAD_BR,        // BR , , , etiquette
+    QUAD_BZ,        // BZ etiquette , , condition
+    QUAD_BNZ,       // BNZ etiquette , , condition (saute si vraie, voir peephole.h)
+    QUAD_SWITCH,    // SWITCH selecteur , minimum , n : saute par la table des n CASE qui suivent
+    QUAD_CASE,      // CASE etiquette : entree de table, vue comme un branchement
+                    // conditionnel (suite vers l'entree suivante, ou cible)
+    QUAD_COPY,      // := source , , destination
+    QUAD_PURE,      // operation sans effet de bord ni erreur possible
+    QUAD_TRAP,      // / DIV MOD, tableaux, INDEX : peut echouer a l'execution
+    QUAD_ARRAY,     // ARRAY_DECL nom , [elements] , temporaire
+                    // DICT_DECL nom , {"cle":valeur,...} , [hachage]
+    QUAD_PRINT,
+    QUAD_INPUT,
+    QUAD_OTHER,     // operateur inconnu : traite comme un effet de bord
+    QUAD_REMOVED    // supprime par l'optimiseur, ignore par les analyses
+} QuadKind;
+
+typedef struct BasicBlock {
+    int first;      // indice (dans quads) du premier quad du bloc
+    int last;       // indice qui suit le dernier quad
+    int succ[2];    // blocs successeurs, -1 : aucun
+    int predStart;  // predecesseurs : preds[predStart .. predStart + predCount[
+    int predCount;
+} BasicBlock;
+
+typedef struct Cfg {
+    tableQuads *quads;
+    unsigned char *kinds;   // QuadKind de chaque quad
+    int *blockOf;           // bloc de chaque quad
+    BasicBlock *blocks;
+    int blockCount;
+    int *preds;
+    IdMap labels;           // etiquette -> bloc
+    IdMap names;            // nom -> indice dense
+    StringId *nameIds;      // indice dense -> nom
+    int nameCount;
+    int *arrayUses;         // noms lus dans le texte "[...]" ("{...}") de chaque ARRAY_DECL (DICT_DECL)
+    int *arrayUseStart;     // par quad : arrayUses[arrayUseStart[i] .. arrayUseStart[i + 1][
+    // rempli par cfgDominators
+    int *idom;              // dominateur immediat ; -1 : entree ou bloc inaccessible
+    int *order;             // blocs accessibles en ordre postfixe inverse
+    int orderCount;
+} Cfg;
+
+#define CFG_MAX_USES 2
+
+int cfgBuild(Cfg *cfg, tableQuads *quads);
+void cfgFree(Cfg *cfg);
+
+// 1 si l'operande est un litteral (nombre, chaine, booleen, tableau,
+// dictionnaire)
+int cfgIsLiteral(StringId id);
+// indice dense du nom, -1 pour un litteral ou une chaine vide
+int cfgName(const Cfg *cfg, StringId id);
+// etiquette visee par un BR/BZ/BNZ/CASE
+StringId cfgBranchLabel(const Cfg *cfg, int i);
+// nom defini par le quad i (STRING_ID_NONE si aucun)
+StringId cfgDef(const Cfg *cfg, int i);
+// champ du quad i qui porte ce nom, NULL si aucun
+StringId *cfgDefField(const Cfg *cfg, int i);
+// champs du quad i qui portent un operande lu (hors texte des tableaux) ;
+// retourne leur nombre, au plus CFG_MAX_USES
+int cfgUseFields(const Cfg *cfg, int i, StringId *fields[CFG_MAX_USES]);
+
+// arbre des dominateurs (Cooper, Harvey et Kennedy) sur les blocs
+// accessibles depuis l'entree ; 0 ou -1 si la memoire manque
+int cfgDominators(Cfg *cfg);
+// frontiere de dominance de chaque bloc accessible (jamais l'entree) :
+// df[start[b] .. start[b + 1][, dominateurs deja calcules ; NULL si la
+// memoire manque
+int *cfgFrontiers(const Cfg *cfg, int **start);
+
+#endif
@@ -0,0 +1,146 @@
+// Client du serveur de compilation (compiler --serve SOCKET).
+//
+//   hsclient SOCKET fichier...
+//       compile chaque fichier via le serveur et affiche sa sortie
+//   hsclient --bench N SOCKET COMPILATEUR fichier...
+//       compare N passes via le serveur a N passes fork+exec du compilateur
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "server.h"
+
+static double maintenant(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int connecter(const char *socketPath) {
+    struct sockaddr_un address;
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) {
+        perror("socket");
+        return -1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+    if (connect(sock, (struct sockaddr *)&address, sizeof(address)) < 0) {
+        perror(socketPath);
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+// envoie une requete et lit la reponse jusqu'a la ligne de statut ;
+// la sortie est recopiee sur sortie si elle n'est pas NULL
+static int compilerDistant(int sock, FILE *reponses, const char *fichier, FILE *sortie) {
+    char chemin[PATH_MAX];
+    if (!realpath(fichier, chemin)) {
+        perror(fichier);
+        return 1;
+    }
+    size_t longueur = strlen(chemin);
+    chemin[longueur++] = '\n';
+    if (write(sock, chemin, longueur) != (ssize_t)longueur) {
+        perror("write");
+        return 1;
+    }
+
+    char *ligne = NULL;
+    size_t capacite = 0;
+    size_t marqueur = strlen(SERVER_STATUS_MARKER);
+    int status = 1;
+    while (getline(&ligne, &capacite, reponses) > 0) {
+        if (strncmp(ligne, SERVER_STATUS_MARKER, marqueur) == 0) {
+            status = atoi(ligne + marqueur);
+            break;
+        }
+        if (sortie) {
+            fputs(ligne, sortie);
+        }
+    }
+    free(ligne);
+    return status;
+}
+
+static int compilerLocal(const char *compilateur, const char *fichier) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        int nul = open("/dev/null", O_WRONLY);
+        dup2(nul, STDOUT_FILENO);
+        dup2(nul, STDERR_FILENO);
+        execl(compilateur, compilateur, fichier, (char *)NULL);
+        _exit(127);
+    }
+    int status = 1;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+
+static int benchmark(int passes, const char *socketPath, const char *compilateur,
+                     char **fichiers, int nbFichiers) {
+    int sock = connecter(socketPath);
+    if (sock < 0) {
+        return 1;
+    }
+    FILE *reponses = fdopen(dup(sock), "r");
+
+    double debut = maintenant();
+    for (int p = 0; p < passes; p++) {
+        for (int i = 0; i < nbFichiers; i++) {
+            compilerDistant(sock, reponses, fichiers[i], NULL);
+        }
+    }
+    double serveur = maintenant() - debut;
+
+    debut = maintenant();
+    for (int p = 0; p < passes; p++) {
+        for (int i = 0; i < nbFichiers; i++) {
+            compilerLocal(compilateur, fichiers[i]);
+        }
+    }
+    double local = maintenant() - debut;
+
+    int total = passes * nbFichiers;
+    printf("%d compilations\n", total);
+    printf("  serveur     : %8.3f s  (%7.3f ms/fichier)\n", serveur, serveur * 1e3 / total);
+    printf("  fork+exec   : %8.3f s  (%7.3f ms/fichier)\n", local, local * 1e3 / total);
+    printf("  acceleration: %8.2fx\n", serveur > 0 ? local / serveur : 0);
+
+    fclose(reponses);
+    close(sock);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 6 && strcmp(argv[1], "--bench") == 0) {
+        return benchmark(atoi(argv[2]), argv[3], argv[4], argv + 5, argc - 5);
+    }
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s SOCKET fichier...\n"
+                        "       %s --bench N SOCKET COMPILATEUR fichier...\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    int sock = connecter(argv[1]);
+    if (sock < 0) {
+        return 1;
+    }
+    FILE *reponses = fdopen(dup(sock), "r");
+    int result = 0;
+    for (int i = 2; i < argc; i++) {
+        result |= compilerDistant(sock, reponses, argv[i], stdout);
+    }
+    fclose(reponses);
+    close(sock);
+    return result;
+}
@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "compilation.h"
+#include "source.h"
+#include "vm.h"
+
+int initCompilation(Compilation *ctx, FILE *out, FILE *err) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->file = "input.txt";
+    ctx->out = out;
+    ctx->err = err;
+    ctx->qc = 1;
+    initPile(&ctx->stack);
+    initQuads(&ctx->quads);
+    ctx->quads.stats = &ctx->stats;
+
+    ctx->symbolTable = createSymbolTable();
+    if (!ctx->symbolTable) {
+        fprintf(stderr, "Error: Failed to create symbol table.\n");
+        return -1;
+    }
+    ctx->scanner = scannerCreate(ctx);
+    if (!ctx->scanner) {
+        fprintf(stderr, "Error: Failed to create scanner.\n");
+        freeSymbolTable(ctx->symbolTable);
+        ctx->symbolTable = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+void freeCompilation(Compilation *ctx) {
+    if (ctx->scanner) {
+        scannerDestroy(ctx->scanner);
+    }
+    freeSymbolTable(ctx->symbolTable);
+    libererQuads(&ctx->quads);
+    freeParseArena(&ctx->arena);
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+// message d'erreur semantique, situe a la position courante du scanner
+void compilationError(Compilation *ctx, const char *message) {
+    ctx->errors++;
+    fprintf(ctx->err, "File '%s', line %d, character %d: %s\n",
+            ctx->file, scannerLine(ctx->scanner), ctx->positionCurseur, message);
+}
+
+// execution des quads par la machine virtuelle (--run) ; la sortie du
+// programme suit l'affichage des quads sur ctx->out
+int executerProgramme(Compilation *ctx) {
+    VmProgram programme;
+    fprintf(ctx->out, "Running program...\n");
+    statsStart(&ctx->stats, PHASE_RUN);
+    int result = 1;
+    if (vmLoad(&programme, &ctx->quads, ctx->symbolTable, ctx->err) == 0) {
+        result = vmRun(&programme, stdin, ctx->out, ctx->err);
+    }
+    statsStop(&ctx->stats, PHASE_RUN);
+    ctx->stats.executed += programme.executed;
+    vmFree(&programme);
+    fflush(ctx->out);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Compilation parallele (-j N)
+//
+// Les fichiers sont distribues dynamiquement aux threads (compteur atomique),
+// chaque thread garde son propre contexte d'un fichier a l'autre. La sortie
+// de chaque fichier est capturee en memoire (open_memstream) ; le thread
+// principal la recopie sur stdout/stderr dans l'ordre des fichiers des
+// qu'elle est prete, ce qui rend le resultat identique a l'execution
+// sequentielle, quel que soit l'ordre de fin des compilations.
+//
+// Avec --run, les programmes lisent tous stdin : chacun attend son tour
+// (ordre des fichiers) pour s'executer, apres sa compilation, et lit donc
+// les memes lignes qu'en sequentiel.
+
+typedef struct Travail {
+    const char *fichier;
+    char *sortie;
+    size_t tailleSortie;
+    char *erreurs;
+    size_t tailleErreurs;
+    int resultat;
+    int termine;
+    CompileStats stats;
+} Travail;
+
+typedef struct PoolCompilation {
+    Travail *travaux;
+    int nbTravaux;
+    int prochain;               // indice du prochain fichier a distribuer
+    const CompileCache *cache;
+    int executer;               // --run
+    int optimiser;              // -O
+    int tour;                   // indice du prochain fichier a executer (--run)
+    pthread_mutex_t verrou;
+    pthread_cond_t fini;
+    pthread_cond_t tourSuivant;
+} PoolCompilation;
+
+static void terminerTravail(PoolCompilation *pool, Travail *t, int resultat) {
+    pthread_mutex_lock(&pool->verrou);
+    t->resultat = resultat;
+    t->termine = 1;
+    pthread_cond_broadcast(&pool->fini);
+    pthread_mutex_unlock(&pool->verrou);
+}
+
+// execution du fichier i (ctx NULL : rien a executer) quand tous les
+// precedents ont ete executes
+static int executerASonTour(PoolCompilation *pool, int i, Compilation *ctx) {
+    pthread_mutex_lock(&pool->verrou);
+    while (pool->tour != i) {
+        pthread_cond_wait(&pool->tourSuivant, &pool->verrou);
+    }
+    pthread_mutex_unlock(&pool->verrou);
+    int resultat = ctx ? executerProgramme(ctx) : 0;
+    pthread_mutex_lock(&pool->verrou);
+    pool->tour++;
+    pthread_cond_broadcast(&pool->tourSuivant);
+    pthread_mutex_unlock(&pool->verrou);
+    return resultat;
+}
+
+static void *travailleur(void *arg) {
+    PoolCompilation *pool = (PoolCompilation *)arg;
+    Compilation ctx;
+    int pret = initCompilation(&ctx, NULL, NULL) == 0;
+    ctx.cache = pool->cache;
+    ctx.optimize = pool->optimiser;
+
+    for (;;) {
+        int i = __atomic_fetch_add(&pool->prochain, 1, __ATOMIC_RELAXED);
+        if (i >= pool->nbTravaux) {
+            break;
+        }
+        Travail *t = &pool->travaux[i];
+        FILE *out = pret ? open_memstream(&t->sortie, &t->tailleSortie) : NULL;
+        FILE *err = out ? open_memstream(&t->erreurs, &t->tailleErreurs) : NULL;
+        if (!err) {
+            if (out) fclose(out);
+            if (pool->executer) {
+                executerASonTour(pool, i, NULL);
+            }
+            terminerTravail(pool, t, 1);
+            continue;
+        }
+
+        ctx.out = out;
+        ctx.err = err;
+        memset(&ctx.stats, 0, sizeof(ctx.stats));
+        int resultat = compilerFichier(&ctx, t->fichier);
+        if (pool->executer) {
+            // meme condition que compilerFichier en sequentiel
+            int executable = resultat == 0 && ctx.errors == 0;
+            int execution = executerASonTour(pool, i, executable ? &ctx : NULL);
+            if (executable) {
+                resultat = execution;
+            }
+        }
+        fclose(out);
+        fclose(err);
+        t->stats = ctx.stats;
+        terminerTravail(pool, t, resultat);
+    }
+
+    if (pret) {
+        freeCompilation(&ctx);
+    }
+    return NULL;
+}
+
+int compilerEnParallele(const char **fichiers, int nbFichiers, int jobs,
+                        const CompileCache *cache, int executer, int optimiser, CompileStats *total) {
+    PoolCompilation pool;
+    pool.travaux = (Travail *)calloc(nbFichiers, sizeof(Travail));
+    if (!pool.travaux) {
+        fprintf(stderr, "Error: Failed to allocate compilation jobs.\n");
+        return 1;
+    }
+    pool.nbTravaux = nbFichiers;
+    pool.prochain = 0;
+    pool.cache = cache;
+    pool.executer = executer;
+    pool.optimiser = optimiser;
+    pool.tour = 0;
+    pthread_mutex_init(&pool.verrou, NULL);
+    pthread_cond_init(&pool.fini, NULL);
+    pthread_cond_init(&pool.tourSuivant, NULL);
+    for (int i = 0; i < nbFichiers; i++) {
+        pool.travaux[i].fichier = fichiers[i];
+    }
+
+    if (jobs > nbFichiers) {
+        jobs = nbFichiers;
+    }
+    pthread_t *threads = (pthread_t *)malloc(jobs * sizeof(pthread_t));
+    int lances = 0;
+    while (threads && lances < jobs && pthread_create(&threads[lances], NULL, travailleur, &pool) == 0) {
+        lances++;
+    }
+    if (lances == 0) {
+        // aucun thread : le thread principal fait tout le travail
+        travailleur(&pool);
+    }
+
+    // restitution dans l'ordre des fichiers
+    int resultat = 0;
+    for (int i = 0; i < nbFichiers; i++) {
+        Travail *t = &pool.travaux[i];
+        pthread_mutex_lock(&pool.verrou);
+        while (!t->termine) {
+            pthread_cond_wait(&pool.fini, &pool.verrou);
+        }
+        pthread_mutex_unlock(&pool.verrou);
+
+        if (t->tailleSortie) {
+            fwrite(t->sortie, 1, t->tailleSortie, stdout);
+            fflush(stdout);
+        }
+        if (t->tailleErreurs) {
+            fwrite(t->erreurs, 1, t->tailleErreurs, stderr);
+        }
+        free(t->sortie);
+        free(t->erreurs);
+        resultat |= t->resultat;
+        statsMerge(total, &t->stats);
+    }
+
+    for (int i = 0; i < lances; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    pthread_cond_destroy(&pool.fini);
+    pthread_cond_destroy(&pool.tourSuivant);
+    pthread_mutex_destroy(&pool.verrou);
+    free(pool.travaux);
+    return resultat;
+}
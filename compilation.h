@@ -0,0 +1,59 @@
+#ifndef COMPILATION_H
+#define COMPILATION_H
+#include <stdio.h>
+#include "tableSymboles.h"
+#include "semantic.h"
+#include "quadruplets.h"
+#include "pile.h"
+#include "stats.h"
+#include "cache.h"
+
+// Etat complet d'une compilation : le scanner Flex (reentrant) et le parseur
+// Bison (pur) ne touchent a aucune variable globale, tout passe par ce
+// contexte. Plusieurs compilations peuvent donc tourner en meme temps, une
+// par thread (option -j N) ; seul le pool de chaines (interner.h) est partage.
+//
+// Un contexte se reutilise d'un fichier a l'autre : compilerFichier remet
+// la table des symboles, la pile et les quadruplets a zero sans les liberer.
+
+typedef struct Compilation {
+    const char *file;           // fichier en cours (messages d'erreur)
+    void *scanner;              // scanner Flex (yyscan_t)
+    struct SourceFile *source;  // fichier ouvert par compilerFichier (NULL : aucun)
+    SymbolTable *symbolTable;
+    pile stack;                 // numeros des boucles While/Repeat ouvertes
+    struct Aiguillage *switches;    // Switch ouverts, le plus interne d'abord (voir aiguillage.h)
+    tableQuads quads;
+    int qc;                     // numero du prochain quad
+    MaterializedJumps condition;    // dernier and/or/not materialise (voir syntaxique.y)
+    ParseArena arena;           // listes d'expressions, rendue apres chaque fichier
+    int positionCurseur;        // colonne courante dans la ligne
+    FILE *out;                  // trace et resultats (stdout ou tampon)
+    FILE *err;                  // messages d'erreur (stderr ou tampon)
+    CompileStats stats;         // compteurs de cette compilation
+    const CompileCache *cache;  // cache sur disque (NULL : desactive)
+    int errors;                 // erreurs signalees pour le fichier en cours
+    const char *bytecode;       // fichier .hsb a produire (-o), NULL : aucun
+    unsigned modeFichiers;      // droits du fichier .hsb (0666 moins l'umask)
+    const char *natif;          // executable x86-64 a produire (--native), NULL : aucun
+    int run;                    // executer le programme apres compilation (--run)
+    int optimize;               // optimiser les quads apres yyparse (-O)
+} Compilation;
+
+int initCompilation(Compilation *ctx, FILE *out, FILE *err);
+void freeCompilation(Compilation *ctx);
+void compilationError(Compilation *ctx, const char *message);
+int executerProgramme(Compilation *ctx);
+
+// implementee dans syntaxique.y
+int compilerFichier(Compilation *ctx, const char *chemin);
+
+// compile les fichiers sur jobs threads ; les sorties sont rendues sur
+// stdout/stderr dans l'ordre des fichiers, octet pour octet comme en
+// sequentiel. Les compteurs de chaque fichier sont fusionnes dans total.
+// Avec executer (--run), les programmes s'executent un a la fois dans
+// l'ordre des fichiers : stdin est lu comme en sequentiel.
+int compilerEnParallele(const char **fichiers, int nbFichiers, int jobs,
+                        const CompileCache *cache, int executer, int optimiser, CompileStats *total);
+
+#endif
@@ -0,0 +1,124 @@
+#include <stdlib.h>
+#include "dictionnaire.h"
+
+// place tous les paquets avec la graine seed ; -1 si deux cles d'un paquet
+// ont les memes positions ou si un paquet ne trouve pas de place
+static int placer(const uint64_t *hashes, uint32_t n, uint32_t seed, const uint32_t *start,
+                  const uint32_t *keys, const uint32_t *order, uint32_t placed, uint64_t *f,
+                  uint32_t *slots, unsigned char *used, uint32_t *displacements) {
+    for (uint32_t b = 0; b < dictBuckets(n); b++) {
+        displacements[b] = 0;
+    }
+    for (uint32_t k = 0; k < n; k++) {
+        used[k] = 0;
+    }
+    uint32_t rounds = n > 0 && UINT32_MAX / n < DICT_MAX_ROUNDS ? UINT32_MAX / n : DICT_MAX_ROUNDS;
+    uint32_t libre = 0;     // premiere case peut-etre libre (cles seules)
+    for (uint32_t p = 0; p < placed; p++) {
+        uint32_t b = order[p];
+        const uint32_t *bucket = keys + start[b];
+        uint32_t size = start[b + 1] - start[b];
+        for (uint32_t i = 0; i < size; i++) {
+            f[2 * i] = dictPosition(hashes[bucket[i]], seed, 1, n);
+            f[2 * i + 1] = dictPosition(hashes[bucket[i]], seed, 2, n);
+        }
+        if (size == 1) {
+            while (used[libre]) libre++;
+            used[libre] = 1;
+            displacements[b] = (uint32_t)((libre + n - f[0]) % n);
+            continue;
+        }
+        // deux cles aux memes positions ne se separent jamais
+        for (uint32_t i = 0; i < size; i++) {
+            for (uint32_t j = i + 1; j < size; j++) {
+                if (f[2 * i] == f[2 * j] && f[2 * i + 1] == f[2 * j + 1]) {
+                    return -1;
+                }
+            }
+        }
+        int found = 0;
+        for (uint32_t d0 = 0; d0 < rounds && !found; d0++) {
+            for (uint32_t i = 0; i < size; i++) {
+                slots[i] = (uint32_t)((f[2 * i] + (uint64_t)d0 * f[2 * i + 1]) % n);
+            }
+            for (uint32_t d1 = 0; d1 < n && !found; d1++) {
+                uint32_t k = 0;
+                for (; k < size; k++) {
+                    uint32_t slot = slots[k] + d1 < n ? slots[k] + d1 : slots[k] + d1 - n;
+                    if (used[slot]) {
+                        break;
+                    }
+                    used[slot] = 1;
+                }
+                found = k == size;
+                while (!found && k > 0) {
+                    k--;
+                    used[slots[k] + d1 < n ? slots[k] + d1 : slots[k] + d1 - n] = 0;
+                }
+                if (found) {
+                    displacements[b] = d0 * n + d1;
+                }
+            }
+        }
+        if (!found) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Les paquets sont places du plus grand au plus petit : les gros paquets
+// trouvent facilement de la place tant que la table est presque vide, les
+// cles seules prennent a la fin, directement, les cases qui restent
+int dictPerfectHash(const uint64_t *hashes, uint32_t n, uint32_t *displacements, uint32_t *seed) {
+    uint32_t buckets = dictBuckets(n);
+    uint32_t *start = (uint32_t *)calloc(buckets + 1, sizeof(uint32_t));
+    uint32_t *keys = (uint32_t *)malloc((n + 1) * sizeof(uint32_t));
+    uint32_t *order = (uint32_t *)malloc(buckets * sizeof(uint32_t));
+    uint32_t *slots = (uint32_t *)malloc((n + 1) * sizeof(uint32_t));
+    unsigned char *used = (unsigned char *)calloc(n + 1, 1);
+    int status = start && keys && order && slots && used ? 0 : -1;
+
+    // cles rangees par paquet (tri par comptage)
+    uint32_t largest = 0;
+    for (uint32_t k = 0; k < n && status == 0; k++) {
+        start[dictBucket(hashes[k], buckets) + 1]++;
+    }
+    for (uint32_t b = 0; b < buckets && status == 0; b++) {
+        largest = start[b + 1] > largest ? start[b + 1] : largest;
+        start[b + 1] += start[b];
+    }
+    // slots sert ici de curseur de chaque paquet
+    for (uint32_t b = 0; b < buckets && status == 0; b++) {
+        slots[b] = start[b];
+    }
+    for (uint32_t k = 0; k < n && status == 0; k++) {
+        keys[slots[dictBucket(hashes[k], buckets)]++] = k;
+    }
+    // paquets par taille decroissante (tri par comptage sur la taille)
+    uint32_t placed = 0;
+    for (uint32_t size = largest; size > 0 && status == 0; size--) {
+        for (uint32_t b = 0; b < buckets; b++) {
+            if (start[b + 1] - start[b] == size) {
+                order[placed++] = b;
+            }
+        }
+    }
+    uint64_t *f = status == 0 ? (uint64_t *)malloc(2 * (largest + 1) * sizeof(uint64_t)) : NULL;
+    status = f || status < 0 ? status : -1;
+    // une graine echoue sans erreur : on essaie la suivante
+    int placement = -1;
+    for (uint32_t s = 0; s < DICT_MAX_SEEDS && status == 0 && placement < 0; s++) {
+        placement = placer(hashes, n, s, start, keys, order, placed, f, slots, used, displacements);
+        *seed = s;
+    }
+    status = status < 0 ? status : placement;
+
+    free(f);
+    free(start);
+    free(keys);
+    free(order);
+    free(slots);
+    free(used);
+    return status;
+}
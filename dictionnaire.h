@@ -0,0 +1,76 @@
+#ifndef DICTIONNAIRE_H
+#define DICTIONNAIRE_H
+#include <stddef.h>
+#include <stdint.h>
+
+// Hachage des cles de dictionnaire, commun au compilateur (syntaxique.y)
+// et a la machine virtuelle (vm.c) : le hachage parfait calcule a la
+// compilation doit donner les memes cases au chargement. Les Switch sur
+// chaines (aiguillage.h) rangent leurs cas par dictBucket, aussi calcule
+// par natif_runtime.c, d'ou les fonctions en ligne.
+//
+// dictHash donne le hache de base d'une cle (FNV-1a sur 64 bits), dictMix
+// le melange avec une graine. Hachage parfait minimal ("hash, displace
+// and compress") des n cles d'un litteral : chaque cle tombe dans l'un des
+// dictBuckets(n) paquets et recoit deux positions f1, f2 dans [0, n[.
+// Chaque paquet a un deplacement d = d0 * n + d1 tel que les cases
+// (f1 + d0 * f2 + d1) % n de ses cles soient toutes encore libres. Les n
+// cles occupent alors exactement les n cases et une recherche ne compare
+// qu'une seule cle. d1 parcourt toutes les cases : une cle seule dans son
+// paquet prend directement une case libre. f1 et f2 dependent d'une graine
+// globale : si deux cles d'un paquet ont les memes positions ou si un
+// paquet ne trouve pas de place, on recommence avec la graine suivante.
+
+#define DICT_BUCKET_SIZE 3      // cles par paquet en moyenne
+#define DICT_MAX_ROUNDS 64      // valeurs de d0 essayees par graine
+#define DICT_MAX_SEEDS 256      // graines essayees avant abandon
+
+static inline uint64_t dictHash(const char *key, size_t length) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (size_t k = 0; k < length; k++) {
+        h ^= (unsigned char)key[k];
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+static inline uint64_t dictMix(uint64_t h, uint32_t seed) {
+    h ^= seed * 0x9E3779B97F4A7C15ull + 0x632BE59BD9B4E019ull;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    return h ^ (h >> 33);
+}
+
+// x dans [0, n[ sans division (32 bits de poids fort)
+static inline uint32_t dictRange(uint64_t x, uint32_t n) {
+    return (uint32_t)(((x >> 32) * n) >> 32);
+}
+
+static inline uint32_t dictBuckets(uint32_t n) {
+    return n / DICT_BUCKET_SIZE + 1;
+}
+
+static inline uint32_t dictBucket(uint64_t h, uint32_t buckets) {
+    return dictRange(dictMix(h, 0), buckets);
+}
+
+// positions f1, f2 d'une cle pour la graine globale seed (la graine 0
+// donne les positions des litteraux compiles avant les graines)
+static inline uint32_t dictPosition(uint64_t h, uint32_t seed, int which, uint32_t n) {
+    return dictRange(dictMix(h, 2 * seed + (uint32_t)which), n);
+}
+
+static inline uint32_t dictPerfectSlot(uint64_t h, uint32_t seed, uint32_t displacement, uint32_t n) {
+    uint64_t f1 = dictPosition(h, seed, 1, n), f2 = dictPosition(h, seed, 2, n);
+    return (uint32_t)((f1 + (uint64_t)(displacement / n) * f2 + displacement % n) % n);
+}
+
+// remplit displacements[dictBuckets(n)] (0 pour un paquet vide) et *seed,
+// la graine retenue ; -1 si aucune des DICT_MAX_SEEDS graines ne separe
+// les cles de chaque paquet en DICT_MAX_ROUNDS valeurs de d0 ou si la
+// memoire manque
+int dictPerfectHash(const uint64_t *hashes, uint32_t n, uint32_t *displacements, uint32_t *seed);
+
+#endif
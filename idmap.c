@@ -0,0 +1,44 @@
+#include <stdlib.h>
+#include "idmap.h"
+
+int initIdMap(IdMap *map, uint32_t expected) {
+    uint32_t capacity = 16;
+    while (capacity < 2 * expected) {
+        capacity *= 2;
+    }
+    map->keys = (uint32_t *)calloc(capacity, sizeof(uint32_t));
+    map->values = (int32_t *)malloc(capacity * sizeof(int32_t));
+    map->mask = capacity - 1;
+    map->count = 0;
+    return map->keys && map->values ? 0 : -1;
+}
+
+void freeIdMap(IdMap *map) {
+    free(map->keys);
+    free(map->values);
+    map->keys = NULL;
+    map->values = NULL;
+}
+
+static uint32_t idSlot(const IdMap *map, StringId id) {
+    uint32_t i = (id * 2654435761u) & map->mask;
+    while (map->keys[i] && map->keys[i] != id + 1) {
+        i = (i + 1) & map->mask;
+    }
+    return i;
+}
+
+int32_t idMapGet(const IdMap *map, StringId id, int32_t absent) {
+    uint32_t i = idSlot(map, id);
+    return map->keys[i] ? map->values[i] : absent;
+}
+
+// la table est dimensionnee a l'avance pour toutes les cles possibles
+void idMapPut(IdMap *map, StringId id, int32_t value) {
+    uint32_t i = idSlot(map, id);
+    if (!map->keys[i]) {
+        map->keys[i] = id + 1;
+        map->count++;
+    }
+    map->values[i] = value;
+}
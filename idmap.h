@@ -0,0 +1,25 @@
+#ifndef IDMAP_H
+#define IDMAP_H
+#include <stdint.h>
+#include "interner.h"
+
+// Table StringId -> entier (adressage ouvert, sondage lineaire), utilisee
+// pour dedoublonner le pool de chaines du bytecode, resoudre les etiquettes
+// et associer une case a chaque nom dans la machine virtuelle.
+//
+// La table ne grandit pas : elle est dimensionnee a l'avance (initIdMap)
+// pour le nombre maximal de cles qu'elle recevra.
+
+typedef struct IdMap {
+    uint32_t *keys;         // StringId + 1 (0 = case libre)
+    int32_t *values;
+    uint32_t mask;
+    uint32_t count;
+} IdMap;
+
+int initIdMap(IdMap *map, uint32_t expected);
+void freeIdMap(IdMap *map);
+int32_t idMapGet(const IdMap *map, StringId id, int32_t absent);
+void idMapPut(IdMap *map, StringId id, int32_t value);
+
+#endif
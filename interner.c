@@ -0,0 +1,306 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "interner.h"
+
+#define INTERNER_MAX_BLOCKS (32 - INTERNER_BLOCK_BITS)
+
+typedef struct InternEntry {
+    const char *str;
+    uint32_t length;
+    uint32_t hash;
+} InternEntry;
+
+typedef struct CharChunk {
+    struct CharChunk *next;
+    size_t used;
+    size_t size;
+    char data[];
+} CharChunk;
+
+// Un shard : ses entrees sont rangees dans des blocs de taille doublante
+// (256, 512, 1024, ...) qui ne sont jamais reallouees, ce qui permet de
+// lire une entree sans verrou. slots est une table a adressage ouvert
+// (sondage lineaire) contenant l'indice local + 1 (0 = case libre).
+// Le handle d'une entree est (local << INTERNER_SHARD_BITS | shard) + 1,
+// le handle 0 etant reserve a la chaine vide.
+typedef struct InternShard {
+    pthread_mutex_t lock;
+    InternEntry *blocks[INTERNER_MAX_BLOCKS];
+    uint32_t count;
+    uint32_t *slots;
+    uint32_t slotMask;
+    CharChunk *chunks;
+} InternShard;
+
+static InternShard shards[INTERNER_SHARDS];
+static pthread_once_t shardsOnce = PTHREAD_ONCE_INIT;
+static InternFailure failureHandler;
+static unsigned generation;
+
+static void initShards(void) {
+    for (uint32_t s = 0; s < INTERNER_SHARDS; s++) {
+        pthread_mutex_init(&shards[s].lock, NULL);
+    }
+}
+
+// le verrou du shard est rendu avant de quitter ou de remonter au gestionnaire
+static void failure(InternShard *shard, const char *message) {
+    pthread_mutex_unlock(&shard->lock);
+    if (failureHandler) {
+        failureHandler(message);
+    }
+    fprintf(stderr, "Error: %s\n", message);
+    exit(1);
+}
+
+static void outOfMemory(InternShard *shard) {
+    failure(shard, "Out of memory in string pool");
+}
+
+static uint32_t hashBytes(const char *s, size_t length) {
+    // FNV-1a 32 bits
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// shard choisi par les bits de poids fort, les bits faibles servant aux slots
+static uint32_t shardOf(uint32_t hash) {
+    return hash >> (32 - INTERNER_SHARD_BITS);
+}
+
+// position (bloc, decalage) de l'entree locale i
+static InternEntry *entryAt(InternShard *shard, uint32_t i) {
+    uint32_t j = i + (1u << INTERNER_BLOCK_BITS);
+    int msb = 31 - __builtin_clz(j);
+    return &shard->blocks[msb - INTERNER_BLOCK_BITS][j - (1u << msb)];
+}
+
+static const char *storeChars(InternShard *shard, const char *s, size_t length) {
+    CharChunk *chunk = shard->chunks;
+    if (!chunk || chunk->size - chunk->used < length + 1) {
+        size_t size = length + 1 > INTERNER_CHUNK_SIZE ? length + 1 : INTERNER_CHUNK_SIZE;
+        chunk = (CharChunk *)malloc(sizeof(CharChunk) + size);
+        if (!chunk) {
+            outOfMemory(shard);
+        }
+        chunk->used = 0;
+        chunk->size = size;
+        chunk->next = shard->chunks;
+        shard->chunks = chunk;
+    }
+    char *dest = chunk->data + chunk->used;
+    memcpy(dest, s, length);
+    dest[length] = '\0';
+    chunk->used += length + 1;
+    return dest;
+}
+
+static void resizeSlots(InternShard *shard, uint32_t newSize) {
+    uint32_t *slots = (uint32_t *)calloc(newSize, sizeof(uint32_t));
+    if (!slots) {
+        outOfMemory(shard);
+    }
+    uint32_t mask = newSize - 1;
+    for (uint32_t local = 0; local < shard->count; local++) {
+        uint32_t i = entryAt(shard, local)->hash & mask;
+        while (slots[i]) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = local + 1;
+    }
+    free(shard->slots);
+    shard->slots = slots;
+    shard->slotMask = mask;
+}
+
+static void growSlots(InternShard *shard) {
+    resizeSlots(shard, shard->slots ? 2 * (shard->slotMask + 1) : INTERNER_INITIAL_SLOTS);
+}
+
+void initInterner(void) {
+    pthread_once(&shardsOnce, initShards);
+}
+
+// a appeler hors de toute compilation en cours
+void freeInterner(void) {
+    initInterner();
+    for (uint32_t s = 0; s < INTERNER_SHARDS; s++) {
+        InternShard *shard = &shards[s];
+        CharChunk *chunk = shard->chunks;
+        while (chunk) {
+            CharChunk *next = chunk->next;
+            free(chunk);
+            chunk = next;
+        }
+        for (int b = 0; b < INTERNER_MAX_BLOCKS; b++) {
+            free(shard->blocks[b]);
+            shard->blocks[b] = NULL;
+        }
+        free(shard->slots);
+        shard->slots = NULL;
+        shard->slotMask = 0;
+        shard->chunks = NULL;
+        __atomic_store_n(&shard->count, 0, __ATOMIC_RELEASE);
+    }
+}
+
+void internerOnFailure(InternFailure handler) {
+    failureHandler = handler;
+}
+
+unsigned internerGeneration(void) {
+    return __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+}
+
+void internerMark(InternMark *mark) {
+    initInterner();
+    for (uint32_t s = 0; s < INTERNER_SHARDS; s++) {
+        InternShard *shard = &shards[s];
+        pthread_mutex_lock(&shard->lock);
+        mark->count[s] = shard->count;
+        mark->chunk[s] = shard->chunks;
+        mark->used[s] = shard->chunks ? shard->chunks->used : 0;
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+
+// Les blocs de caracteres et d'entrees poses apres la marque sont rendus,
+// la table des slots est refaite (et reduite) sur les entrees restantes
+void internerRelease(const InternMark *mark) {
+    initInterner();
+    for (uint32_t s = 0; s < INTERNER_SHARDS; s++) {
+        InternShard *shard = &shards[s];
+        pthread_mutex_lock(&shard->lock);
+        uint32_t count = mark->count[s];
+        if (shard->count == count) {
+            pthread_mutex_unlock(&shard->lock);
+            continue;
+        }
+        while (shard->chunks && shard->chunks != mark->chunk[s]) {
+            CharChunk *next = shard->chunks->next;
+            free(shard->chunks);
+            shard->chunks = next;
+        }
+        if (shard->chunks) {
+            shard->chunks->used = mark->used[s];
+        }
+        for (int b = 0; b < INTERNER_MAX_BLOCKS; b++) {
+            // premiere entree locale du bloc b
+            uint32_t first = (1u << (b + INTERNER_BLOCK_BITS)) - (1u << INTERNER_BLOCK_BITS);
+            if (shard->blocks[b] && first >= count) {
+                free(shard->blocks[b]);
+                shard->blocks[b] = NULL;
+            }
+        }
+        __atomic_store_n(&shard->count, count, __ATOMIC_RELEASE);
+        uint32_t size = INTERNER_INITIAL_SLOTS;
+        while (2 * count > size) {
+            size *= 2;
+        }
+        resizeSlots(shard, size);
+        pthread_mutex_unlock(&shard->lock);
+    }
+    __atomic_fetch_add(&generation, 1, __ATOMIC_RELEASE);
+}
+
+StringId internStringN(const char *s, size_t length) {
+    if (length == 0) {
+        return STRING_ID_NONE;
+    }
+    initInterner();
+    uint32_t h = hashBytes(s, length);
+    uint32_t shardIndex = shardOf(h);
+    InternShard *shard = &shards[shardIndex];
+
+    pthread_mutex_lock(&shard->lock);
+    if (!shard->slots) {
+        growSlots(shard);
+    }
+    uint32_t i = h & shard->slotMask;
+    while (shard->slots[i]) {
+        uint32_t local = shard->slots[i] - 1;
+        InternEntry *e = entryAt(shard, local);
+        if (e->hash == h && e->length == length && memcmp(e->str, s, length) == 0) {
+            pthread_mutex_unlock(&shard->lock);
+            return ((local << INTERNER_SHARD_BITS) | shardIndex) + 1;
+        }
+        i = (i + 1) & shard->slotMask;
+    }
+
+    uint32_t local = shard->count;
+    uint32_t j = local + (1u << INTERNER_BLOCK_BITS);
+    int msb = 31 - __builtin_clz(j);
+    int block = msb - INTERNER_BLOCK_BITS;
+    if (block >= INTERNER_MAX_BLOCKS - INTERNER_SHARD_BITS) {
+        failure(shard, "String pool is full");
+    }
+    if (!shard->blocks[block]) {
+        shard->blocks[block] = (InternEntry *)malloc(((size_t)1 << msb) * sizeof(InternEntry));
+        if (!shard->blocks[block]) {
+            outOfMemory(shard);
+        }
+    }
+    InternEntry *e = &shard->blocks[block][j - (1u << msb)];
+    e->str = storeChars(shard, s, length);
+    e->length = (uint32_t)length;
+    e->hash = h;
+    shard->slots[i] = local + 1;
+    __atomic_store_n(&shard->count, local + 1, __ATOMIC_RELEASE);
+
+    // garder la table a moitie vide pour des sondages courts
+    if (2 * shard->count > shard->slotMask + 1) {
+        growSlots(shard);
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return ((local << INTERNER_SHARD_BITS) | shardIndex) + 1;
+}
+
+StringId internString(const char *s) {
+    if (!s) {
+        return STRING_ID_NONE;
+    }
+    return internStringN(s, strlen(s));
+}
+
+StringId internFormat(const char *format, int n) {
+    char buffer[64];
+    int length = snprintf(buffer, sizeof(buffer), format, n);
+    return internStringN(buffer, length < (int)sizeof(buffer) ? (size_t)length : sizeof(buffer) - 1);
+}
+
+static InternEntry *lookupEntry(StringId id) {
+    if (id == STRING_ID_NONE) {
+        return NULL;
+    }
+    uint32_t key = id - 1;
+    InternShard *shard = &shards[key & (INTERNER_SHARDS - 1)];
+    uint32_t local = key >> INTERNER_SHARD_BITS;
+    if (local >= __atomic_load_n(&shard->count, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+    return entryAt(shard, local);
+}
+
+const char *internedString(StringId id) {
+    InternEntry *e = lookupEntry(id);
+    return e ? e->str : "";
+}
+
+size_t internedLength(StringId id) {
+    InternEntry *e = lookupEntry(id);
+    return e ? e->length : 0;
+}
+
+size_t internedCount(void) {
+    size_t count = 1;  // la chaine vide
+    for (uint32_t s = 0; s < INTERNER_SHARDS; s++) {
+        count += __atomic_load_n(&shards[s].count, __ATOMIC_ACQUIRE);
+    }
+    return count;
+}
@@ -0,0 +1,54 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+#include <stddef.h>
+#include <stdint.h>
+
+// Pool global de chaines internees : chaque identificateur, temporaire,
+// etiquette ou litteral est stocke une seule fois et designe par un
+// handle stable de 32 bits. Deux chaines sont egales si et seulement si
+// leurs handles sont egaux.
+//
+// Le pool est partage entre les compilations paralleles (-j N) : il est
+// decoupe en shards choisis par le hash de la chaine, chacun protege par
+// son propre verrou. La lecture d'un handle (internedString) ne prend
+// aucun verrou : une entree publiee n'est jamais deplacee.
+
+typedef uint32_t StringId;
+
+#define STRING_ID_NONE 0            // handle de la chaine vide ""
+#define INTERNER_SHARD_BITS 6       // 64 shards
+#define INTERNER_SHARDS (1u << INTERNER_SHARD_BITS)
+#define INTERNER_INITIAL_SLOTS 64   // par shard, puissance de 2
+#define INTERNER_BLOCK_BITS 8       // premier bloc d'entrees : 256 entrees
+#define INTERNER_CHUNK_SIZE 16384   // taille d'un bloc de caracteres
+
+// Etat du pool a un instant donne (serveur de compilation) : chaque shard
+// garde son nombre d'entrees et la position dans son bloc de caracteres
+typedef struct InternMark {
+    uint32_t count[INTERNER_SHARDS];
+    const void *chunk[INTERNER_SHARDS];
+    size_t used[INTERNER_SHARDS];
+} InternMark;
+
+// Echec du pool (memoire epuisee, pool plein) : sans gestionnaire, message
+// sur stderr et exit(1). Le gestionnaire recoit le message et ne revient
+// pas (longjmp, voir compilerRequete) ; le pool reste utilisable
+typedef void (*InternFailure)(const char *message);
+
+void initInterner(void);
+void freeInterner(void);
+void internerMark(InternMark *mark);
+// rend tout ce qui a ete interne depuis mark : les handles correspondants
+// deviennent invalides. A appeler hors de toute compilation en cours
+void internerRelease(const InternMark *mark);
+// incremente a chaque internerRelease (caches indexes par les chaines)
+unsigned internerGeneration(void);
+void internerOnFailure(InternFailure handler);
+StringId internString(const char *s);
+StringId internStringN(const char *s, size_t length);
+StringId internFormat(const char *format, int n);
+const char *internedString(StringId id);
+size_t internedLength(StringId id);
+size_t internedCount(void);
+
+#endif
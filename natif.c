@@ -0,0 +1,1440 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include "natif.h"
+#include "idmap.h"
+#include "interner.h"
+
+#define TYPE_UNSET (-2)     // nom qu'aucune operation typee n'a encore ecrit
+
+enum {
+    N_COPIE, N_BR, N_BZ, N_BNZ, N_ADD, N_SUB, N_MUL, N_DIV, N_IDIV, N_MOD,
+    N_EQ, N_NE, N_LT, N_LE, N_GT, N_GE, N_AND, N_OR, N_NOT, N_NEG,
+    N_CONCAT, N_ARRAY, N_PRINT, N_INPUT, N_SWITCH, N_CASE, N_HASH, N_OPERATEURS
+};
+
+// operateurs des quads produits par syntaxique.y (voir vmOperators)
+static const char *const nomsOperateurs[N_OPERATEURS] = {
+    ":=", "BR", "BZ", "BNZ", "+", "-", "*", "/", "DIV", "MOD",
+    "==", "!=", "<", "<=", ">", ">=", "AND", "OR", "NOT", "UMINUS",
+    "CONCAT", "ARRAY_DECL", "PRINT", "INPUT", "SWITCH", "CASE", "HASH"
+};
+
+// operateurs que seule la machine virtuelle execute (--run) : operations
+// element par element et reductions des tableaux, dictionnaires
+static const char *const reservesVm[][2] = {
+    { "VADD", "array operation" }, { "VSUB", "array operation" }, { "VMUL", "array operation" },
+    { "VDIV", "array operation" }, { "VIDIV", "array operation" }, { "VMOD", "array operation" },
+    { "VEQ", "array operation" }, { "VNE", "array operation" }, { "VLT", "array operation" },
+    { "VLE", "array operation" }, { "VGT", "array operation" }, { "VGE", "array operation" },
+    { "VAND", "array operation" }, { "VOR", "array operation" }, { "VNOT", "array operation" },
+    { "VNEG", "array operation" }, { "SUM", "array reduction" }, { "MIN", "array reduction" },
+    { "MAX", "array reduction" }, { "DICT_DECL", "dictionary" }, { "INDEX", "dictionary lookup" },
+};
+
+// erreurs d'execution, memes textes que vm.c
+enum {
+    M_DIVISION, M_MODULO, M_ARITHMETIQUE, M_COMPARAISON, M_AND, M_OR, M_NOT,
+    M_MOINS, M_CONCAT, M_LECTURE, M_SWITCH, M_HASH, N_MESSAGES
+};
+
+static const char *const messages[N_MESSAGES] = {
+    "Division by zero", "Modulo by zero", "Unsupported operand types for arithmetic",
+    "Cannot compare values of these types", "AND requires boolean operands",
+    "OR requires boolean operands", "NOT requires a boolean operand",
+    "Unary minus requires a numeric operand", "CONCAT requires two strings",
+    "Cannot read an array", "SWITCH requires an integer", "HASH requires a string"
+};
+
+// etiquettes de type des elements de tableau (VmType, vm.h)
+enum { HS_INT = 1, HS_FLOAT, HS_BOOL, HS_STRING, HS_ARRAY };
+
+// les NB_PRESERVES premiers survivent aux appels (callee-saved)
+static const char *const registresEntiers[] = {
+    "%rbx", "%r12", "%r13", "%r14", "%r15", "%r8", "%r9", "%r10"
+};
+static const char *const registresReels[] = {
+    "%xmm8", "%xmm9", "%xmm10", "%xmm11", "%xmm12", "%xmm13", "%xmm14", "%xmm15"
+};
+
+#define NB_PRESERVES 5
+#define NB_ENTIERS 8
+#define NB_REELS 8
+#define SAUVEGARDES (8 * NB_PRESERVES)  // rbx, r12-r15 sous rbp
+#define PROFONDEUR_MAX 5                // poids 8^5 au plus
+
+// genre d'un operande
+enum { O_NOM, O_ENTIER, O_REEL, O_BOOLEEN, O_CHAINE, O_TABLEAU };
+
+typedef struct Operande {
+    int genre;
+    int type;               // TYPE_* (tableSymboles.h)
+    int nom;                // indice dans noms (O_NOM)
+    int64_t i;              // O_ENTIER, O_BOOLEEN
+    double f;               // O_REEL
+    const char *texte;      // O_CHAINE : sans les guillemets ; O_TABLEAU : "[...]"
+    size_t longueur;
+} Operande;
+
+typedef struct Nom {
+    StringId id;
+    int type;               // TYPE_*, TYPE_UNSET ou TYPE_UNKNOWN (types en conflit)
+    int declare;            // type fixe par la table des symboles
+    int lu;                 // lu par au moins un quad
+    int registre;           // dans registresEntiers / registresReels, -1 : sur la pile
+    long poids;
+} Nom;
+
+typedef struct Echec {
+    int qc;
+    int message;
+} Echec;
+
+typedef struct Generateur {
+    tableQuads *t;
+    SymbolTable *table;
+    FILE *s;                // assembleur
+    FILE *err;
+    int *operateurs;        // N_* de chaque quad, -1 : etiquette
+    IdMap indices;          // nom -> indice dans noms
+    IdMap etiquettes;       // etiquette -> indice du quad
+    Nom *noms;
+    int nbNoms, capaciteNoms;
+    int appeles[NB_ENTIERS + NB_REELS];  // noms dans un registre ecrase par les appels
+    int nbAppeles;
+    Echec *echecs;          // sorties vers hs_fail, emises apres la fonction
+    int nbEchecs, capaciteEchecs;
+    int etiquette;          // compteur des etiquettes .Ln (sauts) et .Lc (constantes)
+    int qc;                 // quad en cours
+} Generateur;
+
+static int erreur(Generateur *g, const char *message, const char *detail) {
+    if (detail) {
+        fprintf(g->err, "Error: native code: %s '%s' (quad %d)\n", message, detail, g->qc);
+    } else {
+        fprintf(g->err, "Error: native code: %s (quad %d)\n", message, g->qc);
+    }
+    return -1;
+}
+
+static void emettre(Generateur *g, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    fputc('\t', g->s);
+    vfprintf(g->s, format, args);
+    fputc('\n', g->s);
+    va_end(args);
+}
+
+// ---------------------------------------------------------------------------
+// Operandes
+
+static int estNumerique(int type) {
+    return type == TYPE_INTEGER || type == TYPE_FLOAT || type == TYPE_BOOLEAN;
+}
+
+// "[e1,e2,...]" element par element, decoupage identique a arraySlot (vm.c)
+typedef struct Elements {
+    const char *texte;
+    size_t longueur, i, debut;
+    int profondeur, guillemets;
+} Elements;
+
+static void initElements(Elements *e, const char *texte, size_t longueur) {
+    memset(e, 0, sizeof(*e));
+    e->texte = texte;
+    e->longueur = longueur;
+    e->i = 1;
+    e->debut = 1;
+}
+
+static int elementSuivant(Elements *e, const char **element, size_t *taille) {
+    for (; e->i < e->longueur && e->longueur > 2; e->i++) {
+        char c = e->texte[e->i];
+        if (e->guillemets) {
+            if (c == '\\' && e->i + 1 < e->longueur) e->i++;
+            else if (c == '"') e->guillemets = 0;
+            continue;
+        }
+        if (c == '"') e->guillemets = 1;
+        else if (c == '[') e->profondeur++;
+        else if (c == ']' && e->profondeur > 0) e->profondeur--;
+        else if ((c == ',' && e->profondeur == 0) || e->i == e->longueur - 1) {
+            *element = e->texte + e->debut;
+            *taille = e->i - e->debut;
+            e->debut = ++e->i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// litteral ou nom, comme parseLiteral (vm.c) ; -1 si l'operande manque ou
+// si le litteral est invalide
+static int decoder(Generateur *g, const char *texte, size_t n, Operande *o) {
+    memset(o, 0, sizeof(*o));
+    o->nom = -1;
+    o->texte = texte;
+    o->longueur = n;
+    if (n == 0) {
+        return erreur(g, "missing operand", NULL);
+    }
+    if (texte[0] == '[') {
+        o->genre = O_TABLEAU;
+        o->type = TYPE_ARRAY;
+        return 0;
+    }
+    if (n >= 2 && texte[0] == '"' && texte[n - 1] == '"') {
+        o->genre = O_CHAINE;
+        o->type = TYPE_STRING;
+        o->texte = texte + 1;
+        o->longueur = n - 2;
+        return 0;
+    }
+    if ((n == 4 && memcmp(texte, "true", 4) == 0) || (n == 5 && memcmp(texte, "false", 5) == 0)) {
+        o->genre = O_BOOLEEN;
+        o->type = TYPE_BOOLEAN;
+        o->i = texte[0] == 't';
+        return 0;
+    }
+    if (!isdigit((unsigned char)texte[0])) {
+        StringId id = internStringN(texte, n);
+        o->genre = O_NOM;
+        o->nom = idMapGet(&g->indices, id, -1);
+        o->type = o->nom >= 0 ? g->noms[o->nom].type : TYPE_UNSET;
+        return 0;
+    }
+    char buffer[64];
+    if (n >= sizeof(buffer)) {
+        return erreur(g, "invalid literal", texte);
+    }
+    memcpy(buffer, texte, n);
+    buffer[n] = '\0';
+    if (strpbrk(buffer, ".eE")) {
+        o->genre = O_REEL;
+        o->type = TYPE_FLOAT;
+        o->f = strtod(buffer, NULL);
+        o->i = 0;
+    } else {
+        o->genre = O_ENTIER;
+        o->type = TYPE_INTEGER;
+        o->i = strtoll(buffer, NULL, 10);
+    }
+    return 0;
+}
+
+static int decoderId(Generateur *g, StringId id, Operande *o) {
+    if (id == STRING_ID_NONE) {
+        return erreur(g, "missing operand", NULL);
+    }
+    return decoder(g, internedString(id), internedLength(id), o);
+}
+
+// operandes lus (au plus deux) et nom ecrit par un quad ; la cible d'un
+// branchement n'est pas un operande
+static int champs(int op, const quad *q, StringId lus[2], StringId *ecrit) {
+    lus[0] = lus[1] = STRING_ID_NONE;
+    *ecrit = STRING_ID_NONE;
+    switch (op) {
+        case N_BR:
+        case N_CASE:
+            return 0;
+        case N_SWITCH:
+            // SWITCH selecteur, minimum, n (n : taille de la table, pas un nom)
+            lus[0] = q->operande1;
+            lus[1] = q->operande2;
+            return 2;
+        case N_BZ:
+        case N_BNZ:
+            lus[0] = q->resultat;
+            return 1;
+        case N_PRINT:
+            lus[0] = q->operande1;
+            return 1;
+        case N_ARRAY:
+            // ARRAY_DECL nom, [elements], temporaire
+            lus[0] = q->operande2;
+            *ecrit = q->operande1;
+            return 1;
+        case N_COPIE:
+        case N_NOT:
+        case N_NEG:
+        case N_INPUT:
+            lus[0] = q->operande1;
+            *ecrit = q->resultat;
+            return 1;
+        default:
+            lus[0] = q->operande1;
+            lus[1] = q->operande2;
+            *ecrit = q->resultat;
+            return 2;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Recensement des noms et des etiquettes
+
+static int ajouterNom(Generateur *g, StringId id, int lu) {
+    int n = idMapGet(&g->indices, id, -1);
+    if (n < 0) {
+        if (g->nbNoms == g->capaciteNoms) {
+            int capacite = g->capaciteNoms ? 2 * g->capaciteNoms : 64;
+            Nom *noms = (Nom *)realloc(g->noms, capacite * sizeof(Nom));
+            if (!noms) {
+                return -1;
+            }
+            g->noms = noms;
+            g->capaciteNoms = capacite;
+        }
+        n = g->nbNoms++;
+        Nom *nom = &g->noms[n];
+        memset(nom, 0, sizeof(*nom));
+        nom->id = id;
+        nom->type = TYPE_UNSET;
+        nom->registre = -1;
+        SymbolEntry *symbole = g->table ? lookupSymbolByName(g->table, id, currentScope(g->table)) : NULL;
+        if (symbole && symbole->type >= TYPE_BOOLEAN && symbole->type <= TYPE_ARRAY) {
+            nom->type = symbole->type;
+            nom->declare = 1;
+        }
+        idMapPut(&g->indices, id, n);
+    }
+    g->noms[n].lu |= lu;
+    return n;
+}
+
+static int recenserLu(Generateur *g, const char *texte, size_t n) {
+    if (n > 0 && texte[0] == '[') {
+        Elements e;
+        const char *element;
+        size_t taille;
+        initElements(&e, texte, n);
+        while (elementSuivant(&e, &element, &taille)) {
+            if (taille == 0) {
+                return erreur(g, "empty array element", NULL);
+            }
+            if (recenserLu(g, element, taille) < 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+    Operande o;
+    if (decoder(g, texte, n, &o) < 0) {
+        return -1;
+    }
+    if (o.genre == O_NOM && ajouterNom(g, internStringN(texte, n), 1) < 0) {
+        return erreur(g, "out of memory", NULL);
+    }
+    return 0;
+}
+
+static int recenser(Generateur *g) {
+    tableQuads *t = g->t;
+    StringId ids[N_OPERATEURS];
+    for (int k = 0; k < N_OPERATEURS; k++) {
+        ids[k] = internString(nomsOperateurs[k]);
+    }
+    for (int i = 0; i < t->taille; i++) {
+        quad *q = &t->quads[i];
+        g->qc = q->qc;
+        int op = -1;
+        for (int k = 0; k < N_OPERATEURS && op < 0; k++) {
+            op = q->operateur == ids[k] ? k : -1;
+        }
+        g->operateurs[i] = op;
+        if (op < 0) {
+            if (q->operande1 != STRING_ID_NONE || q->operande2 != STRING_ID_NONE || q->resultat != STRING_ID_NONE) {
+                const char *nom = internedString(q->operateur);
+                for (size_t k = 0; k < sizeof(reservesVm) / sizeof(reservesVm[0]); k++) {
+                    if (strcmp(nom, reservesVm[k][0]) == 0) {
+                        fprintf(g->err, "Error: native code: %s '%s' is only supported by the VM, use --run (quad %d)\n",
+                                reservesVm[k][1], nom, g->qc);
+                        return -1;
+                    }
+                }
+                return erreur(g, "unknown operator", nom);
+            }
+            // etiquette : la premiere definition compte, comme dans vm.c
+            if (idMapGet(&g->etiquettes, q->operateur, -1) < 0) {
+                idMapPut(&g->etiquettes, q->operateur, i);
+            }
+            continue;
+        }
+        StringId lus[2], ecrit;
+        int nbLus = champs(op, q, lus, &ecrit);
+        for (int k = 0; k < nbLus; k++) {
+            if (lus[k] == STRING_ID_NONE) {
+                return erreur(g, "missing operand for", nomsOperateurs[op]);
+            }
+            if (recenserLu(g, internedString(lus[k]), internedLength(lus[k])) < 0) {
+                return -1;
+            }
+        }
+        if (op == N_BR || op == N_BZ || op == N_BNZ || op == N_PRINT || op == N_SWITCH || op == N_CASE) {
+            continue;
+        }
+        Operande o;
+        if (ecrit == STRING_ID_NONE) {
+            return erreur(g, "missing result for", nomsOperateurs[op]);
+        }
+        if (decoderId(g, ecrit, &o) < 0) {
+            return -1;
+        }
+        if (o.genre != O_NOM) {
+            return erreur(g, "cannot assign to literal", internedString(ecrit));
+        }
+        if (ajouterNom(g, ecrit, 0) < 0) {
+            return erreur(g, "out of memory", NULL);
+        }
+    }
+    return 0;
+}
+
+// indice du quad vise par un branchement : numero de quad (apres -O) ou
+// etiquette ; t->taille pour la fin du programme
+static int cible(Generateur *g, StringId id) {
+    int i = indiceCible(g->t, id);
+    return i >= 0 ? i : idMapGet(&g->etiquettes, id, -1);
+}
+
+// ---------------------------------------------------------------------------
+// Types statiques
+
+// type du resultat selon celui des operandes (resultType, vm.c) ;
+// TYPE_UNKNOWN avec *message si l'operation echoue toujours
+static int typeOperation(int op, int ta, int tb, int *message) {
+    *message = -1;
+    if (ta == TYPE_UNSET || tb == TYPE_UNSET) {
+        return TYPE_UNSET;
+    }
+    if (ta == TYPE_UNKNOWN || tb == TYPE_UNKNOWN) {
+        return TYPE_UNKNOWN;
+    }
+    switch (op) {
+        case N_COPIE:
+            return ta;
+        case N_ADD:
+        case N_SUB:
+        case N_MUL:
+            if (!estNumerique(ta) || !estNumerique(tb)) break;
+            return ta == TYPE_FLOAT || tb == TYPE_FLOAT ? TYPE_FLOAT : TYPE_INTEGER;
+        case N_DIV:
+            if (!estNumerique(ta) || !estNumerique(tb)) break;
+            return TYPE_FLOAT;
+        case N_IDIV:
+        case N_MOD:
+            if (!estNumerique(ta) || !estNumerique(tb)) break;
+            return TYPE_INTEGER;
+        case N_EQ: case N_NE: case N_LT: case N_LE: case N_GT: case N_GE:
+            if (!(ta == TYPE_STRING && tb == TYPE_STRING) && !(estNumerique(ta) && estNumerique(tb))) {
+                *message = M_COMPARAISON;
+                return TYPE_UNKNOWN;
+            }
+            return TYPE_BOOLEAN;
+        case N_AND:
+        case N_OR:
+            if (ta != TYPE_BOOLEAN || tb != TYPE_BOOLEAN) {
+                *message = op == N_AND ? M_AND : M_OR;
+                return TYPE_UNKNOWN;
+            }
+            return TYPE_BOOLEAN;
+        case N_NOT:
+            if (ta != TYPE_BOOLEAN) {
+                *message = M_NOT;
+                return TYPE_UNKNOWN;
+            }
+            return TYPE_BOOLEAN;
+        case N_NEG:
+            if (!estNumerique(ta)) {
+                *message = M_MOINS;
+                return TYPE_UNKNOWN;
+            }
+            return ta == TYPE_FLOAT ? TYPE_FLOAT : TYPE_INTEGER;
+        case N_CONCAT:
+            if (ta != TYPE_STRING || tb != TYPE_STRING) {
+                *message = M_CONCAT;
+                return TYPE_UNKNOWN;
+            }
+            return TYPE_STRING;
+        case N_HASH:
+            if (ta != TYPE_STRING) {
+                *message = M_HASH;
+                return TYPE_UNKNOWN;
+            }
+            return TYPE_INTEGER;
+        default:
+            return TYPE_UNKNOWN;
+    }
+    *message = M_ARITHMETIQUE;
+    return TYPE_UNKNOWN;
+}
+
+// type ecrit par le quad i dans son resultat ; TYPE_UNKNOWN avec
+// *message si le quad echoue toujours
+static int typeQuad(Generateur *g, int i, int *message) {
+    quad *q = &g->t->quads[i];
+    int op = g->operateurs[i];
+    StringId lus[2], ecrit;
+    int nbLus = champs(op, q, lus, &ecrit);
+    Operande a, b;
+    *message = -1;
+    if (decoderId(g, lus[0], &a) < 0 || (nbLus == 2 && decoderId(g, lus[1], &b) < 0)) {
+        return TYPE_UNKNOWN;
+    }
+    if (op == N_INPUT) {
+        // lecture au type declare, chaine sinon
+        Nom *nom = &g->noms[idMapGet(&g->indices, ecrit, -1)];
+        if (nom->declare && nom->type == TYPE_ARRAY) {
+            *message = M_LECTURE;
+            return TYPE_UNKNOWN;
+        }
+        return nom->declare ? nom->type : TYPE_STRING;
+    }
+    if (op == N_ARRAY) {
+        return a.type;
+    }
+    return typeOperation(op, a.type, nbLus == 2 ? b.type : a.type, message);
+}
+
+// Un nom declare garde le type de la table des symboles, les autres
+// prennent le type commun de leurs ecritures ; repete jusqu'a stabilite
+// (les types ne font que monter : TYPE_UNSET, un type, TYPE_UNKNOWN)
+static int typer(Generateur *g) {
+    int change;
+    do {
+        change = 0;
+        for (int i = 0; i < g->t->taille; i++) {
+            int op = g->operateurs[i];
+            if (op < 0 || op == N_BR || op == N_BZ || op == N_BNZ || op == N_PRINT || op == N_SWITCH ||
+                op == N_CASE) {
+                continue;
+            }
+            g->qc = g->t->quads[i].qc;
+            int message;
+            int type = typeQuad(g, i, &message);
+            if (type == TYPE_UNSET || message >= 0) {
+                continue;
+            }
+            StringId lus[2], ecrit;
+            champs(op, &g->t->quads[i], lus, &ecrit);
+            Nom *nom = &g->noms[idMapGet(&g->indices, ecrit, -1)];
+            int joint = nom->type == TYPE_UNSET || nom->type == type ? type : TYPE_UNKNOWN;
+            if (joint != nom->type) {
+                nom->type = joint;
+                change = 1;
+            }
+        }
+    } while (change);
+
+    for (int n = 0; n < g->nbNoms; n++) {
+        Nom *nom = &g->noms[n];
+        if (nom->type == TYPE_UNKNOWN || (nom->type == TYPE_UNSET && nom->lu)) {
+            g->qc = 0;
+            fprintf(g->err, "Error: native code: '%s' has no static type\n", internedString(nom->id));
+            return -1;
+        }
+        if (nom->type == TYPE_UNSET) {
+            nom->type = TYPE_INTEGER;   // jamais lu
+        }
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Registres : poids de chaque nom (occurrences, x8 par niveau de boucle)
+
+static int allouerRegistres(Generateur *g) {
+    tableQuads *t = g->t;
+    int *profondeur = (int *)calloc(t->taille + 1, sizeof(int));
+    if (!profondeur) {
+        return -1;
+    }
+    // un branchement arriere delimite une boucle [cible, branchement]
+    for (int i = 0; i < t->taille; i++) {
+        int op = g->operateurs[i];
+        if (op == N_BR || op == N_BZ || op == N_BNZ) {
+            int j = cible(g, op == N_BR ? t->quads[i].resultat : t->quads[i].operande1);
+            if (j >= 0 && j <= i) {
+                profondeur[j]++;
+                profondeur[i + 1]--;
+            }
+        }
+    }
+    int niveau = 0;
+    for (int i = 0; i < t->taille; i++) {
+        niveau += profondeur[i];
+        int op = g->operateurs[i];
+        if (op < 0) {
+            continue;
+        }
+        long poids = 1L << (3 * (niveau < PROFONDEUR_MAX ? niveau : PROFONDEUR_MAX));
+        StringId lus[3];
+        int nb = champs(op, &t->quads[i], lus, &lus[2]);
+        lus[nb] = lus[2];
+        for (int k = 0; k <= nb; k++) {
+            int n = lus[k] != STRING_ID_NONE ? idMapGet(&g->indices, lus[k], -1) : -1;
+            if (n >= 0) {
+                g->noms[n].poids += poids;
+            }
+        }
+    }
+    free(profondeur);
+
+    // les plus lourds d'abord, une classe de registres par type
+    int entiers = 0, reels = 0;
+    for (;;) {
+        int meilleur = -1;
+        for (int n = 0; n < g->nbNoms; n++) {
+            Nom *nom = &g->noms[n];
+            int libre = nom->type == TYPE_FLOAT ? reels < NB_REELS : entiers < NB_ENTIERS;
+            if (nom->registre < 0 && libre && nom->poids > 0 &&
+                (meilleur < 0 || nom->poids > g->noms[meilleur].poids)) {
+                meilleur = n;
+            }
+        }
+        if (meilleur < 0) {
+            break;
+        }
+        Nom *nom = &g->noms[meilleur];
+        nom->registre = nom->type == TYPE_FLOAT ? reels++ : entiers++;
+        if (nom->type == TYPE_FLOAT || nom->registre >= NB_PRESERVES) {
+            g->appeles[g->nbAppeles++] = meilleur;
+        }
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Emission
+
+static int deplacement(int n) {
+    return -(SAUVEGARDES + 8 + 8 * n);
+}
+
+static const char *place(Generateur *g, int n, char *tampon) {
+    Nom *nom = &g->noms[n];
+    if (nom->registre >= 0) {
+        return nom->type == TYPE_FLOAT ? registresReels[nom->registre] : registresEntiers[nom->registre];
+    }
+    snprintf(tampon, 32, "%d(%%rbp)", deplacement(n));
+    return tampon;
+}
+
+static int echec(Generateur *g, int message) {
+    if (g->nbEchecs == g->capaciteEchecs) {
+        int capacite = g->capaciteEchecs ? 2 * g->capaciteEchecs : 64;
+        Echec *echecs = (Echec *)realloc(g->echecs, capacite * sizeof(Echec));
+        if (!echecs) {
+            return -1;
+        }
+        g->echecs = echecs;
+        g->capaciteEchecs = capacite;
+    }
+    g->echecs[g->nbEchecs].qc = g->qc;
+    g->echecs[g->nbEchecs].message = message;
+    return g->nbEchecs++;
+}
+
+// saut vers l'appel de hs_fail pour le quad en cours
+static int echouer(Generateur *g, const char *saut, int message) {
+    int e = echec(g, message);
+    if (e < 0) {
+        return -1;
+    }
+    emettre(g, "%s .Le%d", saut, e);
+    return 0;
+}
+
+static int constanteReelle(Generateur *g, double f) {
+    uint64_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    int c = g->etiquette++;
+    fprintf(g->s, "\t.section .rodata\n\t.balign 8\n.Lc%d:\n\t.quad %llu\n\t.text\n", c, (unsigned long long)bits);
+    return c;
+}
+
+// HsString (natif_runtime.c) : longueur puis octets, tels quels
+static int constanteChaine(Generateur *g, const char *texte, size_t longueur) {
+    int c = g->etiquette++;
+    fprintf(g->s, "\t.section .rodata\n\t.balign 8\n.Lc%d:\n\t.quad %zu\n", c, longueur);
+    for (size_t i = 0; i < longueur; i += 64) {
+        fputs("\t.ascii \"", g->s);
+        for (size_t k = i; k < longueur && k < i + 64; k++) {
+            unsigned char ch = (unsigned char)texte[k];
+            if (ch == '"' || ch == '\\') fprintf(g->s, "\\%c", ch);
+            else if (ch >= 0x20 && ch < 0x7f) fputc(ch, g->s);
+            else fprintf(g->s, "\\%03o", ch);
+        }
+        fputs("\"\n", g->s);
+    }
+    fputs("\t.byte 0\n\t.text\n", g->s);
+    return c;
+}
+
+static int tient32(int64_t v) {
+    return v >= INT32_MIN && v <= INT32_MAX;
+}
+
+static void immediat(Generateur *g, int64_t v, const char *registre) {
+    emettre(g, tient32(v) ? "movq $%lld, %s" : "movabsq $%lld, %s", (long long)v, registre);
+}
+
+static int construireTableau(Generateur *g, const char *texte, size_t longueur);
+
+// valeur d'un operande (bits d'un reel) dans un registre general
+static int chargerEntier(Generateur *g, const Operande *o, const char *registre) {
+    char tampon[32];
+    switch (o->genre) {
+        case O_NOM: {
+            const char *p = place(g, o->nom, tampon);
+            if (strcmp(p, registre) != 0) {
+                emettre(g, "movq %s, %s", p, registre);
+            }
+            return 0;
+        }
+        case O_REEL: {
+            int64_t bits;
+            memcpy(&bits, &o->f, sizeof(bits));
+            immediat(g, bits, registre);
+            return 0;
+        }
+        case O_CHAINE:
+            emettre(g, "leaq .Lc%d(%%rip), %s", constanteChaine(g, o->texte, o->longueur), registre);
+            return 0;
+        case O_TABLEAU:
+            if (construireTableau(g, o->texte, o->longueur) < 0) {
+                return -1;
+            }
+            if (strcmp(registre, "%rax") != 0) {
+                emettre(g, "movq %%rax, %s", registre);
+            }
+            return 0;
+        default:
+            immediat(g, o->i, registre);
+            return 0;
+    }
+}
+
+// second operande d'une instruction entiere : registre, memoire ou
+// immediat ; charge dans rcx sinon
+static const char *source(Generateur *g, const Operande *o, char *tampon) {
+    if (o->genre == O_NOM) {
+        return place(g, o->nom, tampon);
+    }
+    if ((o->genre == O_ENTIER || o->genre == O_BOOLEEN) && tient32(o->i)) {
+        snprintf(tampon, 32, "$%lld", (long long)o->i);
+        return tampon;
+    }
+    chargerEntier(g, o, "%rcx");
+    return "%rcx";
+}
+
+static double valeurReelle(const Operande *o) {
+    return o->genre == O_REEL ? o->f : (double)o->i;
+}
+
+// valeur numerique convertie en reel dans un registre xmm
+static void chargerReel(Generateur *g, const Operande *o, const char *registre) {
+    char tampon[32];
+    if (o->genre != O_NOM) {
+        emettre(g, "movsd .Lc%d(%%rip), %s", constanteReelle(g, valeurReelle(o)), registre);
+        return;
+    }
+    const char *p = place(g, o->nom, tampon);
+    if (g->noms[o->nom].type != TYPE_FLOAT) {
+        emettre(g, "cvtsi2sdq %s, %s", p, registre);
+    } else if (strcmp(p, registre) != 0) {
+        emettre(g, g->noms[o->nom].registre >= 0 ? "movapd %s, %s" : "movsd %s, %s", p, registre);
+    }
+}
+
+// second operande d'une instruction reelle ; converti dans auxiliaire si
+// c'est un nom entier
+static const char *operandeReel(Generateur *g, const Operande *o, char *tampon, const char *auxiliaire) {
+    if (o->genre != O_NOM) {
+        snprintf(tampon, 32, ".Lc%d(%%rip)", constanteReelle(g, valeurReelle(o)));
+        return tampon;
+    }
+    if (g->noms[o->nom].type != TYPE_FLOAT) {
+        chargerReel(g, o, auxiliaire);
+        return auxiliaire;
+    }
+    return place(g, o->nom, tampon);
+}
+
+static void rangerEntier(Generateur *g, int n, const char *registre) {
+    char tampon[32];
+    const char *p = place(g, n, tampon);
+    if (strcmp(p, registre) != 0) {
+        emettre(g, "movq %s, %s", registre, p);
+    }
+}
+
+static void rangerReel(Generateur *g, int n, const char *registre) {
+    char tampon[32];
+    const char *p = place(g, n, tampon);
+    if (strcmp(p, registre) != 0) {
+        emettre(g, g->noms[n].registre >= 0 ? "movapd %s, %s" : "movsd %s, %s", registre, p);
+    }
+}
+
+// registre du resultat r s'il en a un et que b ne l'occupe pas, defaut sinon
+static const char *destination(Generateur *g, int r, const Operande *b, const char *defaut) {
+    Nom *nom = &g->noms[r];
+    if (nom->registre < 0 || (b && b->genre == O_NOM && b->nom == r)) {
+        return defaut;
+    }
+    return nom->type == TYPE_FLOAT ? registresReels[nom->registre] : registresEntiers[nom->registre];
+}
+
+// appel du support d'execution : les registres ecrases par l'appel sont
+// sauves dans la case de leur nom, puis recharges
+static void appeler(Generateur *g, const char *fonction) {
+    char tampon[32];
+    for (int k = 0; k < g->nbAppeles; k++) {
+        int n = g->appeles[k];
+        const char *format = g->noms[n].type == TYPE_FLOAT ? "movsd %s, %d(%%rbp)" : "movq %s, %d(%%rbp)";
+        emettre(g, format, place(g, n, tampon), deplacement(n));
+    }
+    emettre(g, "call %s", fonction);
+    for (int k = 0; k < g->nbAppeles; k++) {
+        int n = g->appeles[k];
+        const char *format = g->noms[n].type == TYPE_FLOAT ? "movsd %d(%%rbp), %s" : "movq %d(%%rbp), %s";
+        emettre(g, format, deplacement(n), place(g, n, tampon));
+    }
+}
+
+static int etiquetteType(int type) {
+    switch (type) {
+        case TYPE_INTEGER: return HS_INT;
+        case TYPE_FLOAT:   return HS_FLOAT;
+        case TYPE_BOOLEAN: return HS_BOOL;
+        case TYPE_STRING:  return HS_STRING;
+        default:           return HS_ARRAY;
+    }
+}
+
+// tableau construit sur la pile puis copie par hs_array_new ; adresse
+// dans rax
+static int construireTableau(Generateur *g, const char *texte, size_t longueur) {
+    Elements e;
+    const char *element;
+    size_t taille;
+    int nombre = 0;
+    initElements(&e, texte, longueur);
+    while (elementSuivant(&e, &element, &taille)) {
+        nombre++;
+    }
+    int espace = (16 * nombre + 15) & ~15;
+    if (espace > 0) {
+        emettre(g, "subq $%d, %%rsp", espace);
+    }
+    initElements(&e, texte, longueur);
+    for (int k = 0; elementSuivant(&e, &element, &taille); k++) {
+        Operande o;
+        if (decoder(g, element, taille, &o) < 0) {
+            return -1;
+        }
+        emettre(g, "movq $%d, %d(%%rsp)", etiquetteType(o.type), 16 * k);
+        if (o.type == TYPE_FLOAT) {
+            chargerReel(g, &o, "%xmm0");
+            emettre(g, "movsd %%xmm0, %d(%%rsp)", 16 * k + 8);
+        } else {
+            if (chargerEntier(g, &o, "%rax") < 0) {
+                return -1;
+            }
+            emettre(g, "movq %%rax, %d(%%rsp)", 16 * k + 8);
+        }
+    }
+    emettre(g, "movq $%d, %%rdi", nombre);
+    emettre(g, "movq %%rsp, %%rsi");
+    emettre(g, "movq $%d, %%rdx", g->qc);
+    appeler(g, "hs_array_new");
+    if (espace > 0) {
+        emettre(g, "addq $%d, %%rsp", espace);
+    }
+    return 0;
+}
+
+static void copier(Generateur *g, const Operande *a, int r) {
+    if (g->noms[r].type == TYPE_FLOAT) {
+        const char *d = destination(g, r, NULL, "%xmm0");
+        chargerReel(g, a, d);
+        rangerReel(g, r, d);
+        return;
+    }
+    char tampon[32];
+    if (g->noms[r].registre < 0 && (a->genre == O_ENTIER || a->genre == O_BOOLEEN) && tient32(a->i)) {
+        emettre(g, "movq $%lld, %s", (long long)a->i, place(g, r, tampon));
+        return;
+    }
+    const char *d = destination(g, r, NULL, "%rax");
+    chargerEntier(g, a, d);
+    rangerEntier(g, r, d);
+}
+
+// r = a instruction b sur des entiers
+static void binaireEntier(Generateur *g, const char *instruction, const Operande *a, const Operande *b, int r) {
+    char tampon[32];
+    const char *d = destination(g, r, b, "%rax");
+    chargerEntier(g, a, d);
+    emettre(g, "%s %s, %s", instruction, source(g, b, tampon), d);
+    rangerEntier(g, r, d);
+}
+
+static void binaireReel(Generateur *g, const char *instruction, const Operande *a, const Operande *b, int r) {
+    char tampon[32];
+    const char *d = destination(g, r, b, "%xmm0");
+    chargerReel(g, a, d);
+    emettre(g, "%s %s, %s", instruction, operandeReel(g, b, tampon, "%xmm1"), d);
+    rangerReel(g, r, d);
+}
+
+// magie de la division signee par une constante (Hacker's Delight,
+// 10-1) : x / d = (hi(x * m) [+ x ou - x]) >> s, corrige vers zero
+static void magie(int64_t d, int64_t *m, int *s) {
+    const uint64_t deux63 = (uint64_t)1 << 63;
+    uint64_t ad = d < 0 ? (uint64_t)0 - (uint64_t)d : (uint64_t)d;
+    uint64_t t = deux63 + ((uint64_t)d >> 63);
+    uint64_t anc = t - 1 - t % ad;
+    uint64_t q1 = deux63 / anc, r1 = deux63 - q1 * anc;
+    uint64_t q2 = deux63 / ad, r2 = deux63 - q2 * ad;
+    uint64_t delta;
+    int p = 63;
+    do {
+        p++;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= anc) {
+            q1++;
+            r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= ad) {
+            q2++;
+            r2 -= ad;
+        }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+    *m = (int64_t)(q2 + 1);
+    if (d < 0) {
+        *m = (int64_t)((uint64_t)0 - (uint64_t)*m);
+    }
+    *s = p - 64;
+}
+
+// DIV et MOD entiers (integerDivide, vm.c) ; resultat dans rax
+static int diviserEntier(Generateur *g, int op, const Operande *a, const Operande *b, int r) {
+    int constante = b->genre == O_ENTIER || b->genre == O_BOOLEEN;
+    int64_t d = b->i;
+    if (constante && d == 0) {
+        return echouer(g, "jmp", op == N_MOD ? M_MODULO : M_DIVISION);
+    }
+    if (constante && (d == 1 || d == -1)) {
+        if (op == N_MOD) {
+            emettre(g, "xorl %%eax, %%eax");
+        } else {
+            chargerEntier(g, a, "%rax");
+            if (d == -1) {
+                emettre(g, "negq %%rax");
+            }
+        }
+    } else if (constante && d != INT64_MIN) {
+        int64_t m;
+        int s;
+        magie(d, &m, &s);
+        chargerEntier(g, a, "%rcx");
+        immediat(g, m, "%rax");
+        emettre(g, "imulq %%rcx");
+        if (d > 0 && m < 0) {
+            emettre(g, "addq %%rcx, %%rdx");
+        } else if (d < 0 && m > 0) {
+            emettre(g, "subq %%rcx, %%rdx");
+        }
+        if (s > 0) {
+            emettre(g, "sarq $%d, %%rdx", s);
+        }
+        emettre(g, "movq %%rdx, %%rax");
+        emettre(g, "shrq $63, %%rax");
+        emettre(g, "addq %%rdx, %%rax");
+        if (op == N_MOD) {
+            if (tient32(d)) {
+                emettre(g, "imulq $%lld, %%rax", (long long)d);
+            } else {
+                immediat(g, d, "%rdx");
+                emettre(g, "imulq %%rdx, %%rax");
+            }
+            emettre(g, "subq %%rax, %%rcx");
+            emettre(g, "movq %%rcx, %%rax");
+        }
+    } else {
+        int moinsUn = g->etiquette++, fin = g->etiquette++;
+        chargerEntier(g, b, "%rcx");
+        if (!constante) {
+            emettre(g, "testq %%rcx, %%rcx");
+            if (echouer(g, "je", op == N_MOD ? M_MODULO : M_DIVISION) < 0) {
+                return -1;
+            }
+        }
+        chargerEntier(g, a, "%rax");
+        emettre(g, "cmpq $-1, %%rcx");
+        emettre(g, "je .Ln%d", moinsUn);
+        emettre(g, "cqto");
+        emettre(g, "idivq %%rcx");
+        if (op == N_MOD) {
+            emettre(g, "movq %%rdx, %%rax");
+        }
+        emettre(g, "jmp .Ln%d", fin);
+        fprintf(g->s, ".Ln%d:\n", moinsUn);
+        emettre(g, op == N_MOD ? "xorl %%eax, %%eax" : "negq %%rax");
+        fprintf(g->s, ".Ln%d:\n", fin);
+    }
+    rangerEntier(g, r, "%rax");
+    return 0;
+}
+
+static int comparer(Generateur *g, int op, const Operande *a, const Operande *b, int r) {
+    static const char *const signes[] = { "sete", "setne", "setl", "setle", "setg", "setge" };
+    char tampon[32];
+    if (a->type == TYPE_STRING) {
+        chargerEntier(g, a, "%rdi");
+        chargerEntier(g, b, "%rsi");
+        appeler(g, "hs_compare_strings");
+        emettre(g, "cmpq $0, %%rax");
+        emettre(g, "%s %%al", signes[op - N_EQ]);
+    } else if (a->type != TYPE_FLOAT && b->type != TYPE_FLOAT) {
+        chargerEntier(g, a, "%rax");
+        emettre(g, "cmpq %s, %%rax", source(g, b, tampon));
+        emettre(g, "%s %%al", signes[op - N_EQ]);
+    } else {
+        // NaN : ucomisd leve ZF, PF et CF, seul != est vrai
+        chargerReel(g, a, "%xmm0");
+        chargerReel(g, b, "%xmm1");
+        switch (op) {
+            case N_EQ:
+            case N_NE:
+                emettre(g, "ucomisd %%xmm1, %%xmm0");
+                emettre(g, op == N_EQ ? "sete %%al" : "setne %%al");
+                emettre(g, op == N_EQ ? "setnp %%cl" : "setp %%cl");
+                emettre(g, op == N_EQ ? "andb %%cl, %%al" : "orb %%cl, %%al");
+                break;
+            case N_GT:
+            case N_GE:
+                emettre(g, "ucomisd %%xmm1, %%xmm0");
+                emettre(g, op == N_GT ? "seta %%al" : "setae %%al");
+                break;
+            default:
+                emettre(g, "ucomisd %%xmm0, %%xmm1");
+                emettre(g, op == N_LT ? "seta %%al" : "setae %%al");
+                break;
+        }
+    }
+    emettre(g, "movzbl %%al, %%eax");
+    rangerEntier(g, r, "%rax");
+    return 0;
+}
+
+// appel de hs_write_<type> (PRINT : fin = '\n', message d'INPUT : 0)
+static int ecrire(Generateur *g, const Operande *a, int fin) {
+    static const char *const fonctions[] = {
+        "hs_write_bool", "hs_write_int", "hs_write_float", "hs_write_string", "hs_write_array"
+    };
+    if (a->type == TYPE_FLOAT) {
+        chargerReel(g, a, "%xmm0");
+        emettre(g, "movl $%d, %%edi", fin);
+    } else {
+        if (chargerEntier(g, a, "%rdi") < 0) {
+            return -1;
+        }
+        emettre(g, "movl $%d, %%esi", fin);
+    }
+    appeler(g, fonctions[a->type]);
+    return 0;
+}
+
+static int lire(Generateur *g, int r) {
+    static const char *const fonctions[] = {
+        "hs_read_bool", "hs_read_int", "hs_read_float", "hs_read_string"
+    };
+    Nom *nom = &g->noms[r];
+    int type = nom->declare ? nom->type : TYPE_STRING;
+    if (type == TYPE_ARRAY) {
+        return echouer(g, "jmp", M_LECTURE);
+    }
+    emettre(g, "movq $%d, %%rdi", g->qc);
+    appeler(g, fonctions[type]);
+    if (type == TYPE_FLOAT) {
+        rangerReel(g, r, "%xmm0");
+    } else {
+        rangerEntier(g, r, "%rax");
+    }
+    return 0;
+}
+
+static int brancher(Generateur *g, int op, const Operande *c, int j) {
+    if (op == N_BR) {
+        emettre(g, "jmp .Lq%d", j);
+        return 0;
+    }
+    if (c->genre != O_NOM) {
+        // condition constante ; une chaine ou un tableau est non nul
+        int vrai = c->genre == O_CHAINE || c->genre == O_TABLEAU || (c->genre == O_REEL ? c->f != 0 : c->i != 0);
+        if (vrai == (op == N_BNZ)) {
+            emettre(g, "jmp .Lq%d", j);
+        }
+        return 0;
+    }
+    char tampon[32];
+    Nom *nom = &g->noms[c->nom];
+    if (nom->type == TYPE_FLOAT) {
+        chargerEntier(g, c, "%rax");
+        emettre(g, "testq %%rax, %%rax");
+    } else if (nom->registre >= 0) {
+        const char *p = place(g, c->nom, tampon);
+        emettre(g, "testq %s, %s", p, p);
+    } else {
+        emettre(g, "cmpq $0, %s", place(g, c->nom, tampon));
+    }
+    emettre(g, "%s .Lq%d", op == N_BZ ? "je" : "jne", j);
+    return 0;
+}
+
+// SWITCH : saut indirect par une table .rodata de deplacements relatifs
+// vers les cibles des n CASE qui suivent ; hors de [minimum, minimum + n[,
+// quad qui suit la table
+static int aiguiller(Generateur *g, int i, const Operande *a, const Operande *b) {
+    tableQuads *t = g->t;
+    long n = strtol(internedString(t->quads[i].resultat), NULL, 10);
+    int *cibles = (int *)malloc((n + 1) * sizeof(int));
+    if (!cibles) {
+        return erreur(g, "out of memory", NULL);
+    }
+    int j = i + 1;
+    for (long k = 0; k < n; k++, j++) {
+        while (j < t->taille && g->operateurs[j] < 0) {
+            j++;
+        }
+        if (j >= t->taille || g->operateurs[j] != N_CASE) {
+            free(cibles);
+            return erreur(g, "SWITCH without its CASE table", NULL);
+        }
+        cibles[k] = cible(g, t->quads[j].operande1);
+        if (cibles[k] < 0) {
+            free(cibles);
+            return erreur(g, "undefined label", internedString(t->quads[j].operande1));
+        }
+    }
+    if (a->type != TYPE_INTEGER || b->type != TYPE_INTEGER) {
+        free(cibles);
+        return echouer(g, "jmp", M_SWITCH);
+    }
+    char tampon[32];
+    int table = g->etiquette++;
+    chargerEntier(g, a, "%rax");
+    emettre(g, "subq %s, %%rax", source(g, b, tampon));
+    emettre(g, "cmpq $%ld, %%rax", n);
+    emettre(g, "jae .Lq%d", j);
+    emettre(g, "leaq .Lj%d(%%rip), %%rcx", table);
+    emettre(g, "movslq (%%rcx,%%rax,4), %%rax");
+    emettre(g, "addq %%rcx, %%rax");
+    emettre(g, "jmp *%%rax");
+    fprintf(g->s, "\t.section .rodata\n\t.balign 4\n.Lj%d:\n", table);
+    for (long k = 0; k < n; k++) {
+        fprintf(g->s, "\t.long .Lq%d-.Lj%d\n", cibles[k], table);
+    }
+    fputs("\t.text\n", g->s);
+    free(cibles);
+    return 0;
+}
+
+static int genererQuad(Generateur *g, int i) {
+    quad *q = &g->t->quads[i];
+    int op = g->operateurs[i];
+    if (op < 0) {
+        return 0;
+    }
+    StringId lus[2], ecrit;
+    int nbLus = champs(op, q, lus, &ecrit);
+    Operande a, b;
+    if ((nbLus > 0 && decoderId(g, lus[0], &a) < 0) || (nbLus > 1 && decoderId(g, lus[1], &b) < 0)) {
+        return -1;
+    }
+    int r = ecrit != STRING_ID_NONE ? idMapGet(&g->indices, ecrit, -1) : -1;
+
+    if (op == N_BR || op == N_BZ || op == N_BNZ) {
+        int j = cible(g, op == N_BR ? q->resultat : q->operande1);
+        if (j < 0) {
+            return erreur(g, "undefined label", internedString(op == N_BR ? q->resultat : q->operande1));
+        }
+        return brancher(g, op, &a, j);
+    }
+    if (op == N_CASE) {
+        // entree de table : atteinte seulement par le saut du SWITCH
+        int j = cible(g, q->operande1);
+        if (j < 0) {
+            return erreur(g, "undefined label", internedString(q->operande1));
+        }
+        emettre(g, "jmp .Lq%d", j);
+        return 0;
+    }
+    if (op == N_SWITCH) {
+        return aiguiller(g, i, &a, &b);
+    }
+    if (op == N_PRINT) {
+        return ecrire(g, &a, '\n');
+    }
+    if (op == N_INPUT) {
+        return ecrire(g, &a, 0) < 0 ? -1 : lire(g, r);
+    }
+    if (op == N_ARRAY) {
+        if (a.genre == O_TABLEAU) {
+            if (construireTableau(g, a.texte, a.longueur) < 0) {
+                return -1;
+            }
+            rangerEntier(g, r, "%rax");
+            return 0;
+        }
+        copier(g, &a, r);
+        return 0;
+    }
+
+    int message;
+    int type = typeOperation(op, a.type, nbLus == 2 ? b.type : a.type, &message);
+    if (message >= 0 || type == TYPE_UNKNOWN) {
+        return echouer(g, "jmp", message >= 0 ? message : M_ARITHMETIQUE);
+    }
+    int reel = a.type == TYPE_FLOAT || (nbLus == 2 && b.type == TYPE_FLOAT);
+    switch (op) {
+        case N_COPIE:
+            copier(g, &a, r);
+            return 0;
+        case N_ADD:
+        case N_SUB:
+        case N_MUL:
+            if (reel) {
+                binaireReel(g, op == N_ADD ? "addsd" : op == N_SUB ? "subsd" : "mulsd", &a, &b, r);
+            } else {
+                binaireEntier(g, op == N_ADD ? "addq" : op == N_SUB ? "subq" : "imulq", &a, &b, r);
+            }
+            return 0;
+        case N_DIV: {
+            const char *d = destination(g, r, &b, "%xmm0");
+            if (b.genre == O_NOM || valeurReelle(&b) == 0) {
+                int suite = g->etiquette++;
+                chargerReel(g, &b, "%xmm1");
+                emettre(g, "xorpd %%xmm2, %%xmm2");
+                emettre(g, "ucomisd %%xmm2, %%xmm1");
+                emettre(g, "jp .Ln%d", suite);
+                if (echouer(g, "je", M_DIVISION) < 0) {
+                    return -1;
+                }
+                fprintf(g->s, ".Ln%d:\n", suite);
+                chargerReel(g, &a, d);
+                emettre(g, "divsd %%xmm1, %s", d);
+            } else {
+                char tampon[32];
+                chargerReel(g, &a, d);
+                emettre(g, "divsd %s, %s", operandeReel(g, &b, tampon, "%xmm1"), d);
+            }
+            rangerReel(g, r, d);
+            return 0;
+        }
+        case N_IDIV:
+        case N_MOD:
+            if (!reel) {
+                return diviserEntier(g, op, &a, &b, r);
+            }
+            chargerReel(g, &a, "%xmm0");
+            chargerReel(g, &b, "%xmm1");
+            emettre(g, "movq $%d, %%rdi", op == N_MOD);
+            emettre(g, "movq $%d, %%rsi", g->qc);
+            appeler(g, "hs_float_divide");
+            rangerEntier(g, r, "%rax");
+            return 0;
+        case N_EQ: case N_NE: case N_LT: case N_LE: case N_GT: case N_GE:
+            return comparer(g, op, &a, &b, r);
+        case N_AND:
+        case N_OR:
+            // booleens : 0 ou 1
+            binaireEntier(g, op == N_AND ? "andq" : "orq", &a, &b, r);
+            return 0;
+        case N_NOT: {
+            const char *d = destination(g, r, NULL, "%rax");
+            chargerEntier(g, &a, d);
+            emettre(g, "xorq $1, %s", d);
+            rangerEntier(g, r, d);
+            return 0;
+        }
+        case N_NEG:
+            if (reel) {
+                emettre(g, "movsd .Lc%d(%%rip), %%xmm1", constanteReelle(g, -0.0));
+                chargerReel(g, &a, "%xmm0");
+                emettre(g, "xorpd %%xmm1, %%xmm0");
+                rangerReel(g, r, "%xmm0");
+            } else {
+                const char *d = destination(g, r, NULL, "%rax");
+                chargerEntier(g, &a, d);
+                emettre(g, "negq %s", d);
+                rangerEntier(g, r, d);
+            }
+            return 0;
+        case N_CONCAT:
+            chargerEntier(g, &a, "%rdi");
+            chargerEntier(g, &b, "%rsi");
+            emettre(g, "movq $%d, %%rdx", g->qc);
+            appeler(g, "hs_concat");
+            rangerEntier(g, r, "%rax");
+            return 0;
+        case N_HASH:
+            chargerEntier(g, &a, "%rdi");
+            chargerEntier(g, &b, "%rsi");
+            appeler(g, "hs_hash");
+            rangerEntier(g, r, "%rax");
+            return 0;
+        default:
+            return erreur(g, "unsupported operator", nomsOperateurs[op]);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Fonction hs_programme
+
+static const char *const sauves[NB_PRESERVES] = { "%rbx", "%r12", "%r13", "%r14", "%r15" };
+
+static int genererProgramme(Generateur *g) {
+    int cadre = (SAUVEGARDES + 8 * g->nbNoms + 15) & ~15;
+    fputs("\t.text\n\t.globl hs_programme\n\t.type hs_programme, @function\nhs_programme:\n", g->s);
+    emettre(g, "pushq %%rbp");
+    emettre(g, "movq %%rsp, %%rbp");
+    emettre(g, "subq $%d, %%rsp", cadre);
+    for (int k = 0; k < NB_PRESERVES; k++) {
+        emettre(g, "movq %s, %d(%%rbp)", sauves[k], -8 * (k + 1));
+    }
+
+    // valeurs initiales : 0, 0.0, false, "" ou tableau vide
+    char tampon[32];
+    for (int n = 0; n < g->nbNoms; n++) {
+        Nom *nom = &g->noms[n];
+        const char *p = place(g, n, tampon);
+        if (nom->type == TYPE_STRING || nom->type == TYPE_ARRAY) {
+            emettre(g, "leaq %s(%%rip), %%rax", nom->type == TYPE_STRING ? ".Lvide" : ".Ltableauvide");
+            emettre(g, "movq %%rax, %s", p);
+        } else if (nom->registre >= 0) {
+            emettre(g, nom->type == TYPE_FLOAT ? "xorpd %s, %s" : "xorq %s, %s", p, p);
+        } else {
+            emettre(g, "movq $0, %s", p);
+        }
+    }
+
+    for (int i = 0; i < g->t->taille; i++) {
+        g->qc = g->t->quads[i].qc;
+        fprintf(g->s, ".Lq%d:\n", i);
+        if (genererQuad(g, i) < 0) {
+            return -1;
+        }
+    }
+
+    fprintf(g->s, ".Lq%d:\n", g->t->taille);
+    for (int k = 0; k < NB_PRESERVES; k++) {
+        emettre(g, "movq %d(%%rbp), %s", -8 * (k + 1), sauves[k]);
+    }
+    emettre(g, "leave");
+    emettre(g, "ret");
+    for (int e = 0; e < g->nbEchecs; e++) {
+        fprintf(g->s, ".Le%d:\n", e);
+        emettre(g, "movq $%d, %%rdi", g->echecs[e].qc);
+        emettre(g, "leaq .Lm%d(%%rip), %%rsi", g->echecs[e].message);
+        emettre(g, "call hs_fail");
+    }
+    fputs("\t.size hs_programme, .-hs_programme\n\n\t.section .rodata\n\t.balign 8\n", g->s);
+    fputs(".Lvide:\n\t.quad 0, 0\n.Ltableauvide:\n\t.quad 0\n", g->s);
+    for (int m = 0; m < N_MESSAGES; m++) {
+        fprintf(g->s, ".Lm%d:\n\t.string \"%s\"\n", m, messages[m]);
+    }
+    fputs("\t.section .note.GNU-stack,\"\",@progbits\n", g->s);
+    return ferror(g->s) ? erreur(g, "cannot write the assembly file", NULL) : 0;
+}
+
+// ---------------------------------------------------------------------------
+
+static int assembler(const char *assembleur, const char *executable, FILE *err) {
+    if (strchr(assembleur, '\'') || strchr(executable, '\'')) {
+        fprintf(err, "Error: native code: unsupported file name '%s'\n", executable);
+        return -1;
+    }
+    size_t taille = strlen(assembleur) + strlen(executable) + strlen(NATIF_CC) + strlen(NATIF_RUNTIME) + 64;
+    char *commande = (char *)malloc(taille);
+    if (!commande) {
+        return -1;
+    }
+    snprintf(commande, taille, "%s -O2 -o '%s' '%s' '%s' -lm", NATIF_CC, executable, assembleur, NATIF_RUNTIME);
+    int status = system(commande);
+    if (status != 0) {
+        fprintf(err, "Error: native code: '%s' failed\n", commande);
+    }
+    free(commande);
+    return status == 0 ? 0 : -1;
+}
+
+int compilerNatif(tableQuads *t, SymbolTable *table, const char *executable, FILE *err) {
+    Generateur g;
+    memset(&g, 0, sizeof(g));
+    g.t = t;
+    g.table = table;
+    g.err = err;
+
+    // borne du nombre de noms : trois par quad plus les elements des tableaux
+    uint32_t noms = 16;
+    for (int i = 0; i < t->taille; i++) {
+        quad *q = &t->quads[i];
+        StringId operandes[3] = { q->operande1, q->operande2, q->resultat };
+        for (int k = 0; k < 3; k++) {
+            const char *texte = internedString(operandes[k]);
+            noms++;
+            if (texte[0] == '[') {
+                for (; *texte; texte++) {
+                    noms += *texte == ',' || *texte == '[';
+                }
+            }
+        }
+    }
+    size_t longueur = strlen(executable);
+    char *assembleur = (char *)malloc(longueur + 3);
+    int status = -1;
+    if (!assembleur || initIdMap(&g.indices, noms) < 0 || initIdMap(&g.etiquettes, (uint32_t)t->taille + 1) < 0 ||
+        !(g.operateurs = (int *)malloc((t->taille + 1) * sizeof(int)))) {
+        fprintf(err, "Error: Out of memory while generating native code\n");
+        goto fin;
+    }
+    memcpy(assembleur, executable, longueur);
+    memcpy(assembleur + longueur, ".s", 3);
+
+    if (recenser(&g) < 0 || typer(&g) < 0 || allouerRegistres(&g) < 0) {
+        goto fin;
+    }
+    if (!(g.s = fopen(assembleur, "w"))) {
+        fprintf(err, "Error: cannot write '%s'\n", assembleur);
+        goto fin;
+    }
+    status = genererProgramme(&g);
+    if (fclose(g.s) != 0) {
+        status = -1;
+    }
+    if (status == 0) {
+        status = assembler(assembleur, executable, err);
+    }
+
+fin:
+    freeIdMap(&g.indices);
+    freeIdMap(&g.etiquettes);
+    free(g.operateurs);
+    free(g.noms);
+    free(g.echecs);
+    free(assembleur);
+    return status;
+}
@@ -0,0 +1,38 @@
+#ifndef NATIF_H
+#define NATIF_H
+#include <stdio.h>
+#include "quadruplets.h"
+#include "tableSymboles.h"
+
+// Generation de code natif x86-64 (option --native, System V : Linux).
+//
+// Les quads (avec ou sans -O) deviennent une fonction assembleur
+// hs_programme, ecrite dans "<executable>.s" puis assemblee et liee par le
+// compilateur C (NATIF_CC) avec natif_runtime.c (NATIF_RUNTIME), qui
+// fournit main, l'affichage, INPUT, CONCAT, les tableaux et les erreurs
+// d'execution. Le programme produit a la meme sortie et les memes erreurs
+// (quad compris) que --run. Les operations element par element et les
+// reductions des tableaux, ainsi que les dictionnaires, restent a la
+// machine virtuelle : un programme qui en contient est refuse.
+//
+// Chaque nom doit avoir un type statique : celui de la table des symboles
+// pour une variable declaree, sinon le type commun de toutes ses
+// ecritures. Un programme que la machine virtuelle executerait avec des
+// cases dynamiques est refuse. Les noms les plus utilises (poids multiplie
+// par 8 a chaque niveau de boucle) restent dans des registres pendant tout
+// le programme : rbx, r12-r15, r8-r10 pour les entiers, booleens, chaines
+// et tableaux, xmm8-xmm15 pour les reels ; les autres vivent sur la pile.
+// La division entiere par une constante devient une multiplication, un
+// SWITCH un saut indirect par une table de deplacements en .rodata.
+
+#ifndef NATIF_CC
+#define NATIF_CC "cc"
+#endif
+#ifndef NATIF_RUNTIME
+#define NATIF_RUNTIME "natif_runtime.c"
+#endif
+
+// retourne 0 si l'executable a ete produit, -1 sinon (message sur err)
+int compilerNatif(tableQuads *t, SymbolTable *table, const char *executable, FILE *err);
+
+#endif
@@ -0,0 +1,285 @@
+// Support d'execution des programmes compiles en natif (option --native,
+// voir natif.h). Ce fichier n'est pas lie au compilateur : il est compile
+// avec l'assembleur genere pour produire l'executable.
+//
+// Les valeurs ont la meme representation que dans le code genere : entiers
+// et booleens sur 64 bits, reels en double, chaines et tableaux par
+// pointeur. Les affichages, lectures et messages d'erreur reproduisent
+// exactement ceux de la machine virtuelle (vm.c).
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include "dictionnaire.h"
+
+// memes codes que VmType (vm.h), pour les elements des tableaux
+enum { HS_INT = 1, HS_FLOAT, HS_BOOL, HS_STRING, HS_ARRAY };
+
+typedef struct HsString {
+    int64_t length;
+    char text[];
+} HsString;
+
+typedef struct HsValue {
+    int64_t type;
+    union {
+        int64_t i;
+        double f;
+        HsString *s;
+        struct HsArray *a;
+    } as;
+} HsValue;
+
+typedef struct HsArray {
+    int64_t length;
+    HsValue items[];
+} HsArray;
+
+// point d'entree genere
+void hs_programme(void);
+
+// ---------------------------------------------------------------------------
+// Tas : blocs jamais rendus, le programme se termine avec eux
+
+#define HS_CHUNK_SIZE 65536
+
+static char *tasCourant;
+static size_t tasReste;
+
+void hs_fail(int64_t qc, const char *message) __attribute__((noreturn));
+
+static void *allouer(size_t size) {
+    size = (size + 7) & ~(size_t)7;
+    if (size > tasReste) {
+        size_t bloc = size > HS_CHUNK_SIZE ? size : HS_CHUNK_SIZE;
+        tasCourant = (char *)malloc(bloc);
+        if (!tasCourant) {
+            return NULL;
+        }
+        tasReste = bloc;
+    }
+    void *p = tasCourant;
+    tasCourant += size;
+    tasReste -= size;
+    return p;
+}
+
+static HsString *nouvelleChaine(int64_t qc, const char *text, size_t length) {
+    HsString *s = (HsString *)allouer(sizeof(HsString) + length + 1);
+    if (!s) {
+        hs_fail(qc, "Out of memory");
+    }
+    s->length = (int64_t)length;
+    memcpy(s->text, text, length);
+    s->text[length] = '\0';
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+// Erreurs
+
+void hs_fail(int64_t qc, const char *message) {
+    fflush(stdout);
+    fprintf(stderr, "Runtime error (quad %d): %s\n", (int)qc, message);
+    exit(1);
+}
+
+// DIV et MOD dont un operande est reel : resultat entier (voir arithmetic
+// dans vm.c)
+int64_t hs_float_divide(double x, double y, int64_t modulo, int64_t qc) {
+    if (y == 0) {
+        hs_fail(qc, modulo ? "Modulo by zero" : "Division by zero");
+    }
+    double q = modulo ? fmod(x, y) : trunc(x / y);
+    if (!(q > -9.2e18 && q < 9.2e18)) {
+        hs_fail(qc, "Integer overflow");
+    }
+    return (int64_t)q;
+}
+
+// ---------------------------------------------------------------------------
+// Affichage : end vaut '\n' pour PRINT, 0 pour le message d'INPUT
+
+static void ecrireReel(double f) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.15g", f);
+    fputs(buffer, stdout);
+    if (!strpbrk(buffer, ".eEni")) {
+        fputs(".0", stdout);
+    }
+}
+
+static void ecrireValeur(const HsValue *v);
+
+static void ecrireTableau(const HsArray *a) {
+    putchar('[');
+    for (int64_t i = 0; i < a->length; i++) {
+        if (i > 0) {
+            putchar(',');
+        }
+        if (a->items[i].type == HS_STRING) {
+            putchar('"');
+            ecrireValeur(&a->items[i]);
+            putchar('"');
+        } else {
+            ecrireValeur(&a->items[i]);
+        }
+    }
+    putchar(']');
+}
+
+static void ecrireValeur(const HsValue *v) {
+    switch (v->type) {
+        case HS_INT:    printf("%lld", (long long)v->as.i); break;
+        case HS_FLOAT:  ecrireReel(v->as.f); break;
+        case HS_BOOL:   fputs(v->as.i ? "true" : "false", stdout); break;
+        case HS_STRING: fwrite(v->as.s->text, 1, (size_t)v->as.s->length, stdout); break;
+        case HS_ARRAY:  ecrireTableau(v->as.a); break;
+        default:        break;
+    }
+}
+
+static void terminer(int64_t end) {
+    if (end) {
+        putchar((int)end);
+    }
+}
+
+void hs_write_int(int64_t v, int64_t end) {
+    printf("%lld", (long long)v);
+    terminer(end);
+}
+
+void hs_write_float(double v, int64_t end) {
+    ecrireReel(v);
+    terminer(end);
+}
+
+void hs_write_bool(int64_t v, int64_t end) {
+    fputs(v ? "true" : "false", stdout);
+    terminer(end);
+}
+
+void hs_write_string(const HsString *s, int64_t end) {
+    fwrite(s->text, 1, (size_t)s->length, stdout);
+    terminer(end);
+}
+
+void hs_write_array(const HsArray *a, int64_t end) {
+    ecrireTableau(a);
+    terminer(end);
+}
+
+// ---------------------------------------------------------------------------
+// Lecture (INPUT) : une ligne sans \n ni \r, vide en fin de fichier ; le
+// message est affiche juste avant par le code genere
+
+static char *ligne;
+static size_t capaciteLigne;
+
+static const char *lireLigne(size_t *length) {
+    fflush(stdout);
+    ssize_t n = getline(&ligne, &capaciteLigne, stdin);
+    if (n < 0) {
+        n = 0;
+    }
+    while (n > 0 && (ligne[n - 1] == '\n' || ligne[n - 1] == '\r')) {
+        n--;
+    }
+    if (ligne) {
+        ligne[n] = '\0';
+    }
+    *length = (size_t)n;
+    return ligne ? ligne : "";
+}
+
+int64_t hs_read_int(int64_t qc) {
+    size_t length;
+    const char *text = lireLigne(&length);
+    char *end;
+    long long v = strtoll(text, &end, 10);
+    if (end == text || *end) {
+        hs_fail(qc, "Invalid integer input");
+    }
+    return v;
+}
+
+double hs_read_float(int64_t qc) {
+    size_t length;
+    const char *text = lireLigne(&length);
+    char *end;
+    double v = strtod(text, &end);
+    if (end == text || *end) {
+        hs_fail(qc, "Invalid float input");
+    }
+    return v;
+}
+
+int64_t hs_read_bool(int64_t qc) {
+    size_t length;
+    const char *text = lireLigne(&length);
+    if (strcmp(text, "true") != 0 && strcmp(text, "false") != 0) {
+        hs_fail(qc, "Invalid boolean input");
+    }
+    return text[0] == 't';
+}
+
+HsString *hs_read_string(int64_t qc) {
+    size_t length;
+    const char *text = lireLigne(&length);
+    return nouvelleChaine(qc, text, length);
+}
+
+// ---------------------------------------------------------------------------
+// Chaines et tableaux
+
+HsString *hs_concat(const HsString *a, const HsString *b, int64_t qc) {
+    HsString *s = (HsString *)allouer(sizeof(HsString) + a->length + b->length + 1);
+    if (!s) {
+        hs_fail(qc, "Out of memory");
+    }
+    s->length = a->length + b->length;
+    memcpy(s->text, a->text, (size_t)a->length);
+    memcpy(s->text + a->length, b->text, (size_t)b->length);
+    s->text[s->length] = '\0';
+    return s;
+}
+
+// -1, 0 ou 1 : octets, puis longueurs
+int64_t hs_compare_strings(const HsString *a, const HsString *b) {
+    size_t n = (size_t)(a->length < b->length ? a->length : b->length);
+    int c = memcmp(a->text, b->text, n);
+    if (c == 0) {
+        return (a->length > b->length) - (a->length < b->length);
+    }
+    return c > 0 ? 1 : -1;
+}
+
+// case d'une chaine dans une table de m cases (HASH, Switch sur chaines)
+int64_t hs_hash(const HsString *s, int64_t cases) {
+    return dictBucket(dictHash(s->text, (size_t)s->length), (uint32_t)cases);
+}
+
+// copie les count elements construits sur la pile par le code genere
+HsArray *hs_array_new(int64_t count, const HsValue *items, int64_t qc) {
+    HsArray *a = (HsArray *)allouer(sizeof(HsArray) + (size_t)count * sizeof(HsValue));
+    if (!a) {
+        hs_fail(qc, "Out of memory");
+    }
+    a->length = count;
+    if (count > 0) {
+        memcpy(a->items, items, (size_t)count * sizeof(HsValue));
+    }
+    return a;
+}
+
+int main(void) {
+    hs_programme();
+    fflush(stdout);
+    free(ligne);
+    return 0;
+}
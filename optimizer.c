@@ -0,0 +1,2510 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include "optimizer.h"
+#include "cfg.h"
+#include "ssa.h"
+#include "semantic.h"
+
+#define OPT_MAX_ROUNDS 16
+
+static const char *const passNames[OPT_PASS_COUNT] = {
+    "sccp", "inaccessible", "cse locale", "cse globale", "copies", "code mort"
+};
+
+typedef struct Optimiseur {
+    tableQuads *t;
+    Cfg cfg;
+    FILE *out;
+    OptimizerReport *report;
+    StringId copy;          // ":="
+} Optimiseur;
+
+// ---------------------------------------------------------------------------
+// Rapport
+
+static void decrireQuad(FILE *out, const quad *q) {
+    fprintf(out, "[ %s , %s , %s , %s ]", internedString(q->operateur), internedString(q->operande1),
+            internedString(q->operande2), internedString(q->resultat));
+}
+
+static void supprimer(Optimiseur *o, OptimizerPass pass, int i) {
+    o->cfg.kinds[i] = QUAD_REMOVED;
+    o->report->removed[pass]++;
+    if (o->out) {
+        quad *q = &o->t->quads[i];
+        fprintf(o->out, "\t %-13s Quad[%d]=", passNames[pass], q->qc);
+        decrireQuad(o->out, q);
+        fprintf(o->out, " supprime\n");
+    }
+}
+
+static void signalerReecriture(Optimiseur *o, OptimizerPass pass, int i, const quad *avant) {
+    o->report->rewritten[pass]++;
+    if (o->out) {
+        fprintf(o->out, "\t %-13s Quad[%d]=", passNames[pass], avant->qc);
+        decrireQuad(o->out, avant);
+        fprintf(o->out, " -> ");
+        decrireQuad(o->out, &o->t->quads[i]);
+        fputc('\n', o->out);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Table de n-uplets de StringId -> entier (elements des analyses)
+
+typedef struct TableTuples {
+    uint32_t *keys;         // 4 cles par case ; keys[0] == UINT32_MAX : case libre
+    int32_t *values;
+    uint32_t mask;
+} TableTuples;
+
+#define TUPLE_FREE UINT32_MAX
+#define TUPLE_CLASS (UINT32_MAX - 1)    // 4e cle des classes (op, a, b)
+
+static int initTuples(TableTuples *table, uint32_t expected) {
+    uint32_t capacity = 16;
+    while (capacity < 2 * expected) {
+        capacity *= 2;
+    }
+    table->keys = (uint32_t *)malloc(4 * (size_t)capacity * sizeof(uint32_t));
+    table->values = (int32_t *)malloc(capacity * sizeof(int32_t));
+    table->mask = capacity - 1;
+    if (!table->keys || !table->values) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < capacity; i++) {
+        table->keys[4 * i] = TUPLE_FREE;
+    }
+    return 0;
+}
+
+static void freeTuples(TableTuples *table) {
+    free(table->keys);
+    free(table->values);
+}
+
+// valeur associee au n-uplet ; absent, il recoit *next (puis *next + 1)
+static int32_t tupleId(TableTuples *table, uint32_t a, uint32_t b, uint32_t c, uint32_t d, int32_t *next) {
+    uint32_t h = a * 2654435761u ^ (b + 0x9e3779b9u) * 2246822519u ^ (c + 7) * 3266489917u ^ d * 668265263u;
+    uint32_t i = (h ^ h >> 15) & table->mask;
+    for (;;) {
+        uint32_t *k = &table->keys[4 * i];
+        if (k[0] == TUPLE_FREE) {
+            k[0] = a; k[1] = b; k[2] = c; k[3] = d;
+            table->values[i] = (*next)++;
+            return table->values[i];
+        }
+        if (k[0] == a && k[1] == b && k[2] == c && k[3] == d) {
+            return table->values[i];
+        }
+        i = (i + 1) & table->mask;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Ensembles des analyses entre blocs
+//
+// Un nom lu dans un bloc avant d'y etre ecrit peut passer d'un bloc a
+// l'autre. Les autres (presque tous les temporaires) ne sont vivants a
+// l'entree d'aucun bloc, et ce qui passe d'un bloc a l'autre reste peu de
+// chose meme quand le programme grandit : les ensembles a l'entree des
+// blocs sont des listes triees, rangees a la suite dans un meme tableau.
+
+typedef struct Ensembles {
+    int *elements;
+    size_t taille;
+    size_t capacite;
+} Ensembles;
+
+static int compareEntiers(const void *a, const void *b) {
+    return *(const int *)a - *(const int *)b;
+}
+
+static int dansListe(const int *liste, int taille, int x) {
+    return taille > 0 && bsearch(&x, liste, taille, sizeof(int), compareEntiers) != NULL;
+}
+
+// copie la liste x (taille n) a la suite de e ; -1 si la memoire manque
+static int rangerEnsemble(Ensembles *e, const int *x, int n, size_t *debut) {
+    if (e->capacite - e->taille < (size_t)n) {
+        size_t capacite = 2 * e->capacite + n;
+        int *elements = (int *)realloc(e->elements, capacite * sizeof(int));
+        if (!elements) {
+            return -1;
+        }
+        e->elements = elements;
+        e->capacite = capacite;
+    }
+    *debut = e->taille;
+    if (n > 0) {
+        memcpy(e->elements + e->taille, x, n * sizeof(int));
+        e->taille += n;
+    }
+    return 0;
+}
+
+// trie x (taille n) et retire les doublons ; retourne la nouvelle taille
+static int trierListe(int *x, int n) {
+    qsort(x, n, sizeof(int), compareEntiers);
+    int k = 0;
+    for (int i = 0; i < n; i++) {
+        if (k == 0 || x[k - 1] != x[i]) x[k++] = x[i];
+    }
+    return k;
+}
+
+// noms lus dans un bloc avant d'y etre ecrits ; NULL si la memoire manque
+static char *nomsGlobaux(const Cfg *cfg) {
+    char *global = (char *)calloc(cfg->nameCount + 1, 1);
+    int *ecritDans = (int *)malloc((cfg->nameCount + 1) * sizeof(int));
+    if (!global || !ecritDans) {
+        free(global);
+        free(ecritDans);
+        return NULL;
+    }
+    for (int n = 0; n < cfg->nameCount; n++) {
+        ecritDans[n] = -1;
+    }
+    for (int b = 0; b < cfg->blockCount; b++) {
+        for (int i = cfg->blocks[b].first; i < cfg->blocks[b].last; i++) {
+            if (cfg->kinds[i] == QUAD_REMOVED) {
+                continue;
+            }
+            StringId *fields[CFG_MAX_USES];
+            int uses = cfgUseFields(cfg, i, fields);
+            for (int k = 0; k < uses; k++) {
+                int n = cfgName(cfg, *fields[k]);
+                if (n >= 0 && ecritDans[n] != b) global[n] = 1;
+            }
+            if (cfg->kinds[i] == QUAD_ARRAY) {
+                for (int k = cfg->arrayUseStart[i]; k < cfg->arrayUseStart[i + 1]; k++) {
+                    if (ecritDans[cfg->arrayUses[k]] != b) global[cfg->arrayUses[k]] = 1;
+                }
+            }
+            int n = cfgName(cfg, cfgDef(cfg, i));
+            if (n >= 0) {
+                ecritDans[n] = b;
+            }
+        }
+    }
+    free(ecritDans);
+    return global;
+}
+
+// ---------------------------------------------------------------------------
+// Domaine d'une analyse vers l'avant : chaque quad produit au plus un
+// element ; l'ecriture d'un nom invalide les elements qui le mentionnent.
+//
+// Un parcours en avant note le dernier quad qui ecrit chaque nom et celui
+// qui produit chaque element : un element n'est valide que si aucun de ses
+// noms n'a ete ecrit depuis (voir disponible), et chaque quad coute O(1).
+// Seuls les elements qui peuvent etre lus dans un autre bloc que celui qui
+// les produit (globaux) entrent dans l'analyse entre blocs.
+
+typedef struct Domaine {
+    int count;
+    int globals;
+    int names;
+    int groups;
+    int *ofQuad;        // element produit par chaque quad, -1 : aucun
+    int *global;        // par element : indice global, -1 : local
+    int *element;       // par indice global : element
+    int *group;         // par element : groupe (classe, destination)
+    int *mention;       // 3 noms (ou -1) par element
+    int *ecrit;         // par nom : dernier quad du parcours qui l'ecrit
+    int *produit;       // par element : dernier quad du parcours qui le produit
+    // par bloc : indices globaux disponibles a son entree,
+    // ensembles.elements[entreeDebut[b]] .., entreeTaille[b] -1 : tous
+    // (bloc inaccessible)
+    Ensembles ensembles;
+    size_t *entreeDebut;
+    int *entreeTaille;
+    // entree du bloc ouvert (voir ouvrirBloc)
+    int *dansEntree;    // par indice global : bloc ouvert qui l'a a son entree
+    int *groupeBloc;    // par groupe : bloc de groupeTete
+    int *groupeTete;    // par groupe : premier indice global de l'entree, -1 : aucun
+    int *suivant;       // par indice global : suivant du meme groupe
+} Domaine;
+
+static void freeDomaine(Domaine *d) {
+    free(d->ofQuad);
+    free(d->global);
+    free(d->element);
+    free(d->group);
+    free(d->mention);
+    free(d->ecrit);
+    free(d->produit);
+    free(d->ensembles.elements);
+    free(d->entreeDebut);
+    free(d->entreeTaille);
+    free(d->dansEntree);
+    free(d->groupeBloc);
+    free(d->groupeTete);
+    free(d->suivant);
+}
+
+static int allouerDomaine(Domaine *d, int quads) {
+    memset(d, 0, sizeof(*d));
+    d->ofQuad = (int *)malloc((quads + 1) * sizeof(int));
+    d->global = (int *)malloc((quads + 1) * sizeof(int));
+    d->group = (int *)malloc((quads + 1) * sizeof(int));
+    d->mention = (int *)malloc(3 * (size_t)(quads + 1) * sizeof(int));
+    return d->ofQuad && d->global && d->group && d->mention ? 0 : -1;
+}
+
+// nouveau parcours : aucun nom ecrit, aucun element produit
+static void effacerParcours(Domaine *d) {
+    for (int n = 0; n < d->names; n++) d->ecrit[n] = -1;
+    for (int e = 0; e < d->count; e++) d->produit[e] = -1;
+}
+
+// d->global, d->group et d->groups remplis
+static int preparerDomaine(Domaine *d, int names) {
+    d->names = names;
+    d->element = (int *)malloc((d->globals + 1) * sizeof(int));
+    d->ecrit = (int *)malloc((names + 1) * sizeof(int));
+    d->produit = (int *)malloc((d->count + 1) * sizeof(int));
+    d->dansEntree = (int *)malloc((d->globals + 1) * sizeof(int));
+    d->groupeBloc = (int *)malloc((d->groups + 1) * sizeof(int));
+    d->groupeTete = (int *)malloc((d->groups + 1) * sizeof(int));
+    d->suivant = (int *)malloc((d->globals + 1) * sizeof(int));
+    if (!d->element || !d->ecrit || !d->produit || !d->dansEntree || !d->groupeBloc || !d->groupeTete ||
+        !d->suivant) {
+        return -1;
+    }
+    for (int e = 0; e < d->count; e++) {
+        if (d->global[e] >= 0) {
+            d->element[d->global[e]] = e;
+            d->dansEntree[d->global[e]] = -1;
+        }
+    }
+    for (int g = 0; g < d->groups; g++) {
+        d->groupeBloc[g] = -1;
+    }
+    effacerParcours(d);
+    return 0;
+}
+
+// le quad i dans le parcours : son ecriture, puis son element
+static void transfert(Optimiseur *o, Domaine *d, int i) {
+    int n = cfgName(&o->cfg, cfgDef(&o->cfg, i));
+    if (n >= 0) {
+        d->ecrit[n] = i;
+    }
+    if (d->ofQuad[i] >= 0) {
+        d->produit[d->ofQuad[i]] = i;
+    }
+}
+
+// le parcours entre dans le bloc b : son entree devient consultable
+// (dansEntree, groupeTete). Les quads d'un bloc inaccessible sont deja
+// supprimes : il n'a rien a consulter
+static void ouvrirBloc(Domaine *d, int b) {
+    if (!d->entreeTaille || d->entreeTaille[b] < 0) {
+        return;
+    }
+    const int *entree = d->ensembles.elements + d->entreeDebut[b];
+    for (int k = 0; k < d->entreeTaille[b]; k++) {
+        int x = entree[k], g = d->group[d->element[x]];
+        if (d->groupeBloc[g] != b) {
+            d->groupeBloc[g] = b;
+            d->groupeTete[g] = -1;
+        }
+        d->dansEntree[x] = b;
+        d->suivant[x] = d->groupeTete[g];
+        d->groupeTete[g] = x;
+    }
+}
+
+// premier indice global du groupe g a l'entree du bloc ouvert b (les
+// suivants par d->suivant), -1 : aucun
+static int entreeDuGroupe(const Domaine *d, int g, int b) {
+    return d->groupeBloc[g] == b ? d->groupeTete[g] : -1;
+}
+
+// e est-il valide dans le bloc ouvert b, qui commence au quad debut ?
+static int disponible(const Domaine *d, int e, int b, int debut) {
+    int depuis = d->produit[e];
+    if (depuis < debut) {
+        if (d->global[e] < 0 || d->dansEntree[d->global[e]] != b) {
+            return 0;
+        }
+        depuis = debut - 1;
+    }
+    for (int k = 0; k < 3; k++) {
+        int n = d->mention[3 * e + k];
+        if (n >= 0 && d->ecrit[n] > depuis) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// resume de chaque bloc b : gen[genDebut[b]] .., les elements globaux
+// produits et encore valides a la sortie (tries), et ecrits[ecritsDebut[b]] ..,
+// les noms ecrits
+static void resumerBlocs(Optimiseur *o, Domaine *d, int *genDebut, int *gen, int *ecritsDebut, int *ecrits) {
+    Cfg *cfg = &o->cfg;
+    effacerParcours(d);
+    genDebut[0] = ecritsDebut[0] = 0;
+    for (int b = 0; b < cfg->blockCount; b++) {
+        BasicBlock *bloc = &cfg->blocks[b];
+        int ng = genDebut[b], ne = ecritsDebut[b];
+        for (int i = bloc->first; i < bloc->last; i++) {
+            int n = cfgName(cfg, cfgDef(cfg, i));
+            if (n >= 0 && d->ecrit[n] < bloc->first) {
+                ecrits[ne++] = n;
+            }
+            transfert(o, d, i);
+        }
+        for (int i = bloc->first; i < bloc->last; i++) {
+            int e = d->ofQuad[i];
+            if (e >= 0 && d->global[e] >= 0 && d->produit[e] == i && disponible(d, e, b, bloc->first)) {
+                gen[ng++] = d->global[e];
+            }
+        }
+        qsort(gen + genDebut[b], ng - genDebut[b], sizeof(int), compareEntiers);
+        genDebut[b + 1] = ng;
+        ecritsDebut[b + 1] = ne;
+    }
+    effacerParcours(d);
+}
+
+// elements globaux disponibles a l'entree de chaque bloc (d->entreeDebut,
+// d->entreeTaille) : intersection sur les predecesseurs, aucun a l'entree
+// du programme. Les sorties partent de tous les elements ; chaque tour ne
+// reprend que les blocs dont un predecesseur a change. Un bloc dont toute
+// l'entree est encore a tous garde une sortie a tous : c'est exact pour un
+// bloc inaccessible, qui n'a plus de quads, et provisoire pour les autres
+static int disponibles(Optimiseur *o, Domaine *d) {
+    Cfg *cfg = &o->cfg;
+    int blocs = cfg->blockCount, quads = o->t->taille;
+    int *genDebut = (int *)malloc((blocs + 1) * sizeof(int));
+    int *gen = (int *)malloc((quads + 1) * sizeof(int));
+    int *ecritsDebut = (int *)malloc((blocs + 1) * sizeof(int));
+    int *ecrits = (int *)malloc((quads + 1) * sizeof(int));
+    size_t *sortieDebut = (size_t *)malloc((blocs + 1) * sizeof(size_t));
+    int *sortieTaille = (int *)malloc((blocs + 1) * sizeof(int));
+    int *ecritDans = (int *)malloc((d->names + 1) * sizeof(int));
+    int *entree = (int *)malloc((d->globals + 1) * sizeof(int));
+    int *sortie = (int *)malloc((d->globals + 1) * sizeof(int));
+    char *aRevoir = (char *)malloc(blocs + 1);
+    d->entreeDebut = (size_t *)malloc((blocs + 1) * sizeof(size_t));
+    d->entreeTaille = (int *)malloc((blocs + 1) * sizeof(int));
+    int status = -1;
+    if (!genDebut || !gen || !ecritsDebut || !ecrits || !sortieDebut || !sortieTaille || !ecritDans ||
+        !entree || !sortie || !aRevoir || !d->entreeDebut || !d->entreeTaille) {
+        goto fin;
+    }
+    resumerBlocs(o, d, genDebut, gen, ecritsDebut, ecrits);
+    for (int n = 0; n < d->names; n++) {
+        ecritDans[n] = -1;
+    }
+    for (int b = 0; b < blocs; b++) {
+        sortieTaille[b] = -1;
+        d->entreeTaille[b] = -1;
+        aRevoir[b] = 1;
+    }
+    int change = 1;
+    while (change) {
+        change = 0;
+        for (int b = 0; b < blocs; b++) {
+            if (!aRevoir[b]) {
+                continue;
+            }
+            aRevoir[b] = 0;
+            BasicBlock *bloc = &cfg->blocks[b];
+            int ni = b == 0 ? 0 : -1;
+            for (int p = 0; p < bloc->predCount && b != 0; p++) {
+                int pred = cfg->preds[bloc->predStart + p];
+                if (sortieTaille[pred] < 0) {
+                    continue;
+                }
+                const int *s = d->ensembles.elements + sortieDebut[pred];
+                if (ni < 0) {
+                    ni = sortieTaille[pred];
+                    if (ni > 0) memcpy(entree, s, ni * sizeof(int));
+                    continue;
+                }
+                int k = 0;
+                for (int x = 0, y = 0; x < ni && y < sortieTaille[pred];) {
+                    if (entree[x] < s[y]) {
+                        x++;
+                    } else if (entree[x] > s[y]) {
+                        y++;
+                    } else {
+                        entree[k++] = entree[x++];
+                        y++;
+                    }
+                }
+                ni = k;
+            }
+            if (ni < 0) {
+                continue;
+            }
+            if (rangerEnsemble(&d->ensembles, entree, ni, &d->entreeDebut[b]) < 0) {
+                goto fin;
+            }
+            d->entreeTaille[b] = ni;
+            // sortie : entree sans les elements dont un nom est ecrit, plus gen
+            for (int k = ecritsDebut[b]; k < ecritsDebut[b + 1]; k++) {
+                ecritDans[ecrits[k]] = b;
+            }
+            int ns = 0, y = genDebut[b];
+            for (int x = 0; x < ni; x++) {
+                int e = d->element[entree[x]], tue = 0;
+                for (int k = 0; k < 3; k++) {
+                    int n = d->mention[3 * e + k];
+                    tue |= n >= 0 && ecritDans[n] == b;
+                }
+                if (tue) {
+                    continue;
+                }
+                while (y < genDebut[b + 1] && gen[y] < entree[x]) {
+                    sortie[ns++] = gen[y++];
+                }
+                if (y < genDebut[b + 1] && gen[y] == entree[x]) {
+                    y++;
+                }
+                sortie[ns++] = entree[x];
+            }
+            while (y < genDebut[b + 1]) {
+                sortie[ns++] = gen[y++];
+            }
+            if (ns == sortieTaille[b] && (ns == 0 || memcmp(sortie, d->ensembles.elements + sortieDebut[b],
+                                                            ns * sizeof(int)) == 0)) {
+                continue;
+            }
+            if (rangerEnsemble(&d->ensembles, sortie, ns, &sortieDebut[b]) < 0) {
+                goto fin;
+            }
+            sortieTaille[b] = ns;
+            for (int k = 0; k < 2; k++) {
+                if (bloc->succ[k] >= 0) aRevoir[bloc->succ[k]] = 1;
+            }
+            change = 1;
+        }
+    }
+    status = 0;
+
+fin:
+    free(genDebut);
+    free(gen);
+    free(ecritsDebut);
+    free(ecrits);
+    free(sortieDebut);
+    free(sortieTaille);
+    free(ecritDans);
+    free(entree);
+    free(sortie);
+    free(aRevoir);
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Code inaccessible
+
+static int passeInaccessible(Optimiseur *o) {
+    Cfg *cfg = &o->cfg;
+    if (cfg->blockCount == 0) {
+        return 0;
+    }
+    char *atteint = (char *)calloc(cfg->blockCount, 1);
+    int *file = (int *)malloc(cfg->blockCount * sizeof(int));
+    if (!atteint || !file) {
+        free(atteint);
+        free(file);
+        return -1;
+    }
+    int tete = 0, queue = 0;
+    file[queue++] = 0;
+    atteint[0] = 1;
+    while (tete < queue) {
+        BasicBlock *b = &cfg->blocks[file[tete++]];
+        for (int s = 0; s < 2; s++) {
+            if (b->succ[s] >= 0 && !atteint[b->succ[s]]) {
+                atteint[b->succ[s]] = 1;
+                file[queue++] = b->succ[s];
+            }
+        }
+    }
+    int supprimes = 0;
+    for (int b = 0; b < cfg->blockCount; b++) {
+        for (int i = cfg->blocks[b].first; i < cfg->blocks[b].last && !atteint[b]; i++) {
+            if (cfg->kinds[i] != QUAD_REMOVED) {
+                supprimer(o, OPT_UNREACHABLE, i);
+                supprimes++;
+            }
+        }
+    }
+    free(atteint);
+    free(file);
+    return supprimes;
+}
+
+// ---------------------------------------------------------------------------
+// Sous-expressions communes
+//
+// Un element est un calcul (op, a, b, r) : r contient a op b tant qu'aucun
+// des trois noms n'est reecrit. Les calculs de meme (op, a, b) forment une
+// classe ; un quad dont la classe a un element disponible est redondant.
+// Une classe calculee dans un seul bloc n'a aucun element disponible a son
+// entree (le premier passage n'en a pas encore produit) : ses elements
+// restent locaux.
+
+static int commutatif(const char *op) {
+    return strcmp(op, "+") == 0 || strcmp(op, "*") == 0 || strcmp(op, "==") == 0 ||
+           strcmp(op, "!=") == 0 || strcmp(op, "AND") == 0 || strcmp(op, "OR") == 0;
+}
+
+// element disponible de plus grand indice parmi les candidats de la
+// classe c : ceux produits plus tot dans le bloc b, puis ceux de l'entree
+typedef struct Candidats {
+    int *producedHead;      // par classe : dernier element produit dans producedBlock
+    int *producedBlock;
+    int *previousProduced;  // par element : produit avant lui dans le bloc
+} Candidats;
+
+static int meilleurCandidat(const Candidats *k, const Domaine *d, int c, int b, int debut) {
+    int best = -1;
+    for (int e = k->producedBlock[c] == b ? k->producedHead[c] : -1; e >= 0; e = k->previousProduced[e]) {
+        if (e > best && disponible(d, e, b, debut)) best = e;
+    }
+    for (int x = entreeDuGroupe(d, c, b); x >= 0; x = d->suivant[x]) {
+        int e = d->element[x];
+        if (e > best && disponible(d, e, b, debut)) best = e;
+    }
+    return best;
+}
+
+static int passeSousExpressions(Optimiseur *o, int global) {
+    Cfg *cfg = &o->cfg;
+    tableQuads *t = o->t;
+    int n = t->taille;
+    OptimizerPass pass = global ? OPT_GLOBAL_CSE : OPT_LOCAL_CSE;
+
+    Domaine d;
+    TableTuples tuples;
+    Candidats k;
+    int classes = 0;
+    int *classOf = (int *)malloc((n + 1) * sizeof(int));
+    int *classBlock = (int *)malloc((n + 1) * sizeof(int));        // -1 : plusieurs blocs
+    StringId *holder = (StringId *)malloc((n + 1) * sizeof(StringId));
+    k.producedHead = (int *)malloc((n + 1) * sizeof(int));
+    k.producedBlock = (int *)malloc((n + 1) * sizeof(int));
+    k.previousProduced = (int *)malloc((n + 1) * sizeof(int));
+    int status = -1;
+    int tuplesOk = initTuples(&tuples, 2 * (uint32_t)n) == 0;
+    if (allouerDomaine(&d, n) < 0 || !tuplesOk || !classOf || !classBlock || !holder ||
+        !k.producedHead || !k.producedBlock || !k.previousProduced) {
+        goto fin;
+    }
+
+    for (int i = 0; i < n; i++) {
+        d.ofQuad[i] = -1;
+        classOf[i] = -1;
+        if (cfg->kinds[i] != QUAD_PURE && cfg->kinds[i] != QUAD_TRAP) {
+            continue;
+        }
+        quad *q = &t->quads[i];
+        StringId a = q->operande1, b = q->operande2;
+        if (a > b && commutatif(internedString(q->operateur))) {
+            StringId x = a; a = b; b = x;
+        }
+        int32_t avant = classes;
+        int c = tupleId(&tuples, q->operateur, a, b, TUPLE_CLASS, &classes);
+        if (c == avant) {
+            classBlock[c] = cfg->blockOf[i];
+            k.producedBlock[c] = -1;
+        } else if (classBlock[c] != cfg->blockOf[i]) {
+            classBlock[c] = -1;
+        }
+        classOf[i] = c;
+        avant = d.count;
+        int e = tupleId(&tuples, q->operateur, a, b, q->resultat, &d.count);
+        if (e == avant) {
+            d.group[e] = c;
+            holder[e] = q->resultat;
+            d.mention[3 * e] = cfgName(cfg, a);
+            d.mention[3 * e + 1] = cfgName(cfg, b);
+            d.mention[3 * e + 2] = cfgName(cfg, q->resultat);
+        }
+        // x := x + 1 : la valeur calculee n'est plus dans x
+        if (q->resultat != q->operande1 && q->resultat != q->operande2) {
+            d.ofQuad[i] = e;
+        }
+    }
+    d.groups = classes;
+    for (int e = 0; e < d.count; e++) {
+        d.global[e] = global && classBlock[d.group[e]] < 0 ? d.globals++ : -1;
+    }
+    if (preparerDomaine(&d, cfg->nameCount) < 0 || (global && disponibles(o, &d) < 0)) {
+        goto fin;
+    }
+
+    status = 0;
+    for (int b = 0; b < cfg->blockCount; b++) {
+        BasicBlock *bloc = &cfg->blocks[b];
+        ouvrirBloc(&d, b);
+        for (int i = bloc->first; i < bloc->last; i++) {
+            if (classOf[i] >= 0 && cfg->kinds[i] != QUAD_REMOVED) {
+                int e = meilleurCandidat(&k, &d, classOf[i], b, bloc->first);
+                if (e >= 0) {
+                    quad *q = &t->quads[i];
+                    if (holder[e] == q->resultat) {
+                        supprimer(o, pass, i);
+                    } else {
+                        quad avant = *q;
+                        q->operateur = o->copy;
+                        q->operande1 = holder[e];
+                        q->operande2 = STRING_ID_NONE;
+                        cfg->kinds[i] = QUAD_COPY;
+                        signalerReecriture(o, pass, i, &avant);
+                    }
+                    status++;
+                }
+            }
+            // le quad reecrit laisse toujours a op b dans r
+            int e = d.ofQuad[i];
+            if (e >= 0 && d.produit[e] < bloc->first) {
+                int c = d.group[e];
+                if (k.producedBlock[c] != b) {
+                    k.producedBlock[c] = b;
+                    k.producedHead[c] = -1;
+                }
+                k.previousProduced[e] = k.producedHead[c];
+                k.producedHead[c] = e;
+            }
+            transfert(o, &d, i);
+        }
+    }
+
+fin:
+    if (tuplesOk) {
+        freeTuples(&tuples);
+    }
+    freeDomaine(&d);
+    free(classOf);
+    free(classBlock);
+    free(holder);
+    free(k.producedHead);
+    free(k.producedBlock);
+    free(k.previousProduced);
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Propagation des copies
+//
+// Un element est une copie (source, destination) : destination vaut source
+// tant qu'aucun des deux n'est reecrit. Seules les copies vers un nom global
+// peuvent servir dans un autre bloc, groupees par destination. A l'entree d'un bloc accessible, une destination a au plus
+// une copie disponible (celle de sa derniere ecriture sur chaque chemin) :
+// chaque lecture n'en examine qu'une.
+
+// enfants de chaque bloc dans l'arbre des dominateurs :
+// enfants[debut[b] .. debut[b + 1][ ; NULL si la memoire manque
+static int *enfantsDominateurs(const Cfg *cfg, int **debut) {
+    int blocs = cfg->blockCount;
+    *debut = (int *)calloc(blocs + 2, sizeof(int));
+    int *enfants = (int *)malloc((blocs + 1) * sizeof(int));
+    if (!*debut || !enfants) {
+        free(*debut);
+        free(enfants);
+        return NULL;
+    }
+    for (int b = 0; b < blocs; b++) {
+        if (cfg->idom[b] >= 0) (*debut)[cfg->idom[b] + 2]++;
+    }
+    for (int b = 0; b < blocs; b++) {
+        (*debut)[b + 2] += (*debut)[b + 1];
+    }
+    // debut[b + 1] sert de curseur, puis vaut la fin des enfants de b
+    for (int b = 0; b < blocs; b++) {
+        if (cfg->idom[b] >= 0) enfants[(*debut)[cfg->idom[b] + 1]++] = b;
+    }
+    return enfants;
+}
+
+// Copies disponibles a l'entree des blocs, analyse creuse. La copie
+// disponible vers une destination x (au plus une) ne change que dans les
+// blocs qui ecrivent x ou la source d'une copie vers x : chacun recoit un
+// noeud, et chaque jonction de leur frontiere de dominance iteree un phi.
+// Un parcours de l'arbre des dominateurs relie chaque noeud a celui qui le
+// precede, comme le renommage de ssa.c ; les valeurs descendent ensuite
+// d'inconnue a une copie puis a aucune, chaque noeud au plus deux fois.
+// Le cout suit le nombre de noeuds, pas blocs * destinations.
+
+enum { NOEUD_ECRIT, NOEUD_FILTRE, NOEUD_PHI };
+
+#define NOEUD_ENTREE -1     // aucun noeud avant : entree du programme
+#define NOEUD_ABSENT -2     // argument d'un predecesseur inaccessible
+#define COPIE_AUCUNE -1
+#define COPIE_INCONNUE -2
+
+typedef struct NoeudCopie {
+    int genre;
+    int nom;        // destination
+    int bloc;
+    int lien;       // FILTRE : noeud precedent ; PHI : arguments liens[lien ..]
+    int valeur;     // element, COPIE_AUCUNE ou COPIE_INCONNUE
+} NoeudCopie;
+
+typedef struct AnalyseCopies {
+    NoeudCopie *noeuds;
+    int count;
+    int capacite;
+    int *liens;
+    int *ecritsDebut;       // par bloc : noms ecrits, tries
+    int *ecrits;
+    int *requetesDebut;     // par bloc : destinations lues avant d'y etre ecrites
+    int *requetes;
+    int *requeteNoeud;      // noeud qui precede chaque requete
+    int *noeudsDebut;       // par bloc : ses noeuds ECRIT et FILTRE
+    int *phisDebut;         // par bloc : ses phis
+    int *phis;
+} AnalyseCopies;
+
+static int ajouterNoeud(AnalyseCopies *a, int genre, int nom, int bloc, int valeur) {
+    if (a->count == a->capacite) {
+        int capacite = a->capacite ? 2 * a->capacite : 64;
+        NoeudCopie *noeuds = (NoeudCopie *)realloc(a->noeuds, capacite * sizeof(NoeudCopie));
+        if (!noeuds) {
+            return -1;
+        }
+        a->noeuds = noeuds;
+        a->capacite = capacite;
+    }
+    NoeudCopie *n = &a->noeuds[a->count];
+    n->genre = genre;
+    n->nom = nom;
+    n->bloc = bloc;
+    n->lien = NOEUD_ENTREE;
+    n->valeur = valeur;
+    return a->count++;
+}
+
+static int valeurNoeud(const AnalyseCopies *a, int k) {
+    return k == NOEUD_ENTREE ? COPIE_AUCUNE : k == NOEUD_ABSENT ? COPIE_INCONNUE : a->noeuds[k].valeur;
+}
+
+static int evaluerNoeud(const AnalyseCopies *a, const Domaine *d, const Cfg *cfg, int k) {
+    const NoeudCopie *n = &a->noeuds[k];
+    if (n->genre == NOEUD_FILTRE) {
+        int v = valeurNoeud(a, n->lien);
+        int source = v >= 0 ? d->mention[3 * v + 2] : -1;
+        const int *ecrits = a->ecrits + a->ecritsDebut[n->bloc];
+        int taille = a->ecritsDebut[n->bloc + 1] - a->ecritsDebut[n->bloc];
+        return source >= 0 && dansListe(ecrits, taille, source) ? COPIE_AUCUNE : v;
+    }
+    if (n->genre == NOEUD_PHI) {
+        int r = COPIE_INCONNUE;
+        for (int p = 0; p < cfg->blocks[n->bloc].predCount; p++) {
+            int v = valeurNoeud(a, a->liens[n->lien + p]);
+            if (v != COPIE_INCONNUE) {
+                r = r == COPIE_INCONNUE || r == v ? v : COPIE_AUCUNE;
+            }
+        }
+        return r;
+    }
+    return n->valeur;
+}
+
+// noeuds ECRIT et FILTRE de chaque bloc, destinations lues a son entree ;
+// d->global, d->group (la destination) remplis
+static int noeudsDesBlocs(Optimiseur *o, Domaine *d, AnalyseCopies *a) {
+    Cfg *cfg = &o->cfg;
+    int names = cfg->nameCount;
+    char *destination = (char *)calloc(names + 1, 1);
+    int *sourceDebut = (int *)calloc(names + 2, sizeof(int));
+    int *parSource = (int *)malloc((d->globals + 1) * sizeof(int));
+    int *lu = (int *)malloc((names + 1) * sizeof(int));
+    int *filtre = (int *)malloc((names + 1) * sizeof(int));
+    int status = -1;
+    if (!destination || !sourceDebut || !parSource || !lu || !filtre) {
+        goto fin;
+    }
+    // copies globales rangees par source
+    for (int e = 0; e < d->count; e++) {
+        if (d->global[e] >= 0) {
+            destination[d->group[e]] = 1;
+            if (d->mention[3 * e + 2] >= 0) sourceDebut[d->mention[3 * e + 2] + 2]++;
+        }
+    }
+    for (int k = 0; k < names; k++) {
+        sourceDebut[k + 2] += sourceDebut[k + 1];
+        lu[k] = filtre[k] = -1;
+    }
+    for (int e = 0; e < d->count; e++) {
+        if (d->global[e] >= 0 && d->mention[3 * e + 2] >= 0) {
+            parSource[sourceDebut[d->mention[3 * e + 2] + 1]++] = e;
+        }
+    }
+
+    effacerParcours(d);
+    a->ecritsDebut[0] = a->requetesDebut[0] = 0;
+    for (int b = 0; b < cfg->blockCount; b++) {
+        BasicBlock *bloc = &cfg->blocks[b];
+        int ne = a->ecritsDebut[b], nr = a->requetesDebut[b];
+        for (int i = bloc->first; i < bloc->last; i++) {
+            StringId *fields[CFG_MAX_USES];
+            int uses = cfgUseFields(cfg, i, fields);
+            for (int k = 0; k < uses; k++) {
+                int n = cfgName(cfg, *fields[k]);
+                if (n >= 0 && destination[n] && d->ecrit[n] < bloc->first && lu[n] != b) {
+                    lu[n] = b;
+                    a->requetes[nr++] = n;
+                }
+            }
+            int n = cfgName(cfg, cfgDef(cfg, i));
+            if (n >= 0 && d->ecrit[n] < bloc->first) {
+                a->ecrits[ne++] = n;
+            }
+            transfert(o, d, i);
+        }
+        a->ecritsDebut[b + 1] = ne;
+        a->requetesDebut[b + 1] = nr;
+        qsort(a->ecrits + a->ecritsDebut[b], ne - a->ecritsDebut[b], sizeof(int), compareEntiers);
+        a->noeudsDebut[b] = a->count;
+        // destination ecrite : sa derniere ecriture decide
+        for (int k = a->ecritsDebut[b]; k < ne; k++) {
+            int w = a->ecrits[k];
+            if (destination[w]) {
+                int e = d->ofQuad[d->ecrit[w]];
+                int v = e >= 0 && disponible(d, e, b, bloc->first) ? e : COPIE_AUCUNE;
+                if (ajouterNoeud(a, NOEUD_ECRIT, w, b, v) < 0) {
+                    goto fin;
+                }
+            }
+        }
+        // source ecrite : la copie d'entree vers x peut tomber
+        for (int k = a->ecritsDebut[b]; k < ne; k++) {
+            int w = a->ecrits[k];
+            for (int j = sourceDebut[w]; j < sourceDebut[w + 1]; j++) {
+                int x = d->group[parSource[j]];
+                if (d->ecrit[x] < bloc->first && filtre[x] != b) {
+                    filtre[x] = b;
+                    if (ajouterNoeud(a, NOEUD_FILTRE, x, b, COPIE_INCONNUE) < 0) {
+                        goto fin;
+                    }
+                }
+            }
+        }
+    }
+    a->noeudsDebut[cfg->blockCount] = a->count;
+    effacerParcours(d);
+    status = 0;
+
+fin:
+    free(destination);
+    free(sourceDebut);
+    free(parSource);
+    free(lu);
+    free(filtre);
+    return status;
+}
+
+// phis : frontiere de dominance iteree des blocs qui ont un noeud pour le
+// meme nom ; ranges par bloc, leurs arguments dans a->liens
+static int placerPhis(const Cfg *cfg, AnalyseCopies *a) {
+    int blocs = cfg->blockCount, names = cfg->nameCount, noeuds = a->count;
+    int *dfStart = NULL, *df = cfgFrontiers(cfg, &dfStart);
+    int *parNomDebut = (int *)calloc(names + 2, sizeof(int));
+    int *parNom = (int *)malloc((noeuds + 1) * sizeof(int));
+    int *aPhi = (int *)malloc((blocs + 1) * sizeof(int));
+    int *enAttente = (int *)malloc((blocs + 1) * sizeof(int));
+    int *travail = (int *)malloc((blocs + 1) * sizeof(int));
+    int status = -1;
+    a->phisDebut = (int *)calloc(blocs + 2, sizeof(int));
+    if (!df || !parNomDebut || !parNom || !aPhi || !enAttente || !travail || !a->phisDebut) {
+        goto fin;
+    }
+    for (int k = 0; k < noeuds; k++) {
+        parNomDebut[a->noeuds[k].nom + 2]++;
+    }
+    for (int x = 0; x < names; x++) {
+        parNomDebut[x + 2] += parNomDebut[x + 1];
+    }
+    for (int k = 0; k < noeuds; k++) {
+        parNom[parNomDebut[a->noeuds[k].nom + 1]++] = k;
+    }
+    for (int b = 0; b < blocs; b++) {
+        aPhi[b] = enAttente[b] = -1;
+    }
+    for (int x = 0; x < names; x++) {
+        int sommet = 0;
+        for (int k = parNomDebut[x]; k < parNomDebut[x + 1]; k++) {
+            int b = a->noeuds[parNom[k]].bloc;
+            if (enAttente[b] != x) {
+                enAttente[b] = x;
+                travail[sommet++] = b;
+            }
+        }
+        while (sommet > 0) {
+            int b = travail[--sommet];
+            for (int k = dfStart[b]; k < dfStart[b + 1]; k++) {
+                int j = df[k];
+                if (aPhi[j] == x) {
+                    continue;
+                }
+                aPhi[j] = x;
+                if (ajouterNoeud(a, NOEUD_PHI, x, j, COPIE_INCONNUE) < 0) {
+                    goto fin;
+                }
+                if (enAttente[j] != x) {
+                    enAttente[j] = x;
+                    travail[sommet++] = j;
+                }
+            }
+        }
+    }
+
+    int phis = a->count - noeuds, arguments = 0;
+    a->phis = (int *)malloc((phis + 1) * sizeof(int));
+    if (!a->phis) {
+        goto fin;
+    }
+    for (int k = noeuds; k < a->count; k++) {
+        a->phisDebut[a->noeuds[k].bloc + 2]++;
+        a->noeuds[k].lien = arguments;
+        arguments += cfg->blocks[a->noeuds[k].bloc].predCount;
+    }
+    for (int b = 0; b < blocs; b++) {
+        a->phisDebut[b + 2] += a->phisDebut[b + 1];
+    }
+    for (int k = noeuds; k < a->count; k++) {
+        a->phis[a->phisDebut[a->noeuds[k].bloc + 1]++] = k;
+    }
+    a->liens = (int *)malloc((arguments + 1) * sizeof(int));
+    if (!a->liens) {
+        goto fin;
+    }
+    for (int k = 0; k < arguments; k++) {
+        a->liens[k] = NOEUD_ABSENT;
+    }
+    status = 0;
+
+fin:
+    free(dfStart);
+    free(df);
+    free(parNomDebut);
+    free(parNom);
+    free(aPhi);
+    free(enAttente);
+    free(travail);
+    return status;
+}
+
+// le parcours entre dans b : courant[x] est le noeud qui precede, pour
+// chaque destination x
+static void relierBloc(const Cfg *cfg, AnalyseCopies *a, int b, int *courant, int *journalNom,
+                       int *journalAvant, int *sommet) {
+    for (int k = a->phisDebut[b]; k < a->phisDebut[b + 1]; k++) {
+        int phi = a->phis[k], x = a->noeuds[phi].nom;
+        journalNom[*sommet] = x;
+        journalAvant[(*sommet)++] = courant[x];
+        courant[x] = phi;
+    }
+    for (int k = a->requetesDebut[b]; k < a->requetesDebut[b + 1]; k++) {
+        a->requeteNoeud[k] = courant[a->requetes[k]];
+    }
+    for (int k = a->noeudsDebut[b]; k < a->noeudsDebut[b + 1]; k++) {
+        int x = a->noeuds[k].nom;
+        a->noeuds[k].lien = courant[x];
+        journalNom[*sommet] = x;
+        journalAvant[(*sommet)++] = courant[x];
+        courant[x] = k;
+    }
+    // arguments des phis des successeurs
+    for (int s = 0; s < 2; s++) {
+        int succ = cfg->blocks[b].succ[s];
+        if (succ < 0) {
+            continue;
+        }
+        BasicBlock *bloc = &cfg->blocks[succ];
+        for (int p = 0; p < bloc->predCount; p++) {
+            if (cfg->preds[bloc->predStart + p] != b) {
+                continue;
+            }
+            for (int k = a->phisDebut[succ]; k < a->phisDebut[succ + 1]; k++) {
+                int phi = a->phis[k];
+                a->liens[a->noeuds[phi].lien + p] = courant[a->noeuds[phi].nom];
+            }
+        }
+    }
+}
+
+// parcours de l'arbre des dominateurs en profondeur, sans recursion
+static int relierNoeuds(const Cfg *cfg, AnalyseCopies *a) {
+    int blocs = cfg->blockCount;
+    int *debut = NULL, *enfants = enfantsDominateurs(cfg, &debut);
+    int *courant = (int *)malloc((cfg->nameCount + 1) * sizeof(int));
+    int *journalNom = (int *)malloc((a->count + 1) * sizeof(int));
+    int *journalAvant = (int *)malloc((a->count + 1) * sizeof(int));
+    int *pile = (int *)malloc((blocs + 1) * sizeof(int));
+    int *curseur = (int *)malloc((blocs + 1) * sizeof(int));
+    int *marque = (int *)malloc((blocs + 1) * sizeof(int));
+    int status = -1;
+    if (!enfants || !courant || !journalNom || !journalAvant || !pile || !curseur || !marque) {
+        goto fin;
+    }
+    for (int x = 0; x < cfg->nameCount; x++) {
+        courant[x] = NOEUD_ENTREE;
+    }
+    int sommet = 0, journal = 0;
+    if (cfg->orderCount > 0) {
+        pile[0] = 0;
+        curseur[0] = debut[0];
+        marque[0] = 0;
+        sommet = 1;
+        relierBloc(cfg, a, 0, courant, journalNom, journalAvant, &journal);
+    }
+    while (sommet > 0) {
+        int b = pile[sommet - 1];
+        if (curseur[sommet - 1] < debut[b + 1]) {
+            int c = enfants[curseur[sommet - 1]++];
+            pile[sommet] = c;
+            curseur[sommet] = debut[c];
+            marque[sommet++] = journal;
+            relierBloc(cfg, a, c, courant, journalNom, journalAvant, &journal);
+        } else {
+            for (sommet--; journal > marque[sommet]; journal--) {
+                courant[journalNom[journal - 1]] = journalAvant[journal - 1];
+            }
+        }
+    }
+    status = 0;
+
+fin:
+    free(debut);
+    free(enfants);
+    free(courant);
+    free(journalNom);
+    free(journalAvant);
+    free(pile);
+    free(curseur);
+    free(marque);
+    return status;
+}
+
+// valeurs des noeuds par liste de travail ; chaque noeud change au plus
+// deux fois
+static int resoudreNoeuds(const Cfg *cfg, const Domaine *d, AnalyseCopies *a) {
+    int noeuds = a->count;
+    int *debut = (int *)calloc(noeuds + 2, sizeof(int));
+    int *utilisateurs = NULL;
+    int *file = (int *)malloc((noeuds + 1) * sizeof(int));
+    char *dansFile = (char *)malloc(noeuds + 1);
+    int status = -1;
+    if (!debut || !file || !dansFile) {
+        goto fin;
+    }
+    // deux tours : compter les utilisateurs de chaque noeud, puis les ranger
+    for (int tour = 0; tour < 2; tour++) {
+        for (int k = 0; k < noeuds; k++) {
+            const NoeudCopie *n = &a->noeuds[k];
+            const int *sources = n->genre == NOEUD_PHI ? a->liens + n->lien : &n->lien;
+            int nb = n->genre == NOEUD_PHI ? cfg->blocks[n->bloc].predCount : n->genre == NOEUD_FILTRE;
+            for (int j = 0; j < nb; j++) {
+                int source = sources[j];
+                if (source < 0) {
+                    continue;
+                }
+                if (tour == 0) {
+                    debut[source + 2]++;
+                } else {
+                    utilisateurs[debut[source + 1]++] = k;
+                }
+            }
+        }
+        if (tour == 0) {
+            for (int k = 0; k < noeuds; k++) {
+                debut[k + 2] += debut[k + 1];
+            }
+            utilisateurs = (int *)malloc((debut[noeuds + 1] + 1) * sizeof(int));
+            if (!utilisateurs) {
+                goto fin;
+            }
+        }
+    }
+
+    // file circulaire : un noeud n'y est qu'une fois
+    int tete = 0, taille = 0;
+    for (int k = 0; k < noeuds; k++) {
+        dansFile[k] = a->noeuds[k].genre != NOEUD_ECRIT;
+        if (dansFile[k]) file[taille++] = k;
+    }
+    while (taille > 0) {
+        int k = file[tete];
+        tete = (tete + 1) % (noeuds + 1);
+        taille--;
+        dansFile[k] = 0;
+        int v = evaluerNoeud(a, d, cfg, k);
+        if (v == a->noeuds[k].valeur) {
+            continue;
+        }
+        a->noeuds[k].valeur = v;
+        for (int j = debut[k]; j < debut[k + 1]; j++) {
+            int u = utilisateurs[j];
+            if (!dansFile[u]) {
+                dansFile[u] = 1;
+                file[(tete + taille++) % (noeuds + 1)] = u;
+            }
+        }
+    }
+    status = 0;
+
+fin:
+    free(debut);
+    free(utilisateurs);
+    free(file);
+    free(dansFile);
+    return status;
+}
+
+static void freeAnalyseCopies(AnalyseCopies *a) {
+    free(a->noeuds);
+    free(a->liens);
+    free(a->ecritsDebut);
+    free(a->ecrits);
+    free(a->requetesDebut);
+    free(a->requetes);
+    free(a->requeteNoeud);
+    free(a->noeudsDebut);
+    free(a->phisDebut);
+    free(a->phis);
+}
+
+// d->entreeDebut, d->entreeTaille : les copies disponibles a l'entree de
+// chaque bloc accessible, pour les destinations qui y sont lues avant d'etre
+// ecrites
+static int copiesALEntree(Optimiseur *o, Domaine *d) {
+    Cfg *cfg = &o->cfg;
+    int blocs = cfg->blockCount, quads = o->t->taille;
+    if (!cfg->idom && cfgDominators(cfg) < 0) {
+        return -1;
+    }
+    AnalyseCopies a;
+    memset(&a, 0, sizeof(a));
+    a.ecritsDebut = (int *)malloc((blocs + 1) * sizeof(int));
+    a.ecrits = (int *)malloc((quads + 1) * sizeof(int));
+    a.requetesDebut = (int *)malloc((blocs + 1) * sizeof(int));
+    a.requetes = (int *)malloc((CFG_MAX_USES * (size_t)quads + 1) * sizeof(int));
+    a.requeteNoeud = (int *)malloc((CFG_MAX_USES * (size_t)quads + 1) * sizeof(int));
+    a.noeudsDebut = (int *)malloc((blocs + 1) * sizeof(int));
+    int *entree = (int *)malloc((d->globals + 1) * sizeof(int));
+    d->entreeDebut = (size_t *)malloc((blocs + 1) * sizeof(size_t));
+    d->entreeTaille = (int *)malloc((blocs + 1) * sizeof(int));
+    int status = -1;
+    if (!a.ecritsDebut || !a.ecrits || !a.requetesDebut || !a.requetes || !a.requeteNoeud || !a.noeudsDebut ||
+        !entree || !d->entreeDebut || !d->entreeTaille || noeudsDesBlocs(o, d, &a) < 0 ||
+        placerPhis(cfg, &a) < 0 || relierNoeuds(cfg, &a) < 0 || resoudreNoeuds(cfg, d, &a) < 0) {
+        goto fin;
+    }
+    for (int b = 0; b < blocs; b++) {
+        d->entreeTaille[b] = -1;
+        if (b != 0 && cfg->idom[b] < 0) {
+            continue;
+        }
+        int n = 0;
+        for (int k = a.requetesDebut[b]; k < a.requetesDebut[b + 1]; k++) {
+            int v = valeurNoeud(&a, a.requeteNoeud[k]);
+            if (v >= 0) entree[n++] = d->global[v];
+        }
+        qsort(entree, n, sizeof(int), compareEntiers);
+        if (rangerEnsemble(&d->ensembles, entree, n, &d->entreeDebut[b]) < 0) {
+            goto fin;
+        }
+        d->entreeTaille[b] = n;
+    }
+    status = 0;
+
+fin:
+    freeAnalyseCopies(&a);
+    free(entree);
+    return status;
+}
+
+static int passeCopies(Optimiseur *o) {
+    Cfg *cfg = &o->cfg;
+    tableQuads *t = o->t;
+    int n = t->taille;
+
+    Domaine d;
+    TableTuples tuples;
+    StringId *source = (StringId *)malloc((n + 1) * sizeof(StringId));
+    int *destination = (int *)malloc((n + 1) * sizeof(int));
+    char *global = NULL;
+    int status = -1;
+    int tuplesOk = initTuples(&tuples, (uint32_t)n) == 0;
+    if (allouerDomaine(&d, n) < 0 || !tuplesOk || !source || !destination) {
+        goto fin;
+    }
+
+    for (int i = 0; i < n; i++) {
+        d.ofQuad[i] = -1;
+        quad *q = &t->quads[i];
+        int dst = cfgName(cfg, q->resultat);
+        if (cfg->kinds[i] != QUAD_COPY || dst < 0 || q->operande1 == q->resultat ||
+            q->operande1 == STRING_ID_NONE || internedString(q->operande1)[0] == '[') {
+            continue;
+        }
+        int32_t avant = d.count;
+        int e = tupleId(&tuples, q->operande1, q->resultat, 0, 0, &d.count);
+        if (e == avant) {
+            source[e] = q->operande1;
+            destination[e] = dst;
+            d.group[e] = dst;
+            d.mention[3 * e] = dst;
+            d.mention[3 * e + 1] = -1;
+            d.mention[3 * e + 2] = cfgName(cfg, q->operande1);
+        }
+        d.ofQuad[i] = e;
+    }
+
+    global = nomsGlobaux(cfg);
+    if (!global) {
+        goto fin;
+    }
+    d.groups = cfg->nameCount;
+    for (int e = 0; e < d.count; e++) {
+        d.global[e] = global[destination[e]] ? d.globals++ : -1;
+    }
+    if (preparerDomaine(&d, cfg->nameCount) < 0 || copiesALEntree(o, &d) < 0) {
+        goto fin;
+    }
+
+    status = 0;
+    for (int b = 0; b < cfg->blockCount; b++) {
+        BasicBlock *bloc = &cfg->blocks[b];
+        ouvrirBloc(&d, b);
+        for (int i = bloc->first; i < bloc->last; i++) {
+            StringId *fields[CFG_MAX_USES];
+            int uses = cfgUseFields(cfg, i, fields);
+            quad avant = t->quads[i];
+            int remplace = 0;
+            for (int k = 0; k < uses; k++) {
+                int nom = cfgName(cfg, *fields[k]);
+                if (nom < 0) {
+                    continue;
+                }
+                // copie de la derniere ecriture dans le bloc, sinon celle
+                // de l'entree
+                int e = -1;
+                if (d.ecrit[nom] >= bloc->first) {
+                    e = d.ofQuad[d.ecrit[nom]];
+                } else {
+                    int x = entreeDuGroupe(&d, nom, b);
+                    e = x >= 0 ? d.element[x] : -1;
+                }
+                if (e >= 0 && disponible(&d, e, b, bloc->first)) {
+                    *fields[k] = source[e];
+                    remplace = 1;
+                }
+            }
+            if (remplace) {
+                signalerReecriture(o, OPT_COPY_PROPAGATION, i, &avant);
+                status++;
+            }
+            // la copie lue ailleurs reste vraie : destination vaut l'ancienne source
+            transfert(o, &d, i);
+        }
+    }
+
+fin:
+    if (tuplesOk) {
+        freeTuples(&tuples);
+    }
+    freeDomaine(&d);
+    free(source);
+    free(destination);
+    free(global);
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Code mort : vivacite des noms, en arriere
+
+static int supprimable(const Cfg *cfg, int i) {
+    switch (cfg->kinds[i]) {
+        case QUAD_COPY:
+        case QUAD_PURE:
+        case QUAD_ARRAY:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// noms vivants pendant un parcours arriere : ceux dont vivantDans vaut le
+// numero du parcours en cours ; a l'entree de chaque bloc, les noms
+// globaux vivants (voir vivants)
+typedef struct Vivacite {
+    int *vivantDans;
+    int parcours;
+    Ensembles ensembles;
+    size_t *entreeDebut;    // par bloc : ensembles.elements[entreeDebut[b]] ..
+    int *entreeTaille;
+} Vivacite;
+
+// noms lus avant d'etre ecrits et noms ecrits, releves par parcoursArriere
+typedef struct ResumeBloc {
+    int *lus;
+    int nbLus;
+    int *ecrits;
+    int nbEcrits;
+} ResumeBloc;
+
+static void freeVivacite(Vivacite *v) {
+    free(v->vivantDans);
+    free(v->ensembles.elements);
+    free(v->entreeDebut);
+    free(v->entreeTaille);
+}
+
+static int initVivacite(const Cfg *cfg, Vivacite *v) {
+    memset(v, 0, sizeof(*v));
+    v->vivantDans = (int *)calloc(cfg->nameCount + 1, sizeof(int));
+    v->entreeDebut = (size_t *)malloc((cfg->blockCount + 1) * sizeof(size_t));
+    v->entreeTaille = (int *)malloc((cfg->blockCount + 1) * sizeof(int));
+    return v->vivantDans && v->entreeDebut && v->entreeTaille ? 0 : -1;
+}
+
+static int vivant(const Vivacite *v, int n) {
+    return v->vivantDans[n] == v->parcours;
+}
+
+static void rendreVivant(Vivacite *v, int n, int oui) {
+    v->vivantDans[n] = oui ? v->parcours : 0;
+}
+
+static int vivantALEntree(const Vivacite *v, int b, int n) {
+    return dansListe(v->ensembles.elements + v->entreeDebut[b], v->entreeTaille[b], n);
+}
+
+// rend vivants les noms vivants a l'entree de b
+static void ajouterEntree(Vivacite *v, int b) {
+    const int *entree = v->ensembles.elements + v->entreeDebut[b];
+    for (int k = 0; k < v->entreeTaille[b]; k++) {
+        rendreVivant(v, entree[k], 1);
+    }
+}
+
+// rend vivants les noms lus par le quad i
+static void lectures(const Cfg *cfg, int i, Vivacite *v, ResumeBloc *r) {
+    StringId *fields[CFG_MAX_USES];
+    int uses = cfgUseFields(cfg, i, fields);
+    for (int k = 0; k < uses; k++) {
+        int n = cfgName(cfg, *fields[k]);
+        if (n >= 0) {
+            rendreVivant(v, n, 1);
+            if (r) r->lus[r->nbLus++] = n;
+        }
+    }
+    if (cfg->kinds[i] == QUAD_ARRAY) {
+        for (int k = cfg->arrayUseStart[i]; k < cfg->arrayUseStart[i + 1]; k++) {
+            rendreVivant(v, cfg->arrayUses[k], 1);
+            if (r) r->lus[r->nbLus++] = cfg->arrayUses[k];
+        }
+    }
+}
+
+// parcours d'un bloc de la sortie (noms vivants deja marques) vers
+// l'entree ; avec o, les quads dont le resultat est mort sont supprimes au
+// passage, avec r, les noms lus et ecrits y sont releves
+static int parcoursArriere(Optimiseur *o, const Cfg *cfg, int b, Vivacite *v, ResumeBloc *r) {
+    int supprimes = 0;
+    for (int i = cfg->blocks[b].last - 1; i >= cfg->blocks[b].first; i--) {
+        if (cfg->kinds[i] == QUAD_REMOVED) {
+            continue;
+        }
+        quad *q = &cfg->quads->quads[i];
+        int n = cfgName(cfg, cfgDef(cfg, i));
+        int copieIdentique = cfg->kinds[i] == QUAD_COPY && q->operande1 == q->resultat;
+        if (o && supprimable(cfg, i) && (copieIdentique || (n >= 0 && !vivant(v, n)))) {
+            supprimer(o, OPT_DEAD_CODE, i);
+            supprimes++;
+            continue;
+        }
+        if (n >= 0) {
+            rendreVivant(v, n, 0);
+            if (r) r->ecrits[r->nbEcrits++] = n;
+        }
+        lectures(cfg, i, v, r);
+    }
+    return supprimes;
+}
+
+// nouveau parcours, qui part des noms vivants a la sortie du bloc b
+static void sortieBloc(const Cfg *cfg, int b, Vivacite *v) {
+    v->parcours++;
+    for (int s = 0; s < 2; s++) {
+        int succ = cfg->blocks[b].succ[s];
+        if (succ >= 0) ajouterEntree(v, succ);
+    }
+}
+
+// noms vivants a l'entree de chaque bloc (v->entreeDebut, v->entreeTaille).
+// Chaque bloc est resume une fois (noms lus avant d'etre ecrits, noms
+// ecrits) ; chaque tour ne reprend que les blocs dont un successeur a change
+static int vivants(const Cfg *cfg, Vivacite *v) {
+    int blocs = cfg->blockCount, quads = cfg->quads->taille;
+    size_t *lusDebut = (size_t *)malloc((blocs + 1) * sizeof(size_t));
+    size_t *ecritsDebut = (size_t *)malloc((blocs + 1) * sizeof(size_t));
+    int *nbLus = (int *)malloc((blocs + 1) * sizeof(int));
+    int *nbEcrits = (int *)malloc((blocs + 1) * sizeof(int));
+    int *sortie = (int *)malloc((cfg->nameCount + 1) * sizeof(int));
+    int *entree = (int *)malloc((cfg->nameCount + 1) * sizeof(int));
+    char *aRevoir = (char *)malloc(blocs + 1);
+    ResumeBloc r;
+    r.lus = (int *)malloc((CFG_MAX_USES * (size_t)quads + cfg->arrayUseStart[quads] + 1) * sizeof(int));
+    r.ecrits = (int *)malloc((quads + 1) * sizeof(int));
+    int status = -1;
+    if (!lusDebut || !ecritsDebut || !nbLus || !nbEcrits || !sortie || !entree || !aRevoir || !r.lus ||
+        !r.ecrits) {
+        goto fin;
+    }
+    v->ensembles.taille = 0;
+    for (int b = 0; b < blocs; b++) {
+        v->parcours++;
+        r.nbLus = r.nbEcrits = 0;
+        parcoursArriere(NULL, cfg, b, v, &r);
+        int n = 0;
+        for (int k = 0; k < r.nbLus; k++) {
+            if (vivant(v, r.lus[k])) r.lus[n++] = r.lus[k];
+        }
+        nbLus[b] = trierListe(r.lus, n);
+        nbEcrits[b] = trierListe(r.ecrits, r.nbEcrits);
+        if (rangerEnsemble(&v->ensembles, r.lus, nbLus[b], &lusDebut[b]) < 0 ||
+            rangerEnsemble(&v->ensembles, r.ecrits, nbEcrits[b], &ecritsDebut[b]) < 0) {
+            goto fin;
+        }
+        v->entreeDebut[b] = 0;
+        v->entreeTaille[b] = 0;
+        aRevoir[b] = 1;
+    }
+    int change = 1;
+    while (change) {
+        change = 0;
+        for (int b = blocs - 1; b >= 0; b--) {
+            if (!aRevoir[b]) {
+                continue;
+            }
+            aRevoir[b] = 0;
+            // sortie : union des entrees des successeurs
+            int ns = 0;
+            for (int s = 0; s < 2; s++) {
+                int succ = cfg->blocks[b].succ[s];
+                if (succ < 0) {
+                    continue;
+                }
+                const int *e = v->ensembles.elements + v->entreeDebut[succ];
+                for (int k = 0; k < v->entreeTaille[succ]; k++) {
+                    sortie[ns++] = e[k];
+                }
+            }
+            ns = trierListe(sortie, ns);
+            // entree : lus, plus la sortie sans les noms ecrits
+            const int *ecrits = v->ensembles.elements + ecritsDebut[b];
+            int ni = 0;
+            for (int k = 0; k < ns; k++) {
+                if (!dansListe(ecrits, nbEcrits[b], sortie[k])) entree[ni++] = sortie[k];
+            }
+            const int *lus = v->ensembles.elements + lusDebut[b];
+            for (int k = 0; k < nbLus[b]; k++) {
+                entree[ni++] = lus[k];
+            }
+            ni = trierListe(entree, ni);
+            const int *avant = v->ensembles.elements + v->entreeDebut[b];
+            if (ni == v->entreeTaille[b] && (ni == 0 || memcmp(entree, avant, ni * sizeof(int)) == 0)) {
+                continue;
+            }
+            if (rangerEnsemble(&v->ensembles, entree, ni, &v->entreeDebut[b]) < 0) {
+                goto fin;
+            }
+            v->entreeTaille[b] = ni;
+            const BasicBlock *bloc = &cfg->blocks[b];
+            for (int p = 0; p < bloc->predCount; p++) {
+                aRevoir[cfg->preds[bloc->predStart + p]] = 1;
+            }
+            change = 1;
+        }
+    }
+    status = 0;
+
+fin:
+    free(lusDebut);
+    free(ecritsDebut);
+    free(nbLus);
+    free(nbEcrits);
+    free(sortie);
+    free(entree);
+    free(aRevoir);
+    free(r.lus);
+    free(r.ecrits);
+    return status;
+}
+
+static int passeCodeMort(Optimiseur *o) {
+    Cfg *cfg = &o->cfg;
+    Vivacite v;
+    if (initVivacite(cfg, &v) < 0) {
+        freeVivacite(&v);
+        return -1;
+    }
+    int total = 0, supprimes;
+    do {
+        if (vivants(cfg, &v) < 0) {
+            total = -1;
+            break;
+        }
+        supprimes = 0;
+        for (int b = 0; b < cfg->blockCount; b++) {
+            sortieBloc(cfg, b, &v);
+            supprimes += parcoursArriere(o, cfg, b, &v, NULL);
+        }
+        total += supprimes;
+    } while (supprimes > 0);
+    freeVivacite(&v);
+    return total;
+}
+
+// ---------------------------------------------------------------------------
+// Propagation conditionnelle des constantes (Wegman et Zadeck), sur la
+// forme SSA
+//
+// Chaque version vaut "indefini" (aucune ecriture atteinte), une constante
+// ou "variable". Seuls les blocs atteints par une arete executable sont
+// evalues, et un BZ dont la condition est constante n'ouvre que l'arete
+// prise : une boucle qui reecrit x avec la meme valeur garde x constant,
+// ce que le repliement de syntaxique.y ne peut pas savoir. Les constantes
+// sont des litteraux de quad, calcules par foldBinary / foldUnary.
+
+enum { SCCP_INDEFINI, SCCP_CONSTANTE, SCCP_VARIABLE };
+
+typedef struct Treillis {
+    unsigned char etat;
+    StringId constante;     // litteral, meme texte pour une meme valeur
+} Treillis;
+
+typedef struct Repliable {
+    const char *name;
+    FoldOperator op;
+} Repliable;
+
+// operateurs des quads, et ceux de semantic.c qui les calculent
+static const Repliable repliables[] = {
+    { "+", FOLD_ADD }, { "-", FOLD_SUB }, { "*", FOLD_MUL }, { "/", FOLD_DIV },
+    { "DIV", FOLD_IDIV }, { "MOD", FOLD_MOD }, { "CONCAT", FOLD_ADD },
+    { "==", FOLD_EQ }, { "!=", FOLD_NE }, { "<", FOLD_LT }, { ">", FOLD_GT },
+    { "<=", FOLD_LE }, { ">=", FOLD_GE }, { "AND", FOLD_AND }, { "OR", FOLD_OR },
+    { "NOT", FOLD_NOT }, { "UMINUS", FOLD_NEG },
+};
+
+#define REPLIABLE_COUNT (int)(sizeof(repliables) / sizeof(repliables[0]))
+
+typedef struct Sccp {
+    Optimiseur *o;
+    Cfg *cfg;
+    SsaForm ssa;
+    Treillis *valeurs;
+    char *blocAtteint;
+    unsigned char *areteOuverte;    // par bloc : succ[0], succ[1]
+    int *lectureStart;              // sites de lecture de chaque valeur :
+    int *lectures;                  // quad i, ou -1 - k pour le phi k
+    int *phiBloc;
+    int *aretes;                    // file : 2 * bloc + s
+    int areteCount;
+    int *abaissees;                 // file des valeurs qui ont change
+    int abaisseeCount;
+    StringId operateurs[REPLIABLE_COUNT];
+    StringId vrai, faux, br;
+} Sccp;
+
+// valeur d'un litteral de quad (ou d'une constante du treillis)
+static int lireLitteral(StringId id, expression *e) {
+    const char *text = internedString(id);
+    size_t n = strlen(text);
+    memset(&e->as, 0, sizeof(e->as));
+    e->constant = true;
+    if (n >= 2 && text[0] == '"' && text[n - 1] == '"') {
+        e->type = TYPE_STRING;
+        e->as.s = internStringN(text + 1, n - 2);
+    } else if (strcmp(text, "true") == 0 || strcmp(text, "false") == 0) {
+        e->type = TYPE_BOOLEAN;
+        e->as.b = text[0] == 't';
+    } else if (strpbrk(text, ".eEni")) {
+        e->type = TYPE_FLOAT;
+        e->as.f = strtod(text, NULL);
+    } else if (isdigit((unsigned char)text[0]) || text[0] == '-') {
+        e->type = TYPE_INTEGER;
+        e->as.i = strtoll(text, NULL, 10);
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+// la machine virtuelle relit le litteral (parseLiteral dans vm.c) : pas
+// de nombre negatif ni de inf / nan
+static int ecrivable(StringId id) {
+    const char *text = internedString(id);
+    return text[0] == '"' || isdigit((unsigned char)text[0]) ||
+           strcmp(text, "true") == 0 || strcmp(text, "false") == 0;
+}
+
+static Treillis treillis(unsigned char etat, StringId constante) {
+    Treillis t = { etat, constante };
+    return t;
+}
+
+static Treillis rencontre(Treillis a, Treillis b) {
+    if (a.etat == SCCP_INDEFINI) return b;
+    if (b.etat == SCCP_INDEFINI) return a;
+    if (a.etat == SCCP_CONSTANTE && b.etat == SCCP_CONSTANTE && a.constante == b.constante) return a;
+    return treillis(SCCP_VARIABLE, STRING_ID_NONE);
+}
+
+static Treillis valeurOperande(const Sccp *s, StringId id) {
+    int v = ssaValue(&s->ssa, id);
+    if (v >= 0) {
+        return s->valeurs[v];
+    }
+    expression e;
+    if (id == STRING_ID_NONE || !lireLitteral(id, &e)) {
+        return treillis(SCCP_VARIABLE, STRING_ID_NONE);
+    }
+    StringId constante = valuePlace(&e);
+    return treillis(constante == STRING_ID_NONE ? SCCP_VARIABLE : SCCP_CONSTANTE, constante);
+}
+
+static Treillis calculer(const Sccp *s, int i) {
+    quad *q = &s->o->t->quads[i];
+    switch (s->cfg->kinds[i]) {
+        case QUAD_COPY:
+            return valeurOperande(s, q->operande1);
+        case QUAD_PURE:
+        case QUAD_TRAP:
+            break;
+        default:
+            return treillis(SCCP_VARIABLE, STRING_ID_NONE);
+    }
+    int k = 0;
+    while (k < REPLIABLE_COUNT && s->operateurs[k] != q->operateur) {
+        k++;
+    }
+    if (k == REPLIABLE_COUNT) {
+        return treillis(SCCP_VARIABLE, STRING_ID_NONE);
+    }
+    FoldOperator op = repliables[k].op;
+    int unaire = op == FOLD_NOT || op == FOLD_NEG;
+    Treillis a = valeurOperande(s, q->operande1);
+    Treillis b = unaire ? a : valeurOperande(s, q->operande2);
+    if (a.etat != SCCP_CONSTANTE || b.etat != SCCP_CONSTANTE) {
+        int variable = a.etat == SCCP_VARIABLE || b.etat == SCCP_VARIABLE;
+        return treillis(variable ? SCCP_VARIABLE : SCCP_INDEFINI, STRING_ID_NONE);
+    }
+    expression x, y, r;
+    char error[MAX_FOLD_ERROR_LENGTH];
+    memset(&r, 0, sizeof(r));
+    lireLitteral(a.constante, &x);
+    lireLitteral(b.constante, &y);
+    const char *produit = unaire ? foldUnary(op, &x, &r, error) : foldBinary(op, &x, &y, &r, error);
+    // types refuses, erreur (division par zero) ou autre operateur : le
+    // calcul reste a l'execution
+    if (!produit || strcmp(produit, repliables[k].name) != 0) {
+        return treillis(SCCP_VARIABLE, STRING_ID_NONE);
+    }
+    StringId constante = valuePlace(&r);
+    return treillis(constante == STRING_ID_NONE ? SCCP_VARIABLE : SCCP_CONSTANTE, constante);
+}
+
+static void abaisser(Sccp *s, int v, Treillis t) {
+    Treillis avant = s->valeurs[v];
+    Treillis apres = rencontre(avant, t);
+    if (apres.etat != avant.etat || apres.constante != avant.constante) {
+        s->valeurs[v] = apres;
+        s->abaissees[s->abaisseeCount++] = v;
+    }
+}
+
+static void ouvrirArete(Sccp *s, int b, int slot) {
+    if (s->cfg->blocks[b].succ[slot] >= 0 && !s->areteOuverte[2 * b + slot]) {
+        s->areteOuverte[2 * b + slot] = 1;
+        s->aretes[s->areteCount++] = 2 * b + slot;
+    }
+}
+
+// arete de p vers b ouverte
+static int areteExecutable(const Sccp *s, int p, int b) {
+    int slot = s->cfg->blocks[p].succ[0] == b ? 0 : 1;
+    return s->areteOuverte[2 * p + slot];
+}
+
+// 1 : condition vraie, 0 : fausse, -1 : inconnue
+static int conditionConstante(const Sccp *s, Treillis c) {
+    if (c.etat != SCCP_CONSTANTE) {
+        return -1;
+    }
+    if (c.constante == s->vrai || c.constante == s->faux) {
+        return c.constante == s->vrai;
+    }
+    expression e;
+    if (lireLitteral(c.constante, &e) && e.type == TYPE_INTEGER) {
+        return e.as.i != 0;
+    }
+    return -1;
+}
+
+static void evaluerPhi(Sccp *s, int k) {
+    Phi *phi = &s->ssa.phis[k];
+    BasicBlock *bloc = &s->cfg->blocks[s->phiBloc[k]];
+    Treillis t = treillis(SCCP_INDEFINI, STRING_ID_NONE);
+    for (int p = 0; p < bloc->predCount; p++) {
+        if (areteExecutable(s, s->cfg->preds[bloc->predStart + p], s->phiBloc[k])) {
+            t = rencontre(t, valeurOperande(s, s->ssa.phiArgs[phi->args + p]));
+        }
+    }
+    abaisser(s, ssaValue(&s->ssa, phi->dest), t);
+}
+
+static void evaluerQuad(Sccp *s, int i) {
+    Cfg *cfg = s->cfg;
+    int b = cfg->blockOf[i];
+    if (cfg->kinds[i] == QUAD_BR) {
+        ouvrirArete(s, b, 0);
+        return;
+    }
+    if (cfg->kinds[i] == QUAD_CASE) {
+        // entree de table : suite et cible, sans condition a evaluer
+        ouvrirArete(s, b, 0);
+        ouvrirArete(s, b, cfg->blocks[b].succ[1] >= 0 ? 1 : 0);
+        return;
+    }
+    if (cfg->kinds[i] == QUAD_BZ || cfg->kinds[i] == QUAD_BNZ) {
+        Treillis t = valeurOperande(s, s->o->t->quads[i].resultat);
+        int c = conditionConstante(s, t);
+        if (t.etat == SCCP_INDEFINI) {
+            return;
+        }
+        // c : 1 si le quad continue en sequence, 0 s'il saute
+        if (c >= 0 && cfg->kinds[i] == QUAD_BNZ) {
+            c = !c;
+        }
+        if (c != 0) {
+            ouvrirArete(s, b, 0);
+        }
+        if (c != 1) {
+            ouvrirArete(s, b, cfg->blocks[b].succ[1] >= 0 ? 1 : 0);
+        }
+        return;
+    }
+    StringId def = cfgDef(cfg, i);
+    int v = def != STRING_ID_NONE ? ssaValue(&s->ssa, def) : -1;
+    if (v >= 0 && s->ssa.valueDef[v] == i) {
+        abaisser(s, v, calculer(s, i));
+    }
+}
+
+static void atteindre(Sccp *s, int b) {
+    Cfg *cfg = s->cfg;
+    for (int k = s->ssa.phiStart[b]; k < s->ssa.phiStart[b + 1]; k++) {
+        evaluerPhi(s, k);
+    }
+    if (s->blocAtteint[b]) {
+        return;
+    }
+    s->blocAtteint[b] = 1;
+    int fin = cfg->blocks[b].last - 1;
+    for (int i = cfg->blocks[b].first; i <= fin; i++) {
+        evaluerQuad(s, i);
+    }
+    if (cfg->kinds[fin] != QUAD_BR && cfg->kinds[fin] != QUAD_BZ && cfg->kinds[fin] != QUAD_BNZ &&
+        cfg->kinds[fin] != QUAD_CASE) {
+        ouvrirArete(s, b, 0);
+    }
+}
+
+static int construireLectures(Sccp *s) {
+    Cfg *cfg = s->cfg;
+    SsaForm *ssa = &s->ssa;
+    s->lectureStart = (int *)calloc(ssa->valueCount + 1, sizeof(int));
+    if (!s->lectureStart) {
+        return -1;
+    }
+    // deux tours : compter, puis ranger
+    int *fill = NULL;
+    for (int tour = 0; tour < 2; tour++) {
+        for (int i = 0; i < cfg->quads->taille; i++) {
+            StringId *fields[CFG_MAX_USES];
+            int uses = cfgUseFields(cfg, i, fields);
+            for (int k = 0; k < uses; k++) {
+                int v = ssaValue(ssa, *fields[k]);
+                if (v < 0) continue;
+                if (tour == 0) s->lectureStart[v + 1]++;
+                else s->lectures[fill[v]++] = i;
+            }
+        }
+        for (int k = 0; k < ssa->phiCount; k++) {
+            int preds = ssa->cfg->blocks[s->phiBloc[k]].predCount;
+            for (int p = 0; p < preds; p++) {
+                int v = ssaValue(ssa, ssa->phiArgs[ssa->phis[k].args + p]);
+                if (v < 0) continue;
+                if (tour == 0) s->lectureStart[v + 1]++;
+                else s->lectures[fill[v]++] = -1 - k;
+            }
+        }
+        if (tour == 0) {
+            for (int v = 0; v < ssa->valueCount; v++) {
+                s->lectureStart[v + 1] += s->lectureStart[v];
+            }
+            s->lectures = (int *)malloc((s->lectureStart[ssa->valueCount] + 1) * sizeof(int));
+            fill = (int *)malloc((ssa->valueCount + 1) * sizeof(int));
+            if (!s->lectures || !fill) {
+                free(fill);
+                return -1;
+            }
+            memcpy(fill, s->lectureStart, (ssa->valueCount + 1) * sizeof(int));
+        }
+    }
+    free(fill);
+    return 0;
+}
+
+// remplace les lectures constantes, replie les calculs et les BZ ;
+// retourne le nombre de quads supprimes ou reecrits
+static int reecrireConstantes(Sccp *s) {
+    Cfg *cfg = s->cfg;
+    Optimiseur *o = s->o;
+    int changes = 0;
+    for (int b = 0; b < cfg->blockCount; b++) {
+        for (int i = cfg->blocks[b].first; i < cfg->blocks[b].last; i++) {
+            if (cfg->kinds[i] == QUAD_REMOVED) {
+                continue;
+            }
+            if (!s->blocAtteint[b]) {
+                supprimer(o, OPT_SCCP, i);
+                changes++;
+                continue;
+            }
+            quad *q = &o->t->quads[i];
+            quad avant = *q;
+            int kind = cfg->kinds[i];
+            int v = ssaValue(&s->ssa, cfgDef(cfg, i));
+            Treillis t = v >= 0 ? s->valeurs[v] : treillis(SCCP_VARIABLE, STRING_ID_NONE);
+            if (kind == QUAD_BZ || kind == QUAD_BNZ) {
+                // c : 1 si le branchement n'est jamais pris, 0 s'il l'est toujours
+                int c = conditionConstante(s, valeurOperande(s, q->resultat));
+                if (c >= 0 && kind == QUAD_BNZ) {
+                    c = !c;
+                }
+                if (c == 1) {
+                    supprimer(o, OPT_SCCP, i);
+                    changes++;
+                    continue;
+                }
+                if (c == 0) {
+                    q->operateur = s->br;
+                    q->resultat = q->operande1;
+                    q->operande1 = STRING_ID_NONE;
+                    q->operande2 = STRING_ID_NONE;
+                    cfg->kinds[i] = QUAD_BR;
+                }
+            } else if ((kind == QUAD_PURE || kind == QUAD_TRAP) && t.etat == SCCP_CONSTANTE &&
+                       ecrivable(t.constante)) {
+                q->operateur = o->copy;
+                q->operande1 = t.constante;
+                q->operande2 = STRING_ID_NONE;
+                cfg->kinds[i] = QUAD_COPY;
+            } else if (kind != QUAD_OTHER) {
+                StringId *fields[CFG_MAX_USES];
+                int uses = cfgUseFields(cfg, i, fields);
+                for (int k = 0; k < uses; k++) {
+                    if (ssaValue(&s->ssa, *fields[k]) < 0) {
+                        continue;
+                    }
+                    Treillis u = valeurOperande(s, *fields[k]);
+                    if (u.etat == SCCP_CONSTANTE && ecrivable(u.constante)) {
+                        *fields[k] = u.constante;
+                    }
+                }
+            }
+            if (memcmp(&avant, q, sizeof(avant)) != 0) {
+                signalerReecriture(o, OPT_SCCP, i, &avant);
+                changes++;
+            }
+        }
+    }
+    return changes;
+}
+
+static int passeConstantes(Optimiseur *o) {
+    Sccp s;
+    memset(&s, 0, sizeof(s));
+    s.o = o;
+    s.cfg = &o->cfg;
+    if (ssaBuild(&s.ssa, s.cfg) < 0) {
+        return -1;
+    }
+    Cfg *cfg = s.cfg;
+    SsaForm *ssa = &s.ssa;
+    int status = -1;
+    s.valeurs = (Treillis *)malloc((ssa->valueCount + 1) * sizeof(Treillis));
+    s.blocAtteint = (char *)calloc(cfg->blockCount + 1, 1);
+    s.areteOuverte = (unsigned char *)calloc(2 * (size_t)cfg->blockCount + 1, 1);
+    s.aretes = (int *)malloc((2 * (size_t)cfg->blockCount + 1) * sizeof(int));
+    s.abaissees = (int *)malloc((2 * (size_t)ssa->valueCount + 1) * sizeof(int));
+    s.phiBloc = (int *)malloc((ssa->phiCount + 1) * sizeof(int));
+    if (!s.valeurs || !s.blocAtteint || !s.areteOuverte || !s.aretes || !s.abaissees || !s.phiBloc) {
+        goto fin;
+    }
+    for (int b = 0; b < cfg->blockCount; b++) {
+        for (int k = ssa->phiStart[b]; k < ssa->phiStart[b + 1]; k++) {
+            s.phiBloc[k] = b;
+        }
+    }
+    if (construireLectures(&s) < 0) {
+        goto fin;
+    }
+    for (int k = 0; k < REPLIABLE_COUNT; k++) {
+        s.operateurs[k] = internString(repliables[k].name);
+    }
+    s.vrai = internString("true");
+    s.faux = internString("false");
+    s.br = internString("BR");
+    // un nom non renomme est lu avant toute ecriture : valeur inconnue
+    for (int v = 0; v < ssa->valueCount; v++) {
+        s.valeurs[v] = treillis(ssa->valueDef[v] == SSA_NO_DEF ? SCCP_VARIABLE : SCCP_INDEFINI, STRING_ID_NONE);
+    }
+
+    if (cfg->blockCount > 0) {
+        atteindre(&s, 0);
+    }
+    while (s.areteCount > 0 || s.abaisseeCount > 0) {
+        if (s.areteCount > 0) {
+            int e = s.aretes[--s.areteCount];
+            atteindre(&s, cfg->blocks[e / 2].succ[e % 2]);
+            continue;
+        }
+        int v = s.abaissees[--s.abaisseeCount];
+        for (int k = s.lectureStart[v]; k < s.lectureStart[v + 1]; k++) {
+            int site = s.lectures[k];
+            if (site >= 0 && s.blocAtteint[cfg->blockOf[site]]) {
+                evaluerQuad(&s, site);
+            } else if (site < 0 && s.blocAtteint[s.phiBloc[-1 - site]]) {
+                evaluerPhi(&s, -1 - site);
+            }
+        }
+    }
+    status = reecrireConstantes(&s);
+
+fin:
+    ssaRestore(ssa);
+    ssaFree(ssa);
+    free(s.valeurs);
+    free(s.blocAtteint);
+    free(s.areteOuverte);
+    free(s.aretes);
+    free(s.abaissees);
+    free(s.phiBloc);
+    free(s.lectureStart);
+    free(s.lectures);
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Invariants de boucle
+//
+// Une arete b -> h dont h domine b ferme une boucle naturelle : l'entete h
+// et les blocs qui atteignent b sans passer par h (les aretes de retour
+// vers un meme entete forment une seule boucle). Un calcul de la boucle est
+// invariant si chaque operande est un litteral, un nom qu'aucun quad de la
+// boucle n'ecrit, ou un nom ecrit par un seul quad, lui-meme invariant. Il
+// est sorti dans la pre-entete, un bloc "PRE_<entete>" place juste avant
+// l'entete (les branchements du reste du programme vers l'entete y sont
+// rediriges), si son resultat x :
+//   - n'est ecrit qu'une fois dans la boucle ;
+//   - n'est pas vivant a l'entree de l'entete : chaque lecture de x dans la
+//     boucle voit ce calcul ;
+//   - n'est pas vivant a la sortie de la boucle, ou le calcul est dans un
+//     bloc qui domine toutes les sorties (il a deja eu lieu en sortant).
+// Seules les copies et les operations pures sont deplacees : executees
+// meme si la boucle ne tourne pas, elles n'ont aucun effet visible. Une
+// operation qui peut echouer (/, tableaux, INDEX) ne sort que si elle ouvre
+// l'entete, precedee uniquement de calculs sans effet : elle s'executait
+// deja a l'entree de la boucle, avant tout PRINT ou INPUT. Les boucles sont
+// traitees de la plus grande a la plus petite : un calcul invariant de deux
+// boucles imbriquees sort des deux.
+
+typedef struct Boucle {
+    int tete;
+    int debut;      // blocs de la boucle : corps[debut .. debut + taille[
+    int taille;
+} Boucle;
+
+// rang[2 * b], rang[2 * b + 1] : entree et sortie de b dans un parcours en
+// profondeur de l'arbre des dominateurs (-1 : bloc inaccessible) ; a domine
+// b si l'intervalle de b est dans celui de a
+static int numeroterDominateurs(const Cfg *cfg, int *rang) {
+    int blocs = cfg->blockCount;
+    int *debut = NULL, *enfants = enfantsDominateurs(cfg, &debut);
+    int *pile = (int *)malloc((blocs + 1) * sizeof(int));
+    int *curseur = (int *)malloc((blocs + 1) * sizeof(int));
+    if (!enfants || !pile || !curseur) {
+        free(debut);
+        free(enfants);
+        free(pile);
+        free(curseur);
+        return -1;
+    }
+    for (int b = 0; b < blocs; b++) {
+        rang[2 * b] = rang[2 * b + 1] = -1;
+    }
+    int compteur = 0, sommet = 0;
+    if (cfg->orderCount > 0) {
+        pile[sommet++] = 0;
+        curseur[0] = debut[0];
+        rang[0] = compteur++;
+    }
+    while (sommet > 0) {
+        int b = pile[sommet - 1];
+        if (curseur[b] < debut[b + 1]) {
+            int c = enfants[curseur[b]++];
+            curseur[c] = debut[c];
+            rang[2 * c] = compteur++;
+            pile[sommet++] = c;
+        } else {
+            rang[2 * b + 1] = compteur++;
+            sommet--;
+        }
+    }
+    free(debut);
+    free(enfants);
+    free(pile);
+    free(curseur);
+    return 0;
+}
+
+static int domine(const int *rang, int a, int b) {
+    return a == b || (rang[2 * a] >= 0 && rang[2 * b] >= 0 && rang[2 * a] < rang[2 * b] &&
+                      rang[2 * b + 1] < rang[2 * a + 1]);
+}
+
+static int accessible(const Cfg *cfg, int b) {
+    return b == 0 || cfg->idom[b] >= 0;
+}
+
+static int compareTailles(const void *a, const void *b) {
+    const Boucle *x = (const Boucle *)a, *y = (const Boucle *)b;
+    return x->taille != y->taille ? y->taille - x->taille : x->tete - y->tete;
+}
+
+// boucles naturelles, blocs de chacune dans *corps (agrandi au besoin) ;
+// retourne leur nombre, -1 si la memoire manque
+static int trouverBoucles(const Cfg *cfg, const int *rang, Boucle *boucles, int **corps, size_t *capacite,
+                          int *marque, int *pile) {
+    int nb = 0;
+    size_t total = 0;
+    for (int h = 0; h < cfg->blockCount; h++) {
+        const BasicBlock *tete = &cfg->blocks[h];
+        int sommet = 0, retour = 0;
+        marque[h] = h;
+        for (int p = 0; p < tete->predCount && accessible(cfg, h); p++) {
+            int pred = cfg->preds[tete->predStart + p];
+            if (accessible(cfg, pred) && domine(rang, h, pred)) {
+                retour = 1;
+                if (marque[pred] != h) {
+                    marque[pred] = h;
+                    pile[sommet++] = pred;
+                }
+            }
+        }
+        if (!retour) {
+            continue;
+        }
+        // une boucle a au plus blockCount blocs
+        if (total + cfg->blockCount > *capacite) {
+            size_t capacite2 = 2 * *capacite > total + cfg->blockCount ? 2 * *capacite
+                                                                       : total + cfg->blockCount;
+            int *corps2 = (int *)realloc(*corps, capacite2 * sizeof(int));
+            if (!corps2) {
+                return -1;
+            }
+            *corps = corps2;
+            *capacite = capacite2;
+        }
+        // remontee des predecesseurs jusqu'a l'entete
+        Boucle *l = &boucles[nb++];
+        l->tete = h;
+        l->debut = (int)total;
+        (*corps)[total++] = h;
+        while (sommet > 0) {
+            int b = pile[--sommet];
+            (*corps)[total++] = b;
+            for (int p = 0; p < cfg->blocks[b].predCount; p++) {
+                int pred = cfg->preds[cfg->blocks[b].predStart + p];
+                if (accessible(cfg, pred) && marque[pred] != h) {
+                    marque[pred] = h;
+                    pile[sommet++] = pred;
+                }
+            }
+        }
+        l->taille = (int)total - l->debut;
+        qsort(*corps + l->debut, l->taille, sizeof(int), compareEntiers);
+    }
+    return nb;
+}
+
+// le quad i peut-il sortir de la boucle d'entete h ? (ecritures : nombre
+// d'ecritures de chaque nom dans la boucle, invariant : noms ecrits par un
+// calcul deja sorti ; v marque les noms vivants a la sortie de la boucle)
+static int sortable(const Cfg *cfg, int i, int h, const Vivacite *v, const int *ecritures,
+                    const char *invariant, int dominant, int ouvre) {
+    int kind = cfg->kinds[i];
+    if (kind != QUAD_PURE && kind != QUAD_COPY && !(kind == QUAD_TRAP && ouvre)) {
+        return 0;
+    }
+    int x = cfgName(cfg, cfgDef(cfg, i));
+    if (x < 0 || ecritures[x] != 1) {
+        return 0;
+    }
+    if (vivantALEntree(v, h, x) || (vivant(v, x) && !dominant)) {
+        return 0;
+    }
+    StringId *fields[CFG_MAX_USES];
+    int uses = cfgUseFields(cfg, i, fields);
+    for (int k = 0; k < uses; k++) {
+        int y = cfgName(cfg, *fields[k]);
+        if (y >= 0 && ecritures[y] > 0 && !invariant[y]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int passeInvariants(Optimiseur *o) {
+    Cfg *cfg = &o->cfg;
+    tableQuads *t = o->t;
+    int n = t->taille, blocs = cfg->blockCount;
+    if (blocs == 0) {
+        return 0;
+    }
+    Vivacite v;
+    int vivaciteOk = initVivacite(cfg, &v) == 0;
+    Boucle *boucles = (Boucle *)malloc(blocs * sizeof(Boucle));
+    size_t capacite = 2 * (size_t)blocs;
+    int *corps = (int *)malloc(capacite * sizeof(int));
+    int *rang = (int *)malloc(2 * (size_t)blocs * sizeof(int));
+    int *marque = (int *)malloc(blocs * sizeof(int));
+    int *pile = (int *)malloc((blocs + 1) * sizeof(int));
+    int *ecritures = (int *)calloc(cfg->nameCount + 1, sizeof(int));
+    char *invariant = (char *)calloc(cfg->nameCount + 1, 1);
+    int *hote = (int *)malloc((n + 1) * sizeof(int));               // entete ou -1
+    int *sortis = (int *)malloc((n + 1) * sizeof(int));
+    int *sortisDebut = (int *)calloc(blocs + 1, sizeof(int));
+    int *sortisFin = (int *)calloc(blocs + 1, sizeof(int));
+    StringId *pre = (StringId *)malloc((blocs + 1) * sizeof(StringId));
+    quad *quads = (quad *)malloc((size_t)(n + blocs) * sizeof(quad));
+    int status = vivaciteOk && boucles && corps && rang && marque && pile && ecritures && invariant && hote &&
+                 sortis && sortisDebut && sortisFin && pre && quads && cfgDominators(cfg) == 0 &&
+                 numeroterDominateurs(cfg, rang) == 0 ? 0 : -1;
+
+    int nb = 0;
+    if (status == 0) {
+        for (int b = 0; b < blocs; b++) marque[b] = -1;
+        for (int i = 0; i < n; i++) hote[i] = -1;
+        status = vivants(cfg, &v);
+        nb = status == 0 ? trouverBoucles(cfg, rang, boucles, &corps, &capacite, marque, pile) : 0;
+        status = nb < 0 ? -1 : status;
+        nb = nb < 0 ? 0 : nb;
+        qsort(boucles, nb, sizeof(Boucle), compareTailles);
+        for (int b = 0; b < blocs; b++) marque[b] = -1;
+    }
+    int total = 0;
+    for (int k = 0; k < nb && status == 0; k++) {
+        Boucle *l = &boucles[k];
+        const int *blocsBoucle = corps + l->debut;
+        int h = l->tete;
+        const BasicBlock *tete = &cfg->blocks[h];
+        for (int j = 0; j < l->taille; j++) {
+            marque[blocsBoucle[j]] = k + blocs;
+        }
+        o->report->loops++;
+        // la pre-entete se place devant l'entete : le bloc precedent ne
+        // doit pas y entrer par la suite du code depuis la boucle
+        int precedent = h > 0 ? cfg->blocks[h - 1].last - 1 : -1;
+        if (cfg->kinds[tete->first] != QUAD_LABEL ||
+            (h > 0 && marque[h - 1] == k + blocs && cfg->kinds[precedent] != QUAD_BR)) {
+            continue;
+        }
+
+        // ecritures dans la boucle, sorties et noms vivants apres la boucle
+        int sorties = 0;
+        v.parcours++;
+        for (int j = 0; j < l->taille; j++) {
+            const BasicBlock *bloc = &cfg->blocks[blocsBoucle[j]];
+            for (int i = bloc->first; i < bloc->last; i++) {
+                int x = hote[i] < 0 && cfg->kinds[i] != QUAD_REMOVED ? cfgName(cfg, cfgDef(cfg, i)) : -1;
+                if (x >= 0) ecritures[x]++;
+            }
+            int sort = 0;
+            for (int s = 0; s < 2; s++) {
+                int succ = bloc->succ[s];
+                if (succ >= 0 && marque[succ] != k + blocs) {
+                    ajouterEntree(&v, succ);
+                    sort = 1;
+                }
+            }
+            sort |= bloc->succ[0] < 0 && bloc->succ[1] < 0;
+            if (sort) pile[sorties++] = blocsBoucle[j];
+        }
+
+        // un bloc domine toutes les sorties s'il domine leur plus proche
+        // dominateur commun
+        int commun = sorties > 0 ? pile[0] : -1;
+        for (int s = 1; s < sorties; s++) {
+            while (!domine(rang, commun, pile[s])) commun = cfg->idom[commun];
+        }
+        int debut = total, change = 1;
+        while (change) {
+            change = 0;
+            for (int j = 0; j < l->taille; j++) {
+                int b = blocsBoucle[j];
+                int dominant = commun < 0 || domine(rang, b, commun);
+                int ouvre = b == h;     // aucun effet avant ce quad dans l'entete
+                for (int i = cfg->blocks[b].first; i < cfg->blocks[b].last; i++) {
+                    int kind = cfg->kinds[i];
+                    if (hote[i] < 0 && sortable(cfg, i, h, &v, ecritures, invariant, dominant, ouvre)) {
+                        hote[i] = h;
+                        sortis[total++] = i;
+                        invariant[cfgName(cfg, cfgDef(cfg, i))] = 1;
+                        change = 1;
+                    }
+                    if (hote[i] < 0 && kind != QUAD_LABEL && kind != QUAD_REMOVED &&
+                        kind != QUAD_PURE && kind != QUAD_COPY) {
+                        ouvre = 0;
+                    }
+                }
+            }
+        }
+        for (int j = 0; j < l->taille; j++) {
+            const BasicBlock *bloc = &cfg->blocks[blocsBoucle[j]];
+            for (int i = bloc->first; i < bloc->last; i++) {
+                int x = cfg->kinds[i] != QUAD_REMOVED ? cfgName(cfg, cfgDef(cfg, i)) : -1;
+                if (x >= 0) {
+                    ecritures[x] = 0;
+                    invariant[x] = 0;
+                }
+            }
+        }
+
+        // nom de la boucle : derniere etiquette de l'entete (WHILE_COND_...)
+        int etiquette = tete->first;
+        while (etiquette + 1 < tete->last && cfg->kinds[etiquette + 1] == QUAD_LABEL) etiquette++;
+        const char *nom = internedString(t->quads[etiquette].operateur);
+        o->report->hoisted += total - debut;
+        // pre-entete, d'un nom inutilise
+        char texte[64];
+        snprintf(texte, sizeof(texte), "PRE_%s", nom);
+        for (int suffixe = 1; idMapGet(&cfg->labels, internString(texte), -1) >= 0; suffixe++) {
+            snprintf(texte, sizeof(texte), "PRE_%s_%d", nom, suffixe);
+        }
+        if (o->out) {
+            for (int s = debut; s < total; s++) {
+                quad *q = &t->quads[sortis[s]];
+                fprintf(o->out, "\t %-13s Quad[%d]=", "invariants", q->qc);
+                decrireQuad(o->out, q);
+                fprintf(o->out, " sorti vers %s\n", texte);
+            }
+            fprintf(o->out, "\t %-13s boucle %s (%d bloc(s)) : %d quad(s) sorti(s)\n", "invariants",
+                    nom, l->taille, total - debut);
+        }
+        if (total == debut) {
+            continue;
+        }
+        // le reste du programme entre dans la boucle par la pre-entete
+        pre[h] = internString(texte);
+        sortisDebut[h] = debut;
+        sortisFin[h] = total;
+        for (int p = 0; p < tete->predCount; p++) {
+            int pred = cfg->preds[tete->predStart + p];
+            int i = cfg->blocks[pred].last - 1, kind = cfg->kinds[i];
+            if ((kind == QUAD_BR || kind == QUAD_BZ || kind == QUAD_BNZ || kind == QUAD_CASE) &&
+                marque[pred] != k + blocs &&
+                idMapGet(&cfg->labels, cfgBranchLabel(cfg, i), -1) == h) {
+                quad *q = &t->quads[i];
+                *(kind == QUAD_BR ? &q->resultat : &q->operande1) = pre[h];
+            }
+        }
+    }
+
+    // chaque pre-entete devant son entete ; les quads gardent leur numero
+    // (celui de l'entete pour l'etiquette) jusqu'a la fin de l'optimisation
+    if (status == 0 && total > 0) {
+        int j = 0;
+        for (int b = 0; b < blocs; b++) {
+            if (sortisFin[b] > sortisDebut[b]) {
+                memset(&quads[j], 0, sizeof(quad));
+                quads[j].operateur = pre[b];
+                quads[j++].qc = t->quads[cfg->blocks[b].first].qc;
+                for (int s = sortisDebut[b]; s < sortisFin[b]; s++) {
+                    quads[j++] = t->quads[sortis[s]];
+                }
+            }
+            for (int i = cfg->blocks[b].first; i < cfg->blocks[b].last; i++) {
+                if (hote[i] < 0) {
+                    quads[j++] = t->quads[i];
+                }
+            }
+        }
+        free(t->quads);
+        t->quads = quads;
+        t->taille = t->capacite = j;
+        quads = NULL;
+    }
+
+    free(boucles);
+    free(corps);
+    free(rang);
+    free(marque);
+    free(pile);
+    free(ecritures);
+    free(invariant);
+    free(hote);
+    free(sortis);
+    free(sortisDebut);
+    free(sortisFin);
+    free(pre);
+    free(quads);
+    freeVivacite(&v);
+    return status < 0 ? -1 : total;
+}
+
+// ---------------------------------------------------------------------------
+
+// retire les quads supprimes (sans renumeroter : le rapport garde les
+// numeros d'origine)
+static void compacter(Optimiseur *o) {
+    tableQuads *t = o->t;
+    int j = 0;
+    for (int i = 0; i < t->taille; i++) {
+        if (o->cfg.kinds[i] != QUAD_REMOVED) {
+            t->quads[j++] = t->quads[i];
+        }
+    }
+    t->taille = j;
+}
+
+// passes repetees tant que l'une d'elles change quelque chose
+static int repeterPasses(Optimiseur *o) {
+    for (int round = 0; round < OPT_MAX_ROUNDS; round++) {
+        int r[OPT_PASS_COUNT];
+        r[OPT_SCCP] = 0;
+        r[OPT_UNREACHABLE] = passeInaccessible(o);
+        r[OPT_LOCAL_CSE] = passeSousExpressions(o, 0);
+        r[OPT_GLOBAL_CSE] = passeSousExpressions(o, 1);
+        r[OPT_COPY_PROPAGATION] = passeCopies(o);
+        r[OPT_DEAD_CODE] = passeCodeMort(o);
+        int change = 0;
+        for (int p = 0; p < OPT_PASS_COUNT; p++) {
+            if (r[p] < 0) return -1;
+            change |= r[p] > 0;
+        }
+        if (!change) {
+            break;
+        }
+    }
+    return 0;
+}
+
+int optimiserQuads(tableQuads *t, SymbolTable *table, FILE *out, OptimizerReport *report) {
+    Optimiseur o;
+    OptimizerReport local;
+    memset(&o, 0, sizeof(o));
+    o.t = t;
+    o.out = out;
+    o.report = report ? report : &local;
+    o.copy = internString(":=");
+    memset(o.report, 0, sizeof(*o.report));
+    o.report->before = t->taille;
+
+    if (out) {
+        fprintf(out, "\n=============  Optimisation des quadruplets =============\n");
+    }
+    // programme deja optimise : les passes suppriment des quads, les
+    // cibles redeviennent des etiquettes
+    int status = retablirEtiquettes(t) < 0 ? -1 : 0;
+    status = status == 0 ? cfgBuild(&o.cfg, t) : status;
+    if (status == 0) {
+        status = passeConstantes(&o) < 0 ? -1 : 0;
+        // les branchements replies changent le graphe
+        compacter(&o);
+        cfgFree(&o.cfg);
+        status = status == 0 ? cfgBuild(&o.cfg, t) : status;
+    }
+    status = status == 0 ? repeterPasses(&o) : status;
+    // invariants de boucle, sur le programme nettoye ; les quads sortis
+    // peuvent ensuite doubler un calcul d'avant la boucle
+    if (status == 0) {
+        compacter(&o);
+        cfgFree(&o.cfg);
+        status = cfgBuild(&o.cfg, t);
+        int sortis = status == 0 ? passeInvariants(&o) : 0;
+        if (sortis < 0) {
+            status = -1;
+        } else if (sortis > 0) {
+            cfgFree(&o.cfg);
+            status = cfgBuild(&o.cfg, t);
+            status = status == 0 ? repeterPasses(&o) : status;
+        }
+    }
+
+    if (o.cfg.kinds) {
+        compacter(&o);
+    }
+    for (int i = 0; i < t->taille; i++) {
+        t->quads[i].qc = t->premier + i;
+    }
+    cfgFree(&o.cfg);
+
+    // branchements, puis etiquettes remplacees par des numeros de quad
+    BranchReport *branches = &o.report->branches;
+    memset(branches, 0, sizeof(*branches));
+    if (status == 0 && optimiserBranchements(t, out, branches) < 0) {
+        status = -1;
+    }
+    if (status == 0 && resoudreEtiquettes(t, branches) < 0) {
+        status = -1;
+    }
+    // temporaires : cases reutilisees (apres la resolution, les quads ne bougent plus)
+    TempReport *temps = &o.report->temps;
+    memset(temps, 0, sizeof(*temps));
+    if (status == 0 && allouerTemporaires(t, table, temps) < 0) {
+        status = -1;
+    }
+    int removed = o.report->before - t->taille;
+    o.report->after = t->taille;
+
+    if (out) {
+        for (int p = 0; p < OPT_PASS_COUNT; p++) {
+            fprintf(out, "%s%s: %d supprime(s), %d reecrit(s)", p ? " ; " : "", passNames[p],
+                    o.report->removed[p], o.report->rewritten[p]);
+        }
+        fprintf(out, "\nboucles: %d boucle(s) naturelle(s), %d quad(s) sorti(s) vers les pre-entetes",
+                o.report->loops, o.report->hoisted);
+        fprintf(out, "\nbranchements: %d etiquette(s) fusionnee(s), %d saut(s) court-circuite(s), "
+                "%d inversion(s), %d vers la suite ; %d etiquette(s) resolue(s), %d cible(s)",
+                branches->merged, branches->threaded, branches->inverted, branches->removed,
+                branches->labels, branches->resolved);
+        fprintf(out, "\ntemporaires: %d -> %d case(s), au plus %d vivant(s) ensemble",
+                temps->temps, temps->slots, temps->peak);
+        fprintf(out, "\n%d -> %d quads\n", o.report->before, o.report->after);
+        if (status < 0) {
+            fprintf(out, "Optimisation interrompue : memoire insuffisante\n");
+        }
+    }
+    return status < 0 ? -1 : removed;
+}
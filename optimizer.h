@@ -0,0 +1,65 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+#include <stdio.h>
+#include "quadruplets.h"
+#include "peephole.h"
+#include "tempalloc.h"
+
+// Optimiseur de quadruplets (option -O), applique apres yyparse.
+//
+// Le programme est decoupe en blocs de base (cfg.h) puis transforme par
+// des passes successives. D'abord, sur la forme SSA (ssa.h), une
+// propagation conditionnelle des constantes (SCCP) : les calculs dont les
+// operandes sont constants sur tous les chemins executables sont replies,
+// les lectures de constantes remplacees par le litteral, les BZ dont la
+// condition est connue deviennent BR ou disparaissent, et les blocs qu'ils
+// ne peuvent plus atteindre sont supprimes. Puis, repetees tant que l'une
+// d'elles change quelque chose :
+//   - code inaccessible : blocs qu'aucun chemin ne relie a l'entree ;
+//   - sous-expressions communes, dans chaque bloc puis sur tout le graphe
+//     (expressions disponibles) : "op a b r" dont la valeur est deja dans
+//     un nom h devient ":= h , , r" (ou disparait si h est r) ;
+//   - propagation des copies (copies disponibles) : apres ":= a , , b",
+//     les lectures de b lisent a ;
+//   - code mort (vivacite des noms) : un calcul ou une copie dont le
+//     resultat n'est plus jamais lu est supprime. PRINT, INPUT et les
+//     operations qui peuvent echouer (/, DIV, MOD) sont toujours gardes.
+// Les calculs invariants des boucles naturelles (While, Repeat) sortent
+// ensuite dans une pre-entete placee devant la boucle, puis ces passes
+// sont reprises.
+//
+// Enfin les branchements sont simplifies, les etiquettes remplacees par
+// des numeros de quad (peephole.h) et les temporaires ranges dans des
+// cases reutilisables (tempalloc.h). La sortie du programme est inchangee
+// (make verifier-optimiseur). Les quads restants sont renumerotes a partir
+// de premier.
+
+typedef enum OptimizerPass {
+    OPT_SCCP,
+    OPT_UNREACHABLE,
+    OPT_LOCAL_CSE,
+    OPT_GLOBAL_CSE,
+    OPT_COPY_PROPAGATION,
+    OPT_DEAD_CODE,
+    OPT_PASS_COUNT
+} OptimizerPass;
+
+typedef struct OptimizerReport {
+    int removed[OPT_PASS_COUNT];    // quads supprimes par chaque passe
+    int rewritten[OPT_PASS_COUNT];  // quads reecrits (operande ou operateur)
+    int loops;                      // boucles naturelles trouvees
+    int hoisted;                    // quads sortis dans leur pre-entete
+    BranchReport branches;          // branchements et etiquettes (peephole.h)
+    TempReport temps;               // temporaires (tempalloc.h)
+    int before;                     // nombre de quads avant / apres
+    int after;
+} OptimizerReport;
+
+// optimise t sur place ; table (NULL : types inconnus) donne le type des
+// variables (tempalloc.h). Chaque quad supprime ou reecrit est decrit sur
+// out (NULL : aucun rapport). Retourne le nombre de quads supprimes, -1 si
+// la memoire manque (le programme reste alors correct, mais partiellement
+// optimise)
+int optimiserQuads(tableQuads *t, SymbolTable *table, FILE *out, OptimizerReport *report);
+
+#endif
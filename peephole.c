@@ -0,0 +1,374 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "peephole.h"
+#include "idmap.h"
+
+#define PEEPHOLE_MAX_ROUNDS 16
+
+// GENRE_CASE : entree d'une table SWITCH, a sa place meme si elle vise
+// l'instruction suivante
+enum { GENRE_AUTRE, GENRE_ETIQUETTE, GENRE_BR, GENRE_BZ, GENRE_BNZ, GENRE_CASE, GENRE_SUPPRIME };
+
+typedef struct Peephole {
+    tableQuads *t;
+    unsigned char *genre;
+    IdMap etiquettes;       // etiquette -> indice de son pseudo-quad
+    FILE *out;
+    BranchReport *report;
+    StringId br, bz, bnz, cas;
+} Peephole;
+
+static int initPeephole(Peephole *p, tableQuads *t, FILE *out, BranchReport *report) {
+    memset(p, 0, sizeof(*p));
+    p->t = t;
+    p->out = out;
+    p->report = report;
+    p->br = internString("BR");
+    p->bz = internString("BZ");
+    p->bnz = internString("BNZ");
+    p->cas = internString("CASE");
+    p->genre = (unsigned char *)malloc(t->taille + 1);
+    if (!p->genre || initIdMap(&p->etiquettes, (uint32_t)t->taille) < 0) {
+        return -1;
+    }
+    for (int i = 0; i < t->taille; i++) {
+        quad *q = &t->quads[i];
+        if (q->operateur == p->br) {
+            p->genre[i] = GENRE_BR;
+        } else if (q->operateur == p->bz) {
+            p->genre[i] = GENRE_BZ;
+        } else if (q->operateur == p->bnz) {
+            p->genre[i] = GENRE_BNZ;
+        } else if (q->operateur == p->cas) {
+            p->genre[i] = GENRE_CASE;
+        } else if (q->operande1 == STRING_ID_NONE && q->operande2 == STRING_ID_NONE &&
+                   q->resultat == STRING_ID_NONE) {
+            p->genre[i] = GENRE_ETIQUETTE;
+            if (idMapGet(&p->etiquettes, q->operateur, -1) < 0) {
+                idMapPut(&p->etiquettes, q->operateur, i);
+            }
+        } else {
+            p->genre[i] = GENRE_AUTRE;
+        }
+    }
+    return 0;
+}
+
+static void freePeephole(Peephole *p) {
+    free(p->genre);
+    freeIdMap(&p->etiquettes);
+}
+
+static int estBranchement(const Peephole *p, int i) {
+    return p->genre[i] == GENRE_BR || p->genre[i] == GENRE_BZ || p->genre[i] == GENRE_BNZ ||
+           p->genre[i] == GENRE_CASE;
+}
+
+// champ qui porte la cible du branchement i
+static StringId *champCible(Peephole *p, int i) {
+    quad *q = &p->t->quads[i];
+    return p->genre[i] == GENRE_BR ? &q->resultat : &q->operande1;
+}
+
+// premiere instruction executee apres i (etiquettes et quads supprimes
+// sautes) ; taille : fin du programme
+static int suivant(const Peephole *p, int i) {
+    int j = i + 1;
+    while (j < p->t->taille && (p->genre[j] == GENRE_ETIQUETTE || p->genre[j] == GENRE_SUPPRIME)) {
+        j++;
+    }
+    return j;
+}
+
+// instruction executee en sautant a l'etiquette, -1 si elle n'existe pas
+static int destination(const Peephole *p, StringId etiquette) {
+    int k = idMapGet(&p->etiquettes, etiquette, -1);
+    return k < 0 ? -1 : suivant(p, k - 1);
+}
+
+static void decrireQuad(FILE *out, const quad *q) {
+    fprintf(out, "[ %s , %s , %s , %s ]", internedString(q->operateur), internedString(q->operande1),
+            internedString(q->operande2), internedString(q->resultat));
+}
+
+static void supprimer(Peephole *p, const char *raison, int i) {
+    p->genre[i] = GENRE_SUPPRIME;
+    if (p->out) {
+        quad *q = &p->t->quads[i];
+        fprintf(p->out, "\t %-13s Quad[%d]=", raison, q->qc);
+        decrireQuad(p->out, q);
+        fprintf(p->out, " supprime\n");
+    }
+}
+
+static void signalerReecriture(Peephole *p, const char *raison, int i, const quad *avant) {
+    if (p->out) {
+        fprintf(p->out, "\t %-13s Quad[%d]=", raison, avant->qc);
+        decrireQuad(p->out, avant);
+        fprintf(p->out, " -> ");
+        decrireQuad(p->out, &p->t->quads[i]);
+        fputc('\n', p->out);
+    }
+}
+
+// une suite d'etiquettes devient sa premiere ; retourne le nombre fusionne
+static int fusionnerEtiquettes(Peephole *p) {
+    tableQuads *t = p->t;
+    int fusions = 0, tete = -1;
+    // etiquette de tete de chaque etiquette fusionnee, par indice de quad
+    int *teteDe = (int *)malloc((t->taille + 1) * sizeof(int));
+    if (!teteDe) {
+        return -1;
+    }
+    for (int i = 0; i < t->taille; i++) {
+        teteDe[i] = i;
+        if (p->genre[i] == GENRE_SUPPRIME) {
+            continue;
+        }
+        if (p->genre[i] != GENRE_ETIQUETTE) {
+            tete = -1;
+        } else if (tete < 0) {
+            tete = i;
+        } else {
+            teteDe[i] = tete;
+        }
+    }
+    for (int i = 0; i < t->taille; i++) {
+        if (!estBranchement(p, i)) {
+            continue;
+        }
+        StringId *cible = champCible(p, i);
+        int k = idMapGet(&p->etiquettes, *cible, -1);
+        if (k >= 0 && teteDe[k] != k) {
+            quad avant = t->quads[i];
+            *cible = t->quads[teteDe[k]].operateur;
+            signalerReecriture(p, "etiquettes", i, &avant);
+        }
+    }
+    for (int i = 0; i < t->taille; i++) {
+        if (teteDe[i] != i) {
+            supprimer(p, "etiquettes", i);
+            fusions++;
+        }
+    }
+    free(teteDe);
+    return fusions;
+}
+
+// cibles court-circuitees ; les cycles de BR s'arretent apres taille sauts
+static int courtCircuiter(Peephole *p) {
+    tableQuads *t = p->t;
+    int changes = 0;
+    for (int i = 0; i < t->taille; i++) {
+        if (!estBranchement(p, i)) {
+            continue;
+        }
+        StringId *cible = champCible(p, i);
+        StringId etiquette = *cible;
+        for (int sauts = 0; sauts < t->taille; sauts++) {
+            int d = destination(p, etiquette);
+            if (d < 0 || d >= t->taille || p->genre[d] != GENRE_BR || t->quads[d].resultat == etiquette) {
+                break;
+            }
+            etiquette = t->quads[d].resultat;
+        }
+        if (etiquette != *cible) {
+            quad avant = t->quads[i];
+            *cible = etiquette;
+            signalerReecriture(p, "sauts", i, &avant);
+            changes++;
+        }
+    }
+    return changes;
+}
+
+// BZ L1 ; BR L2 ; L1:  ->  BNZ L2 ; L1:   (et BNZ / BR -> BZ)
+static int inverserConditions(Peephole *p) {
+    tableQuads *t = p->t;
+    int changes = 0;
+    for (int i = 0; i < t->taille; i++) {
+        if (p->genre[i] != GENRE_BZ && p->genre[i] != GENRE_BNZ) {
+            continue;
+        }
+        int j = suivant(p, i);
+        if (j >= t->taille || p->genre[j] != GENRE_BR) {
+            continue;
+        }
+        // une etiquette entre les deux : le BR est vise par ailleurs
+        int etiquette = 0;
+        for (int k = i + 1; k < j; k++) {
+            etiquette |= p->genre[k] == GENRE_ETIQUETTE;
+        }
+        quad *q = &t->quads[i];
+        if (etiquette || destination(p, q->operande1) != suivant(p, j)) {
+            continue;
+        }
+        quad avant = *q;
+        int genre = p->genre[i] == GENRE_BZ ? GENRE_BNZ : GENRE_BZ;
+        q->operateur = genre == GENRE_BZ ? p->bz : p->bnz;
+        q->operande1 = t->quads[j].resultat;
+        p->genre[i] = (unsigned char)genre;
+        signalerReecriture(p, "inversion", i, &avant);
+        supprimer(p, "inversion", j);
+        changes++;
+    }
+    return changes;
+}
+
+// branchement vers l'instruction qui le suit (la condition d'un BZ est un
+// nom ou un litteral : la lire n'a pas d'effet)
+static int supprimerInutiles(Peephole *p) {
+    int supprimes = 0;
+    for (int i = 0; i < p->t->taille; i++) {
+        if (estBranchement(p, i) && p->genre[i] != GENRE_CASE &&
+            destination(p, *champCible(p, i)) == suivant(p, i)) {
+            supprimer(p, "suivant", i);
+            supprimes++;
+        }
+    }
+    return supprimes;
+}
+
+static void compacter(Peephole *p) {
+    tableQuads *t = p->t;
+    int j = 0;
+    for (int i = 0; i < t->taille; i++) {
+        if (p->genre[i] != GENRE_SUPPRIME) {
+            t->quads[j] = t->quads[i];
+            t->quads[j].qc = t->premier + j;
+            j++;
+        }
+    }
+    t->taille = j;
+}
+
+int optimiserBranchements(tableQuads *t, FILE *out, BranchReport *report) {
+    Peephole p;
+    BranchReport local;
+    if (!report) {
+        report = &local;
+    }
+    memset(report, 0, sizeof(*report));
+    int avant = t->taille, status = 0;
+    if (initPeephole(&p, t, out, report) < 0) {
+        freePeephole(&p);
+        return -1;
+    }
+    for (int round = 0; round < PEEPHOLE_MAX_ROUNDS; round++) {
+        int fusions = fusionnerEtiquettes(&p);
+        if (fusions < 0) {
+            status = -1;
+            break;
+        }
+        int sauts = courtCircuiter(&p);
+        int inversions = inverserConditions(&p);
+        int inutiles = supprimerInutiles(&p);
+        report->merged += fusions;
+        report->threaded += sauts;
+        report->inverted += inversions;
+        report->removed += inutiles;
+        if (fusions + sauts + inversions + inutiles == 0) {
+            break;
+        }
+    }
+    compacter(&p);
+    freePeephole(&p);
+    return status < 0 ? -1 : avant - t->taille;
+}
+
+int resoudreEtiquettes(tableQuads *t, BranchReport *report) {
+    Peephole p;
+    if (initPeephole(&p, t, NULL, report) < 0) {
+        freePeephole(&p);
+        return -1;
+    }
+    // indice final du quad qui suit chaque etiquette
+    int garde = 0;
+    for (int i = 0; i < t->taille; i++) {
+        if (p.genre[i] == GENRE_ETIQUETTE) {
+            if (idMapGet(&p.etiquettes, t->quads[i].operateur, -1) == i) {
+                idMapPut(&p.etiquettes, t->quads[i].operateur, garde);
+            }
+            p.genre[i] = GENRE_SUPPRIME;
+            report->labels++;
+        } else {
+            garde++;
+        }
+    }
+    char numero[16];
+    for (int i = 0; i < t->taille; i++) {
+        if (!estBranchement(&p, i)) {
+            continue;
+        }
+        StringId *cible = champCible(&p, i);
+        int k = idMapGet(&p.etiquettes, *cible, -1);
+        // etiquette inconnue : laissee telle quelle, la machine virtuelle la signale
+        if (k >= 0 && indiceCible(t, *cible) < 0) {
+            snprintf(numero, sizeof(numero), "%d", t->premier + k);
+            *cible = internString(numero);
+            report->resolved++;
+        }
+    }
+    int avant = t->taille;
+    compacter(&p);
+    freePeephole(&p);
+    return avant - t->taille;
+}
+
+int retablirEtiquettes(tableQuads *t) {
+    Peephole p;
+    if (initPeephole(&p, t, NULL, NULL) < 0) {
+        freePeephole(&p);
+        return -1;
+    }
+    char *vise = (char *)calloc(t->taille + 1, 1);
+    int ajouts = 0;
+    for (int i = 0; i < t->taille && vise; i++) {
+        int k = estBranchement(&p, i) ? indiceCible(t, *champCible(&p, i)) : -1;
+        if (k >= 0 && !vise[k]) {
+            vise[k] = 1;
+            ajouts++;
+        }
+    }
+    quad *quads = vise && ajouts ? (quad *)malloc((t->taille + ajouts) * sizeof(quad)) : NULL;
+    if (!vise || (ajouts && !quads)) {
+        free(vise);
+        freePeephole(&p);
+        return -1;
+    }
+    if (ajouts == 0) {
+        free(vise);
+        freePeephole(&p);
+        return 0;
+    }
+    char nom[24];
+    for (int i = 0; i < t->taille; i++) {
+        int k = estBranchement(&p, i) ? indiceCible(t, *champCible(&p, i)) : -1;
+        if (k >= 0) {
+            snprintf(nom, sizeof(nom), "Q%d", t->premier + k);
+            *champCible(&p, i) = internString(nom);
+        }
+    }
+    int j = 0;
+    for (int i = 0; i <= t->taille; i++) {
+        if (vise[i]) {
+            snprintf(nom, sizeof(nom), "Q%d", t->premier + i);
+            quad *q = &quads[j++];
+            memset(q, 0, sizeof(*q));
+            q->operateur = internString(nom);
+        }
+        if (i < t->taille) {
+            quads[j++] = t->quads[i];
+        }
+    }
+    for (int i = 0; i < j; i++) {
+        quads[i].qc = t->premier + i;
+    }
+    free(t->quads);
+    t->quads = quads;
+    t->taille = t->capacite = j;
+    free(vise);
+    freePeephole(&p);
+    return ajouts;
+}
@@ -0,0 +1,40 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+#include <stdio.h>
+#include "quadruplets.h"
+
+// Branchements (option -O, a la fin de optimiserQuads).
+//
+// optimiserBranchements travaille sur les etiquettes et repete jusqu'a
+// stabilite :
+//   - etiquettes adjacentes fusionnees (la premiere de la suite reste) ;
+//   - sauts en cascade : un branchement vers "L: BR M" vise directement M ;
+//   - "BZ L1 , , c ; BR L2 ; L1:" devient "BNZ L2 , , c ; L1:" (BNZ saute
+//     si la condition est vraie), et inversement ;
+//   - un branchement vers l'instruction qui le suit disparait (sauf une
+//     entree CASE, dont la position dans la table compte).
+//
+// resoudreEtiquettes supprime ensuite les pseudo-quads d'etiquette : chaque
+// branchement porte le numero (qc) du quad vise, premier + taille pour la
+// fin du programme (voir indiceCible). La machine virtuelle, le bytecode et
+// cfg.h acceptent les deux formes ; retablirEtiquettes revient aux
+// etiquettes ("Q<qc>") avant de supprimer ou deplacer des quads.
+
+typedef struct BranchReport {
+    int merged;         // etiquettes fusionnees
+    int threaded;       // cibles court-circuitees
+    int inverted;       // BZ / BR remplaces par un seul BNZ / BZ
+    int removed;        // branchements vers l'instruction suivante
+    int labels;         // etiquettes supprimees par la resolution
+    int resolved;       // branchements resolus
+} BranchReport;
+
+// chaque changement est decrit sur out (NULL : aucun rapport) ; retourne
+// le nombre de quads supprimes, -1 si la memoire manque
+int optimiserBranchements(tableQuads *t, FILE *out, BranchReport *report);
+int resoudreEtiquettes(tableQuads *t, BranchReport *report);
+// retourne le nombre d'etiquettes ajoutees (quads renumerotes), -1 si la
+// memoire manque
+int retablirEtiquettes(tableQuads *t);
+
+#endif
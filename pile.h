@@ -1,3 +1,5 @@
+#ifndef PILE_H
+#define PILE_H
 #define MAX 128
 
 // pile de tableau
@@ -20,4 +22,6 @@ int depiler(pile *p);
 
 void sommet(pile *p, int *x);
 
-void afficherPile(pile *p);
\ No newline at end of file
+void afficherPile(pile *p);
+
+#endif
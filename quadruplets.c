@@ -1,83 +1,142 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "quadruplets.h"
+#include "stats.h"
+#include "bytecode.h"
 
-quad *creerQuadreplet(char opr[30],char op1[30],char op2[30],char res[30],int num){
-    quad *q = (quad *)malloc(sizeof(quad));
-    strcpy(q->operateur,opr);
-    strcpy(q->operande1,op1);
-    strcpy(q->operande2,op2);
-    strcpy(q->resultat,res);
-    q->qc=num;
-    q->suivant=NULL;
-    return q;
+void initQuads(tableQuads *t){
+    t->quads = NULL;
+    t->taille = 0;
+    t->capacite = 0;
+    t->premier = 1;
+    t->echec = 0;
+    t->stats = NULL;
 }
 
-void insererQuadreplet(quad **p,char opr[],char op1[],char op2[],char res[],int num) {  
-    quad *q;
-    if(*p==NULL){
-        *p=creerQuadreplet(opr,op1,op2,res,num);
-    }else{
-    q = (quad *)malloc(sizeof(quad));
-    strcpy(q->operateur,opr);
-    strcpy(q->operande1,op1);
-    strcpy(q->operande2,op2);
-    strcpy(q->resultat,res);
+// remise a zero sans liberer la memoire (reutilisee pour la compilation suivante)
+void viderQuads(tableQuads *t){
+    t->taille = 0;
+    t->premier = 1;
+    t->echec = 0;
+}
+
+void libererQuads(tableQuads *t){
+    CompileStats *stats = t->stats;
+    free(t->quads);
+    initQuads(t);
+    t->stats = stats;
+}
+
+int insererQuadrepletId(tableQuads *t,StringId opr,StringId op1,StringId op2,StringId res,int num) {
+    int chrono = statsEnabled && t->stats;
+    double debut = chrono ? statsWallClock() : 0;
+    if (t->taille == 0){
+        t->premier = num;
+    }
+    if (t->taille == t->capacite){
+        int capacite = t->capacite ? 2 * t->capacite : QUADS_CAPACITE_INITIALE;
+        quad *quads = (quad *)realloc(t->quads, capacite * sizeof(quad));
+        if (quads == NULL){
+            t->echec = 1;
+            return -1;
+        }
+        t->quads = quads;
+        t->capacite = capacite;
+    }
+    quad *q = &t->quads[t->taille++];
+    q->operateur=opr;
+    q->operande1=op1;
+    q->operande2=op2;
+    q->resultat=res;
     q->qc=num;
-    q->suivant = *p;
-    *p = q;
+    if (chrono){
+        t->stats->wall[PHASE_EMIT] += statsWallClock() - debut;
     }
+    return 0;
 }
 
+int insererQuadreplet(tableQuads *t,const char opr[],const char op1[],const char op2[],const char res[],int num) {
+    return insererQuadrepletId(t,internString(opr),internString(op1),internString(op2),internString(res),num);
+}
 
-void ajouterQuadreplet(quad ** q,quad * nouveauQuadreplet,int num){
-    if(nouveauQuadreplet == NULL)
-        return;
-
-    if (q != NULL){
-        nouveauQuadreplet->qc=num;
-        nouveauQuadreplet->suivant = *q;
+// acces direct au quad numero qc (les numeros sont consecutifs a partir de premier)
+quad *obtenirQuad(tableQuads *t, int qc){
+    int i = qc - t->premier;
+    if (i < 0 || i >= t->taille){
+        return NULL;
     }
-    *q = nouveauQuadreplet;
-}   
+    return &t->quads[i];
+}
 
+int indiceCible(const tableQuads *t, StringId operande){
+    const char *text = internedString(operande);
+    if (!isdigit((unsigned char)text[0])){
+        return -1;
+    }
+    char *fin;
+    long qc = strtol(text, &fin, 10);
+    if (*fin != '\0' || qc < t->premier || qc > (long)t->premier + t->taille){
+        return -1;
+    }
+    return (int)(qc - t->premier);
+}
 
 // mise a jour du quad numero qc dans le quad *(l'ensemble des quadreplets)
-void updateQuadreplet(quad *q, int qc,char num[30]){
-    quad *p = q;
+void updateQuadreplet(tableQuads *t, int qc,const char num[]){
+    quad *p = obtenirQuad(t, qc);
     if (p==NULL){
         return ;
     }
-    while(p!=NULL){
-        if(p->qc==qc){
-            strcpy(p->operande1,num);
-            return ;
-        }
-        p=p->suivant;
-    }
+    p->operande1=internString(num);
 }
 
-void afficherQuadsRecursion(quad * q){
-    if(q == NULL){
-        return;
-    }
-    afficherQuadsRecursion(q->suivant);
-    printf("\t Quad[%d]=[ %s , %s , %s , %s ] \n",q->qc,q->operateur,q->operande1,q->operande2,q->resultat);
-
+void afficherQuad(tableQuads *t)
+{
+    ecrireQuads(stdout, t);
 }
 
-void afficherQuad(quad *q)
+void ecrireQuads(FILE *out, tableQuads *t)
 {
-    quad * p;
-    p = q;
-    printf("\n=============  Affichage des quadruplets =============\n");
-    if (q==NULL){
-        printf("\n\n \t\t quad *Vide \n");
+    fprintf(out, "\n=============  Affichage des quadruplets =============\n");
+    if (t->taille==0){
+        fprintf(out, "\n\n \t\t quad *Vide \n");
     }else{
-        printf("___________________________________________________\n\n");
-        afficherQuadsRecursion(p);
+        fprintf(out, "___________________________________________________\n\n");
+        for (int i = 0; i < t->taille; i++){
+            quad *q = &t->quads[i];
+            fprintf(out, "\t Quad[%d]=[ %s , %s , %s , %s ] \n",q->qc,internedString(q->operateur),
+                   internedString(q->operande1),internedString(q->operande2),internedString(q->resultat));
+        }
     }
-    printf("___________________________________________________\n");
+    fprintf(out, "___________________________________________________\n");
 }
 
+int enregistrerQuad(tableQuads *t, SymbolTable *table, const char chemin[], unsigned mode)
+{
+    char temp[4096];
+    snprintf(temp, sizeof(temp), "%s.tmp-XXXXXX", chemin);
+    int fd = mkstemp(temp);
+    FILE *f = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (f == NULL){
+        if (fd >= 0){
+            close(fd);
+            unlink(temp);
+        }
+        fprintf(stderr, "Erreur: Ne peut pas creer le fichier '%s'\n", chemin);
+        return -1;
+    }
+    // mkstemp cree le fichier en 0600 : droits habituels d'un fichier produit
+    fchmod(fd, mode);
+    int erreur = bytecodeWrite(f, t, table) < 0;
+    erreur |= fclose(f) != 0;
+    if (erreur || rename(temp, chemin) < 0){
+        unlink(temp);
+        fprintf(stderr, "Erreur: Ne peut pas ecrire le fichier '%s'\n", chemin);
+        return -1;
+    }
+    return 0;
+}
@@ -1,27 +1,67 @@
-// la structure QUAD (qui contienne les quadreplets) sera implémentée comme 
-// liste lineare chainée de chaines de caractères
+#ifndef QUADRUPLETS_H
+#define QUADRUPLETS_H
+#include <stdio.h>
+#include "interner.h"
+#include "stats.h"
+
+// la structure QUAD (qui contienne les quadreplets) sera implémentée comme
+// tableau dynamique contigu, indexé directement par le numero du quad (qc).
+// Les champs sont des handles du pool de chaines (voir interner.h)
 typedef struct quad quad;
 struct quad
-{   
-    char operateur[30];
-	char operande1[30];
-	char operande2[30];   
-	char resultat[30];   
+{
+    StringId operateur;
+	StringId operande1;
+	StringId operande2;
+	StringId resultat;
 	int qc;    //it's named qc par convontion
-    struct quad *suivant; // suivant pour liste lineare chainée
 };
 
-// machine abstraite 
+// tableau des quadreplets : ajout en O(1) amorti, acces/mise a jour en O(1)
+typedef struct tableQuads tableQuads;
+struct tableQuads
+{
+    quad *quads;    // zone contigue des quadreplets
+    int taille;     // nombre de quads inseres
+    int capacite;   // nombre de quads alloues
+    int premier;    // numero (qc) du premier quad insere
+    int echec;      // un quad n'a pas pu etre insere (memoire) : programme incomplet
+    CompileStats *stats;    // chronometrage de l'emission (NULL : aucun)
+};
+
+#define QUADS_CAPACITE_INITIALE 64
+
+// machine abstraite
+
+void initQuads(tableQuads * t);
+
+void viderQuads(tableQuads * t);
+
+void libererQuads(tableQuads * t);
+
+// -1 si la memoire manque : le quad n'est pas insere et t->echec reste
+// leve jusqu'a viderQuads
+int insererQuadreplet(tableQuads * t,const char opr[],const char op1[],const char op2[],const char res[],int num);
+
+int insererQuadrepletId(tableQuads * t,StringId opr,StringId op1,StringId op2,StringId res,int num);
 
-quad * creerQuadreplet(char opr[30],char op1[30],char op2[30],char res[30],int num);
+quad * obtenirQuad(tableQuads * t, int qc);
 
-void insererQuadreplet(quad ** p,char opr[],char op1[],char op2[],char res[],int num);
+// cible d'un branchement resolu (operande = numero du quad vise, voir
+// peephole.h) : indice dans t, t->taille pour la fin du programme, -1 si
+// l'operande n'est pas un numero de quad
+int indiceCible(const tableQuads * t, StringId operande);
 
-void updateQuadreplet(quad * q, int qc,char num[30]);
+void updateQuadreplet(tableQuads * t, int qc,const char num[]);
 
-void afficherQuad(quad * q);
+void afficherQuad(tableQuads * t);
 
+void ecrireQuads(FILE * out, tableQuads * t);
 
-void enregistrerQuad(quad * q);
-void ajouterQuadreplet(quad ** q,quad * nouveauQuadreplet,int num);
+// ecriture du programme (quads + table des symboles) au format binaire
+// decrit dans bytecode.h ; remplacement atomique du fichier chemin, cree
+// avec les droits mode (0666 moins l'umask, lu au demarrage : umask()
+// change le masque de tout le processus)
+int enregistrerQuad(tableQuads * t, SymbolTable * table, const char chemin[], unsigned mode);
 
+#endif
@@ -4,183 +4,1105 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
-#define YYERROR return
+#include <math.h>
+#include "interner.h"
+#include "vecteurs.h"
+#include "idmap.h"
 
 
-// fonctions de gestion de liste
+// ---------------------------------------------------------------------------
+// Tableaux
+
+static int typedElements(int elementType) {
+    return elementType == TYPE_INTEGER || elementType == TYPE_FLOAT || elementType == TYPE_BOOLEAN;
+}
+
+static size_t elementSize(int elementType) {
+    switch (elementType) {
+        case TYPE_INTEGER: return sizeof(int64_t);
+        case TYPE_FLOAT:   return sizeof(double);
+        case TYPE_BOOLEAN: return sizeof(bool);
+        default:           return sizeof(char *);
+    }
+}
+
+// tampon de capacity elements ; aligne pour les noyaux de vecteurs.h
+static void *allocateElements(int elementType, size_t capacity) {
+    size_t size = (capacity ? capacity : 1) * elementSize(elementType);
+    if (!typedElements(elementType)) {
+        return malloc(size);
+    }
+    size = (size + VEC_ALIGNMENT - 1) & ~(size_t)(VEC_ALIGNMENT - 1);
+    return aligned_alloc(VEC_ALIGNMENT, size);
+}
+
+static void *arrayBuffer(const ArrayType *arr) {
+    switch (arr->elementType) {
+        case TYPE_INTEGER: return arr->data.i;
+        case TYPE_FLOAT:   return arr->data.f;
+        case TYPE_BOOLEAN: return arr->data.b;
+        default:           return arr->data.text;
+    }
+}
+
+static void setArrayBuffer(ArrayType *arr, void *buffer) {
+    switch (arr->elementType) {
+        case TYPE_INTEGER: arr->data.i = (int64_t *)buffer; break;
+        case TYPE_FLOAT:   arr->data.f = (double *)buffer; break;
+        case TYPE_BOOLEAN: arr->data.b = (bool *)buffer; break;
+        default:           arr->data.text = (char **)buffer; break;
+    }
+}
+
+// valeurs vivantes de l'analyse, une liste par fil de compilation (-j)
+static _Thread_local ArrayType *liveArrays;
+static _Thread_local DictType *liveDicts;
+
+// tableau vide, sans type d'element
 ArrayType* createArray() {
     ArrayType* arr = malloc(sizeof(ArrayType));
     if (!arr) return NULL;
-    
-
     arr->length = 0;
-    arr->capacity = 10;  // Initial capacity
-    arr->data = malloc(arr->capacity * sizeof(char*));
-    
-    if (!arr->data) {
-        free(arr);
-        return NULL;
-    }
-    
+    arr->capacity = 0;
+    arr->elementType = TYPE_UNKNOWN;
+    arr->data.text = NULL;
+    arr->previousLive = NULL;
+    arr->nextLive = liveArrays;
+    if (liveArrays) liveArrays->previousLive = arr;
+    liveArrays = arr;
     return arr;
 }
 
-ArrayType* createArrayFromExprList(ExpressionList* list) {
-    if (!list) return NULL;
-    
-    // Count elements first
-    size_t count = 0;
-    ExpressionList* current = list;
-    while (current) {
-        count++;
-        current = current->next;
+void freeArray(ArrayType *arr) {
+    if (!arr) return;
+    if (arr->previousLive) arr->previousLive->nextLive = arr->nextLive;
+    else liveArrays = arr->nextLive;
+    if (arr->nextLive) arr->nextLive->previousLive = arr->previousLive;
+    if (!typedElements(arr->elementType)) {
+        for (size_t k = 0; k < arr->length; k++) {
+            free(arr->data.text[k]);
+        }
     }
-    
-    // Create array with exact size needed
-    ArrayType* arr = malloc(sizeof(ArrayType));
-    if (!arr) return NULL;
-    
-    arr->length = count;
-    arr->capacity = count;
-    arr->data = malloc(count * sizeof(char*));
-    
-    if (!arr->data) {
-        free(arr);
-        return NULL;
+    free(arrayBuffer(arr));
+    free(arr);
+}
+
+static void arrayElement(const ArrayType *arr, size_t k, expression *e);
+
+// place pour un element de plus, range comme elementType : agrandit le
+// tampon, ou passe du tampon type au texte de chaque element
+static int reserveElement(ArrayType *arr, int elementType) {
+    int sameStorage = arr->elementType == elementType ||
+                      (!typedElements(arr->elementType) && !typedElements(elementType));
+    if (sameStorage && arr->length < arr->capacity) {
+        arr->elementType = elementType;
+        return 0;
+    }
+    size_t capacity = arr->length < arr->capacity ? arr->capacity : arr->capacity ? 2 * arr->capacity : 8;
+    void *buffer = allocateElements(elementType, capacity);
+    if (!buffer) {
+        return -1;
+    }
+    if (sameStorage) {
+        if (arr->length > 0) {
+            memcpy(buffer, arrayBuffer(arr), arr->length * elementSize(elementType));
+        }
+    } else {
+        char **text = (char **)buffer;
+        for (size_t k = 0; k < arr->length; k++) {
+            expression e;
+            char element[64];
+            arrayElement(arr, k, &e);
+            text[k] = strdup(formatValue(&e, element, sizeof(element)));
+            if (!text[k]) {
+                while (k > 0) free(text[--k]);
+                free(buffer);
+                return -1;
+            }
+        }
+    }
+    free(arrayBuffer(arr));
+    arr->elementType = elementType;
+    setArrayBuffer(arr, buffer);
+    arr->capacity = capacity;
+    return 0;
+}
+
+// ajoute le texte d'un element (chaine entre guillemets, tableau, ...)
+static int appendElementText(ArrayType *arr, const char *text, size_t length, int type) {
+    int elementType = arr->length == 0 || arr->elementType == type ? type : TYPE_UNKNOWN;
+    char *copy = strndup(text, length);
+    if (!copy || reserveElement(arr, elementType) < 0) {
+        free(copy);
+        return -1;
     }
-    
-    // Copy values
-    current = list;
-    for (size_t i = 0; i < count && current; i++) {
-        arr->data[i] = strdup(current->expr.value);
-        if (!arr->data[i]) {
-            // Cleanup on failure
-            for (size_t j = 0; j < i; j++) {
-                free(arr->data[j]);
+    arr->data.text[arr->length++] = copy;
+    return 0;
+}
+
+// le tableau reste type tant que ses elements ont tous le meme type
+// entier, reel ou booleen, puis passe au texte
+int appendArrayElement(ArrayType *arr, const expression *e) {
+    if (!typedElements(e->type) || (arr->length > 0 && arr->elementType != e->type)) {
+        if (e->type == TYPE_STRING) {
+            const char *text = internedString(e->as.s);
+            size_t n = strlen(text);
+            char *quoted = malloc(n + 3);
+            if (!quoted) {
+                return -1;
             }
-            free(arr->data);
-            free(arr);
+            quoted[0] = '"';
+            memcpy(quoted + 1, text, n);
+            quoted[n + 1] = '"';
+            int status = appendElementText(arr, quoted, n + 2, TYPE_STRING);
+            free(quoted);
+            return status;
+        }
+        char buffer[64];
+        const char *text = formatValue(e, buffer, sizeof(buffer));
+        return appendElementText(arr, text, strlen(text), e->type);
+    }
+    if (reserveElement(arr, e->type) < 0) {
+        return -1;
+    }
+    switch (e->type) {
+        case TYPE_INTEGER: arr->data.i[arr->length] = e->as.i; break;
+        case TYPE_FLOAT:   arr->data.f[arr->length] = e->as.f; break;
+        default:           arr->data.b[arr->length] = e->as.b; break;
+    }
+    arr->length++;
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Arene de l'analyse et listes d'expressions
+
+#define PARSE_CHUNK_SIZE 65536
+
+struct ParseChunk {
+    ParseChunk *next;
+    size_t used;
+    size_t size;
+    char data[];
+};
+
+void *parseAlloc(ParseArena *arena, size_t size) {
+    size = (size + 7) & ~(size_t)7;
+    ParseChunk *chunk = arena->chunks;
+    if (!chunk || chunk->size - chunk->used < size) {
+        size_t capacity = size > PARSE_CHUNK_SIZE ? size : PARSE_CHUNK_SIZE;
+        chunk = malloc(sizeof(ParseChunk) + capacity);
+        if (!chunk) {
             return NULL;
         }
-        current = current->next;
+        chunk->next = arena->chunks;
+        chunk->used = 0;
+        chunk->size = capacity;
+        arena->chunks = chunk;
     }
-    
-    return arr;
+    void *p = chunk->data + chunk->used;
+    chunk->used += size;
+    return p;
+}
+
+void freeParseArena(ParseArena *arena) {
+    while (arena->chunks) {
+        ParseChunk *next = arena->chunks->next;
+        free(arena->chunks);
+        arena->chunks = next;
+    }
+}
+
+ExpressionList *createExpressionList(ParseArena *arena, const expression *first) {
+    ExpressionList *list = parseAlloc(arena, sizeof(ExpressionList));
+    if (!list) {
+        return NULL;
+    }
+    list->values = createArray();
+    list->keys = NULL;
+    list->keyCapacity = 0;
+    list->places = NULL;
+    list->length = 0;
+    list->capacity = 0;
+    list->constant = true;
+    return list->values ? addExpressionToList(arena, list, first) : NULL;
 }
 
-ExpressionList* createExpressionNode(expression expr) {
-    ExpressionList* node = malloc(sizeof(ExpressionList));
-    if (node) {
-        node->expr = expr;
-        node->next = NULL;
+// ajoute "prefix" puis "text" a la suite des places (prefix vaut "[",
+// "{", "," ...) ; le texte double de taille : les anciens blocs restent
+// dans l'arene
+static int appendPlace(ParseArena *arena, ExpressionList *list, const char *prefix, size_t p,
+                       const char *text, size_t n) {
+    if (list->length + p + n + 1 > list->capacity) {
+        size_t capacity = list->capacity ? 2 * list->capacity : 64;
+        while (capacity < list->length + p + n + 1) capacity *= 2;
+        char *places = parseAlloc(arena, capacity);
+        if (!places) {
+            return -1;
+        }
+        if (list->length > 0) {
+            memcpy(places, list->places, list->length);
+        }
+        list->places = places;
+        list->capacity = capacity;
     }
-    return node;
+    memcpy(list->places + list->length, prefix, p);
+    list->length += p;
+    memcpy(list->places + list->length, text, n);
+    list->length += n;
+    return 0;
 }
 
-ExpressionList* addExpressionToList(ExpressionList* list, expression expr) {
+ExpressionList *addExpressionToList(ParseArena *arena, ExpressionList *list, const expression *expr) {
+    const char *prefix = list->length == 0 ? "[" : ",";
+    if (appendArrayElement(list->values, expr) < 0 ||
+        appendPlace(arena, list, prefix, 1, internedString(expr->place), internedLength(expr->place)) < 0) {
+        return NULL;
+    }
+    list->constant = list->constant && expr->constant;
+    return list;
+}
+
+ExpressionList *createDictItems(ParseArena *arena, StringId key, const expression *first) {
+    ExpressionList *list = parseAlloc(arena, sizeof(ExpressionList));
     if (!list) {
-        return createExpressionNode(expr);
+        return NULL;
+    }
+    list->values = createArray();
+    list->keys = NULL;
+    list->keyCapacity = 0;
+    list->places = NULL;
+    list->length = 0;
+    list->capacity = 0;
+    list->constant = true;
+    return list->values ? addDictItem(arena, list, key, first) : NULL;
+}
+
+// place "cle":valeur ; les cles vont dans un tableau de l'arene qui double
+// comme le texte
+ExpressionList *addDictItem(ParseArena *arena, ExpressionList *list, StringId key, const expression *expr) {
+    size_t count = list->values->length;
+    if (count == list->keyCapacity) {
+        size_t capacity = list->keyCapacity ? 2 * list->keyCapacity : 16;
+        StringId *keys = parseAlloc(arena, capacity * sizeof(StringId));
+        if (!keys) {
+            return NULL;
+        }
+        if (count > 0) {
+            memcpy(keys, list->keys, count * sizeof(StringId));
+        }
+        list->keys = keys;
+        list->keyCapacity = capacity;
     }
-    ExpressionList* current = list;
-    while (current->next != NULL) {
-        current = current->next;
+    const char *text = internedString(key);
+    if (appendArrayElement(list->values, expr) < 0 ||
+        appendPlace(arena, list, count == 0 ? "{\"" : ",\"", 2, text, strlen(text)) < 0 ||
+        appendPlace(arena, list, "\":", 2, internedString(expr->place), internedLength(expr->place)) < 0) {
+        return NULL;
     }
-    current->next = createExpressionNode(expr);
+    list->keys[count] = key;
+    list->constant = list->constant && expr->constant;
     return list;
 }
 
+// les valeurs sont reprises a items (comme ArrayLiteral), les cles copiees
+DictType *createDict(const ExpressionList *items) {
+    DictType *dict = malloc(sizeof(DictType));
+    if (!dict) {
+        return NULL;
+    }
+    dict->length = items ? items->values->length : 0;
+    dict->keys = malloc((dict->length ? dict->length : 1) * sizeof(StringId));
+    dict->values = items ? items->values : createArray();
+    if (!dict->keys || !dict->values) {
+        free(dict->keys);
+        free(dict);
+        return NULL;
+    }
+    if (dict->length > 0) {
+        memcpy(dict->keys, items->keys, dict->length * sizeof(StringId));
+    }
+    dict->previousLive = NULL;
+    dict->nextLive = liveDicts;
+    if (liveDicts) liveDicts->previousLive = dict;
+    liveDicts = dict;
+    return dict;
+}
+
+void freeDict(DictType *dict) {
+    if (!dict) return;
+    if (dict->previousLive) dict->previousLive->nextLive = dict->nextLive;
+    else liveDicts = dict->nextLive;
+    if (dict->nextLive) dict->nextLive->previousLive = dict->previousLive;
+    freeArray(dict->values);
+    free(dict->keys);
+    free(dict);
+}
+
+// valeur par defaut d'une variable du type donne, ou inputValue tel quel
+// (deja mis en forme par formatValue) pour stockage dans la table des symboles
+void createValueString(int type, const char *inputValue, char *valueStr) {
+    if (inputValue != NULL && inputValue[0] != '\0') {
+        strncpy(valueStr, inputValue, MAX_VALUE_LENGTH - 1);
+        valueStr[MAX_VALUE_LENGTH - 1] = '\0';
+        return;
+    }
+    switch (type) {
+        case TYPE_INTEGER: strcpy(valueStr, "0"); break;
+        case TYPE_FLOAT:   strcpy(valueStr, "0.0"); break;
+        case TYPE_BOOLEAN: strcpy(valueStr, "false"); break;
+        case TYPE_STRING:  strcpy(valueStr, ""); break;
+        case TYPE_ARRAY:   strcpy(valueStr, "[]"); break;
+        case TYPE_DICT:    strcpy(valueStr, "{}"); break;
+        default:
+            fprintf(stderr, "Error: Unsupported type %d in createValueString\n", type);
+            valueStr[0] = '\0';
+            break;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Valeurs <-> texte
 
+// plus courte ecriture qui relit le meme double ; garde toujours le point
+// pour rester distincte d'un entier
+static void formatReal(double f, char *buffer, size_t size) {
+    snprintf(buffer, size, "%.15g", f);
+    if (strtod(buffer, NULL) != f) {
+        snprintf(buffer, size, "%.17g", f);
+    }
+    if (!strpbrk(buffer, ".eEni")) {
+        strncat(buffer, ".0", size - strlen(buffer) - 1);
+    }
+}
 
-// conversion vers chaine de caractères de la valeur et type pour stockage dans table des symboles
+// "[e1,e2,...]" (ou "{"k1":e1,...}" avec keys) sans limite de longueur,
+// chaines entre guillemets ; retourne la chaine internee
+static const char *formatItems(const ArrayType *arr, const StringId *keys, char open, char close) {
+    size_t length = 1, capacity = 64;
+    char *text = malloc(capacity);
+    if (!text) {
+        return open == '[' ? "[]" : "{}";
+    }
+    text[0] = open;
+    for (size_t k = 0; arr && k < arr->length; k++) {
+        char element[64];
+        const char *item;
+        if (typedElements(arr->elementType)) {
+            expression e;
+            arrayElement(arr, k, &e);
+            item = formatValue(&e, element, sizeof(element));
+        } else {
+            item = arr->data.text[k];
+        }
+        const char *key = keys ? internedString(keys[k]) : "";
+        size_t n = strlen(item), m = keys ? strlen(key) + 3 : 0;
+        if (length + m + n + 2 > capacity) {
+            while (length + m + n + 2 > capacity) capacity *= 2;
+            char *grown = realloc(text, capacity);
+            if (!grown) {
+                break;
+            }
+            text = grown;
+        }
+        if (k > 0) {
+            text[length++] = ',';
+        }
+        if (keys) {
+            text[length++] = '"';
+            memcpy(text + length, key, m - 3);
+            length += m - 3;
+            text[length++] = '"';
+            text[length++] = ':';
+        }
+        memcpy(text + length, item, n);
+        length += n;
+    }
+    text[length++] = close;
+    const char *result = internedString(internStringN(text, length));
+    free(text);
+    return result;
+}
+
+static const char *formatArray(const ArrayType *arr) {
+    return formatItems(arr, NULL, '[', ']');
+}
+
+static const char *formatDict(const DictType *dict) {
+    return dict ? formatItems(dict->values, dict->keys, '{', '}') : "{}";
+}
 
-void getTypeString(int type, char *typeStr) {
-    switch(type) {
+// texte de la valeur tel que l'affiche la table des symboles ; retourne
+// buffer, ou directement la chaine internee pour TYPE_STRING, TYPE_ARRAY et
+// TYPE_DICT
+const char *formatValue(const expression *expr, char *buffer, size_t size) {
+    switch (expr->type) {
         case TYPE_INTEGER:
-            strcpy(typeStr, "int");
-            break;
+            snprintf(buffer, size, "%lld", (long long)expr->as.i);
+            return buffer;
         case TYPE_FLOAT:
-            strcpy(typeStr, "float");
-            break;
+            formatReal(expr->as.f, buffer, size);
+            return buffer;
         case TYPE_BOOLEAN:
-            strcpy(typeStr, "bool");
-            break;
+            return expr->as.b ? "true" : "false";
         case TYPE_STRING:
-            strcpy(typeStr, "string");
-            break;
+            return internedString(expr->as.s);
         case TYPE_ARRAY:
-            strcpy(typeStr, "array");
+            return formatArray(expr->as.a);
+        case TYPE_DICT:
+            return formatDict(expr->as.d);
+        default:
+            return "{}";
+    }
+}
+
+// valeur d'un element ecrit par formatArray : entier, reel, booleen,
+// chaine entre guillemets, tableau ou dictionnaire
+static void parseElement(const char *text, size_t length, expression *e) {
+    memset(&e->as, 0, sizeof(e->as));
+    if (length >= 2 && text[0] == '"') {
+        e->type = TYPE_STRING;
+        e->as.s = internStringN(text + 1, length - 2);
+    } else if (text[0] == '[') {
+        e->type = TYPE_ARRAY;
+    } else if (text[0] == '{') {
+        e->type = TYPE_DICT;
+    } else if (length == 4 && strncmp(text, "true", 4) == 0) {
+        e->type = TYPE_BOOLEAN;
+        e->as.b = true;
+    } else if (length == 5 && strncmp(text, "false", 5) == 0) {
+        e->type = TYPE_BOOLEAN;
+    } else if (memchr(text, '.', length) || memchr(text, 'e', length) || memchr(text, 'E', length) ||
+               memchr(text, 'n', length) || memchr(text, 'i', length)) {
+        e->type = TYPE_FLOAT;
+        e->as.f = strtod(text, NULL);
+    } else if (length > 0) {
+        e->type = TYPE_INTEGER;
+        e->as.i = strtoll(text, NULL, 10);
+    } else {
+        e->type = TYPE_UNKNOWN;
+    }
+}
+
+// element k ; un element range en texte est relu par parseElement (un
+// tableau ou dictionnaire imbrique n'y est pas reconstruit : seul son type
+// est donne)
+static void arrayElement(const ArrayType *arr, size_t k, expression *e) {
+    switch (arr->elementType) {
+        case TYPE_INTEGER: e->type = TYPE_INTEGER; e->as.i = arr->data.i[k]; break;
+        case TYPE_FLOAT:   e->type = TYPE_FLOAT;   e->as.f = arr->data.f[k]; break;
+        case TYPE_BOOLEAN: e->type = TYPE_BOOLEAN; e->as.b = arr->data.b[k]; break;
+        default:
+            parseElement(arr->data.text[k], strlen(arr->data.text[k]), e);
             break;
-        case TYPE_DICT:     
-            strcpy(typeStr, "dict");
+    }
+}
+
+// fin de l'element qui commence en p : virgule ou crochet (accolade)
+// fermant de premier niveau, hors guillemets
+static const char *itemEnd(const char *p) {
+    int depth = 0;
+    bool quoted = false;
+    while (*p && (quoted || depth > 0 || (*p != ',' && *p != ']' && *p != '}'))) {
+        if (*p == '"') {
+            quoted = !quoted;
+        } else if (!quoted) {
+            depth += (*p == '[' || *p == '{') - (*p == ']' || *p == '}');
+        }
+        p++;
+    }
+    return p;
+}
+
+static int appendParsedElement(ArrayType *arr, const char *text, size_t length) {
+    expression e;
+    parseElement(text, length, &e);
+    return typedElements(e.type) ? appendArrayElement(arr, &e) : appendElementText(arr, text, length, e.type);
+}
+
+// elements de premier niveau de "[a,"b,c",[d,e]]" (virgules hors crochets
+// et hors guillemets)
+static ArrayType *parseArray(const char *text) {
+    ArrayType *arr = createArray();
+    if (!arr || text[0] != '[') {
+        return arr;
+    }
+    const char *p = text + 1;
+    while (*p && *p != ']') {
+        const char *start = p;
+        p = itemEnd(p);
+        if (appendParsedElement(arr, start, p - start) < 0) {
             break;
-        default:
-            printf("Unsupported type returned by getTypeString %d\n", type);
-            yyerror("Unsupported type returned by getTypeString");
-            YYERROR;
+        }
+        if (*p == ',') {
+            p++;
+        }
     }
+    return arr;
 }
-void createValueString(int type, const char *inputValue, char *valueStr) {
-    if (inputValue == NULL || strlen(inputValue) == 0) {
-        // Handle case when there is no value by setting defaults
-        
-        switch(type) {
-            case TYPE_INTEGER:
-                snprintf(valueStr, MAX_VALUE_LENGTH, "%d", 0);
-                break;
-            case TYPE_FLOAT:
-                snprintf(valueStr, MAX_VALUE_LENGTH, "%.2f", 0.0);
-                break;
-            case TYPE_BOOLEAN:
-                strncpy(valueStr, "false", MAX_VALUE_LENGTH - 1);
-                valueStr[MAX_VALUE_LENGTH - 1] = '\0';
-                break;
-            case TYPE_STRING:
-                strncpy(valueStr, "", MAX_VALUE_LENGTH - 1);
-                valueStr[MAX_VALUE_LENGTH - 1] = '\0';
-                break;
-            case TYPE_ARRAY:
-                strncpy(valueStr, "[]", MAX_VALUE_LENGTH - 1);
-                valueStr[MAX_VALUE_LENGTH - 1] = '\0';
-                break;
-            case TYPE_DICT:     
-                strncpy(valueStr, "{}", MAX_VALUE_LENGTH - 1);
-                valueStr[MAX_VALUE_LENGTH - 1] = '\0';
-                break;
-            default:
-                yyerror("Unsupported type returned by createValueString 1");
-                
-                YYERROR;
+
+// "{"k1":v1,"k2":v2}" tel que l'ecrit formatDict
+static DictType *parseDict(const char *text) {
+    DictType *dict = createDict(NULL);
+    if (!dict || text[0] != '{') {
+        return dict;
+    }
+    size_t capacity = 1;
+    const char *p = text + 1;
+    while (*p == '"') {
+        const char *key = p + 1;
+        const char *colon = strchr(key, '"');
+        if (!colon || colon[1] != ':') {
+            break;
         }
-    } else {
-        switch(type) {
-            case TYPE_INTEGER:
-                snprintf(valueStr, MAX_VALUE_LENGTH, "%d", atoi(inputValue));
-                break;
-            case TYPE_FLOAT:
-                snprintf(valueStr, MAX_VALUE_LENGTH, "%.2f", atof(inputValue));
-                break;
-            case TYPE_BOOLEAN:
-                strncpy(valueStr, inputValue, MAX_VALUE_LENGTH - 1);
-                valueStr[MAX_VALUE_LENGTH - 1] = '\0';
-                break;
-            case TYPE_STRING:
-                strncpy(valueStr, inputValue, MAX_VALUE_LENGTH - 1);
-                valueStr[MAX_VALUE_LENGTH - 1] = '\0';
-                break;
-            case TYPE_ARRAY:
-                strncpy(valueStr, inputValue, MAX_VALUE_LENGTH - 1);
-                valueStr[MAX_VALUE_LENGTH - 1] = '\0';
-                break;
-            case TYPE_DICT:     
-                strncpy(valueStr, inputValue, MAX_VALUE_LENGTH - 1);
-                valueStr[MAX_VALUE_LENGTH - 1] = '\0';
+        p = itemEnd(colon + 2);
+        if (dict->length == capacity) {
+            StringId *keys = realloc(dict->keys, 2 * capacity * sizeof(StringId));
+            if (!keys) {
                 break;
-            default:
-                yyerror("Unsupported type returned by createValueString 2");
-                
-                YYERROR;
+            }
+            dict->keys = keys;
+            capacity *= 2;
+        }
+        if (appendParsedElement(dict->values, colon + 2, p - colon - 2) < 0) {
+            break;
+        }
+        dict->keys[dict->length++] = internStringN(key, colon - key);
+        if (*p == ',') {
+            p++;
+        }
+    }
+    return dict;
+}
+
+// Dernier dictionnaire relu par parseValue. Un dictionnaire est relu a
+// chaque utilisation de son nom : le cache evite de relire un grand texte
+// (meme chaine internee, meme pointeur) et donne l'entree d'une cle par une
+// table StringId -> indice. Les dictionnaires remplaces ne sont rendus
+// qu'a la fin du fichier (une expression peut encore les designer), comme
+// les autres valeurs relues. Un cache par fil de compilation (-j) ; il ne
+// vaut que pour la generation du pool ou il a ete rempli (internerRelease
+// rend les chaines)
+typedef struct DictCache {
+    const char *text;
+    DictType *dict;
+    IdMap index;
+    unsigned generation;
+} DictCache;
+
+static _Thread_local DictCache dictCache;
+
+static DictType *cachedDict(const char *text) {
+    if (dictCache.dict && dictCache.text == text && dictCache.generation == internerGeneration()) {
+        return dictCache.dict;
+    }
+    DictType *dict = parseDict(text);
+    if (!dict) {
+        return NULL;
+    }
+    freeIdMap(&dictCache.index);
+    dictCache.text = NULL;
+    dictCache.dict = NULL;
+    if (initIdMap(&dictCache.index, (uint32_t)dict->length) == 0) {
+        for (size_t k = 0; k < dict->length; k++) {
+            idMapPut(&dictCache.index, dict->keys[k], (int32_t)k);
+        }
+        dictCache.text = text;
+        dictCache.dict = dict;
+        dictCache.generation = internerGeneration();
+    }
+    return dict;
+}
+
+// fin du fichier : les valeurs des dictionnaires sont dans liveArrays
+void freeParseValues(void) {
+    while (liveDicts) {
+        DictType *dict = liveDicts;
+        liveDicts = dict->nextLive;
+        free(dict->keys);
+        free(dict);
+    }
+    while (liveArrays) {
+        freeArray(liveArrays);
+    }
+    freeIdMap(&dictCache.index);
+    dictCache.text = NULL;
+    dictCache.dict = NULL;
+}
+
+// indice de la cle dans dict, dict->length si elle est absente
+static size_t dictKey(const DictType *dict, StringId key) {
+    if (dict == dictCache.dict) {
+        int32_t k = idMapGet(&dictCache.index, key, -1);
+        return k >= 0 ? (size_t)k : dict->length;
+    }
+    size_t k = 0;
+    while (k < dict->length && dict->keys[k] != key) {
+        k++;
+    }
+    return k;
+}
+
+// relit la valeur d'une variable depuis la table des symboles
+void parseValue(int type, const char *text, expression *expr) {
+    expr->type = type;
+    memset(&expr->as, 0, sizeof(expr->as));
+    switch (type) {
+        case TYPE_INTEGER: expr->as.i = strtoll(text, NULL, 10); break;
+        case TYPE_FLOAT:   expr->as.f = strtod(text, NULL); break;
+        case TYPE_BOOLEAN: expr->as.b = strcmp(text, "true") == 0; break;
+        case TYPE_STRING:  expr->as.s = internString(text); break;
+        case TYPE_ARRAY:   expr->as.a = parseArray(text); break;
+        case TYPE_DICT:    expr->as.d = cachedDict(text); break;
+        default: break;
+    }
+}
+
+// operande litteral d'un quad : les chaines sont entre guillemets (sans
+// limite de longueur), les reels gardent toujours leur point pour rester
+// distincts des entiers. STRING_ID_NONE si la memoire manque
+StringId valuePlace(const expression *expr) {
+    char buffer[256];
+    if (expr->type != TYPE_STRING) {
+        return internString(formatValue(expr, buffer, sizeof(buffer)));
+    }
+    size_t n = internedLength(expr->as.s);
+    char *place = n + 2 <= sizeof(buffer) ? buffer : (char *)malloc(n + 2);
+    if (!place) {
+        return STRING_ID_NONE;
+    }
+    place[0] = '"';
+    memcpy(place + 1, internedString(expr->as.s), n);
+    place[n + 1] = '"';
+    StringId id = internStringN(place, n + 2);
+    if (place != buffer) {
+        free(place);
+    }
+    return id;
+}
+
+// ---------------------------------------------------------------------------
+// Repliement des constantes
+//
+// Une seule table (operateur, type gauche, type droit) donne le type du
+// resultat, l'operateur du quad et la fonction qui calcule la valeur. Les
+// calculs suivent la machine virtuelle (vm.c) : entiers sur 64 bits modulo
+// 2^64, "/" toujours reel, "//" et "%" entiers meme sur des reels.
+
+typedef const char *(*FoldFunction)(FoldOperator op, const expression *lhs, const expression *rhs,
+                                    expression *result);
+
+typedef struct FoldRule {
+    signed char resultType;
+    const char *quadOperator;
+    FoldFunction fold;          // NULL : combinaison de types refusee
+} FoldRule;
+
+static const char *const foldSymbols[FOLD_COUNT] = {
+    [FOLD_ADD] = "+",   [FOLD_SUB] = "-",   [FOLD_MUL] = "*",   [FOLD_DIV] = "/",
+    [FOLD_IDIV] = "//", [FOLD_MOD] = "%",   [FOLD_EQ] = "==",   [FOLD_NE] = "!=",
+    [FOLD_LT] = "<",    [FOLD_GT] = ">",    [FOLD_LE] = "<=",   [FOLD_GE] = ">=",
+    [FOLD_AND] = "and", [FOLD_OR] = "or",   [FOLD_NOT] = "not", [FOLD_NEG] = "-",
+    [FOLD_SUM] = "sum", [FOLD_MIN] = "min", [FOLD_MAX] = "max", [FOLD_INDEX] = "[]",
+};
+
+static inline int64_t wrapAdd(int64_t x, int64_t y) { return (int64_t)((uint64_t)x + (uint64_t)y); }
+static inline int64_t wrapSub(int64_t x, int64_t y) { return (int64_t)((uint64_t)x - (uint64_t)y); }
+static inline int64_t wrapMul(int64_t x, int64_t y) { return (int64_t)((uint64_t)x * (uint64_t)y); }
+
+static inline double realOf(const expression *e) {
+    return e->type == TYPE_FLOAT ? e->as.f : (double)e->as.i;
+}
+
+static bool compareResult(FoldOperator op, int c) {
+    switch (op) {
+        case FOLD_EQ: return c == 0;
+        case FOLD_NE: return c != 0;
+        case FOLD_LT: return c < 0;
+        case FOLD_GT: return c > 0;
+        case FOLD_LE: return c <= 0;
+        default:      return c >= 0;
+    }
+}
+
+static const char *foldIntegers(FoldOperator op, const expression *lhs, const expression *rhs,
+                                expression *result) {
+    int64_t x = lhs->as.i, y = rhs->as.i;
+    switch (op) {
+        case FOLD_ADD: result->as.i = wrapAdd(x, y); return NULL;
+        case FOLD_SUB: result->as.i = wrapSub(x, y); return NULL;
+        case FOLD_MUL: result->as.i = wrapMul(x, y); return NULL;
+        case FOLD_IDIV:
+        case FOLD_MOD:
+            if (y == 0) {
+                return op == FOLD_MOD ? "Modulo by zero error" : "Division by zero error";
+            }
+            if (y == -1) {
+                result->as.i = op == FOLD_MOD ? 0 : wrapSub(0, x);
+            } else {
+                result->as.i = op == FOLD_MOD ? x % y : x / y;
+            }
+            return NULL;
+        case FOLD_NEG: result->as.i = wrapSub(0, x); return NULL;
+        default:
+            result->as.b = compareResult(op, (x > y) - (x < y));
+            return NULL;
+    }
+}
+
+// au moins un reel, ou "/" : calcul en double
+static const char *foldReals(FoldOperator op, const expression *lhs, const expression *rhs,
+                             expression *result) {
+    double x = realOf(lhs), y = realOf(rhs);
+    switch (op) {
+        case FOLD_ADD: result->as.f = x + y; return NULL;
+        case FOLD_SUB: result->as.f = x - y; return NULL;
+        case FOLD_MUL: result->as.f = x * y; return NULL;
+        case FOLD_NEG: result->as.f = -x; return NULL;
+        case FOLD_DIV:
+            if (y == 0) {
+                return "Division by zero error";
+            }
+            result->as.f = x / y;
+            return NULL;
+        case FOLD_IDIV:
+        case FOLD_MOD: {
+            if (y == 0) {
+                return op == FOLD_MOD ? "Modulo by zero error" : "Division by zero error";
+            }
+            double q = op == FOLD_MOD ? fmod(x, y) : trunc(x / y);
+            if (!(q > -9.2e18 && q < 9.2e18)) {
+                return "Integer overflow in constant expression";
+            }
+            result->as.i = (int64_t)q;
+            return NULL;
+        }
+        default:
+            // NaN : seule la difference est vraie
+            if (x != x || y != y) {
+                result->as.b = op == FOLD_NE;
+            } else {
+                result->as.b = compareResult(op, (x > y) - (x < y));
+            }
+            return NULL;
+    }
+}
+
+static const char *foldStrings(FoldOperator op, const expression *lhs, const expression *rhs,
+                               expression *result) {
+    const char *x = internedString(lhs->as.s);
+    const char *y = internedString(rhs->as.s);
+    if (op != FOLD_ADD) {
+        result->as.b = compareResult(op, strcmp(x, y));
+        return NULL;
+    }
+    size_t n = strlen(x), m = strlen(y);
+    char *text = malloc(n + m + 1);
+    if (!text) {
+        return "Out of memory";
+    }
+    memcpy(text, x, n);
+    memcpy(text + n, y, m + 1);
+    result->as.s = internStringN(text, n + m);
+    free(text);
+    return NULL;
+}
+
+static const char *foldBooleans(FoldOperator op, const expression *lhs, const expression *rhs,
+                                expression *result) {
+    bool x = lhs->as.b, y = rhs->as.b;
+    switch (op) {
+        case FOLD_AND: result->as.b = x && y; break;
+        case FOLD_OR:  result->as.b = x || y; break;
+        case FOLD_NOT: result->as.b = !x; break;
+        case FOLD_EQ:  result->as.b = x == y; break;
+        default:       result->as.b = x != y; break;
+    }
+    return NULL;
+}
+
+// operations sur les tableaux : element par element avec les regles
+// scalaires ci-dessus, un scalaire etant repete sur toute la longueur
+static const char *foldArrays(FoldOperator op, const expression *lhs, const expression *rhs,
+                              expression *result);
+static const char *foldReduction(FoldOperator op, const expression *lhs, const expression *rhs,
+                                 expression *result);
+static const char *foldIndex(FoldOperator op, const expression *lhs, const expression *rhs,
+                             expression *result);
+
+#define RULE(op, lhs, rhs, type, quad, fold) [op][lhs][rhs] = {type, quad, fold}
+
+// operations numeriques : entier si les deux operandes le sont
+#define ARITHMETIC(op, quad) \
+    RULE(op, TYPE_INTEGER, TYPE_INTEGER, TYPE_INTEGER, quad, foldIntegers), \
+    RULE(op, TYPE_INTEGER, TYPE_FLOAT, TYPE_FLOAT, quad, foldReals), \
+    RULE(op, TYPE_FLOAT, TYPE_INTEGER, TYPE_FLOAT, quad, foldReals), \
+    RULE(op, TYPE_FLOAT, TYPE_FLOAT, TYPE_FLOAT, quad, foldReals)
+
+// type du resultat fixe quels que soient les operandes numeriques
+#define NUMERIC(op, type, quad, integers) \
+    RULE(op, TYPE_INTEGER, TYPE_INTEGER, type, quad, integers), \
+    RULE(op, TYPE_INTEGER, TYPE_FLOAT, type, quad, foldReals), \
+    RULE(op, TYPE_FLOAT, TYPE_INTEGER, type, quad, foldReals), \
+    RULE(op, TYPE_FLOAT, TYPE_FLOAT, type, quad, foldReals)
+
+#define ORDERING(op, quad) \
+    NUMERIC(op, TYPE_BOOLEAN, quad, foldIntegers), \
+    RULE(op, TYPE_STRING, TYPE_STRING, TYPE_BOOLEAN, quad, foldStrings)
+
+#define EQUALITY(op, quad) \
+    ORDERING(op, quad), \
+    RULE(op, TYPE_BOOLEAN, TYPE_BOOLEAN, TYPE_BOOLEAN, quad, foldBooleans)
+
+#define ELEMENTWISE(op, quad) \
+    RULE(op, TYPE_ARRAY, TYPE_ARRAY, TYPE_ARRAY, quad, foldArrays), \
+    RULE(op, TYPE_ARRAY, TYPE_INTEGER, TYPE_ARRAY, quad, foldArrays), \
+    RULE(op, TYPE_ARRAY, TYPE_FLOAT, TYPE_ARRAY, quad, foldArrays), \
+    RULE(op, TYPE_ARRAY, TYPE_BOOLEAN, TYPE_ARRAY, quad, foldArrays), \
+    RULE(op, TYPE_INTEGER, TYPE_ARRAY, TYPE_ARRAY, quad, foldArrays), \
+    RULE(op, TYPE_FLOAT, TYPE_ARRAY, TYPE_ARRAY, quad, foldArrays), \
+    RULE(op, TYPE_BOOLEAN, TYPE_ARRAY, TYPE_ARRAY, quad, foldArrays)
+
+// les operateurs unaires sont ranges avec le type de l'operande des deux cotes
+static const FoldRule foldRules[FOLD_COUNT][TYPE_DICT + 1][TYPE_DICT + 1] = {
+    ARITHMETIC(FOLD_ADD, "+"),
+    RULE(FOLD_ADD, TYPE_STRING, TYPE_STRING, TYPE_STRING, "CONCAT", foldStrings),
+    ARITHMETIC(FOLD_SUB, "-"),
+    ARITHMETIC(FOLD_MUL, "*"),
+    NUMERIC(FOLD_DIV, TYPE_FLOAT, "/", foldReals),
+    NUMERIC(FOLD_IDIV, TYPE_INTEGER, "DIV", foldIntegers),
+    NUMERIC(FOLD_MOD, TYPE_INTEGER, "MOD", foldIntegers),
+    EQUALITY(FOLD_EQ, "=="),
+    EQUALITY(FOLD_NE, "!="),
+    ORDERING(FOLD_LT, "<"),
+    ORDERING(FOLD_GT, ">"),
+    ORDERING(FOLD_LE, "<="),
+    ORDERING(FOLD_GE, ">="),
+    RULE(FOLD_AND, TYPE_BOOLEAN, TYPE_BOOLEAN, TYPE_BOOLEAN, "AND", foldBooleans),
+    RULE(FOLD_OR, TYPE_BOOLEAN, TYPE_BOOLEAN, TYPE_BOOLEAN, "OR", foldBooleans),
+    RULE(FOLD_NOT, TYPE_BOOLEAN, TYPE_BOOLEAN, TYPE_BOOLEAN, "NOT", foldBooleans),
+    RULE(FOLD_NEG, TYPE_INTEGER, TYPE_INTEGER, TYPE_INTEGER, "UMINUS", foldIntegers),
+    RULE(FOLD_NEG, TYPE_FLOAT, TYPE_FLOAT, TYPE_FLOAT, "UMINUS", foldReals),
+    ELEMENTWISE(FOLD_ADD, "VADD"),
+    ELEMENTWISE(FOLD_SUB, "VSUB"),
+    ELEMENTWISE(FOLD_MUL, "VMUL"),
+    ELEMENTWISE(FOLD_DIV, "VDIV"),
+    ELEMENTWISE(FOLD_IDIV, "VIDIV"),
+    ELEMENTWISE(FOLD_MOD, "VMOD"),
+    ELEMENTWISE(FOLD_EQ, "VEQ"),
+    ELEMENTWISE(FOLD_NE, "VNE"),
+    ELEMENTWISE(FOLD_LT, "VLT"),
+    ELEMENTWISE(FOLD_GT, "VGT"),
+    ELEMENTWISE(FOLD_LE, "VLE"),
+    ELEMENTWISE(FOLD_GE, "VGE"),
+    ELEMENTWISE(FOLD_AND, "VAND"),
+    ELEMENTWISE(FOLD_OR, "VOR"),
+    RULE(FOLD_NOT, TYPE_ARRAY, TYPE_ARRAY, TYPE_ARRAY, "VNOT", foldArrays),
+    RULE(FOLD_NEG, TYPE_ARRAY, TYPE_ARRAY, TYPE_ARRAY, "VNEG", foldArrays),
+    // type du resultat donne par les elements (TYPE_UNKNOWN pour les quads)
+    RULE(FOLD_SUM, TYPE_ARRAY, TYPE_ARRAY, TYPE_UNKNOWN, "SUM", foldReduction),
+    RULE(FOLD_MIN, TYPE_ARRAY, TYPE_ARRAY, TYPE_UNKNOWN, "MIN", foldReduction),
+    RULE(FOLD_MAX, TYPE_ARRAY, TYPE_ARRAY, TYPE_UNKNOWN, "MAX", foldReduction),
+    // type de la valeur trouvee (voir foldIndex)
+    RULE(FOLD_INDEX, TYPE_DICT, TYPE_STRING, TYPE_UNKNOWN, "INDEX", foldIndex),
+};
+
+static const FoldRule *foldRule(FoldOperator op, int lhsType, int rhsType) {
+    if (op < 0 || op >= FOLD_COUNT || lhsType < 0 || lhsType > TYPE_DICT ||
+        rhsType < 0 || rhsType > TYPE_DICT) {
+        return NULL;
+    }
+    const FoldRule *rule = &foldRules[op][lhsType][rhsType];
+    return rule->fold ? rule : NULL;
+}
+
+static int scalarElement(int type) {
+    return type == TYPE_INTEGER || type == TYPE_FLOAT || type == TYPE_BOOLEAN;
+}
+
+static const char *foldArrays(FoldOperator op, const expression *lhs, const expression *rhs,
+                              expression *result) {
+    const ArrayType *a = lhs->type == TYPE_ARRAY ? lhs->as.a : NULL;
+    const ArrayType *b = rhs->type == TYPE_ARRAY ? rhs->as.a : NULL;
+    size_t n = a ? a->length : b->length;
+    if (a && b && a->length != b->length) {
+        return "Array length mismatch error";
+    }
+    ArrayType *arr = createArray();
+    if (!arr) {
+        return "Out of memory";
+    }
+    for (size_t k = 0; k < n; k++) {
+        expression x = *lhs, y = *rhs, z;
+        if (a) arrayElement(a, k, &x);
+        if (b) arrayElement(b, k, &y);
+        const FoldRule *rule = foldRule(op, x.type, op >= FOLD_NOT ? x.type : y.type);
+        if (!scalarElement(x.type) || !scalarElement(y.type) || !rule) {
+            freeArray(arr);
+            return "Type mismatch: array elements do not support this operator";
+        }
+        z.type = rule->resultType;
+        memset(&z.as, 0, sizeof(z.as));
+        const char *message = rule->fold(op, &x, &y, &z);
+        if (message || appendArrayElement(arr, &z) < 0) {
+            freeArray(arr);
+            return message ? message : "Out of memory";
+        }
+    }
+    result->as.a = arr;
+    return NULL;
+}
+
+// sum : entier si tous les elements le sont, reel sinon ; min et max
+// rendent l'element lui-meme (compare en reel si les types sont melanges)
+static const char *foldReduction(FoldOperator op, const expression *lhs, const expression *rhs,
+                                 expression *result) {
+    (void)rhs;
+    const ArrayType *arr = lhs->as.a;
+    if (arr->length == 0) {
+        if (op != FOLD_SUM) {
+            return "Empty array error";
+        }
+        result->type = TYPE_INTEGER;
+        result->as.i = 0;
+        return NULL;
+    }
+    if (arr->elementType == TYPE_INTEGER) {
+        result->type = TYPE_INTEGER;
+        result->as.i = op == FOLD_SUM ? vecSumInt(arr->data.i, arr->length)
+                     : op == FOLD_MIN ? vecMinInt(arr->data.i, arr->length)
+                                      : vecMaxInt(arr->data.i, arr->length);
+        return NULL;
+    }
+    if (arr->elementType == TYPE_FLOAT) {
+        result->type = TYPE_FLOAT;
+        result->as.f = op == FOLD_SUM ? vecSumFloat(arr->data.f, arr->length)
+                     : op == FOLD_MIN ? vecMinFloat(arr->data.f, arr->length)
+                                      : vecMaxFloat(arr->data.f, arr->length);
+        return NULL;
+    }
+    // elements melanges : entiers et reels seulement
+    double *values = op == FOLD_SUM ? allocateElements(TYPE_FLOAT, arr->length) : NULL;
+    if (op == FOLD_SUM && !values) {
+        return "Out of memory";
+    }
+    for (size_t k = 0; k < arr->length; k++) {
+        expression e;
+        arrayElement(arr, k, &e);
+        if (e.type != TYPE_INTEGER && e.type != TYPE_FLOAT) {
+            free(values);
+            return "Type mismatch: reduction requires an array of numbers";
+        }
+        if (values) {
+            values[k] = realOf(&e);
+        } else if (k == 0 || (op == FOLD_MIN ? realOf(&e) < realOf(result) : realOf(&e) > realOf(result))) {
+            result->type = e.type;
+            result->as = e.as;
+        }
+    }
+    if (values) {
+        result->type = TYPE_FLOAT;
+        result->as.f = vecSumFloat(values, arr->length);
+        free(values);
+    }
+    return NULL;
+}
+
+// d[cle] : valeur de la cle dans le dictionnaire, comme pour les autres
+// operateurs d'apres la valeur connue de la cle. Une cle constante absente
+// est une erreur ; une cle calculee absente (lue par Input...) doit
+// trouver sa valeur a l'execution : les valeurs doivent alors toutes avoir
+// le meme type, celui du resultat
+static const char *foldIndex(FoldOperator op, const expression *lhs, const expression *rhs,
+                             expression *result) {
+    (void)op;
+    const DictType *dict = lhs->as.d;
+    size_t length = dict ? dict->length : 0;
+    size_t found = dict ? dictKey(dict, rhs->as.s) : 0;
+    if (found == length) {
+        if (rhs->constant || length == 0) {
+            return "Key not found error";
+        }
+        expression e;
+        arrayElement(dict->values, 0, result);
+        for (size_t k = 1; k < length; k++) {
+            arrayElement(dict->values, k, &e);
+            if (e.type != result->type) {
+                return "Type mismatch: dict values have different types (use a constant key)";
+            }
+        }
+        found = 0;
+    }
+    arrayElement(dict->values, found, result);
+    // un tableau ou un dictionnaire imbrique est reconstruit depuis son texte
+    if (result->type == TYPE_ARRAY) {
+        result->as.a = parseArray(dict->values->data.text[found]);
+    } else if (result->type == TYPE_DICT) {
+        result->as.d = parseDict(dict->values->data.text[found]);
+    }
+    return NULL;
+}
+
+// erreur qui tient aux valeurs et non aux types : division par zero,
+// debordement, longueurs differentes, tableau vide, cle absente
+static bool valueError(const char *message) {
+    return strncmp(message, "Type mismatch", 13) != 0 && strcmp(message, "Out of memory") != 0;
+}
+
+static const char *applyRule(const FoldRule *rule, FoldOperator op, const expression *lhs,
+                             const expression *rhs, expression *result, char *error) {
+    expression value;
+    value.type = rule->resultType;
+    memset(&value.as, 0, sizeof(value.as));
+    bool constant = lhs->constant && rhs->constant;
+    const char *message = rule->fold(op, lhs, rhs, &value);
+    // une variable n'a pas forcement a l'execution la derniere valeur vue
+    // par l'analyse : l'erreur est laissee a l'execution, sauf si le type
+    // du resultat en depend
+    if (message && !constant && valueError(message) && value.type != TYPE_UNKNOWN) {
+        message = NULL;
+        if (value.type == TYPE_ARRAY && !value.as.a && !(value.as.a = createArray())) {
+            message = "Out of memory";
         }
     }
+    if (message) {
+        snprintf(error, MAX_FOLD_ERROR_LENGTH, "%s", message);
+        return NULL;
+    }
+    result->type = value.type;
+    result->constant = constant;
+    result->as = value.as;
+    return rule->quadOperator;
 }
 
+const char *foldBinary(FoldOperator op, const expression *lhs, const expression *rhs,
+                       expression *result, char *error) {
+    const FoldRule *rule = foldRule(op, lhs->type, rhs->type);
+    if (!rule || op >= FOLD_NOT) {
+        snprintf(error, MAX_FOLD_ERROR_LENGTH, "Type mismatch: operator '%s' cannot be applied to %s and %s",
+                 op >= 0 && op < FOLD_COUNT ? foldSymbols[op] : "?",
+                 symbolTypeName(lhs->type), symbolTypeName(rhs->type));
+        return NULL;
+    }
+    return applyRule(rule, op, lhs, rhs, result, error);
+}
+
+const char *foldUnary(FoldOperator op, const expression *operand, expression *result, char *error) {
+    const FoldRule *rule = foldRule(op, operand->type, operand->type);
+    if (!rule || op < FOLD_NOT) {
+        snprintf(error, MAX_FOLD_ERROR_LENGTH, "Type mismatch: operator '%s' cannot be applied to %s",
+                 op >= 0 && op < FOLD_COUNT ? foldSymbols[op] : "?", symbolTypeName(operand->type));
+        return NULL;
+    }
+    return applyRule(rule, op, operand, operand, result, error);
+}
 
+int quadResultType(const char *quadOperator, int lhsType, int rhsType) {
+    for (int op = 0; op < FOLD_COUNT; op++) {
+        const FoldRule *rule = foldRule((FoldOperator)op, lhsType, op >= FOLD_NOT ? lhsType : rhsType);
+        if (rule && strcmp(rule->quadOperator, quadOperator) == 0) {
+            return rule->resultType;
+        }
+    }
+    return TYPE_UNKNOWN;
+}
@@ -2,30 +2,152 @@
 #ifndef SEMANTIC_H
 #define SEMANTIC_H
 #include <stdbool.h>
+#include <stdint.h>
 #include "tableSymboles.h"
 
+#define MAX_NUMBER_LENGTH 64        // texte d'un entier ou d'un reel (formatValue)
+
+// as    : valeur calculee a la compilation, selon type (TYPE_INTEGER -> i,
+//         TYPE_FLOAT -> f, TYPE_BOOLEAN -> b, TYPE_STRING -> s,
+//         TYPE_ARRAY -> a, TYPE_DICT -> d) ; convertie en texte seulement pour la table des
+//         symboles (formatValue)
+// place : operande des quads qui porte le resultat a l'execution
+//         (litteral, nom de variable ou temporaire $tN : le $ ne peut
+//         pas commencer un identificateur), interne
+// constant : as est sur (litteraux, const, operations sur des constantes) ;
+//         sinon c'est la derniere valeur vue par l'analyse, qui ne sert
+//         qu'au typage
 typedef struct expression {
     int type;
-    char value[MAX_NAME_LENGTH];  
-    void* data;
+    bool constant;
+    union {
+        int64_t i;
+        double f;
+        bool b;
+        StringId s;
+        ArrayType *a;
+        DictType *d;
+    } as;
+    StringId place;
 } expression;
 
-typedef struct ExpressionNode {
-    expression expr;
-    struct ExpressionNode* next;
+// Arene de l'analyse : blocs chaines rendus en une fois a la fin de chaque
+// fichier (voir compilerFichier)
+typedef struct ParseChunk ParseChunk;
+
+typedef struct ParseArena {
+    ParseChunk *chunks;
+} ParseArena;
+
+// Elements d'un litteral [e1, e2, ...], d'une liste d'arguments ou d'un
+// dictionnaire {"k1": e1, ...}. Chaque ajout est en O(1) amorti : la
+// valeur va directement dans values, la place a la suite du texte
+// "[p1,p2,..." ou "{"k1":p1,..." (pris dans l'arene, toujours un octet de
+// reserve pour le crochet ou l'accolade fermante)
+typedef struct ExpressionList {
+    ArrayType *values;
+    StringId *keys;     // cle de chaque valeur (dictionnaire seulement)
+    size_t keyCapacity;
+    char *places;
+    size_t length;      // octets utilises dans places
+    size_t capacity;
+    bool constant;      // toutes les valeurs sont constantes
 } ExpressionList;
 
+// Conditions and / or / not en forme de sauts (voir syntaxique.y) : les
+// numeros des quads BZ, BNZ et BR dont la cible n'est pas encore connue,
+// pris dans l'arene
+typedef struct JumpList {
+    int qc;
+    struct JumpList *next;
+} JumpList;
+
+// sauts vers la suite vraie et vers la suite fausse ; le code se termine
+// sur l'une des deux, sans saut
+typedef struct Jumps {
+    JumpList *trueList;
+    JumpList *falseList;
+} Jumps;
+
+// dernier and / or / not rendu en booleen : ses sauts, le temporaire place
+// et ses quads [start, end[, retires si une condition le reprend aussitot
+typedef struct MaterializedJumps {
+    Jumps jumps;
+    StringId place;
+    int start;
+    int end;                    // 0 : aucun
+} MaterializedJumps;
+
 typedef struct variable {
     struct SymbolEntry* entry;
 } variable;
 
+// Operateurs repliables a la compilation (voir foldBinary / foldUnary)
+typedef enum FoldOperator {
+    FOLD_ADD,
+    FOLD_SUB,
+    FOLD_MUL,
+    FOLD_DIV,       // "/" : toujours reel
+    FOLD_IDIV,      // "//"
+    FOLD_MOD,
+    FOLD_EQ,
+    FOLD_NE,
+    FOLD_LT,
+    FOLD_GT,
+    FOLD_LE,
+    FOLD_GE,
+    FOLD_AND,
+    FOLD_OR,
+    FOLD_INDEX,     // d[cle]
+    FOLD_NOT,       // unaires
+    FOLD_NEG,
+    FOLD_SUM,       // reductions d'un tableau (sum, min, max)
+    FOLD_MIN,
+    FOLD_MAX,
+    FOLD_COUNT
+} FoldOperator;
+
+#define MAX_FOLD_ERROR_LENGTH 128
+
 // Function declarations
-void getTypeString(int type, char* typeStr);
+// Les tableaux et dictionnaires crees pendant l'analyse restent designes
+// par les expressions jusqu'a la fin du fichier : freeParseValues rend
+// ceux qui sont encore vivants (voir compilerFichier)
 ArrayType* createArray();
-ArrayType* createArrayFromExprList(ExpressionList* list);
-void getTypeString(int type, char *typeStr);
+void freeArray(ArrayType *arr);
+void freeParseValues(void);
+// ajoute la valeur de e a la fin de arr ; -1 si la memoire manque
+int appendArrayElement(ArrayType *arr, const expression *e);
+// dictionnaire des cles et valeurs de items (NULL : vide) ; NULL si la
+// memoire manque
+DictType *createDict(const ExpressionList *items);
+void freeDict(DictType *dict);
 void createValueString(int type, const char *inputValue, char *valueStr);
-ExpressionList* createExpressionNode(expression expr);
-ExpressionList* addExpressionToList(ExpressionList* list, expression expr);
 
-#endif // SEMANTIC_H
\ No newline at end of file
+void *parseAlloc(ParseArena *arena, size_t size);
+void freeParseArena(ParseArena *arena);
+// NULL si la memoire manque
+ExpressionList *createExpressionList(ParseArena *arena, const expression *first);
+ExpressionList *addExpressionToList(ParseArena *arena, ExpressionList *list, const expression *expr);
+ExpressionList *createDictItems(ParseArena *arena, StringId key, const expression *first);
+ExpressionList *addDictItem(ParseArena *arena, ExpressionList *list, StringId key, const expression *expr);
+
+// valeur <-> texte de la table des symboles
+const char *formatValue(const expression *expr, char *buffer, size_t size);
+void parseValue(int type, const char *text, expression *expr);
+// operande litteral d'un quad pour la valeur de expr
+StringId valuePlace(const expression *expr);
+
+// Replient l'operation sur les valeurs de lhs/rhs dans result (type et
+// valeur) et retournent l'operateur du quad a produire, ou NULL avec le
+// message dans error si les types ne s'y pretent pas. Les erreurs de
+// valeur (division par zero, cle absente...) ne sont signalees que si les
+// operandes sont constants : sinon l'execution decide
+const char *foldBinary(FoldOperator op, const expression *lhs, const expression *rhs,
+                       expression *result, char *error);
+const char *foldUnary(FoldOperator op, const expression *operand, expression *result, char *error);
+// type du resultat d'un quad "operateur a b" (rhsType ignore pour un
+// operateur unaire) d'apres les memes regles, TYPE_UNKNOWN si aucune
+int quadResultType(const char *quadOperator, int lhsType, int rhsType);
+
+#endif // SEMANTIC_H
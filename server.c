@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "server.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onStopSignal(int sig) {
+    (void)sig;
+    stopRequested = 1;
+}
+
+// connexion ouverte : octets recus qui ne forment pas encore une requete complete
+typedef struct Connection {
+    int fd;
+    char *buffer;
+    size_t length;
+    size_t capacity;
+    int closed;             // fin de flux recue : servir les requetes restantes puis fermer
+} Connection;
+
+static int hasRequest(const Connection *c) {
+    return c->length > 0 && memchr(c->buffer, '\n', c->length) != NULL;
+}
+
+// lecture de ce qui est disponible ; -1 si la memoire manque
+static int receive(Connection *c) {
+    if (c->capacity - c->length < SERVER_READ_SIZE) {
+        size_t capacity = c->capacity ? 2 * c->capacity : 2 * SERVER_READ_SIZE;
+        while (capacity - c->length < SERVER_READ_SIZE) {
+            capacity *= 2;
+        }
+        char *buffer = realloc(c->buffer, capacity);
+        if (!buffer) {
+            return -1;
+        }
+        c->buffer = buffer;
+        c->capacity = capacity;
+    }
+    ssize_t n = read(c->fd, c->buffer + c->length, c->capacity - c->length);
+    if (n > 0) {
+        c->length += (size_t)n;
+    } else if (n == 0 || (errno != EINTR && errno != EAGAIN)) {
+        c->closed = 1;
+    }
+    return 0;
+}
+
+// premiere requete de la connexion ; la sortie du compilateur part
+// directement sur la socket (stdout et stderr y sont rediriges le temps
+// de la compilation)
+static void serveRequest(Connection *c, CompileFunction compile, void *context, int savedOut, int savedErr) {
+    char *end = memchr(c->buffer, '\n', c->length);
+    size_t consumed = (size_t)(end - c->buffer) + 1;
+    *end = '\0';
+    if (end > c->buffer) {
+        fflush(stdout);
+        fflush(stderr);
+        dup2(c->fd, STDOUT_FILENO);
+        dup2(c->fd, STDERR_FILENO);
+
+        int status = compile(context, c->buffer);
+        fflush(stderr);
+        printf("%s %d\n", SERVER_STATUS_MARKER, status);
+        fflush(stdout);
+
+        dup2(savedOut, STDOUT_FILENO);
+        dup2(savedErr, STDERR_FILENO);
+    }
+    memmove(c->buffer, c->buffer + consumed, c->length - consumed);
+    c->length -= consumed;
+}
+
+int runCompileServer(const char *socketPath, CompileFunction compile, void *context) {
+    struct sockaddr_un address;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Error: socket path too long '%s'\n", socketPath);
+        return 1;
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        perror("socket");
+        return 1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketPath);
+    unlink(socketPath);
+    if (bind(listener, (struct sockaddr *)&address, sizeof(address)) < 0 ||
+        listen(listener, SERVER_BACKLOG) < 0) {
+        perror(socketPath);
+        close(listener);
+        return 1;
+    }
+
+    int savedOut = dup(STDOUT_FILENO);
+    int savedErr = dup(STDERR_FILENO);
+    Connection *conns = calloc(SERVER_MAX_CONNECTIONS, sizeof(Connection));
+    struct pollfd *fds = calloc(SERVER_MAX_CONNECTIONS + 1, sizeof(struct pollfd));
+    if (savedOut < 0 || savedErr < 0 || !conns || !fds) {
+        perror("serveur");
+        free(conns);
+        free(fds);
+        close(savedOut);
+        close(savedErr);
+        close(listener);
+        return 1;
+    }
+
+    // pas de SA_RESTART : poll() est interrompu par SIGINT/SIGTERM
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onStopSignal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Les connexions sont surveillees ensemble : a chaque tour, chaque
+    // connexion qui a une requete complete en voit une servie, les autres
+    // n'attendent donc pas qu'un client se deconnecte. Les compilations
+    // restent faites une a une sur le meme contexte
+    fprintf(stderr, "Compile server listening on %s\n", socketPath);
+    int count = 0;
+    int result = 0;
+    while (!stopRequested) {
+        int pending = 0;
+        fds[0].fd = count < SERVER_MAX_CONNECTIONS ? listener : -1;
+        fds[0].events = POLLIN;
+        for (int i = 0; i < count; i++) {
+            fds[i + 1].fd = conns[i].closed ? -1 : conns[i].fd;
+            fds[i + 1].events = POLLIN;
+            pending |= hasRequest(&conns[i]);
+        }
+        if (poll(fds, count + 1, pending ? 0 : -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            result = 1;
+            break;
+        }
+        int polled = count;
+        if (fds[0].revents & POLLIN) {
+            int conn = accept(listener, NULL, NULL);
+            if (conn >= 0) {
+                memset(&conns[count], 0, sizeof(Connection));
+                conns[count++].fd = conn;
+            } else if (errno != EINTR && errno != ECONNABORTED) {
+                perror("accept");
+            }
+        }
+        for (int i = 0; i < count; i++) {
+            Connection *c = &conns[i];
+            int readable = i < polled && fds[i + 1].fd >= 0 &&
+                           (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR));
+            if (readable && receive(c) < 0) {
+                c->closed = 1;
+                c->length = 0;
+            }
+            if (!stopRequested && hasRequest(c)) {
+                serveRequest(c, compile, context, savedOut, savedErr);
+            }
+        }
+        // connexions terminees : retirees une fois leurs requetes servies
+        for (int i = 0; i < count;) {
+            if (conns[i].closed && !hasRequest(&conns[i])) {
+                close(conns[i].fd);
+                free(conns[i].buffer);
+                conns[i] = conns[--count];
+            } else {
+                i++;
+            }
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        close(conns[i].fd);
+        free(conns[i].buffer);
+    }
+    free(conns);
+    free(fds);
+    close(savedOut);
+    close(savedErr);
+    close(listener);
+    unlink(socketPath);
+    fprintf(stderr, "Compile server stopped\n");
+    return result;
+}
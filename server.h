@@ -0,0 +1,28 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+// Mode serveur de compilation (option --serve) : un processus unique garde
+// la table des symboles, la pile et les quadruplets (leur memoire) entre
+// les requetes, recues sur une socket Unix locale. Ce qu'une requete ajoute
+// au pool de chaines lui est rendu a la fin (voir compilerRequete), et un
+// echec du pool ne fait echouer qu'elle.
+//
+// Plusieurs connexions peuvent etre ouvertes a la fois ; leurs requetes
+// sont compilees une a une, a tour de role.
+//
+// Protocole (texte, une connexion peut enchainer plusieurs requetes) :
+//   requete : chemin du fichier source, termine par '\n'
+//   reponse : sortie du compilateur (stdout et stderr), puis la ligne
+//             SERVER_STATUS_MARKER <code de retour>\n
+
+#define SERVER_STATUS_MARKER "#HSC-STATUS"
+#define SERVER_BACKLOG 64
+#define SERVER_MAX_CONNECTIONS 256
+#define SERVER_READ_SIZE 4096
+
+// context est passe tel quel a compile (la compilation courante du serveur)
+typedef int (*CompileFunction)(void *context, const char *path);
+
+int runCompileServer(const char *socketPath, CompileFunction compile, void *context);
+
+#endif
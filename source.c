@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "source.h"
+
+// Projection avec deux octets nuls garantis apres le contenu : on reserve
+// une zone anonyme (remplie de zeros) arrondie a la page, puis on projette
+// le fichier par-dessus. La fin de la derniere page du fichier est nulle,
+// et si le fichier remplit exactement ses pages, la page anonyme suivante
+// fournit les zeros. Projection privee : Flex ecrit temporairement dans le
+// tampon (caractere de fin de yytext), ces ecritures ne touchent pas le fichier.
+static int mapSource(SourceFile *src, int fd, size_t length) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t total = (length + 2 + page - 1) / page * page;
+
+    char *base = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+    if (length > 0 &&
+        mmap(base, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, total);
+        return -1;
+    }
+    madvise(base, total, MADV_SEQUENTIAL);
+
+    src->data = base;
+    src->length = length;
+    src->mappedLength = total;
+    return 0;
+}
+
+// ouvre path ; le scanner est branche sur le contenu. Retourne -1 en cas d'erreur
+int openSource(SourceFile *src, const char *path, void *scanner) {
+    memset(src, 0, sizeof(*src));
+    src->path = path;
+    src->scanner = scanner;
+
+    if (strcmp(path, SOURCE_STDIN) == 0) {
+        src->stream = stdin;
+        src->buffer = scannerSetStream(scanner, stdin);
+        return 0;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && mapSource(src, fd, (size_t)st.st_size) == 0) {
+        close(fd);
+        src->buffer = scannerSetBuffer(scanner, src->data, src->length);
+        return 0;
+    }
+
+    // tube, peripherique ou projection impossible : lecture en flux
+    src->stream = fdopen(fd, "r");
+    if (!src->stream) {
+        close(fd);
+        return -1;
+    }
+    src->buffer = scannerSetStream(scanner, src->stream);
+    return 0;
+}
+
+void closeSource(SourceFile *src) {
+    if (src->buffer) {
+        scannerRelease(src->scanner, src->buffer);
+    }
+    if (src->mappedLength) {
+        munmap(src->data, src->mappedLength);
+    } else if (src->stream && src->stream != stdin) {
+        fclose(src->stream);
+    }
+    memset(src, 0, sizeof(*src));
+}
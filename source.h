@@ -0,0 +1,35 @@
+#ifndef SOURCE_H
+#define SOURCE_H
+#include <stdio.h>
+#include <stddef.h>
+
+// Fichier source projete en memoire : le scanner Flex travaille directement
+// sur les pages du fichier (yy_scan_buffer), sans lecture ni recopie.
+// Les entrees qui ne sont pas des fichiers reguliers (tubes, "-") sont lues
+// en flux par le tampon habituel de Flex.
+
+typedef struct SourceFile {
+    const char *path;
+    char *data;             // contenu, suivi de deux octets nuls
+    size_t length;          // taille du contenu
+    size_t mappedLength;    // taille de la projection (0 en mode flux)
+    FILE *stream;           // non NULL en mode flux
+    void *scanner;          // scanner Flex reentrant qui lit ce fichier
+    void *buffer;           // tampon Flex (YY_BUFFER_STATE)
+} SourceFile;
+
+#define SOURCE_STDIN "-"
+
+int openSource(SourceFile *src, const char *path, void *scanner);
+void closeSource(SourceFile *src);
+
+// implementees dans lexical.l ; scanner est un yyscan_t
+void *scannerCreate(void *extra);
+void scannerDestroy(void *scanner);
+void *scannerSetBuffer(void *scanner, char *data, size_t length);
+void *scannerSetStream(void *scanner, FILE *stream);
+void scannerRelease(void *scanner, void *buffer);
+int scannerLine(void *scanner);
+const char *scannerText(void *scanner);
+
+#endif
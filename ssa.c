@@ -0,0 +1,427 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ssa.h"
+
+typedef struct Renommage {
+    SsaForm *ssa;
+    StringId *current;      // version courante de chaque nom (STRING_ID_NONE : nom d'origine)
+    int *counter;           // derniere version de chaque nom
+    int *logName;           // ecritures de current a defaire en sortant d'un bloc
+    StringId *logPrevious;
+    int logTop;
+    char *buffer;
+    size_t bufferSize;
+} Renommage;
+
+int ssaValue(const SsaForm *ssa, StringId id) {
+    return idMapGet(&ssa->values, id, -1);
+}
+
+// range les paires (cle, valeur) par cle : start[cle] .. start[cle + 1][ ;
+// sans valeurs, la valeur d'une paire est son indice
+static int *grouper(const int *cles, const int *valeurs, int count, int keys, int **start) {
+    *start = (int *)calloc(keys + 1, sizeof(int));
+    int *grouped = (int *)malloc((count + 1) * sizeof(int));
+    int *fill = (int *)malloc((keys + 1) * sizeof(int));
+    if (!*start || !grouped || !fill) {
+        free(grouped);
+        free(fill);
+        return NULL;
+    }
+    for (int e = 0; e < count; e++) {
+        (*start)[cles[e] + 1]++;
+    }
+    for (int k = 0; k < keys; k++) {
+        (*start)[k + 1] += (*start)[k];
+    }
+    memcpy(fill, *start, (keys + 1) * sizeof(int));
+    for (int e = 0; e < count; e++) {
+        grouped[fill[cles[e]]++] = valeurs ? valeurs[e] : e;
+    }
+    free(fill);
+    return grouped;
+}
+
+// ---------------------------------------------------------------------------
+// Renommage
+
+static StringId nouvelleVersion(Renommage *r, int name, int def) {
+    SsaForm *ssa = r->ssa;
+    const char *base = internedString(ssa->cfg->nameIds[name]);
+    size_t needed = strlen(base) + 16;
+    if (needed > r->bufferSize) {
+        char *grown = (char *)realloc(r->buffer, needed);
+        if (!grown) {
+            return STRING_ID_NONE;
+        }
+        r->buffer = grown;
+        r->bufferSize = needed;
+    }
+    snprintf(r->buffer, r->bufferSize, "%s.%d", base, ++r->counter[name]);
+    StringId id = internString(r->buffer);
+    int k = ssa->valueCount++;
+    idMapPut(&ssa->values, id, k);
+    ssa->valueIds[k] = id;
+    ssa->valueDef[k] = def;
+    ssa->valueBase[k] = name;
+    r->logName[r->logTop] = name;
+    r->logPrevious[r->logTop++] = r->current[name];
+    r->current[name] = id;
+    return id;
+}
+
+static StringId versionCourante(const Renommage *r, int name) {
+    return r->current[name] != STRING_ID_NONE ? r->current[name] : r->ssa->cfg->nameIds[name];
+}
+
+static int entrerBloc(Renommage *r, const char *renamed, int b) {
+    SsaForm *ssa = r->ssa;
+    Cfg *cfg = ssa->cfg;
+    for (int k = ssa->phiStart[b]; k < ssa->phiStart[b + 1]; k++) {
+        Phi *phi = &ssa->phis[k];
+        phi->dest = nouvelleVersion(r, cfgName(cfg, phi->base), -1 - k);
+        if (phi->dest == STRING_ID_NONE) {
+            return -1;
+        }
+    }
+    for (int i = cfg->blocks[b].first; i < cfg->blocks[b].last; i++) {
+        if (cfg->kinds[i] == QUAD_REMOVED) {
+            continue;
+        }
+        StringId *fields[CFG_MAX_USES];
+        int uses = cfgUseFields(cfg, i, fields);
+        for (int k = 0; k < uses; k++) {
+            int n = cfgName(cfg, *fields[k]);
+            if (n >= 0 && renamed[n]) {
+                *fields[k] = versionCourante(r, n);
+            }
+        }
+        StringId *def = cfgDefField(cfg, i);
+        int n = def ? cfgName(cfg, *def) : -1;
+        if (n >= 0 && renamed[n]) {
+            *def = nouvelleVersion(r, n, i);
+            if (*def == STRING_ID_NONE) {
+                return -1;
+            }
+        }
+    }
+    // arguments des phis des successeurs
+    for (int s = 0; s < 2; s++) {
+        int succ = cfg->blocks[b].succ[s];
+        if (succ < 0) {
+            continue;
+        }
+        BasicBlock *bloc = &cfg->blocks[succ];
+        for (int p = 0; p < bloc->predCount; p++) {
+            if (cfg->preds[bloc->predStart + p] != b) {
+                continue;
+            }
+            for (int k = ssa->phiStart[succ]; k < ssa->phiStart[succ + 1]; k++) {
+                Phi *phi = &ssa->phis[k];
+                ssa->phiArgs[phi->args + p] = versionCourante(r, cfgName(cfg, phi->base));
+            }
+        }
+    }
+    return 0;
+}
+
+static void sortirBloc(Renommage *r, int mark) {
+    while (r->logTop > mark) {
+        r->logTop--;
+        r->current[r->logName[r->logTop]] = r->logPrevious[r->logTop];
+    }
+}
+
+// parcours de l'arbre des dominateurs en profondeur, sans recursion
+static int renommer(SsaForm *ssa, const char *renamed, int versions) {
+    Cfg *cfg = ssa->cfg;
+    int blocks = cfg->blockCount;
+    int names = cfg->nameCount;
+    Renommage r;
+    memset(&r, 0, sizeof(r));
+    r.ssa = ssa;
+    r.current = (StringId *)calloc(names + 1, sizeof(StringId));
+    r.counter = (int *)calloc(names + 1, sizeof(int));
+    r.logName = (int *)malloc((versions + 1) * sizeof(int));
+    r.logPrevious = (StringId *)malloc((versions + 1) * sizeof(StringId));
+
+    // enfants de chaque bloc dans l'arbre des dominateurs
+    int *parent = (int *)malloc((blocks + 1) * sizeof(int));
+    int *enfant = (int *)malloc((blocks + 1) * sizeof(int));
+    int *pile = (int *)malloc((blocks + 1) * sizeof(int));
+    int *curseur = (int *)malloc((blocks + 1) * sizeof(int));
+    int *marque = (int *)malloc((blocks + 1) * sizeof(int));
+    int *children = NULL, *childStart = NULL;
+    int status = -1;
+    if (!r.current || !r.counter || !r.logName || !r.logPrevious || !parent || !enfant ||
+        !pile || !curseur || !marque) {
+        goto fin;
+    }
+    int aretes = 0;
+    for (int k = 1; k < cfg->orderCount; k++) {
+        int b = cfg->order[k];
+        parent[aretes] = cfg->idom[b];
+        enfant[aretes++] = b;
+    }
+    children = grouper(parent, enfant, aretes, blocks, &childStart);
+    if (!children) {
+        goto fin;
+    }
+
+    status = 0;
+    int sommet = 0;
+    if (blocks > 0) {
+        pile[0] = 0;
+        curseur[0] = childStart[0];
+        marque[0] = 0;
+        sommet = 1;
+        status = entrerBloc(&r, renamed, 0);
+    }
+    while (sommet > 0 && status == 0) {
+        int b = pile[sommet - 1];
+        if (curseur[sommet - 1] < childStart[b + 1]) {
+            int c = children[curseur[sommet - 1]++];
+            pile[sommet] = c;
+            curseur[sommet] = childStart[c];
+            marque[sommet++] = r.logTop;
+            status = entrerBloc(&r, renamed, c);
+        } else {
+            sortirBloc(&r, marque[--sommet]);
+        }
+    }
+
+fin:
+    free(r.current);
+    free(r.counter);
+    free(r.logName);
+    free(r.logPrevious);
+    free(r.buffer);
+    free(parent);
+    free(enfant);
+    free(pile);
+    free(curseur);
+    free(marque);
+    free(children);
+    free(childStart);
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Construction
+
+int ssaBuild(SsaForm *ssa, Cfg *cfg) {
+    memset(ssa, 0, sizeof(*ssa));
+    ssa->cfg = cfg;
+    if (!cfg->idom && cfgDominators(cfg) < 0) {
+        return -1;
+    }
+    int blocks = cfg->blockCount;
+    int names = cfg->nameCount;
+    int n = cfg->quads->taille;
+
+    char *excluded = (char *)calloc(names + 1, 1);
+    char *global = (char *)calloc(names + 1, 1);
+    char *renamed = (char *)calloc(names + 1, 1);
+    int *stamp = (int *)malloc((names + 1) * sizeof(int));
+    int *defName = (int *)malloc((n + 1) * sizeof(int));
+    int *defBlock = (int *)malloc((n + 1) * sizeof(int));
+    int *defStart = NULL, *defBlocks = NULL, *dfStart = NULL, *df = NULL;
+    int *hasPhi = (int *)malloc((blocks + 1) * sizeof(int));
+    int *inWork = (int *)malloc((blocks + 1) * sizeof(int));
+    int *work = (int *)malloc((blocks + 1) * sizeof(int));
+    int *phiBlock = NULL, *phiName = NULL, *parBloc = NULL;
+    int phiCapacity = 0, defs = 0, status = -1;
+    if (!excluded || !global || !renamed || !stamp || !defName || !defBlock || !hasPhi || !inWork || !work) {
+        goto fin;
+    }
+
+    // noms lus avant toute ecriture dans un bloc, blocs qui ecrivent chaque nom
+    for (int k = 0; k < names; k++) {
+        stamp[k] = -1;
+    }
+    for (int k = 0; k < cfg->orderCount; k++) {
+        int b = cfg->order[k];
+        for (int i = cfg->blocks[b].first; i < cfg->blocks[b].last; i++) {
+            if (cfg->kinds[i] == QUAD_REMOVED) {
+                continue;
+            }
+            StringId *fields[CFG_MAX_USES];
+            int uses = cfgUseFields(cfg, i, fields);
+            for (int u = 0; u < uses; u++) {
+                int name = cfgName(cfg, *fields[u]);
+                if (name >= 0 && stamp[name] != b) {
+                    global[name] = 1;
+                }
+            }
+            for (int u = cfg->arrayUseStart[i]; u < cfg->arrayUseStart[i + 1]; u++) {
+                excluded[cfg->arrayUses[u]] = 1;
+            }
+            int name = cfgName(cfg, cfgDef(cfg, i));
+            if (name < 0) {
+                continue;
+            }
+            if (cfg->kinds[i] == QUAD_ARRAY || cfg->kinds[i] == QUAD_OTHER) {
+                excluded[name] = 1;
+            }
+            if (stamp[name] != b) {
+                stamp[name] = b;
+                defName[defs] = name;
+                defBlock[defs++] = b;
+            }
+            renamed[name] = 1;
+        }
+    }
+    defBlocks = grouper(defName, defBlock, defs, names, &defStart);
+    df = cfgFrontiers(cfg, &dfStart);
+    if (!defBlocks || !df) {
+        goto fin;
+    }
+
+    // phis : frontiere de dominance iteree des blocs qui ecrivent le nom
+    for (int b = 0; b < blocks; b++) {
+        hasPhi[b] = -1;
+        inWork[b] = -1;
+    }
+    for (int name = 0; name < names; name++) {
+        renamed[name] &= !excluded[name];
+        if (!renamed[name] || !global[name]) {
+            continue;
+        }
+        int top = 0;
+        for (int k = defStart[name]; k < defStart[name + 1]; k++) {
+            inWork[defBlocks[k]] = name;
+            work[top++] = defBlocks[k];
+        }
+        while (top > 0) {
+            int x = work[--top];
+            for (int k = dfStart[x]; k < dfStart[x + 1]; k++) {
+                int y = df[k];
+                if (hasPhi[y] == name) {
+                    continue;
+                }
+                hasPhi[y] = name;
+                if (ssa->phiCount == phiCapacity) {
+                    phiCapacity = phiCapacity ? 2 * phiCapacity : 64;
+                    int *pb = (int *)realloc(phiBlock, phiCapacity * sizeof(int));
+                    int *pn = pb ? (int *)realloc(phiName, phiCapacity * sizeof(int)) : NULL;
+                    if (pb) phiBlock = pb;
+                    if (pn) phiName = pn;
+                    if (!pb || !pn) {
+                        goto fin;
+                    }
+                }
+                phiBlock[ssa->phiCount] = y;
+                phiName[ssa->phiCount++] = name;
+                if (inWork[y] != name) {
+                    inWork[y] = name;
+                    work[top++] = y;
+                }
+            }
+        }
+    }
+
+    // phis ranges par bloc, un argument par predecesseur
+    parBloc = grouper(phiBlock, NULL, ssa->phiCount, blocks, &ssa->phiStart);
+    int argCount = 0;
+    for (int k = 0; k < ssa->phiCount; k++) {
+        argCount += cfg->blocks[phiBlock[k]].predCount;
+    }
+    ssa->phis = (Phi *)malloc((ssa->phiCount + 1) * sizeof(Phi));
+    ssa->phiArgs = (StringId *)malloc((argCount + 1) * sizeof(StringId));
+    if (!parBloc || !ssa->phis || !ssa->phiArgs) {
+        goto fin;
+    }
+    argCount = 0;
+    for (int k = 0; k < ssa->phiCount; k++) {
+        Phi *phi = &ssa->phis[k];
+        int b = phiBlock[parBloc[k]];
+        phi->base = cfg->nameIds[phiName[parBloc[k]]];
+        phi->dest = STRING_ID_NONE;
+        phi->args = argCount;
+        for (int p = 0; p < cfg->blocks[b].predCount; p++) {
+            ssa->phiArgs[argCount++] = STRING_ID_NONE;
+        }
+    }
+
+    // valeurs : les noms d'origine, puis les versions creees en renommant
+    int versions = 0;
+    for (int k = 0; k < cfg->orderCount; k++) {
+        BasicBlock *bloc = &cfg->blocks[cfg->order[k]];
+        versions += bloc->last - bloc->first;
+    }
+    versions += ssa->phiCount;
+    uint32_t capacity = (uint32_t)names + (uint32_t)versions + 1;
+    ssa->valueIds = (StringId *)malloc(capacity * sizeof(StringId));
+    ssa->valueDef = (int *)malloc(capacity * sizeof(int));
+    ssa->valueBase = (int *)malloc(capacity * sizeof(int));
+    if (!ssa->valueIds || !ssa->valueDef || !ssa->valueBase || initIdMap(&ssa->values, capacity) < 0) {
+        goto fin;
+    }
+    for (int name = 0; name < names; name++) {
+        idMapPut(&ssa->values, cfg->nameIds[name], name);
+        ssa->valueIds[name] = cfg->nameIds[name];
+        ssa->valueDef[name] = SSA_NO_DEF;
+        ssa->valueBase[name] = name;
+    }
+    ssa->valueCount = names;
+    status = renommer(ssa, renamed, versions);
+    if (status < 0) {
+        // les quads deja renommes reprennent leur nom
+        ssaRestore(ssa);
+    }
+
+fin:
+    free(excluded);
+    free(global);
+    free(renamed);
+    free(stamp);
+    free(defName);
+    free(defBlock);
+    free(defStart);
+    free(defBlocks);
+    free(dfStart);
+    free(df);
+    free(hasPhi);
+    free(inWork);
+    free(work);
+    free(phiBlock);
+    free(phiName);
+    free(parBloc);
+    if (status < 0) {
+        ssaFree(ssa);
+    }
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Sortie de SSA
+
+void ssaRestore(SsaForm *ssa) {
+    Cfg *cfg = ssa->cfg;
+    if (!ssa->valueIds) {
+        return;
+    }
+    for (int i = 0; i < cfg->quads->taille; i++) {
+        quad *q = &cfg->quads->quads[i];
+        StringId *fields[3] = { &q->operande1, &q->operande2, &q->resultat };
+        for (int k = 0; k < 3; k++) {
+            int v = ssaValue(ssa, *fields[k]);
+            if (v >= 0 && ssa->valueDef[v] != SSA_NO_DEF) {
+                *fields[k] = cfg->nameIds[ssa->valueBase[v]];
+            }
+        }
+    }
+    ssa->phiCount = 0;
+}
+
+void ssaFree(SsaForm *ssa) {
+    free(ssa->phis);
+    free(ssa->phiStart);
+    free(ssa->phiArgs);
+    freeIdMap(&ssa->values);
+    free(ssa->valueIds);
+    free(ssa->valueDef);
+    free(ssa->valueBase);
+    memset(ssa, 0, sizeof(*ssa));
+}
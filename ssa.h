@@ -0,0 +1,57 @@
+#ifndef SSA_H
+#define SSA_H
+#include "cfg.h"
+
+// Forme SSA des quadruplets, construite sur un Cfg.
+//
+// Chaque ecriture d'une variable ou d'un temporaire definit une nouvelle
+// version "x.k" (aucun nom du parseur ne contient de point : variables,
+// nom@id des Functions, temporaires $tN) ; aux jonctions (frontiere de
+// dominance des ecritures) un phi choisit la version selon le predecesseur.
+// Les phis ne sont places que pour les noms lus avant d'etre ecrits dans
+// un bloc (semi-elagage), jamais dans le bloc d'entree : une lecture qui
+// n'est precedee d'aucune ecriture garde le nom d'origine et vaut "inconnu".
+//
+// Les noms lus dans le texte d'un tableau ("[a,b]") et ceux que definit
+// ARRAY_DECL ou un operateur inconnu ne sont pas renommes.
+//
+// Les quads sont renommes sur place. ssaRestore revient aux noms
+// d'origine : les passes qui travaillent sur la forme SSA ne font que
+// remplacer des lectures par des constantes, supprimer des quads ou des
+// branchements ; aucune duree de vie ne s'allonge et deux versions d'un
+// meme nom ne sont jamais vivantes ensemble, les phis disparaissent donc
+// sans copie.
+
+typedef struct Phi {
+    StringId base;          // nom d'origine
+    StringId dest;          // version definie
+    int args;               // version lue depuis le p-ieme predecesseur : phiArgs[args + p]
+} Phi;
+
+typedef struct SsaForm {
+    Cfg *cfg;
+    Phi *phis;
+    int phiCount;
+    int *phiStart;          // phis du bloc b : phis[phiStart[b] .. phiStart[b + 1][
+    StringId *phiArgs;      // STRING_ID_NONE : predecesseur inaccessible
+    // valeurs : chaque version, plus les noms non renommes
+    IdMap values;           // nom -> indice dense
+    StringId *valueIds;
+    int *valueDef;          // quad qui definit la version, -1 - phi pour un phi,
+                            // INT32_MIN pour un nom non renomme
+    int *valueBase;         // indice (cfg) du nom d'origine
+    int valueCount;
+} SsaForm;
+
+#define SSA_NO_DEF INT32_MIN
+
+// calcule les dominateurs si besoin ; 0 ou -1 si la memoire manque (les
+// quads sont alors inchanges)
+int ssaBuild(SsaForm *ssa, Cfg *cfg);
+// indice dense de la valeur, -1 pour un litteral
+int ssaValue(const SsaForm *ssa, StringId id);
+// sortie de SSA : chaque version reprend son nom d'origine
+void ssaRestore(SsaForm *ssa);
+void ssaFree(SsaForm *ssa);
+
+#endif
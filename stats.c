@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "stats.h"
+#include "interner.h"
+
+int statsEnabled = STATS_OFF;
+CompileStats stats;
+
+static const char *const phaseNames[PHASE_COUNT] = {
+    "scanning", "parsing", "emission", "optimization", "output", "run", "total"
+};
+
+double statsWallClock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// temps CPU du processus pour le total, du thread courant pour les phases
+// d'une compilation (qui peut tourner sur un thread du pool -j N)
+static double statsCpuClock(Phase phase) {
+    struct timespec ts;
+    clock_gettime(phase == PHASE_TOTAL ? CLOCK_PROCESS_CPUTIME_ID : CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void statsStart(CompileStats *s, Phase phase) {
+    s->startWall[phase] = statsWallClock();
+    s->startCpu[phase] = statsCpuClock(phase);
+}
+
+void statsStop(CompileStats *s, Phase phase) {
+    s->wall[phase] += statsWallClock() - s->startWall[phase];
+    s->cpu[phase] += statsCpuClock(phase) - s->startCpu[phase];
+}
+
+void statsReset(void) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+// taille des tables a la fin d'une compilation ; quads : nombre produit
+// par l'analyse, avant l'optimiseur
+void statsRecordTables(CompileStats *s, SymbolTable *table, long quads) {
+    int symbols = 0, maxProbe = 0;
+    double averageProbe = 0;
+    symbolTableStats(table, &symbols, &averageProbe, &maxProbe);
+    s->symbols += symbols;
+    s->probeTotal += (long)(averageProbe * symbols + 0.5);
+    if (maxProbe > s->maxProbe) {
+        s->maxProbe = maxProbe;
+    }
+    s->quads += quads;
+}
+
+void statsMerge(CompileStats *total, const CompileStats *s) {
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        total->wall[p] += s->wall[p];
+        total->cpu[p] += s->cpu[p];
+    }
+    total->tokens += s->tokens;
+    total->quads += s->quads;
+    total->symbols += s->symbols;
+    total->probeTotal += s->probeTotal;
+    if (s->maxProbe > total->maxProbe) {
+        total->maxProbe = s->maxProbe;
+    }
+    total->cacheHits += s->cacheHits;
+    total->cacheMisses += s->cacheMisses;
+    total->cacheStores += s->cacheStores;
+    total->cacheEvictions += s->cacheEvictions;
+    total->executed += s->executed;
+    total->optimized += s->optimized;
+    total->optimizedQuads += s->optimizedQuads;
+}
+
+// Comptage des allocations : l'editeur de liens redirige malloc/calloc/realloc
+// vers ces fonctions (-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc).
+// Seuls les appels des fichiers lies avec --wrap sont comptes : ceux faits
+// a l'interieur de la libc (tampons de stdio, strdup, getline...) lui
+// echappent, le total est donc un minorant.
+// Les compteurs sont partages par tous les threads, d'ou les increments atomiques
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    __atomic_fetch_add(&stats.allocations, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats.allocatedBytes, (long)size, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    __atomic_fetch_add(&stats.allocations, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats.allocatedBytes, (long)(count * size), __ATOMIC_RELAXED);
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    __atomic_fetch_add(&stats.allocations, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats.allocatedBytes, (long)size, __ATOMIC_RELAXED);
+    return __real_realloc(ptr, size);
+}
+
+void statsReport(FILE *out, const CompileStats *s) {
+    long symbols = s->symbols, quads = s->quads;
+    int maxProbe = s->maxProbe;
+    double averageProbe = symbols > 0 ? (double)s->probeTotal / symbols : 0;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    long peakRssKb = usage.ru_maxrss;
+
+    // temps propre aux actions semantiques : analyse moins lexique et emission
+    double semantic = s->wall[PHASE_PARSE] - s->wall[PHASE_SCAN] - s->wall[PHASE_EMIT];
+    double tokensPerSecond = s->wall[PHASE_PARSE] > 0 ? s->tokens / s->wall[PHASE_PARSE] : 0;
+    double quadsPerSecond = s->wall[PHASE_PARSE] > 0 ? quads / s->wall[PHASE_PARSE] : 0;
+    double executedPerSecond = s->wall[PHASE_RUN] > 0 ? s->executed / s->wall[PHASE_RUN] : 0;
+
+    if (statsEnabled == STATS_JSON) {
+        fprintf(out, "{\n  \"phases\": {\n");
+        // le temps CPU n'est mesure que pour les phases de premier niveau
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            if (p == PHASE_SCAN || p == PHASE_EMIT) {
+                fprintf(out, "    \"%s\": {\"wall\": %.6f, \"cpu\": null},\n", phaseNames[p], s->wall[p]);
+            } else {
+                fprintf(out, "    \"%s\": {\"wall\": %.6f, \"cpu\": %.6f},\n",
+                        phaseNames[p], s->wall[p], s->cpu[p]);
+            }
+        }
+        fprintf(out, "    \"semantic\": {\"wall\": %.6f, \"cpu\": null}\n  },\n", semantic);
+        fprintf(out, "  \"tokens\": %ld,\n  \"tokens_per_second\": %.1f,\n", s->tokens, tokensPerSecond);
+        fprintf(out, "  \"quads\": %ld,\n  \"quads_per_second\": %.1f,\n", quads, quadsPerSecond);
+        fprintf(out, "  \"executed\": %ld,\n  \"executed_per_second\": %.1f,\n", s->executed, executedPerSecond);
+        fprintf(out, "  \"quads_removed\": %ld,\n  \"quads_optimized\": %ld,\n", s->optimized,
+                s->optimizedQuads);
+        fprintf(out, "  \"symbols\": %ld,\n  \"average_probe\": %.3f,\n  \"max_probe\": %d,\n",
+                symbols, averageProbe, maxProbe);
+        fprintf(out, "  \"interned_strings\": %zu,\n", internedCount());
+        fprintf(out, "  \"cache\": {\"hits\": %ld, \"misses\": %ld, \"stores\": %ld, \"evictions\": %ld},\n",
+                s->cacheHits, s->cacheMisses, s->cacheStores, s->cacheEvictions);
+        fprintf(out, "  \"allocations\": %ld,\n  \"allocated_bytes\": %ld,\n",
+                s->allocations, s->allocatedBytes);
+        fprintf(out, "  \"peak_rss_kb\": %ld\n}\n", peakRssKb);
+        return;
+    }
+
+    fprintf(out, "\n=============  Statistiques de compilation =============\n");
+    fprintf(out, "%-22s %12s %12s\n", "phase", "wall (ms)", "cpu (ms)");
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        if (p == PHASE_SCAN || p == PHASE_EMIT) {
+            fprintf(out, "  %-20s %12.3f %12s\n", phaseNames[p], s->wall[p] * 1e3, "-");
+        } else {
+            fprintf(out, "%-22s %12.3f %12.3f\n", phaseNames[p], s->wall[p] * 1e3, s->cpu[p] * 1e3);
+        }
+        if (p == PHASE_EMIT) {
+            fprintf(out, "  %-20s %12.3f %12s\n", "semantic actions", semantic * 1e3, "-");
+        }
+    }
+    fprintf(out, "tokens                 %12ld   (%.0f tokens/s)\n", s->tokens, tokensPerSecond);
+    fprintf(out, "quads emitted          %12ld   (%.0f quads/s)\n", quads, quadsPerSecond);
+    if (s->optimized || s->optimizedQuads) {
+        fprintf(out, "quads after -O         %12ld   (%ld removed)\n", s->optimizedQuads, s->optimized);
+    }
+    if (s->executed) {
+        fprintf(out, "quads executed         %12ld   (%.0f quads/s)\n", s->executed, executedPerSecond);
+    }
+    fprintf(out, "symbols                %12ld   (probe avg %.3f, max %d)\n", symbols, averageProbe, maxProbe);
+    fprintf(out, "interned strings       %12zu\n", internedCount());
+    if (s->cacheHits || s->cacheMisses) {
+        fprintf(out, "cache hits / misses    %12ld / %ld   (%ld stored, %ld evicted)\n",
+                s->cacheHits, s->cacheMisses, s->cacheStores, s->cacheEvictions);
+    }
+    fprintf(out, "allocations            %12ld   (%ld bytes)\n", s->allocations, s->allocatedBytes);
+    fprintf(out, "peak RSS               %12ld kB\n", peakRssKb);
+}
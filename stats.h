@@ -0,0 +1,61 @@
+#ifndef STATS_H
+#define STATS_H
+#include <stdio.h>
+#include "tableSymboles.h"
+
+// Instrumentation de la compilation (option --stats) : temps par phase,
+// debits, taille des tables et allocations memoire.
+
+typedef enum Phase {
+    PHASE_SCAN,     // analyse lexicale (cumulee sur tous les appels a yylex)
+    PHASE_PARSE,    // analyse syntaxique + actions semantiques (inclut SCAN et EMIT)
+    PHASE_EMIT,     // emission des quadruplets (cumulee)
+    PHASE_OPTIMIZE, // optimisation des quadruplets (-O)
+    PHASE_OUTPUT,   // affichage de la table des symboles et des quads
+    PHASE_RUN,      // execution par la machine virtuelle (--run)
+    PHASE_TOTAL,
+    PHASE_COUNT
+} Phase;
+
+// Une compilation (voir compilation.h) remplit sa propre structure, fusionnee
+// ensuite dans le total global : en mode -j N les temps par phase sont donc
+// cumules sur tous les fichiers, seul PHASE_TOTAL mesure le temps ecoule.
+typedef struct CompileStats {
+    double wall[PHASE_COUNT];   // secondes
+    double cpu[PHASE_COUNT];    // secondes (phases de premier niveau seulement)
+    double startWall[PHASE_COUNT];
+    double startCpu[PHASE_COUNT];
+    long tokens;
+    long quads;                 // quads produits par l'analyse (avant -O)
+    long symbols;
+    long probeTotal;            // somme des longueurs de sondage
+    int maxProbe;
+    long cacheHits;             // cache de compilation (--cache)
+    long cacheMisses;
+    long cacheStores;
+    long cacheEvictions;
+    long executed;              // instructions executees par la VM (--run)
+    long optimized;             // quads supprimes par l'optimiseur (-O)
+    long optimizedQuads;        // quads restant apres -O
+    long allocations;           // compteurs globaux (voir __wrap_malloc) : les
+                                // allocations internes de la libc (tampons de
+                                // stdio, strdup...) ne passent pas par eux
+    long allocatedBytes;
+} CompileStats;
+
+#define STATS_OFF 0
+#define STATS_TEXT 1
+#define STATS_JSON 2
+
+extern int statsEnabled;        // STATS_OFF, STATS_TEXT ou STATS_JSON
+extern CompileStats stats;
+
+double statsWallClock(void);
+void statsStart(CompileStats *s, Phase phase);
+void statsStop(CompileStats *s, Phase phase);
+void statsReset(void);
+void statsRecordTables(CompileStats *s, SymbolTable *table, long quads);
+void statsMerge(CompileStats *total, const CompileStats *s);
+void statsReport(FILE *out, const CompileStats *s);
+
+#endif
@@ -1,4 +1,7 @@
 %define parse.error verbose
+%define api.pure full
+%parse-param {void *scanner} {Compilation *ctx}
+%lex-param {void *scanner}
 
 %{
 #include <stdio.h>
@@ -6,14 +9,9 @@
 #include <stdint.h>
 #include <string.h>
 #include <math.h>
+#include <setjmp.h>
+#include <sys/stat.h>
 #define YYDEBUG 1
-extern int yylex();
-extern int yylineno; 
-extern char* yytext;
-extern FILE* yyin;
-int positionCurseur = 0;
-char *file = "input.txt";
-void yyerror(const char *s);  
 %}
 
 %code requires{
@@ -27,21 +25,32 @@ void yyerror(const char *s);
 #include "tableSymboles.h"
 #include "quadruplets.h"
 #include "pile.h"
+#include "stats.h"
+#include "source.h"
+#include "server.h"
+#include "compilation.h"
+#include "bytecode.h"
+#include "optimizer.h"
+#include "natif.h"
+#include "dictionnaire.h"
+#include "idmap.h"
+#include "aiguillage.h"
 
 
 }
 
 
 %union {
-    char identifier[255];      
+    StringId identifier;      
     int type;
     int integerValue;
     double floatValue;
     bool booleanValue;
-    char stringValue[255];
+    StringId stringValue;
     struct SymbolEntry* entry;
     expression expression;
     ExpressionList* exprList;
+    Jumps jumps;
     variable variable;
 }
 
@@ -72,11 +81,12 @@ void yyerror(const char *s);
 
 /* Type definitions for non-terminals */
 %type <expression> Expression SimpleExpression
-%type <exprList> ExpressionList
+%type <exprList> ExpressionList DictItems
 %type <expression> ArrayLiteral
 %type <type> Type
 %type <entry> Declaration Parameter ParameterList NonEmptyParameterList
 %type <variable> Assignment
+%type <integerValue> CaseKeyword
 
 
 %left LOGICAL_OR
@@ -90,19 +100,27 @@ void yyerror(const char *s);
 
 %start Program
 %{
-extern FILE *yyin;
-extern int yylineno;
-extern int yyleng;
-extern int yylex();
-int currentColumn = 1;
-SymbolTable *symbolTable;
-pile * stack;
-quad *q = NULL;  // quadruplet
-int qc = 1; // pile
-
-void yysuccess(char *s);
-void yyerror(const char *s);
-void showLexicalError();
+// tout l'etat de la compilation est dans ctx (voir compilation.h)
+int yylex(YYSTYPE *lval, void *scanner);
+void yyerror(void *scanner, Compilation *ctx, const char *s);
+static int emitQuad(Compilation *ctx, StringId operateur, StringId a, StringId b, StringId r);
+static int emitLabel(Compilation *ctx, const char *label);
+static int emitBranch(Compilation *ctx, const char *label);
+static int closeIfBranch(Compilation *ctx);
+static int emitBinary(Compilation *ctx, FoldOperator op, const expression *lhs, const expression *rhs, expression *result);
+static int emitUnary(Compilation *ctx, FoldOperator op, const expression *operand, expression *result);
+static int emitArrayLiteral(Compilation *ctx, const char *text, size_t length, expression *result);
+static int declareDict(Compilation *ctx, StringId name, ExpressionList *items);
+static int caseConstant(Compilation *ctx, int start, const expression *value);
+static int conditionJumps(Compilation *ctx, const expression *expr, int fallThroughTrue, Jumps *jumps);
+static void backpatch(Compilation *ctx, JumpList *list, StringId label);
+static int placeLabel(Compilation *ctx, const char *prefix, JumpList *list);
+static int logicalLeft(Compilation *ctx, FoldOperator op, const expression *lhs, Jumps *left);
+static int emitLogical(Compilation *ctx, FoldOperator op, const expression *lhs, Jumps left,
+                       const expression *rhs, expression *result);
+static int emitNot(Compilation *ctx, const expression *operand, expression *result);
+static int conditionBranch(Compilation *ctx, const expression *condition, const char *prefix, int *id);
+static StringId quadName(const SymbolEntry *symbol);
 %}
 %%
 
@@ -158,8 +176,8 @@ ForLoop:
 
 WhileLoop:
     WhileStart StatementList ENDWHILE {
-        // Get the start label from stack
-        int whileId = depiler(stack);
+        // Get the start label from &ctx->stack
+        int whileId = depiler(&ctx->stack);
         
         // Generate labels
         char whileConditionLabel[20];
@@ -168,10 +186,10 @@ WhileLoop:
         sprintf(whileEndLabel, "WHILE_END_%d", whileId);
         
         // Generate unconditional jump back to condition
-        insererQuadreplet(&q, "BR", "", "", whileConditionLabel, qc++);
+        if (emitBranch(ctx, whileConditionLabel) < 0) YYERROR;
         
         // Place end label for the while loop
-        insererQuadreplet(&q, whileEndLabel, "", "", "", qc++);
+        if (emitLabel(ctx, whileEndLabel) < 0) YYERROR;
     }
     ;
 
@@ -179,26 +197,28 @@ WhileStart:
     WhileCondition Expression COLON {
         // Validate expression type
         if ($2.type != TYPE_BOOLEAN) {
-            yyerror("While condition must be a boolean expression");
+            compilationError(ctx, "While condition must be a boolean expression");
             YYERROR;
         }
         
-        // Generate unique ID for this while loop
-        int whileId = qc;
+        // ID empile par WhileCondition, avant les quads de la condition
+        int whileId;
+        sommet(&ctx->stack, &whileId);
         
-        // Generate label names
-        char whileConditionLabel[20];
-        char whileEndLabel[20];
-        sprintf(whileConditionLabel, "WHILE_COND_%d", whileId);
-        sprintf(whileEndLabel, "WHILE_END_%d", whileId);
-        insererQuadreplet(&q, whileConditionLabel, "", "", "", qc++);
-        insererQuadreplet(&q, "BZ",whileEndLabel , "",   $2.value, qc++);
-        empiler(stack, whileId);
+        if (conditionBranch(ctx, &$2, "WHILE_END", &whileId) < 0) YYERROR;
     }
     ;
 
 WhileCondition:
-    WHILE
+    WHILE {
+        // L'etiquette doit preceder le calcul de la condition, sinon le
+        // retour en fin de boucle ne la reevalue pas
+        int whileId = ctx->qc;
+        char whileConditionLabel[20];
+        sprintf(whileConditionLabel, "WHILE_COND_%d", whileId);
+        if (emitLabel(ctx, whileConditionLabel) < 0) YYERROR;
+        empiler(&ctx->stack, whileId);
+    }
     ;
 
 
@@ -210,28 +230,23 @@ RepeatLoop: RepeatStart StatementList RepeatEnd
 ;
 
 RepeatStart: REPEAT COLON {
-    int repeatId = qc;
+    int repeatId = ctx->qc;
     char repeatStartLabel[20];
     sprintf(repeatStartLabel, "REPEAT_START_%d", repeatId);
-    insererQuadreplet(&q, repeatStartLabel, "", "", "", qc++);
-    empiler(stack, repeatId);
+    if (emitLabel(ctx, repeatStartLabel) < 0) YYERROR;
+    empiler(&ctx->stack, repeatId);
 }
 RepeatEnd : UNTIL Expression ENDREPEAT
 {
-int repeatId = depiler(stack);
-    char repeatStartLabel[20];
+int repeatId = depiler(&ctx->stack);
     char repeatEndLabel[20];
-    sprintf(repeatStartLabel, "REPEAT_START_%d", repeatId);
     sprintf(repeatEndLabel, "REPEAT_END_%d", repeatId);
-    char typeStr[MAX_TYPE_LENGTH];
-        getTypeString($2.type, typeStr);
-
-    if (!strcmp(typeStr,"boolean")) {
-        yyerror("Repeat-until condition must be a boolean expression");
+    if ($2.type != TYPE_BOOLEAN) {
+        compilationError(ctx, "Repeat-until condition must be a boolean expression");
         YYERROR;
     }
-    insererQuadreplet(&q, "BZ", repeatStartLabel, "",  $2.value, qc++);
-    insererQuadreplet(&q, repeatEndLabel, "", "", "", qc++);
+    if (conditionBranch(ctx, &$2, "REPEAT_START", &repeatId) < 0) YYERROR;
+    if (emitLabel(ctx, repeatEndLabel) < 0) YYERROR;
 } 
 ;
 
@@ -241,973 +256,278 @@ Expression:
         $$ = $1;
     }
     | Expression ADD Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operands for null values
-    if (!$1.value || !$3.value) {
-        yyerror("Operands for addition must be initialized and have valid values.");
-        YYERROR;
-    }
-
-    // Get type information for operands
-    char type1Str[MAX_TYPE_LENGTH];
-    char type3Str[MAX_TYPE_LENGTH];
-    getTypeString($1.type, type1Str);
-    getTypeString($3.type, type3Str);
-
-    // Handle string concatenation if both operands are strings
-    if (strcmp(type1Str, "string") == 0 && strcmp(type3Str, "string") == 0) {
-        snprintf(resultValue, sizeof(resultValue), "%s%s", $1.value, $3.value);
-        
-        char valueStr[MAX_VALUE_LENGTH];
-        createValueString(TYPE_STRING, resultValue, valueStr);
-
-        $$.type = TYPE_STRING;
-        strncpy($$.value, resultValue, MAX_NAME_LENGTH - 1);
-        $$.value[MAX_NAME_LENGTH - 1] = '\0';
-
-        // Generate quadruplet for concatenation operation
-        insererQuadreplet(&q, "CONCAT", $1.value, $3.value, temp, qc++);
-    } 
-    // Handle numeric addition
-    else {
-        // Handle floating point addition
-        if (strcmp(type1Str, "float") == 0 || strcmp(type3Str, "float") == 0) {
-            $$.type = TYPE_FLOAT;
-            float val1 = atof($1.value);
-            float val2 = atof($3.value);
-            snprintf(resultValue, sizeof(resultValue), "%.2f", val1 + val2);
-            
-            char valueStr[MAX_VALUE_LENGTH];
-            createValueString($$.type, resultValue, valueStr);
-            
-            strncpy($$.value, resultValue, MAX_NAME_LENGTH - 1);
-            $$.value[MAX_NAME_LENGTH - 1] = '\0';
-
-            // Generate quadruplet for addition operation
-            insererQuadreplet(&q, "+", $1.value, $3.value, temp, qc++);
-        } 
-        // Handle integer addition
-        else {
-            $$.type = TYPE_INTEGER;
-            int val1 = atoi($1.value);
-            int val2 = atoi($3.value);
-            snprintf(resultValue, sizeof(resultValue), "%d", val1 + val2);
-            
-            char valueStr[MAX_VALUE_LENGTH];
-            createValueString($$.type, resultValue, valueStr);
-            
-            strncpy($$.value, resultValue, MAX_NAME_LENGTH - 1);
-            $$.value[MAX_NAME_LENGTH - 1] = '\0';
-
-            // Generate quadruplet for addition operation
-            insererQuadreplet(&q, "+", $1.value, $3.value, temp, qc++);
-        }
+        if (emitBinary(ctx, FOLD_ADD, &$1, &$3, &$$) < 0) YYERROR;
     }
-}
-
     | Expression SUB Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operands for null values
-    if (!$1.value || !$3.value) {
-        yyerror("Operands for subtraction must be initialized and have valid values.");
-        YYERROR;
+        if (emitBinary(ctx, FOLD_SUB, &$1, &$3, &$$) < 0) YYERROR;
     }
-
-    // Get type information for operands
-    char type1Str[MAX_TYPE_LENGTH];
-    char type3Str[MAX_TYPE_LENGTH];
-    getTypeString($1.type, type1Str);
-    getTypeString($3.type, type3Str);
-
-    // Handle floating point subtraction
-    if (strcmp(type1Str, "float") == 0 || strcmp(type3Str, "float") == 0) {
-        $$.type = TYPE_FLOAT;
-        float val1 = atof($1.value);
-        float val2 = atof($3.value);
-        snprintf(resultValue, sizeof(resultValue), "%.2f", val1 - val2);
-        
-        char valueStr[MAX_VALUE_LENGTH];
-        createValueString($$.type, resultValue, valueStr);
-        
-        // Store result in expression value
-        strncpy($$.value, resultValue, MAX_NAME_LENGTH - 1);
-        $$.value[MAX_NAME_LENGTH - 1] = '\0';
-
-        // Generate quadruplet for subtraction operation
-        insererQuadreplet(&q, "-", $1.value, $3.value, temp, qc++);
-    } 
-    // Handle integer subtraction
-    else {
-        $$.type = TYPE_INTEGER;
-        int val1 = atoi($1.value);
-        int val2 = atoi($3.value);
-        snprintf(resultValue, sizeof(resultValue), "%d", val1 - val2);
-        
-        char valueStr[MAX_VALUE_LENGTH];
-        createValueString($$.type, resultValue, valueStr);
-        
-        // Store result in expression value
-        strncpy($$.value, resultValue, MAX_NAME_LENGTH - 1);
-        $$.value[MAX_NAME_LENGTH - 1] = '\0';
-
-        // Generate quadruplet for subtraction operation
-        insererQuadreplet(&q, "-", $1.value, $3.value, temp, qc++);
-    }
-}
-
-
     | Expression MUL Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operands for null values
-    if (!$1.value || !$3.value) {
-        yyerror("Operands for subtraction must be initialized and have valid values.");
-        YYERROR;
+        if (emitBinary(ctx, FOLD_MUL, &$1, &$3, &$$) < 0) YYERROR;
     }
-
-    // Get type information for operands
-    char type1Str[MAX_TYPE_LENGTH];
-    char type3Str[MAX_TYPE_LENGTH];
-    getTypeString($1.type, type1Str);
-    getTypeString($3.type, type3Str);
-
-    // Handle floating point subtraction
-    if (strcmp(type1Str, "float") == 0 || strcmp(type3Str, "float") == 0) {
-        $$.type = TYPE_FLOAT;
-        float val1 = atof($1.value);
-        float val2 = atof($3.value);
-        snprintf(resultValue, sizeof(resultValue), "%.2f", val1 * val2);
-        
-        char valueStr[MAX_VALUE_LENGTH];
-        createValueString($$.type, resultValue, valueStr);
-        
-        // Store result in expression value
-        strncpy($$.value, resultValue, MAX_NAME_LENGTH - 1);
-        $$.value[MAX_NAME_LENGTH - 1] = '\0';
-
-        // Generate quadruplet for subtraction operation
-        insererQuadreplet(&q, "-", $1.value, $3.value, temp, qc++);
-    } 
-    // Handle integer subtraction
-    else {
-        $$.type = TYPE_INTEGER;
-        int val1 = atoi($1.value);
-        int val2 = atoi($3.value);
-        snprintf(resultValue, sizeof(resultValue), "%d", val1 * val2);
-        
-        char valueStr[MAX_VALUE_LENGTH];
-        createValueString($$.type, resultValue, valueStr);
-        
-        // Store result in expression value
-        strncpy($$.value, resultValue, MAX_NAME_LENGTH - 1);
-        $$.value[MAX_NAME_LENGTH - 1] = '\0';
-
-        // Generate quadruplet for subtraction operation
-        insererQuadreplet(&q, "-", $1.value, $3.value, temp, qc++);
-    }
-}
-
     | Expression DIV Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operands for null values
-    if (!$1.value || !$3.value) {
-        yyerror("Operands for division must be initialized and have valid values.");
-        YYERROR;
-    }
-
-    // Check for division by zero
-    if (atof($3.value) == 0) {
-        yyerror("Division by zero error");
-        YYERROR;
-    }
-
-    // Get type information for operands
-    char type1Str[MAX_TYPE_LENGTH];
-    char type3Str[MAX_TYPE_LENGTH];
-    getTypeString($1.type, type1Str);
-    getTypeString($3.type, type3Str);
-
-    // Always return float for regular division
-    $$.type = TYPE_FLOAT;
-    float val1 = atof($1.value);
-    float val2 = atof($3.value);
-    snprintf(resultValue, sizeof(resultValue), "%.2f", val1 / val2);
-    
-    char valueStr[MAX_VALUE_LENGTH];
-    createValueString($$.type, resultValue, valueStr);
-    
-    // Store result in expression value
-    strncpy($$.value, resultValue, MAX_NAME_LENGTH - 1);
-    $$.value[MAX_NAME_LENGTH - 1] = '\0';
-
-    // Generate quadruplet for division operation
-    insererQuadreplet(&q, "/", $1.value, $3.value, temp, qc++);
-}
-
-| Expression DIV Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operands for null values
-    if (!$1.value || !$3.value) {
-        yyerror("Operands for integer division must be initialized and have valid values.");
-        YYERROR;
-    }
-
-    // Check for division by zero
-    if (atoi($3.value) == 0) {
-        yyerror("Division by zero error");
-        YYERROR;
+        if (emitBinary(ctx, FOLD_DIV, &$1, &$3, &$$) < 0) YYERROR;
     }
-
-    // Get type information for operands
-    char type1Str[MAX_TYPE_LENGTH];
-    char type3Str[MAX_TYPE_LENGTH];
-    getTypeString($1.type, type1Str);
-    getTypeString($3.type, type3Str);
-
-    // Integer division always returns integer
-    $$.type = TYPE_INTEGER;
-    int val1 = atoi($1.value);
-    int val2 = atoi($3.value);
-    snprintf(resultValue, sizeof(resultValue), "%d", val1 / val2);
-    
-    char valueStr[MAX_VALUE_LENGTH];
-    createValueString($$.type, resultValue, valueStr);
-    
-    // Store result in expression value
-    strncpy($$.value, resultValue, MAX_NAME_LENGTH - 1);
-    $$.value[MAX_NAME_LENGTH - 1] = '\0';
-
-    // Generate quadruplet for integer division operation
-    insererQuadreplet(&q, "DIV", $1.value, $3.value, temp, qc++);
-}
-
-
     | Expression INT_DIV Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operands for null values
-    if (!$1.value || !$3.value) {
-        yyerror("Operands for integer division must be initialized and have valid values.");
-        YYERROR;
+        if (emitBinary(ctx, FOLD_IDIV, &$1, &$3, &$$) < 0) YYERROR;
     }
-
-    // Check for division by zero
-    if (atoi($3.value) == 0) {
-        yyerror("Division by zero error");
-        YYERROR;
-    }
-
-    // Get type information for operands
-    char type1Str[MAX_TYPE_LENGTH];
-    char type3Str[MAX_TYPE_LENGTH];
-    getTypeString($1.type, type1Str);
-    getTypeString($3.type, type3Str);
-
-    // Integer division always returns integer
-    $$.type = TYPE_INTEGER;
-    int val1 = atoi($1.value);
-    int val2 = atoi($3.value);
-    snprintf(resultValue, sizeof(resultValue), "%d", val1 / val2);
-    
-    char valueStr[MAX_VALUE_LENGTH];
-    createValueString($$.type, resultValue, valueStr);
-    
-    // Store result in expression value
-    strncpy($$.value, resultValue, MAX_NAME_LENGTH - 1);
-    $$.value[MAX_NAME_LENGTH - 1] = '\0';
-
-    // Generate quadruplet for integer division operation
-    insererQuadreplet(&q, "DIV", $1.value, $3.value, temp, qc++);
-}
-
     | Expression MOD Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operands for null values
-    if (!$1.value || !$3.value) {
-        yyerror("Operands for modulo must be initialized and have valid values.");
-        YYERROR;
+        if (emitBinary(ctx, FOLD_MOD, &$1, &$3, &$$) < 0) YYERROR;
     }
-
-    // Check for modulo by zero
-    if (atoi($3.value) == 0) {
-        yyerror("Modulo by zero error");
-        YYERROR;
+    | Expression EQUAL Expression {
+        if (emitBinary(ctx, FOLD_EQ, &$1, &$3, &$$) < 0) YYERROR;
     }
-
-    // Get type information for operands
-    char type1Str[MAX_TYPE_LENGTH];
-    char type3Str[MAX_TYPE_LENGTH];
-    getTypeString($1.type, type1Str);
-    getTypeString($3.type, type3Str);
-
-    // Modulo operation always returns integer
-    $$.type = TYPE_INTEGER;
-    int val1 = atoi($1.value);
-    int val2 = atoi($3.value);
-    snprintf(resultValue, sizeof(resultValue), "%d", val1 % val2);
-    
-    char valueStr[MAX_VALUE_LENGTH];
-    createValueString($$.type, resultValue, valueStr);
-    
-    // Store result in expression value
-    strncpy($$.value, resultValue, MAX_NAME_LENGTH - 1);
-    $$.value[MAX_NAME_LENGTH - 1] = '\0';
-
-    // Generate quadruplet for modulo operation
-    insererQuadreplet(&q, "MOD", $1.value, $3.value, temp, qc++);
-}
-
-
-    |Expression EQUAL Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operands for null values
-    if (!$1.value || !$3.value) {
-        yyerror("Operands for equality comparison must be initialized and have valid values.");
-        YYERROR;
-    }
-
-    // Get type information for operands
-    char type1Str[MAX_TYPE_LENGTH];
-    char type3Str[MAX_TYPE_LENGTH];
-    getTypeString($1.type, type1Str);
-    getTypeString($3.type, type3Str);
-
-    // Handle string comparison
-    if (strcmp(type1Str, "string") == 0 && strcmp(type3Str, "string") == 0) {
-        int result = strcmp($1.value, $3.value) == 0;
-        snprintf(resultValue, sizeof(resultValue), "%s", result ? "true" : "false");
-    }
-    // Handle numeric comparison
-    else {
-        float val1 = atof($1.value);
-        float val2 = atof($3.value);
-        int result = (val1 == val2);
-        snprintf(resultValue, sizeof(resultValue), "%s", result ? "true" : "false");
-    }
-
-    // Set type to boolean
-    $$.type = TYPE_BOOLEAN;
-    
-    char valueStr[MAX_VALUE_LENGTH];
-    createValueString($$.type, resultValue, valueStr);
-    
-    // Store result in expression value
-    strncpy($$.value, resultValue, MAX_NAME_LENGTH - 1);
-    $$.value[MAX_NAME_LENGTH - 1] = '\0';
-
-    // Generate quadruplet for equality comparison
-    insererQuadreplet(&q, "==", $1.value, $3.value, temp, qc++);
-}
-
-
     | Expression NOT_EQUAL Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operands for null values
-    if (!$1.value || !$3.value) {
-        yyerror("Operands for inequality comparison must be initialized and have valid values.");
-        YYERROR;
-    }
-
-    // Get type information for operands
-    char type1Str[MAX_TYPE_LENGTH];
-    char type3Str[MAX_TYPE_LENGTH];
-    getTypeString($1.type, type1Str);
-    getTypeString($3.type, type3Str);
-
-    // Handle string comparison
-    if (strcmp(type1Str, "string") == 0 && strcmp(type3Str, "string") == 0) {
-        int result = strcmp($1.value, $3.value) != 0;
-        snprintf(resultValue, sizeof(resultValue), "%s", result ? "true" : "false");
-    }
-    // Handle numeric comparison
-    else {
-        float val1 = atof($1.value);
-        float val2 = atof($3.value);
-        int result = (val1 != val2);
-        snprintf(resultValue, sizeof(resultValue), "%s", result ? "true" : "false");
-    }
-
-    // Set type to boolean
-    $$.type = TYPE_BOOLEAN;
-    
-    char valueStr[MAX_VALUE_LENGTH];
-    createValueString($$.type, resultValue, valueStr);
-    
-    // Store result in expression value
-    strncpy($$.value, resultValue, MAX_NAME_LENGTH - 1);
-    $$.value[MAX_NAME_LENGTH - 1] = '\0';
-
-    // Generate quadruplet for inequality comparison
-    insererQuadreplet(&q, "!=", $1.value, $3.value, temp, qc++);
-}
-
-
-    |Expression GREATER_THAN Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operands for null values
-    if (!$1.value || !$3.value) {
-        yyerror("Operands for greater than comparison must be initialized and have valid values.");
-        YYERROR;
-    }
-
-    // Get type information for operands
-    char type1Str[MAX_TYPE_LENGTH];
-    char type3Str[MAX_TYPE_LENGTH];
-    getTypeString($1.type, type1Str);
-    getTypeString($3.type, type3Str);
-
-    // Handle string comparison
-    if (strcmp(type1Str, "string") == 0 && strcmp(type3Str, "string") == 0) {
-        int result = strcmp($1.value, $3.value) > 0;
-        snprintf(resultValue, sizeof(resultValue), "%s", result ? "true" : "false");
+        if (emitBinary(ctx, FOLD_NE, &$1, &$3, &$$) < 0) YYERROR;
     }
-    // Handle float comparison
-    else if (strcmp(type1Str, "float") == 0 || strcmp(type3Str, "float") == 0) {
-        float val1 = atof($1.value);
-        float val2 = atof($3.value);
-        int result = (val1 > val2);
-        snprintf(resultValue, sizeof(resultValue), "%s", result ? "true" : "false");
+    | Expression GREATER_THAN Expression {
+        if (emitBinary(ctx, FOLD_GT, &$1, &$3, &$$) < 0) YYERROR;
     }
-    // Handle integer comparison
-    else {
-        int val1 = atoi($1.value);
-        int val2 = atoi($3.value);
-        int result = (val1 > val2);
-        snprintf(resultValue, sizeof(resultValue), "%s", result ? "true" : "false");
-    }
-
-    // Set type to boolean
-    $$.type = TYPE_BOOLEAN;
-    
-    char valueStr[MAX_VALUE_LENGTH];
-    createValueString($$.type, resultValue, valueStr);
-    
-    // Store result in expression value
-    strncpy($$.value, resultValue, MAX_NAME_LENGTH - 1);
-    $$.value[MAX_NAME_LENGTH - 1] = '\0';
-
-    // Generate quadruplet for greater than comparison
-    insererQuadreplet(&q, ">", $1.value, $3.value, temp, qc++);
-}
-
-
-
     | Expression LESS_THAN Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operands for null values
-    if (!$1.value || !$3.value) {
-        yyerror("Operands for less than comparison must be initialized and have valid values.");
-        YYERROR;
-    }
-
-    // Get type information for operands
-    char type1Str[MAX_TYPE_LENGTH];
-    char type3Str[MAX_TYPE_LENGTH];
-    getTypeString($1.type, type1Str);
-    getTypeString($3.type, type3Str);
-
-    // Handle string comparison
-    if (strcmp(type1Str, "string") == 0 && strcmp(type3Str, "string") == 0) {
-        strcpy(resultValue, strcmp($1.value, $3.value) < 0 ? "true" : "false");
-    }
-    // Handle float comparison
-    else if (strcmp(type1Str, "float") == 0 || strcmp(type3Str, "float") == 0) {
-        float val1 = atof($1.value);
-        float val2 = atof($3.value);
-        strcpy(resultValue, val1 < val2 ? "true" : "false");
+        if (emitBinary(ctx, FOLD_LT, &$1, &$3, &$$) < 0) YYERROR;
     }
-    // Handle integer comparison
-    else {
-        int val1 = atoi($1.value);
-        int val2 = atoi($3.value);
-        strcpy(resultValue, val1 < val2 ? "true" : "false");
-    }
-
-    // Set type to boolean
-    $$.type = TYPE_BOOLEAN;
-    strcpy($$.value, resultValue);
-
-    // Generate quadruplet for less than comparison
-    insererQuadreplet(&q, "<", $1.value, $3.value, temp, qc++);
-}
-
-
     | Expression GREATER_EQUAL Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operands for null values
-    if (!$1.value || !$3.value) {
-        yyerror("Operands for greater than or equal comparison must be initialized and have valid values.");
-        YYERROR;
+        if (emitBinary(ctx, FOLD_GE, &$1, &$3, &$$) < 0) YYERROR;
     }
-
-    // Get type information for operands
-    char type1Str[MAX_TYPE_LENGTH];
-    char type3Str[MAX_TYPE_LENGTH];
-    getTypeString($1.type, type1Str);
-    getTypeString($3.type, type3Str);
-
-    // Handle string comparison
-    if (strcmp(type1Str, "string") == 0 && strcmp(type3Str, "string") == 0) {
-        strcpy(resultValue, strcmp($1.value, $3.value) >= 0 ? "true" : "false");
-    }
-    // Handle float comparison
-    else if (strcmp(type1Str, "float") == 0 || strcmp(type3Str, "float") == 0) {
-        float val1 = atof($1.value);
-        float val2 = atof($3.value);
-        strcpy(resultValue, val1 >= val2 ? "true" : "false");
-    }
-    // Handle integer comparison
-    else {
-        int val1 = atoi($1.value);
-        int val2 = atoi($3.value);
-        strcpy(resultValue, val1 >= val2 ? "true" : "false");
-    }
-
-    // Set type to boolean
-    $$.type = TYPE_BOOLEAN;
-    strcpy($$.value, resultValue);
-
-    // Generate quadruplet for greater than or equal comparison
-    insererQuadreplet(&q, ">=", $1.value, $3.value, temp, qc++);
-}
-
-
     | Expression LESS_EQUAL Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operands for null values
-    if (!$1.value || !$3.value) {
-        yyerror("Operands for less than or equal comparison must be initialized and have valid values.");
-        YYERROR;
-    }
-
-    // Get type information for operands
-    char type1Str[MAX_TYPE_LENGTH];
-    char type3Str[MAX_TYPE_LENGTH];
-    getTypeString($1.type, type1Str);
-    getTypeString($3.type, type3Str);
-
-    // Handle string comparison
-    if (strcmp(type1Str, "string") == 0 && strcmp(type3Str, "string") == 0) {
-        strcpy(resultValue, strcmp($1.value, $3.value) <= 0 ? "true" : "false");
+        if (emitBinary(ctx, FOLD_LE, &$1, &$3, &$$) < 0) YYERROR;
     }
-    // Handle float comparison
-    else if (strcmp(type1Str, "float") == 0 || strcmp(type3Str, "float") == 0) {
-        float val1 = atof($1.value);
-        float val2 = atof($3.value);
-        strcpy(resultValue, val1 <= val2 ? "true" : "false");
+    | Expression LOGICAL_AND {
+        // gauche fausse : la droite n'est pas evaluee
+        if (logicalLeft(ctx, FOLD_AND, &$1, &$<jumps>$) < 0) YYERROR;
+    } Expression {
+        if (emitLogical(ctx, FOLD_AND, &$1, $<jumps>3, &$4, &$$) < 0) YYERROR;
     }
-    // Handle integer comparison
-    else {
-        int val1 = atoi($1.value);
-        int val2 = atoi($3.value);
-        strcpy(resultValue, val1 <= val2 ? "true" : "false");
+    | Expression LOGICAL_OR {
+        // gauche vraie : la droite n'est pas evaluee
+        if (logicalLeft(ctx, FOLD_OR, &$1, &$<jumps>$) < 0) YYERROR;
+    } Expression {
+        if (emitLogical(ctx, FOLD_OR, &$1, $<jumps>3, &$4, &$$) < 0) YYERROR;
     }
-
-    // Set type to boolean
-    $$.type = TYPE_BOOLEAN;
-    strcpy($$.value, resultValue);
-
-    // Generate quadruplet for less than or equal comparison
-    insererQuadreplet(&q, "<=", $1.value, $3.value, temp, qc++);
-}
-
-
-    | Expression LOGICAL_AND Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operands for null values
-    if (!$1.value || !$3.value) {
-        yyerror("Operands for logical AND must be initialized and have valid values.");
-        YYERROR;
-    }
-
-    // Get type information for operands
-    char type1Str[MAX_TYPE_LENGTH];
-    char type3Str[MAX_TYPE_LENGTH];
-    getTypeString($1.type, type1Str);
-    getTypeString($3.type, type3Str);
-
-    // Both operands must be boolean
-    if ($1.type != TYPE_BOOLEAN || $3.type != TYPE_BOOLEAN) {
-        yyerror("Logical AND requires boolean operands");
-        YYERROR;
-    }
-
-    // Perform logical AND operation
-    bool val1 = strcmp($1.value, "true") == 0;
-    bool val2 = strcmp($3.value, "true") == 0;
-    strcpy(resultValue, (val1 && val2) ? "true" : "false");
-
-    // Set type to boolean
-    $$.type = TYPE_BOOLEAN;
-    strcpy($$.value, resultValue);
-
-    // Generate quadruplet for logical AND operation
-    insererQuadreplet(&q, "AND", $1.value, $3.value, temp, qc++);
-}
- 
-
-    | Expression LOGICAL_OR Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operands for null values
-    if (!$1.value || !$3.value) {
-        yyerror("Operands for logical OR must be initialized and have valid values.");
-        YYERROR;
-    }
-
-    // Get type information for operands
-    char type1Str[MAX_TYPE_LENGTH];
-    char type3Str[MAX_TYPE_LENGTH];
-    getTypeString($1.type, type1Str);
-    getTypeString($3.type, type3Str);
-
-    // Both operands must be boolean
-    if ($1.type != TYPE_BOOLEAN || $3.type != TYPE_BOOLEAN) {
-        yyerror("Logical OR requires boolean operands");
-        YYERROR;
-    }
-
-    // Perform logical OR operation
-    bool val1 = strcmp($1.value, "true") == 0;
-    bool val2 = strcmp($3.value, "true") == 0;
-    strcpy(resultValue, (val1 || val2) ? "true" : "false");
-
-    // Set type to boolean
-    $$.type = TYPE_BOOLEAN;
-    strcpy($$.value, resultValue);
-
-    // Generate quadruplet for logical OR operation
-    insererQuadreplet(&q, "OR", $1.value, $3.value, temp, qc++);
-}
-
-
     | LOGICAL_NOT Expression {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operand for null value
-    if (!$2.value) {
-        yyerror("Operand for logical NOT must be initialized and have a valid value.");
-        YYERROR;
-    }
-
-    // Get type information for operand
-    char typeStr[MAX_TYPE_LENGTH];
-    getTypeString($2.type, typeStr);
-
-    // Operand must be boolean
-    if ($2.type != TYPE_BOOLEAN) {
-        yyerror("Logical NOT requires a boolean operand");
-        YYERROR;
+        if (emitNot(ctx, &$2, &$$) < 0) YYERROR;
     }
-
-    // Perform logical NOT operation
-    bool val = strcmp($2.value, "true") == 0;
-    strcpy(resultValue, (!val) ? "true" : "false");
-
-    // Set type to boolean
-    $$.type = TYPE_BOOLEAN;
-    strcpy($$.value, resultValue);
-
-    // Generate quadruplet for logical NOT operation
-    insererQuadreplet(&q, "NOT", $2.value, "", temp, qc++);
-}
-
-
     | SUB Expression %prec UMINUS {
-    char resultValue[MAX_VALUE_LENGTH];
-    char temp[MAX_NAME_LENGTH];
-    snprintf(temp, sizeof(temp), "t%d", qc);
-
-    // Validate operand for null value
-    if (!$2.value) {
-        yyerror("Operand for unary minus must be initialized and have a valid value.");
-        YYERROR;
-    }
-
-    // Get type information for operand
-    char typeStr[MAX_TYPE_LENGTH];
-    getTypeString($2.type, typeStr);
-
-    // Handle float negation
-    if (strcmp(typeStr, "float") == 0) {
-        $$.type = TYPE_FLOAT;
-        float val = -atof($2.value);
-        snprintf(resultValue, sizeof(resultValue), "%.2f", val);
-    }
-    // Handle integer negation
-    else if (strcmp(typeStr, "int") == 0) {
-        $$.type = TYPE_INTEGER;
-        int val = -atoi($2.value);
-        snprintf(resultValue, sizeof(resultValue), "%d", val);
+        if (emitUnary(ctx, FOLD_NEG, &$2, &$$) < 0) YYERROR;
     }
-    // Error for non-numeric types
-    else {
-        yyerror("Unary minus requires numeric operand");
-        YYERROR;
-    }
-
-    strcpy($$.value, resultValue);
-
-    // Generate quadruplet for unary minus operation
-    insererQuadreplet(&q, "UMINUS", $2.value, "", temp, qc++);
-}
     ;
 
-
-
-
-
 SimpleExpression:
     INT_LITERAL {
         $$.type = TYPE_INTEGER;
-        snprintf($$.value, MAX_NAME_LENGTH, "%d", $1);
+        $$.constant = true;
+        $$.as.i = $1;
+        $$.place = valuePlace(&$$);
     }
     | FLOAT_LITERAL {
         $$.type = TYPE_FLOAT;
-        snprintf($$.value, MAX_NAME_LENGTH, "%.2f", $1);
+        $$.constant = true;
+        $$.as.f = $1;
+        $$.place = valuePlace(&$$);
     }
     | STRING_LITERAL {
         $$.type = TYPE_STRING;
-        strncpy($$.value, $1, MAX_NAME_LENGTH - 1);
-        $$.value[MAX_NAME_LENGTH - 1] = '\0';
+        $$.constant = true;
+        $$.as.s = $1;
+        $$.place = valuePlace(&$$);
+        if ($$.place == STRING_ID_NONE) {
+            compilationError(ctx, "Out of memory in string literal");
+            YYERROR;
+        }
     }
     | TRUE {
         $$.type = TYPE_BOOLEAN;
-        strcpy($$.value, "true");
+        $$.as.b = true;
+        $$.constant = true;
+        $$.place = internString("true");
     }
     | FALSE {
         $$.type = TYPE_BOOLEAN;
-        strcpy($$.value, "false");
+        $$.as.b = false;
+        $$.constant = true;
+        $$.place = internString("false");
     }
     | ID {
-        SymbolEntry *symbol = lookupSymbolByName(symbolTable, $1, 0);
+        SymbolEntry *symbol = lookupSymbolByName(ctx->symbolTable, $1, currentScope(ctx->symbolTable));
         if (!symbol) {
-            yyerror("Undefined identifier");
+            compilationError(ctx, "Undefined identifier");
             YYERROR;
         }
         
-        if (strcmp(symbol->type, "int") == 0) $$.type = TYPE_INTEGER;
-        else if (strcmp(symbol->type, "float") == 0) $$.type = TYPE_FLOAT;
-        else if (strcmp(symbol->type, "string") == 0) $$.type = TYPE_STRING;
-        else if (strcmp(symbol->type, "bool") == 0) $$.type = TYPE_BOOLEAN;
-        
-        strncpy($$.value, symbol->value, MAX_NAME_LENGTH - 1);
-        $$.value[MAX_NAME_LENGTH - 1] = '\0';
+        parseValue(symbol->type, symbolValue(symbol), &$$);
+        $$.constant = symbol->isKnown;
+        $$.place = quadName(symbol);
     }
     | ArrayLiteral {
         $$ = $1;
     }
-    | LPAREN Expression RPAREN 
+    | SimpleExpression LBRACKET Expression RBRACKET {
+        // acces a une cle : INDEX d, cle, $tN
+        if (emitBinary(ctx, FOLD_INDEX, &$1, &$3, &$$) < 0) YYERROR;
+    }
+    | ID LPAREN Expression RPAREN {
+        // reductions predefinies sur un tableau
+        const char *name = internedString($1);
+        FoldOperator op = strcmp(name, "sum") == 0 ? FOLD_SUM
+                        : strcmp(name, "min") == 0 ? FOLD_MIN
+                        : strcmp(name, "max") == 0 ? FOLD_MAX : FOLD_COUNT;
+        if (op == FOLD_COUNT) {
+            compilationError(ctx, "Unknown function (expected sum, min or max)");
+            YYERROR;
+        }
+        if (emitUnary(ctx, op, &$3, &$$) < 0) YYERROR;
+    }
+    | LPAREN Expression RPAREN {
+        $$ = $2;
+    }
     | FunctionCall
     ;
 
 Declaration:
     LET Type ID BE Expression {
 
-        if (symbolExistsByName(symbolTable, $3, 0)) {
+        if (symbolExistsInScope(ctx->symbolTable, $3, currentScope(ctx->symbolTable))) {
             char error[100];
-            snprintf(error, sizeof(error), "Symbol '%s' already declared", $3);
-            yyerror(error);
+            snprintf(error, sizeof(error), "Symbol '%s' already declared", internedString($3));
+            compilationError(ctx, error);
             YYERROR;
         }
-        char exprTypeStr[MAX_TYPE_LENGTH];
-        getTypeString($5.type, exprTypeStr);
-        printf("Expression type: %s\n", exprTypeStr);
+        fprintf(ctx->out, "Expression type: %s\n", symbolTypeName($5.type));
 
         // Validate types match
-        char typeStr[MAX_TYPE_LENGTH];
-        getTypeString($2, typeStr);
-        printf("Type retourne: %s\n", typeStr);
+        fprintf(ctx->out, "Type retourne: %s\n", symbolTypeName($2));
 
          if ($2 != $5.type) {
             char error[100];
             snprintf(error, sizeof(error), 
                     "Type mismatch: Cannot assign %s to variable of type %s", 
-                    exprTypeStr, typeStr);
-            yyerror(error);
+                    symbolTypeName($5.type), symbolTypeName($2));
+            compilationError(ctx, error);
             YYERROR;
         }
 
-        // Create value string
-        char valueStr[MAX_VALUE_LENGTH];
-        createValueString($2, ($5.value), valueStr);
+        // Value as displayed by the symbol table
+        char valueBuffer[MAX_NUMBER_LENGTH];
+        const char *valueStr = formatValue(&$5, valueBuffer, sizeof(valueBuffer));
         // Insert into symbol table
-        insertSymbol(symbolTable, $3, typeStr, valueStr, 0, false, true);
+        insertSymbol(ctx->symbolTable, $3, $2, valueStr, currentScope(ctx->symbolTable), false, true);
         
-        // Generate quadruplet
-        char temp[20];
-        sprintf(temp, "t%d", qc);
-        insererQuadreplet(&q, ":=", valueStr, "", $3, qc++);
-
         // Look up the inserted symbol to return it
-        $$ = lookupSymbolByName(symbolTable, $3, 0);
+        $$ = lookupSymbolByName(ctx->symbolTable, $3, currentScope(ctx->symbolTable));
         if (!$$) {
-            yyerror("Failed to retrieve newly inserted symbol");
+            compilationError(ctx, "Failed to retrieve newly inserted symbol");
             YYERROR;
         }
+
+        // Generate quadruplet
+        if (emitQuad(ctx, internString(":="), $5.place, STRING_ID_NONE, quadName($$)) < 0) YYERROR;
         
         
     }
     | CONST Type ID BE Expression {
-        if (symbolExistsByName(symbolTable, $3, 0)) {
+        if (symbolExistsInScope(ctx->symbolTable, $3, currentScope(ctx->symbolTable))) {
             char error[100];
-            snprintf(error, sizeof(error), "Symbol '%s' already declared", $3);
-            yyerror(error);
+            snprintf(error, sizeof(error), "Symbol '%s' already declared", internedString($3));
+            compilationError(ctx, error);
             YYERROR;
         }
 
-                // Validate types match
-        char typeStr[MAX_TYPE_LENGTH];
-        getTypeString($2, typeStr);
-                char exprTypeStr[MAX_TYPE_LENGTH];
-        getTypeString($5.type, exprTypeStr);
-        printf("Expression type: %s\n", exprTypeStr);
+        // Validate types match
+        fprintf(ctx->out, "Expression type: %s\n", symbolTypeName($5.type));
             if ($2 != $5.type) {
         char error[100];
         snprintf(error, sizeof(error), 
                 "Type mismatch: Cannot assign %s to constant of type %s", 
-                exprTypeStr, typeStr);
-        yyerror(error);
+                symbolTypeName($5.type), symbolTypeName($2));
+        compilationError(ctx, error);
         YYERROR;
     }
 
-        // Create value string
-        char valueStr[MAX_VALUE_LENGTH];
-        createValueString($2, ($5.value), valueStr);
+        // Value as displayed by the symbol table
+        char valueBuffer[MAX_NUMBER_LENGTH];
+        const char *valueStr = formatValue(&$5, valueBuffer, sizeof(valueBuffer));
 
         // Insert into symbol table
-        insertSymbol(symbolTable, $3, typeStr, valueStr, 0, true, true);
+        insertSymbol(ctx->symbolTable, $3, $2, valueStr, currentScope(ctx->symbolTable), true, true);
         
-        // Generate quadruplet
-        char temp[20];
-        sprintf(temp, "t%d", qc);
-        insererQuadreplet(&q, ":=", valueStr, "", $3, qc++);
-
         // Look up the inserted symbol to return it
-        $$ = lookupSymbolByName(symbolTable, $3, 0);
+        $$ = lookupSymbolByName(ctx->symbolTable, $3, currentScope(ctx->symbolTable));
         if (!$$) {
-            yyerror("Failed to retrieve newly inserted symbol");
+            compilationError(ctx, "Failed to retrieve newly inserted symbol");
             YYERROR;
         }
+        // une constante calculee depuis des variables n'est connue qu'a l'execution
+        $$->isKnown = $5.constant;
+
+        // Generate quadruplet
+        if (emitQuad(ctx, internString(":="), $5.place, STRING_ID_NONE, quadName($$)) < 0) YYERROR;
     }
     | Type ID {
         // Check for existing symbol
-        if (symbolExistsByName(symbolTable, $2, 0)) {
+        if (symbolExistsInScope(ctx->symbolTable, $2, currentScope(ctx->symbolTable))) {
             char error[100];
-            snprintf(error, sizeof(error), "Symbol '%s' already declared", $2);
-            yyerror(error);
+            snprintf(error, sizeof(error), "Symbol '%s' already declared", internedString($2));
+            compilationError(ctx, error);
             YYERROR;
         }
 
-        // Get type string
-        char typeStr[MAX_TYPE_LENGTH];
+        // Default value for the type
         char valueStr[MAX_VALUE_LENGTH];
-        getTypeString($1, typeStr);
-        
         createValueString($1, NULL, valueStr);
 
         // Insert into symbol table with default value
-        insertSymbol(symbolTable, $2, typeStr, valueStr, 0, false, false);
+        insertSymbol(ctx->symbolTable, $2, $1, valueStr, currentScope(ctx->symbolTable), false, false);
         
-        // Generate quadruplet for default initialization
-        char temp[20];
-        sprintf(temp, "t%d", qc);
-        insererQuadreplet(&q, ":=", valueStr, "", $2, qc++);
-
         // Look up the inserted symbol to return it
-        $$ = lookupSymbolByName(symbolTable, $2, 0);
+        $$ = lookupSymbolByName(ctx->symbolTable, $2, currentScope(ctx->symbolTable));
         if (!$$) {
-            yyerror("Failed to retrieve newly inserted symbol");
+            compilationError(ctx, "Failed to retrieve newly inserted symbol");
             YYERROR;
         }
 
+        // Generate quadruplet for default initialization
+        expression initial;
+        parseValue($1, valueStr, &initial);
+        if (emitQuad(ctx, internString(":="), valuePlace(&initial), STRING_ID_NONE, quadName($$)) < 0) YYERROR;
+
     }
     ;
     |   LET ARRAY ID BE ArrayLiteral {
-        printf("Array declaration with initialization started\n");
+        fprintf(ctx->out, "Array declaration with initialization started\n");
         
         // Check for existing symbol
-        if (symbolExistsByName(symbolTable, $3, 0)) {
-            yyerror("Cannot redeclare identifier");
+        if (symbolExistsInScope(ctx->symbolTable, $3, currentScope(ctx->symbolTable))) {
+            compilationError(ctx, "Cannot redeclare identifier");
             YYERROR;
         }
         
-        // Get the array's element type
-        char typeStr[MAX_TYPE_LENGTH];
-        getTypeString(TYPE_ARRAY, typeStr);
-        
-        
         // Create an empty array entry in symbol table
-        insertSymbol(symbolTable, $3, typeStr, "[]", 0, false, true);
+        insertSymbol(ctx->symbolTable, $3, TYPE_ARRAY, "[]", currentScope(ctx->symbolTable), false, true);
         
         // Get the newly created symbol
-        SymbolEntry* arraySymbol = lookupSymbolByName(symbolTable, $3, 0);
+        SymbolEntry* arraySymbol = lookupSymbolByName(ctx->symbolTable, $3, currentScope(ctx->symbolTable));
         if (!arraySymbol) {
-            yyerror("Failed to create array symbol");
+            compilationError(ctx, "Failed to create array symbol");
             YYERROR;
         }
         
         // Validate array type matches declared type
         expression arrayExpr = $5;
         if (arrayExpr.type != TYPE_ARRAY) {
-            yyerror("Type mismatch: Expected array literal");
+            compilationError(ctx, "Type mismatch: Expected array literal");
             YYERROR;
         }
         
         // Update the array value in symbol table
-        updateSymbolValue(symbolTable, arraySymbol->id, arrayExpr.value, 0);
+        char valueBuffer[MAX_NUMBER_LENGTH];
+        updateSymbolValue(ctx->symbolTable, arraySymbol->id,
+                          formatValue(&arrayExpr, valueBuffer, sizeof(valueBuffer)), currentScope(ctx->symbolTable));
         
-        // Generate array declaration quadruplet
-        char temp[20];
-        sprintf(temp, "t%d", qc);
-        insererQuadreplet(&q, "ARRAY_DECL", $3, arrayExpr.value, temp, qc++);
+        // ArrayLiteral vient de construire le tableau dans un temporaire :
+        // son quad ARRAY_DECL (le dernier emis) definit directement le nom
+        obtenirQuad(&ctx->quads, ctx->qc - 1)->operande1 = quadName(arraySymbol);
         
         $$ = arraySymbol;
-        printf("Array '%s' declared successfully\n", $3);
+        fprintf(ctx->out, "Array '%s' declared successfully\n", internedString($3));
     }
     ;
 
@@ -1237,58 +557,104 @@ Type:
 Assignment:
     ID EQUAL Expression {
         // Check if identifier exists
-        SymbolEntry *symbol = lookupSymbolByName(symbolTable, $1, 0);
+        SymbolEntry *symbol = lookupSymbolByName(ctx->symbolTable, $1, currentScope(ctx->symbolTable));
         if (!symbol) {
-            yyerror("Undefined identifier");
+            compilationError(ctx, "Undefined identifier");
             YYERROR;
         }
         
         // Check if trying to modify a constant
         if (symbol->isConst) {
-            yyerror("Cannot modify constant value");
+            compilationError(ctx, "Cannot modify constant value");
             YYERROR;
         }
         
         // Type compatibility check
-        int symbolType;
-        if (strcmp(symbol->type, "int") == 0) symbolType = TYPE_INTEGER;
-        else if (strcmp(symbol->type, "float") == 0) symbolType = TYPE_FLOAT;
-        else if (strcmp(symbol->type, "string") == 0) symbolType = TYPE_STRING;
-        else if (strcmp(symbol->type, "bool") == 0) symbolType = TYPE_BOOLEAN;
-        
-        if (symbolType != $3.type) {
-            yyerror("Type mismatch in assignment");
+        if (symbol->type != $3.type) {
+            compilationError(ctx, "Type mismatch in assignment");
             YYERROR;
         }
         
         // Update symbol table with the new value
-        updateSymbolValue(symbolTable, symbol->id, $3.value, 0);
+        char valueBuffer[MAX_NUMBER_LENGTH];
+        updateSymbolValue(ctx->symbolTable, symbol->id,
+                          formatValue(&$3, valueBuffer, sizeof(valueBuffer)), currentScope(ctx->symbolTable));
         
         // Generate quadruplet for assignment
-        insererQuadreplet(&q, ":=", $3.value, "", $1, qc++);
+        if (emitQuad(ctx, internString(":="), $3.place, STRING_ID_NONE, quadName(symbol)) < 0) YYERROR;
     }
 PrintStatement:
-    PRINT Expression 
+    PRINT Expression {
+        if (emitQuad(ctx, internString("PRINT"), $2.place, STRING_ID_NONE, STRING_ID_NONE) < 0) YYERROR;
+    }
     ;
 
 InputStatement:
-    INPUT Expression TO ID 
+    INPUT Expression TO ID {
+        SymbolEntry *symbol = lookupSymbolByName(ctx->symbolTable, $4, currentScope(ctx->symbolTable));
+        if (!symbol) {
+            compilationError(ctx, "Undefined identifier");
+            YYERROR;
+        }
+        if (symbol->isConst) {
+            compilationError(ctx, "Cannot modify constant value");
+            YYERROR;
+        }
+        // le message est affiche puis la ligne lue est convertie au type de la variable
+        if (emitQuad(ctx, internString("INPUT"), $2.place, STRING_ID_NONE, quadName(symbol)) < 0) YYERROR;
+    }
     ;
 
 
 
 Function:
-    FUNCTION ID COLON Type LPAREN ParameterList RPAREN LBRACE StatementList RBRACE
+    FunctionHeader FunctionParameterList RPAREN LBRACE StatementList RBRACE {
+        // Les parametres et les declarations du corps disparaissent ici
+        popScope(ctx->symbolTable);
+    }
+    ;
+
+FunctionHeader:
+    FUNCTION ID COLON Type LPAREN {
+        pushScope(ctx->symbolTable);
+    }
+    ;
+
+FunctionParameterList:
+    /* empty */
+    | NonEmptyFunctionParameterList
+    ;
+
+NonEmptyFunctionParameterList:
+    FunctionParameter
+    | NonEmptyFunctionParameterList COMMA FunctionParameter
+    ;
+
+FunctionParameter:
+    Type ID {
+        if (symbolExistsInScope(ctx->symbolTable, $2, currentScope(ctx->symbolTable))) {
+            char error[100];
+            snprintf(error, sizeof(error), "Parameter '%s' already declared", internedString($2));
+            compilationError(ctx, error);
+            YYERROR;
+        }
+
+        char valueStr[MAX_VALUE_LENGTH];
+        createValueString($1, NULL, valueStr);
+
+        // Parameter bound in the function scope, initialized by the caller
+        insertSymbol(ctx->symbolTable, $2, $1, valueStr, currentScope(ctx->symbolTable), false, true);
+    }
     ;
 
 
 
 FunctionCall:
     CALL ID WITH PARAMETERS ParameterList LPAREN ExpressionList RPAREN {
-        printf("Appel valide avec parametres\n");
+        fprintf(ctx->out, "Appel valide avec parametres\n");
     }
     | CALL ID LPAREN RPAREN {
-        printf("Appel valide sans parametres\n");
+        fprintf(ctx->out, "Appel valide sans parametres\n");
     }
     ;
 
@@ -1309,27 +675,116 @@ Parameter:
 
 
 Condition:
-    SimpleIf
-    | IfWithElse
+    IfStart StatementList IfRest
     ;
 
+// La pile garde, pour chaque If ouvert, son ID (etiquette IF_END_id) puis
+// l'ID de l'etiquette IF_NEXT_n vers laquelle saute la derniere condition
+IfStart:
+    IF Expression COLON {
+        if ($2.type != TYPE_BOOLEAN) {
+            compilationError(ctx, "If condition must be a boolean expression");
+            YYERROR;
+        }
+        // ID : numero du dernier quad de la condition
+        int ifId = -1;
+        if (conditionBranch(ctx, &$2, "IF_NEXT", &ifId) < 0) YYERROR;
+        empiler(&ctx->stack, ifId);
+        empiler(&ctx->stack, ifId);
+    }
+    ;
 
-SimpleIf:
-    IF Expression COLON StatementList ENDIF
-
+IfRest:
+    ENDIF {
+        int nextId = depiler(&ctx->stack);
+        int ifId = depiler(&ctx->stack);
+        char nextLabel[20];
+        char endLabel[20];
+        sprintf(nextLabel, "IF_NEXT_%d", nextId);
+        sprintf(endLabel, "IF_END_%d", ifId);
+        if (emitLabel(ctx, nextLabel) < 0) YYERROR;
+        if (emitLabel(ctx, endLabel) < 0) YYERROR;
+    }
+    | ElseStart StatementList ENDIF {
+        int ifId = depiler(&ctx->stack);
+        char endLabel[20];
+        sprintf(endLabel, "IF_END_%d", ifId);
+        if (emitLabel(ctx, endLabel) < 0) YYERROR;
+    }
+    | ElseIfCondition StatementList IfRest
+    ;
 
-IfWithElse:
-    IF Expression COLON StatementList ElseIfList
+ElseStart:
+    ELSE COLON {
+        if (closeIfBranch(ctx) < 0) YYERROR;
+    }
+    ;
 
+ElseIfStart:
+    ELSEIF {
+        // la condition du elseIf est evaluee apres l'etiquette IF_NEXT
+        if (closeIfBranch(ctx) < 0) YYERROR;
+    }
+    ;
 
-ElseIfList:
-    ELSE COLON StatementList ENDIF {
-        // Generate quadruplets for ELSE block
-        
+ElseIfCondition:
+    ElseIfStart Expression COLON {
+        if ($2.type != TYPE_BOOLEAN) {
+            compilationError(ctx, "ElseIf condition must be a boolean expression");
+            YYERROR;
+        }
+        int nextId = -1;
+        if (conditionBranch(ctx, &$2, "IF_NEXT", &nextId) < 0) YYERROR;
+        empiler(&ctx->stack, nextId);
     }
-    | ELSEIF Expression COLON StatementList ElseIfList 
+    ;
+
+// Les corps des cas sont emis dans l'ordre du source ; le choix du cas,
+// qui depend de toutes les valeurs, est place apres eux (voir aiguillage.h)
 SwitchStatement:
-    SWITCH Expression COLON CaseList ENDSWITCH
+    SwitchStart CaseList ENDSWITCH {
+        Aiguillage *sw = ctx->switches;
+        char label[32];
+        sprintf(label, "SWITCH_TEST_%d", sw->id);
+        if (emitLabel(ctx, label) < 0) YYERROR;
+        int status = emettreAiguillage(&ctx->quads, &ctx->qc, sw, ctx->out);
+        if (status == AIGUILLAGE_DOUBLON) {
+            compilationError(ctx, "Duplicate case value");
+            YYERROR;
+        }
+        if (status < 0) {
+            compilationError(ctx, "Out of memory in Switch");
+            YYERROR;
+        }
+        sprintf(label, "SWITCH_END_%d", sw->id);
+        if (emitLabel(ctx, label) < 0) YYERROR;
+        ctx->switches = sw->englobant;
+    }
+    ;
+
+SwitchStart:
+    SWITCH Expression COLON {
+        if ($2.type != TYPE_INTEGER && $2.type != TYPE_FLOAT && $2.type != TYPE_BOOLEAN &&
+            $2.type != TYPE_STRING) {
+            compilationError(ctx, "Switch expression must be an int, float, bool or str");
+            YYERROR;
+        }
+        Aiguillage *sw = (Aiguillage *)parseAlloc(&ctx->arena, sizeof(Aiguillage));
+        if (!sw) {
+            compilationError(ctx, "Out of memory in Switch");
+            YYERROR;
+        }
+        memset(sw, 0, sizeof(*sw));
+        sw->id = ctx->qc;
+        sw->type = $2.type;
+        sw->selecteur = $2.place;
+        sw->defaut = STRING_ID_NONE;
+        sw->englobant = ctx->switches;
+        ctx->switches = sw;
+        char label[32];
+        sprintf(label, "SWITCH_TEST_%d", sw->id);
+        if (emitBranch(ctx, label) < 0) YYERROR;
+    }
     ;
 
 CaseList:
@@ -1342,46 +797,66 @@ CaseItems:
     ;
 
 CaseItem:
-    CASE Expression COLON StatementList
+    CaseStart StatementList {
+        char label[32];
+        sprintf(label, "SWITCH_END_%d", ctx->switches->id);
+        if (emitBranch(ctx, label) < 0) YYERROR;
+    }
+    ;
+
+CaseKeyword:
+    CASE {
+        // premier quad de la valeur du cas
+        $$ = ctx->qc;
+    }
+    ;
+
+CaseStart:
+    CaseKeyword Expression COLON {
+        if (caseConstant(ctx, $1, &$2) < 0) YYERROR;
+    }
     ;
 
 DefaultPart:
     /* empty */
-    | DEFAULT COLON StatementList
+    | DefaultStart StatementList {
+        char label[32];
+        sprintf(label, "SWITCH_END_%d", ctx->switches->id);
+        if (emitBranch(ctx, label) < 0) YYERROR;
+    }
+    ;
+
+DefaultStart:
+    DEFAULT COLON {
+        char label[32];
+        sprintf(label, "SWITCH_DEFAULT_%d", ctx->switches->id);
+        ctx->switches->defaut = internString(label);
+        if (emitLabel(ctx, label) < 0) YYERROR;
+    }
     ;
 
 
+// Le litteral est construit dans un temporaire (ARRAY_DECL $tN, [p1,...], $tN) :
+// son texte n'a pas de limite de longueur, et les noms de ses elements
+// restent des utilisations visibles de l'optimiseur
 ArrayLiteral:
     LBRACKET RBRACKET {
         $$.type = TYPE_ARRAY;
-        ArrayType* arr = createArray();
-        if (!arr) {
-            yyerror("Failed to create empty array");
+        $$.constant = true;
+        $$.as.a = createArray();
+        if (!$$.as.a) {
+            compilationError(ctx, "Failed to create empty array");
             YYERROR;
         }
-        $$.data = arr;
-        strcpy($$.value, "[]");
+        if (emitArrayLiteral(ctx, "[]", 2, &$$) < 0) YYERROR;
     }
     | LBRACKET ExpressionList RBRACKET {
         $$.type = TYPE_ARRAY;
-        ArrayType* arr = createArrayFromExprList($2);
-        if (!arr) {
-            yyerror("Failed to create array from expression list");
-            YYERROR;
-        }
-        $$.data = arr;
-        
-        // Create string representation of array
-        char arrayStr[MAX_NAME_LENGTH] = "[";
-        ExpressionList* current = $2;
-        while (current) {
-            strncat(arrayStr, current->expr.value, MAX_NAME_LENGTH - strlen(arrayStr) - 1);
-            if (current->next) strncat(arrayStr, ",", MAX_NAME_LENGTH - strlen(arrayStr) - 1);
-            current = current->next;
-        }
-        strncat(arrayStr, "]", MAX_NAME_LENGTH - strlen(arrayStr) - 1);
-        strncpy($$.value, arrayStr, MAX_NAME_LENGTH - 1);
-        $$.value[MAX_NAME_LENGTH - 1] = '\0';
+        $$.constant = $2->constant;
+        $$.as.a = $2->values;
+        // addExpressionToList garde toujours la place du crochet fermant
+        $2->places[$2->length] = ']';
+        if (emitArrayLiteral(ctx, $2->places, $2->length + 1, &$$) < 0) YYERROR;
     }
     ;
 
@@ -1389,87 +864,789 @@ ArrayLiteral:
 
 ExpressionList:
     Expression {
-        $$ = createExpressionNode($1);
+        $$ = createExpressionList(&ctx->arena, &$1);
+        if (!$$) {
+            compilationError(ctx, "Out of memory in expression list");
+            YYERROR;
+        }
     }
     | ExpressionList COMMA Expression {
-        $$ = addExpressionToList($1, $3);
+        $$ = addExpressionToList(&ctx->arena, $1, &$3);
+        if (!$$) {
+            compilationError(ctx, "Out of memory in expression list");
+            YYERROR;
+        }
     }
     ;
+// Le dictionnaire est construit directement dans sa variable :
+// DICT_DECL nom, {"k1":p1,...}, [deplacements;graine du hachage parfait]
 DictLiteral:
-    LET DICT ID BE LBRACE RBRACE  // Empty dictionary with DICT keyword
-    | LET DICT ID BE LBRACE DictItems RBRACE  // Dictionary with items
+    LET DICT ID BE LBRACE RBRACE {
+        if (declareDict(ctx, $3, NULL) < 0) YYERROR;
+    }
+    | LET DICT ID BE LBRACE DictItems RBRACE {
+        if (declareDict(ctx, $3, $6) < 0) YYERROR;
+    }
     ;
 
 DictItems:
-    DictItem  // Single item
-    | DictItems COMMA DictItem  // Multiple items separated by commas
-    ;
-
-DictItem:
-    STRING_LITERAL COLON Expression  // Key-value pair
+    STRING_LITERAL COLON Expression {
+        $$ = createDictItems(&ctx->arena, $1, &$3);
+        if (!$$) {
+            compilationError(ctx, "Out of memory in dict literal");
+            YYERROR;
+        }
+    }
+    | DictItems COMMA STRING_LITERAL COLON Expression {
+        $$ = addDictItem(&ctx->arena, $1, $3, &$5);
+        if (!$$) {
+            compilationError(ctx, "Out of memory in dict literal");
+            YYERROR;
+        }
+    }
     ;
 
 %%
 
 /* Gestion des erreurs */
-void yyerror(const char *s) {
+// quad "operateur a b r" numero ctx->qc ; -1 apres avoir signale l'erreur
+// si la memoire manque (ctx->qc n'avance pas : le programme incomplet
+// n'est pas garde)
+static int emitQuad(Compilation *ctx, StringId operateur, StringId a, StringId b, StringId r) {
+    if (insererQuadrepletId(&ctx->quads, operateur, a, b, r, ctx->qc) < 0) {
+        compilationError(ctx, "Out of memory while emitting quads");
+        return -1;
+    }
+    ctx->qc++;
+    return 0;
+}
+
+static int emitLabel(Compilation *ctx, const char *label) {
+    return emitQuad(ctx, internString(label), STRING_ID_NONE, STRING_ID_NONE, STRING_ID_NONE);
+}
+
+static int emitBranch(Compilation *ctx, const char *label) {
+    return emitQuad(ctx, internString("BR"), STRING_ID_NONE, STRING_ID_NONE, internString(label));
+}
+
+// fin d'une branche de If : saut vers IF_END puis etiquette de la
+// condition suivante (elseIf ou else)
+static int closeIfBranch(Compilation *ctx) {
+    int nextId = depiler(&ctx->stack);
+    int ifId;
+    sommet(&ctx->stack, &ifId);
+    char nextLabel[20];
+    char endLabel[20];
+    sprintf(nextLabel, "IF_NEXT_%d", nextId);
+    sprintf(endLabel, "IF_END_%d", ifId);
+    if (emitBranch(ctx, endLabel) < 0) {
+        return -1;
+    }
+    return emitLabel(ctx, nextLabel);
+}
+
+// operateur binaire ou unaire : type et valeur du resultat par la table de
+// semantic.c, puis quad "op lhs rhs $tN" ; -1 apres avoir signale l'erreur
+static int emitBinary(Compilation *ctx, FoldOperator op, const expression *lhs, const expression *rhs, expression *result) {
+    char error[MAX_FOLD_ERROR_LENGTH];
+    const char *quadOperator = foldBinary(op, lhs, rhs, result, error);
+    if (!quadOperator) {
+        compilationError(ctx, error);
+        return -1;
+    }
+    result->place = internFormat("$t%d", ctx->qc);
+    return emitQuad(ctx, internString(quadOperator), lhs->place, rhs->place, result->place);
+}
+
+static int emitUnary(Compilation *ctx, FoldOperator op, const expression *operand, expression *result) {
+    char error[MAX_FOLD_ERROR_LENGTH];
+    const char *quadOperator = foldUnary(op, operand, result, error);
+    if (!quadOperator) {
+        compilationError(ctx, error);
+        return -1;
+    }
+    result->place = internFormat("$t%d", ctx->qc);
+    return emitQuad(ctx, internString(quadOperator), operand->place, STRING_ID_NONE, result->place);
+}
+
+// Valeur d'un Case : une constante, calculee par les quads emis depuis
+// start a partir de litteraux seulement ; elle est gardee dans le Switch
+// ouvert et ses quads sont retires, puis l'etiquette du corps est posee
+static int caseConstant(Compilation *ctx, int start, const expression *value) {
+    Aiguillage *sw = ctx->switches;
+    for (int qc = start; qc <= ctx->qc; qc++) {
+        // les operandes des quads, puis la place de la valeur
+        StringId operandes[2] = { value->place, STRING_ID_NONE };
+        if (qc < ctx->qc) {
+            quad *q = obtenirQuad(&ctx->quads, qc);
+            operandes[0] = q->operande1;
+            operandes[1] = q->operande2;
+        }
+        for (int k = 0; k < 2; k++) {
+            const char *texte = internedString(operandes[k]);
+            char *fin;
+            long numero = texte[0] == '$' && texte[1] == 't' ? strtol(texte + 2, &fin, 10) : -1;
+            int temporaire = numero >= start && numero < ctx->qc && *fin == '\0';
+            if (operandes[k] != STRING_ID_NONE && !temporaire && texte[0] != '"' &&
+                !(texte[0] >= '0' && texte[0] <= '9') && strcmp(texte, "true") != 0 &&
+                strcmp(texte, "false") != 0) {
+                compilationError(ctx, "Case value must be a constant");
+                return -1;
+            }
+        }
+    }
+    if (value->type != sw->type && !(sw->type == TYPE_FLOAT && value->type == TYPE_INTEGER)) {
+        compilationError(ctx, "Case value type does not match the Switch expression");
+        return -1;
+    }
+    CasAiguillage *cas = (CasAiguillage *)parseAlloc(&ctx->arena, sizeof(CasAiguillage));
+    if (!cas) {
+        compilationError(ctx, "Out of memory in Switch");
+        return -1;
+    }
+    memset(cas, 0, sizeof(*cas));
+    switch (value->type) {
+        case TYPE_INTEGER: cas->i = value->as.i; cas->f = (double)value->as.i; break;
+        case TYPE_FLOAT:   cas->f = value->as.f; break;
+        case TYPE_BOOLEAN: cas->i = value->as.b; break;
+        default:           cas->s = value->as.s; break;
+    }
+    if (sw->type == TYPE_FLOAT && !isfinite(cas->f)) {
+        compilationError(ctx, "Case value must be finite");
+        return -1;
+    }
+    ctx->quads.taille -= ctx->qc - start;
+    ctx->qc = start;
+    char label[32];
+    sprintf(label, "SWITCH_CASE_%d", ctx->qc);
+    cas->etiquette = internString(label);
+    if (emitLabel(ctx, label) < 0) {
+        return -1;
+    }
+    cas->suivant = sw->cas;
+    sw->cas = cas;
+    sw->nbCas++;
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Conditions en forme de sauts
+//
+// and, or et not sur des booleens ne calculent pas de valeur : chaque
+// operande finit par des sauts vers la suite vraie ou fausse (Jumps), dont
+// la cible est posee (backpatch) des qu'elle est connue. La droite d'un and
+// n'est atteinte que si la gauche est vraie, celle d'un or que si elle est
+// fausse. Le resultat n'est rendu en booleen (:= true / := false dans un
+// temporaire) qu'a la fin de l'operateur ; une condition (If, ElseIf,
+// While, Until) ou un autre and / or / not qui le suit immediatement
+// retire ces quads et reprend directement ses sauts.
+
+// etiquette prefix_qc, cible des sauts de list
+static int placeLabel(Compilation *ctx, const char *prefix, JumpList *list) {
+    char label[32];
+    snprintf(label, sizeof(label), "%s_%d", prefix, ctx->qc);
+    if (emitLabel(ctx, label) < 0) {
+        return -1;
+    }
+    backpatch(ctx, list, internString(label));
+    return 0;
+}
+
+// cible des sauts de list : resultat d'un BR, operande1 d'un BZ / BNZ
+static void backpatch(Compilation *ctx, JumpList *list, StringId label) {
+    StringId br = internString("BR");
+    for (; list; list = list->next) {
+        quad *q = obtenirQuad(&ctx->quads, list->qc);
+        if (q->operateur == br) {
+            q->resultat = label;
+        } else {
+            q->operande1 = label;
+        }
+    }
+}
+
+// a parcourue : la plus courte, la droite d'un and / or
+static JumpList *mergeJumps(JumpList *a, JumpList *b) {
+    if (!a) {
+        return b;
+    }
+    JumpList *last = a;
+    while (last->next) {
+        last = last->next;
+    }
+    last->next = b;
+    return a;
+}
+
+// saut "operateur , , condition" a completer, ajoute a *list
+static int emitJump(Compilation *ctx, const char *operateur, StringId condition, JumpList **list) {
+    JumpList *jump = (JumpList *)parseAlloc(&ctx->arena, sizeof(JumpList));
+    if (!jump) {
+        compilationError(ctx, "Out of memory in condition");
+        return -1;
+    }
+    jump->qc = ctx->qc;
+    if (strcmp(operateur, "BR") == 0) {
+        condition = STRING_ID_NONE;
+    }
+    if (emitQuad(ctx, internString(operateur), STRING_ID_NONE, STRING_ID_NONE, condition) < 0) {
+        return -1;
+    }
+    jump->next = *list;
+    *list = jump;
+    return 0;
+}
+
+// expr est-il le dernier and / or / not rendu en booleen, sans rien apres ?
+static int isMaterialized(const Compilation *ctx, const expression *expr) {
+    return ctx->condition.end == ctx->qc && expr->type == TYPE_BOOLEAN &&
+           expr->place == ctx->condition.place;
+}
+
+// Sauts de la condition expr, deja calculee ; le code se termine sur la
+// suite vraie si fallThroughTrue, sinon sur la suite fausse
+static int conditionJumps(Compilation *ctx, const expression *expr, int fallThroughTrue, Jumps *jumps) {
+    jumps->trueList = NULL;
+    jumps->falseList = NULL;
+    if (isMaterialized(ctx, expr)) {
+        // ses quads := true / := false disparaissent, ses sauts restent
+        *jumps = ctx->condition.jumps;
+        ctx->quads.taille -= ctx->qc - ctx->condition.start;
+        ctx->qc = ctx->condition.start;
+        ctx->condition.end = 0;
+        if (!fallThroughTrue) {
+            if (emitJump(ctx, "BR", STRING_ID_NONE, &jumps->trueList) < 0) return -1;
+            if (jumps->falseList) {
+                if (placeLabel(ctx, "BOOL_FALSE", jumps->falseList) < 0) return -1;
+                jumps->falseList = NULL;
+            }
+        }
+        return 0;
+    }
+    if (expr->place == internString("true") || expr->place == internString("false")) {
+        int value = expr->place == internString("true");
+        return value == fallThroughTrue ? 0 :
+               emitJump(ctx, "BR", STRING_ID_NONE, value ? &jumps->trueList : &jumps->falseList);
+    }
+    // not x qui vient d'etre calcule : on teste x
+    StringId place = expr->place;
+    int sense = 1;
+    if (ctx->qc > ctx->quads.premier && expr->type == TYPE_BOOLEAN) {
+        quad *last = obtenirQuad(&ctx->quads, ctx->qc - 1);
+        if (last->operateur == internString("NOT") && last->resultat == place) {
+            place = last->operande1;
+            sense = 0;
+            ctx->quads.taille--;
+            ctx->qc--;
+        }
+    }
+    if (fallThroughTrue) {
+        return emitJump(ctx, sense ? "BZ" : "BNZ", place, &jumps->falseList);
+    }
+    return emitJump(ctx, sense ? "BNZ" : "BZ", place, &jumps->trueList);
+}
+
+// booleen de la condition jumps (son code se termine sur la suite vraie),
+// dans le temporaire $tN du premier quad
+static int materializeJumps(Compilation *ctx, Jumps jumps, expression *result) {
+    int start = ctx->qc;
+    StringId temp = internFormat("$t%d", start);
+    result->place = temp;
+    if (jumps.trueList && placeLabel(ctx, "BOOL_TRUE", jumps.trueList) < 0) {
+        return -1;
+    }
+    if (emitQuad(ctx, internString(":="), internString("true"), STRING_ID_NONE, temp) < 0) {
+        return -1;
+    }
+    if (jumps.falseList) {
+        char endLabel[32];
+        snprintf(endLabel, sizeof(endLabel), "BOOL_END_%d", start);
+        if (emitBranch(ctx, endLabel) < 0 || placeLabel(ctx, "BOOL_FALSE", jumps.falseList) < 0 ||
+            emitQuad(ctx, internString(":="), internString("false"), STRING_ID_NONE, temp) < 0 ||
+            emitLabel(ctx, endLabel) < 0) {
+            return -1;
+        }
+    }
+    ctx->condition.jumps = jumps;
+    ctx->condition.place = temp;
+    ctx->condition.start = start;
+    ctx->condition.end = ctx->qc;
+    return 0;
+}
+
+// gauche d'un and (suite vraie : la droite) ou d'un or (suite fausse : la
+// droite) ; rien a faire si elle n'est pas booleenne (tableaux)
+static int logicalLeft(Compilation *ctx, FoldOperator op, const expression *lhs, Jumps *left) {
+    left->trueList = NULL;
+    left->falseList = NULL;
+    if (lhs->type != TYPE_BOOLEAN) {
+        return 0;
+    }
+    if (conditionJumps(ctx, lhs, op == FOLD_AND, left) < 0) {
+        return -1;
+    }
+    JumpList **right = op == FOLD_AND ? &left->trueList : &left->falseList;
+    if (*right) {
+        if (placeLabel(ctx, "BOOL_NEXT", *right) < 0) {
+            return -1;
+        }
+        *right = NULL;
+    }
+    return 0;
+}
+
+static int emitLogical(Compilation *ctx, FoldOperator op, const expression *lhs, Jumps left,
+                       const expression *rhs, expression *result) {
+    if (lhs->type != TYPE_BOOLEAN) {
+        return emitBinary(ctx, op, lhs, rhs, result);
+    }
+    char error[MAX_FOLD_ERROR_LENGTH];
+    if (!foldBinary(op, lhs, rhs, result, error) || rhs->type != TYPE_BOOLEAN) {
+        // bool and tableau : la gauche a deja decide, la droite n'est plus
+        // calculee sur tous les chemins
+        snprintf(error, sizeof(error), "Type mismatch: operator '%s' cannot be applied to %s and %s",
+                 op == FOLD_AND ? "and" : "or", symbolTypeName(lhs->type), symbolTypeName(rhs->type));
+        compilationError(ctx, error);
+        return -1;
+    }
+    Jumps right;
+    if (conditionJumps(ctx, rhs, 1, &right) < 0) {
+        return -1;
+    }
+    Jumps jumps;
+    if (op == FOLD_AND) {
+        jumps.trueList = right.trueList;
+        jumps.falseList = mergeJumps(right.falseList, left.falseList);
+    } else {
+        jumps.trueList = mergeJumps(right.trueList, left.trueList);
+        jumps.falseList = right.falseList;
+    }
+    return materializeJumps(ctx, jumps, result);
+}
+
+// not d'un and / or / not : ses deux suites echangees ; sinon quad NOT
+static int emitNot(Compilation *ctx, const expression *operand, expression *result) {
+    if (!isMaterialized(ctx, operand)) {
+        return emitUnary(ctx, FOLD_NOT, operand, result);
+    }
+    char error[MAX_FOLD_ERROR_LENGTH];
+    if (!foldUnary(FOLD_NOT, operand, result, error)) {
+        compilationError(ctx, error);
+        return -1;
+    }
+    Jumps jumps;
+    if (conditionJumps(ctx, operand, 0, &jumps) < 0) {
+        return -1;
+    }
+    JumpList *trueList = jumps.trueList;
+    jumps.trueList = jumps.falseList;
+    jumps.falseList = trueList;
+    return materializeJumps(ctx, jumps, result);
+}
+
+// saut vers prefix_id si la condition est fausse (If, ElseIf, While,
+// Until), la suite vraie est le code qui suit. *id < 0 : l'ID est le
+// numero du dernier quad de la condition
+static int conditionBranch(Compilation *ctx, const expression *condition, const char *prefix, int *id) {
+    Jumps jumps;
+    if (conditionJumps(ctx, condition, 1, &jumps) < 0) {
+        return -1;
+    }
+    if (*id < 0) {
+        if (!jumps.trueList && !jumps.falseList) {
+            // toujours vraie : aucun saut, l'etiquette reserve le numero
+            if (placeLabel(ctx, "BOOL_TRUE", NULL) < 0) {
+                return -1;
+            }
+        }
+        *id = ctx->qc - 1;
+    }
+    char label[32];
+    snprintf(label, sizeof(label), "%s_%d", prefix, *id);
+    backpatch(ctx, jumps.falseList, internString(label));
+    if (jumps.trueList) {
+        return placeLabel(ctx, "BOOL_TRUE", jumps.trueList);
+    }
+    return 0;
+}
+
+static int emitArrayLiteral(Compilation *ctx, const char *text, size_t length, expression *result) {
+    StringId temp = internFormat("$t%d", ctx->qc);
+    result->place = temp;
+    return emitQuad(ctx, internString("ARRAY_DECL"), temp, internStringN(text, length), temp);
+}
+
+// Toutes les cles d'un litteral sont des constantes : leur hachage parfait
+// (dictionnaire.h) est calcule ici ; ses deplacements et sa graine vont
+// dans le champ resultat du quad ("[d0,d1,...;graine]"). Sans hachage
+// parfait (champ vide), la machine virtuelle range les cles par adressage
+// ouvert
+static int declareDict(Compilation *ctx, StringId name, ExpressionList *items) {
+    if (symbolExistsInScope(ctx->symbolTable, name, currentScope(ctx->symbolTable))) {
+        compilationError(ctx, "Cannot redeclare identifier");
+        return -1;
+    }
+    uint32_t count = items ? (uint32_t)items->values->length : 0;
+    IdMap seen;
+    if (initIdMap(&seen, count) < 0) {
+        compilationError(ctx, "Out of memory in dict literal");
+        return -1;
+    }
+    for (uint32_t k = 0; k < count; k++) {
+        if (idMapGet(&seen, items->keys[k], -1) >= 0) {
+            freeIdMap(&seen);
+            compilationError(ctx, "Duplicate key in dict literal");
+            return -1;
+        }
+        idMapPut(&seen, items->keys[k], (int32_t)k);
+    }
+    freeIdMap(&seen);
+
+    expression dict;
+    dict.type = TYPE_DICT;
+    dict.as.d = createDict(items);
+    if (!dict.as.d) {
+        compilationError(ctx, "Out of memory in dict literal");
+        return -1;
+    }
+    char valueBuffer[MAX_NUMBER_LENGTH];
+    insertSymbol(ctx->symbolTable, name, TYPE_DICT, formatValue(&dict, valueBuffer, sizeof(valueBuffer)),
+                 currentScope(ctx->symbolTable), false, true);
+    freeDict(dict.as.d);
+    SymbolEntry *symbol = lookupSymbolByName(ctx->symbolTable, name, currentScope(ctx->symbolTable));
+    if (!symbol) {
+        compilationError(ctx, "Failed to retrieve newly inserted symbol");
+        return -1;
+    }
+
+    StringId text = internString("{}");
+    StringId hash = STRING_ID_NONE;
+    if (count > 0) {
+        // addDictItem garde toujours la place de l'accolade fermante
+        items->places[items->length] = '}';
+        text = internStringN(items->places, items->length + 1);
+        uint64_t *hashes = malloc(count * sizeof(uint64_t));
+        uint32_t buckets = dictBuckets(count);
+        uint32_t *displacements = malloc(buckets * sizeof(uint32_t));
+        char *list = malloc((size_t)buckets * 11 + 13);
+        for (uint32_t k = 0; hashes && k < count; k++) {
+            hashes[k] = dictHash(internedString(items->keys[k]), internedLength(items->keys[k]));
+        }
+        uint32_t seed = 0;
+        if (hashes && displacements && list && dictPerfectHash(hashes, count, displacements, &seed) == 0) {
+            size_t length = 0;
+            list[length++] = '[';
+            for (uint32_t b = 0; b < buckets; b++) {
+                length += sprintf(list + length, b ? ",%u" : "%u", displacements[b]);
+            }
+            length += sprintf(list + length, ";%u]", seed);
+            hash = internStringN(list, length);
+        } else {
+            fprintf(ctx->out, "Dict '%s': no perfect hash, using linear probing\n", internedString(name));
+        }
+        free(hashes);
+        free(displacements);
+        free(list);
+    }
+    return emitQuad(ctx, internString("DICT_DECL"), quadName(symbol), text, hash);
+}
+
+// Nom d'une variable dans les quads. Les liaisons d'une Function
+// (parametres et declarations du corps) s'appellent nom@id : elles ne
+// partagent pas la variable globale qu'elles masquent, ni celle d'une
+// autre Function ou d'une declaration globale posterieure de meme nom.
+// Le @ ne vient ni d'un identificateur ni des versions SSA (nom.N)
+static StringId quadName(const SymbolEntry *symbol) {
+    if (symbol->scopeLevel == 0) {
+        return symbol->name;
+    }
+    size_t length = internedLength(symbol->name);
+    char *text = malloc(length + 16);
+    if (!text) {
+        return symbol->name;
+    }
+    int n = snprintf(text, length + 16, "%s@%d", internedString(symbol->name), symbol->id);
+    StringId id = internStringN(text, (size_t)n);
+    free(text);
+    return id;
+}
+
+void yyerror(void *scanner, Compilation *ctx, const char *s) {
     if (strcmp(s, "syntax error") == 0) {
-        fprintf(stderr, "File '%s', line %d, character %d: syntax error, unexpected '%s'\n", 
-                file, yylineno, positionCurseur, yytext);
+        ctx->errors++;
+        fprintf(ctx->err, "File '%s', line %d, character %d: syntax error, unexpected '%s'\n", 
+                ctx->file, scannerLine(scanner), ctx->positionCurseur, scannerText(scanner));
     } else {
-        fprintf(stderr, "File '%s', line %d, character %d: %s\n", 
-                file, yylineno, positionCurseur, s);
+        compilationError(ctx, s);
     }
 }
 
-int main(void) {
-    // ouverture fichier de test
-    yyin = fopen("input.txt", "r");
-    if (!yyin) {
-        fprintf(stderr, "Error: Could not open input file\n");
+// compilation d'un fichier source ; la table des symboles, la pile et les
+// quadruplets du contexte sont remis a zero entre deux fichiers
+int compilerFichier(Compilation *ctx, const char *chemin) {
+    SourceFile source;
+    if (openSource(&source, chemin, ctx->scanner) < 0) {
+        fprintf(ctx->err, "Error: Could not open input file '%s'\n", chemin);
         return 1;
     }
+    ctx->file = chemin;
+    ctx->source = &source;
+    ctx->errors = 0;
+    clearSymbolTable(ctx->symbolTable);
+    initPile(&ctx->stack);
+    ctx->switches = NULL;
+    ctx->condition.end = 0;
+    viderQuads(&ctx->quads);
+    ctx->qc = 1;
+    printSymbolTable(ctx->out, ctx->symbolTable);
+
+    // Cache : seuls les fichiers projetes en memoire ont un contenu a hacher
+    char cle[CACHE_KEY_LENGTH + 1];
+    int enCache = ctx->cache && source.mappedLength;
+    int result = 0;
+    if (enCache) {
+        cacheKey(source.data, source.length, cle);
+    }
+    if (enCache && cacheLoad(ctx->cache, cle, source.data, source.length, ctx->symbolTable, &ctx->quads)) {
+        ctx->stats.cacheHits++;
+        ctx->qc = ctx->quads.premier + ctx->quads.taille;
+        fprintf(ctx->out, "Loaded from cache: %s\n", cle);
+    } else {
+        // Affichage du message de demarrage
+        fprintf(ctx->out, "Starting syntax analysis...\n");
+
+        // Lancement de l'analyse syntaxique
+        statsStart(&ctx->stats, PHASE_PARSE);
+        result = yyparse(ctx->scanner, ctx);
+        freeParseArena(&ctx->arena);
+        freeParseValues();
+        statsStop(&ctx->stats, PHASE_PARSE);
+
+        // seules les compilations sans aucune erreur sont gardees
+        if (enCache) {
+            ctx->stats.cacheMisses++;
+            if (result == 0 && ctx->errors == 0 &&
+                cacheStore(ctx->cache, cle, source.data, source.length, ctx->symbolTable, &ctx->quads) == 0) {
+                ctx->stats.cacheStores++;
+            }
+        }
+    }
 
-    // Creation de la table des symboles
-    symbolTable = createSymbolTable();
-    listAllSymbols(symbolTable);
+    // quads produits par l'analyse (ou relus du cache), avant -O
+    long quadsAnalyse = ctx->quads.taille;
 
-    if (!symbolTable) {
-        fprintf(stderr, "Error: Failed to create symbol table.\n");
-        fclose(yyin);
-        return 1;
+    // Optimisation (-O) : refaite a chaque fois, le cache garde les quads du parseur
+    if (ctx->optimize && result == 0 && ctx->errors == 0) {
+        OptimizerReport rapport;
+        statsStart(&ctx->stats, PHASE_OPTIMIZE);
+        optimiserQuads(&ctx->quads, ctx->symbolTable, ctx->out, &rapport);
+        statsStop(&ctx->stats, PHASE_OPTIMIZE);
+        ctx->stats.optimized += rapport.before - rapport.after;
+        ctx->stats.optimizedQuads += rapport.after;
+        ctx->qc = ctx->quads.premier + ctx->quads.taille;
+    }
+
+    // Affichage de table des symboles et des quadruplets generes
+    statsStart(&ctx->stats, PHASE_OUTPUT);
+    printSymbolTable(ctx->out, ctx->symbolTable);
+    ecrireQuads(ctx->out, &ctx->quads);
+    fflush(ctx->out);
+    statsStop(&ctx->stats, PHASE_OUTPUT);
+    statsRecordTables(&ctx->stats, ctx->symbolTable, quadsAnalyse);
+
+    // Programme binaire (-o), seulement si la compilation a reussi
+    if (ctx->bytecode && result == 0 && ctx->errors == 0 &&
+        enregistrerQuad(&ctx->quads, ctx->symbolTable, ctx->bytecode, ctx->modeFichiers) < 0) {
+        result = 1;
+    }
+
+    // Executable natif (--native), meme condition
+    if (ctx->natif && result == 0 && ctx->errors == 0 &&
+        compilerNatif(&ctx->quads, ctx->symbolTable, ctx->natif, ctx->err) < 0) {
+        result = 1;
     }
 
-    // Creation de la pile
-    stack = malloc(sizeof(pile));
-    if (!stack) {
-        fprintf(stderr, "Error: Failed to allocate memory for stack.\n");
-        fclose(yyin);
-        freeSymbolTable(symbolTable);
+    // Execution par la machine virtuelle (--run)
+    if (ctx->run && result == 0 && ctx->errors == 0) {
+        result = executerProgramme(ctx);
+    }
+
+    closeSource(&source);
+    ctx->source = NULL;
+    return result;
+}
+
+// echec du pool de chaines pendant une requete du serveur : retour dans
+// compilerRequete au lieu de quitter
+static jmp_buf requeteEchec;
+static const char *messageEchec;
+
+static void echecRequete(const char *message) {
+    messageEchec = message;
+    longjmp(requeteEchec, 1);
+}
+
+// adaptateur pour le serveur de compilation ; le serveur ne s'arrete
+// pas, l'eviction du cache se fait donc apres chaque nouvelle entree.
+// Tout ce que la requete a interne (noms, litteraux, valeurs de la table
+// des symboles) est rendu a la fin : le pool revient a son etat d'avant
+// et la memoire du serveur ne grandit pas d'une requete a l'autre
+static int compilerRequete(void *context, const char *chemin) {
+    Compilation *ctx = (Compilation *)context;
+    long entrees = ctx->stats.cacheStores;
+    InternMark marque;
+    internerMark(&marque);
+    int result;
+    if (setjmp(requeteEchec) == 0) {
+        internerOnFailure(echecRequete);
+        result = compilerFichier(ctx, chemin);
+    } else {
+        // la compilation est abandonnee la ou elle en etait
+        if (ctx->source) {
+            closeSource(ctx->source);
+            ctx->source = NULL;
+        }
+        freeParseArena(&ctx->arena);
+        freeParseValues();
+        fprintf(stderr, "Error: %s, compilation of '%s' abandoned\n", messageEchec, chemin);
+        result = 1;
+    }
+    internerOnFailure(NULL);
+    if (ctx->cache && ctx->stats.cacheStores > entrees) {
+        ctx->stats.cacheEvictions += cacheEvict(ctx->cache);
+    }
+    // plus rien ne designe les chaines de la requete
+    clearSymbolTable(ctx->symbolTable);
+    viderQuads(&ctx->quads);
+    ctx->switches = NULL;
+    ctx->condition.end = 0;
+    internerRelease(&marque);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    // options de la ligne de commande, puis les fichiers a compiler
+    // ("-" pour l'entree standard, input.txt par defaut)
+    const char **fichiers = malloc(argc * sizeof(char *));
+    int nbFichiers = 0;
+    const char *socketServeur = NULL;
+    int jobs = 1;
+    const char *repertoireCache = NULL;
+    const char *sortieBytecode = NULL;
+    const char *sortieNative = NULL;
+    int executer = 0;
+    int optimiser = 0;
+    long long tailleCache = CACHE_DEFAULT_MAX_BYTES;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            socketServeur = argv[++i];
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            jobs = atoi(argv[++i]);
+        } else if (strncmp(argv[i], "-j", 2) == 0 && atoi(argv[i] + 2) > 0) {
+            jobs = atoi(argv[i] + 2);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            sortieBytecode = argv[++i];
+        } else if (strcmp(argv[i], "--native") == 0 && i + 1 < argc) {
+            sortieNative = argv[++i];
+        } else if (strcmp(argv[i], "--run") == 0) {
+            executer = 1;
+        } else if (strcmp(argv[i], "-O") == 0) {
+            optimiser = 1;
+        } else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            // relecture d'un programme binaire, meme presentation que la compilation
+            Bytecode programme;
+            if (bytecodeMap(&programme, argv[i + 1]) < 0) {
+                fprintf(stderr, "Error: '%s' is not a valid bytecode file\n", argv[i + 1]);
+                return 1;
+            }
+            bytecodeDump(stdout, &programme);
+            bytecodeUnmap(&programme);
+            free(fichiers);
+            return 0;
+        } else if (strcmp(argv[i], "--cache") == 0) {
+            repertoireCache = CACHE_DEFAULT_DIRECTORY;
+        } else if (strncmp(argv[i], "--cache=", 8) == 0 && argv[i][8] != '\0') {
+            repertoireCache = argv[i] + 8;
+        } else if (strncmp(argv[i], "--cache-size=", 13) == 0 && atoll(argv[i] + 13) > 0) {
+            tailleCache = atoll(argv[i] + 13) << 20;
+        } else if (strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats=text") == 0) {
+            statsEnabled = STATS_TEXT;
+        } else if (strcmp(argv[i], "--stats=json") == 0) {
+            statsEnabled = STATS_JSON;
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            fprintf(stderr, "Usage: %s [--stats[=text|json]] [-j N] [--cache[=DIR]] [--cache-size=MB] [-O] [--run] [fichier...]\n"
+                            "       %s [-O] [-o programme.hsb] [--native executable] fichier\n"
+                            "       %s --dump programme.hsb\n"
+                            "       %s --serve SOCKET\n", argv[0], argv[0], argv[0], argv[0]);
+            return 1;
+        } else {
+            fichiers[nbFichiers++] = argv[i];
+        }
+    }
+    if (nbFichiers == 0) {
+        fichiers[nbFichiers++] = "input.txt";
+    }
+    if ((sortieBytecode || sortieNative) && (nbFichiers > 1 || socketServeur)) {
+        fprintf(stderr, "Error: %s takes a single input file\n", sortieBytecode ? "-o" : "--native");
+        free(fichiers);
         return 1;
     }
-    initPile(stack);
+    statsStart(&stats, PHASE_TOTAL);
 
-    // Affichage du message de demarrage
-    printf("Starting syntax analysis...\n");
+    // Creation du pool de chaines internees
+    initInterner();
 
-    // Lancement de l'analyse syntaxique
-    int result = yyparse();
-    listAllSymbols(symbolTable);
+    // Cache de compilation sur disque (desactive par defaut)
+    CompileCache cache;
+    const CompileCache *cacheActif = NULL;
+    if (repertoireCache && cacheOpen(&cache, repertoireCache, tailleCache) == 0) {
+        cacheActif = &cache;
+    }
 
-    // Affichage du message de fin
-    free(stack);
-    // Affichage de table des symboles
-    
-    // Affichage des quadruplets generes
-    afficherQuad(q);
+    int result = 0;
+    if (jobs > 1 && nbFichiers > 1 && !socketServeur) {
+        // un contexte par thread, sorties restituees dans l'ordre des fichiers
+        result = compilerEnParallele(fichiers, nbFichiers, jobs, cacheActif, executer, optimiser, &stats);
+    } else {
+        // Creation du contexte : table des symboles, pile, quadruplets, scanner
+        Compilation ctx;
+        if (initCompilation(&ctx, stdout, stderr) < 0) {
+            free(fichiers);
+            return 1;
+        }
+        ctx.cache = cacheActif;
+        ctx.bytecode = sortieBytecode;
+        // comme cacheOpen : umask() n'a pas de lecture seule
+        mode_t masque = umask(0);
+        umask(masque);
+        ctx.modeFichiers = 0666 & ~masque;
+        ctx.natif = sortieNative;
+        ctx.run = executer;
+        ctx.optimize = optimiser;
+        if (socketServeur) {
+            // le contexte reste chaud d'une requete a l'autre
+            result = runCompileServer(socketServeur, compilerRequete, &ctx);
+        } else {
+            for (int i = 0; i < nbFichiers; i++) {
+                result |= compilerFichier(&ctx, fichiers[i]);
+            }
+        }
+        statsMerge(&stats, &ctx.stats);
+        freeCompilation(&ctx);
+    }
 
-    // Liberation de la table des symboles
-    freeSymbolTable(symbolTable);
-    
-    // Fermeture du fichier
-    fclose(yyin);
+    if (cacheActif) {
+        stats.cacheEvictions += cacheEvict(cacheActif);
+    }
+
+    // Rapport --stats (sur stderr pour ne pas se meler a la sortie)
+    statsStop(&stats, PHASE_TOTAL);
+    if (statsEnabled) {
+        statsReport(stderr, &stats);
+    }
+
+    free(fichiers);
+    freeInterner();
     
     return result;
-    return 0;
-}
\ No newline at end of file
+}
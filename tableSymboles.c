@@ -1,11 +1,95 @@
 #include "tableSymboles.h"
+#include <stdint.h>
+
+// melange des bits du handle (finaliseur de MurmurHash3) : les handles
+// internes sont consecutifs, un simple modulo les regrouperait
+static unsigned int hash(StringId name) {
+    uint64_t h = name;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return (unsigned int)h;
+}
+
+// Robin Hood : on prend la case d'une entree plus proche de sa case ideale
+static void placeSlot(SymbolTable *table, SymbolEntry *entry) {
+    unsigned int mask = table->capacity - 1;
+    unsigned int index = hash(entry->name) & mask;
+    SymbolSlot current = { entry, 0 };
+
+    while (table->slots[index].entry) {
+        if (table->slots[index].distance < current.distance) {
+            SymbolSlot displaced = table->slots[index];
+            table->slots[index] = current;
+            current = displaced;
+        }
+        index = (index + 1) & mask;
+        current.distance++;
+    }
+    table->slots[index] = current;
+}
+
+// indice de la case du nom, ou -1 ; on s'arrete des qu'une case est
+// plus proche de son ideal que la distance parcourue
+static int findSlot(SymbolTable *table, StringId name) {
+    unsigned int mask = table->capacity - 1;
+    unsigned int index = hash(name) & mask;
+    unsigned int distance = 0;
+
+    while (table->slots[index].entry && table->slots[index].distance >= distance) {
+        if (table->slots[index].entry->name == name) {
+            return (int)index;
+        }
+        index = (index + 1) & mask;
+        distance++;
+    }
+    return -1;
+}
+
+// suppression par decalage arriere (pas de pierre tombale)
+static void removeSlot(SymbolTable *table, int index) {
+    unsigned int mask = table->capacity - 1;
+    unsigned int i = (unsigned int)index;
+    unsigned int next = (i + 1) & mask;
+
+    while (table->slots[next].entry && table->slots[next].distance > 0) {
+        table->slots[i] = table->slots[next];
+        table->slots[i].distance--;
+        i = next;
+        next = (next + 1) & mask;
+    }
+    table->slots[i].entry = NULL;
+    table->slots[i].distance = 0;
+    table->count--;
+}
+
+// retire entry de la chaine de son nom (et libere la case si elle est vide)
+static void unlinkEntry(SymbolTable *table, SymbolEntry *entry) {
+    int index = findSlot(table, entry->name);
+    if (index < 0) {
+        return;
+    }
+
+    SymbolEntry *current = table->slots[index].entry;
+    SymbolEntry *prev = NULL;
+    while (current && current != entry) {
+        prev = current;
+        current = current->next;
+    }
+    if (!current) {
+        return;
+    }
 
-unsigned int hash(const char *name) {
-    unsigned int hashValue = 0;
-    for (int i = 0; name[i] != '\0'; i++) {
-        hashValue = 31 * hashValue + name[i];
+    if (prev) {
+        prev->next = current->next;
+    } else if (current->next) {
+        table->slots[index].entry = current->next;
+    } else {
+        removeSlot(table, index);
     }
-    return hashValue % HASH_TABLE_SIZE;
+    table->byId[current->id] = NULL;
 }
 
 SymbolTable *createSymbolTable() {
@@ -13,17 +97,59 @@ SymbolTable *createSymbolTable() {
     if (table == NULL) {
         return NULL;
     }
-    memset(table->buckets, 0, sizeof(table->buckets));
+    table->capacity = SYMBOL_TABLE_INITIAL_CAPACITY;
+    table->count = 0;
+    table->slots = (SymbolSlot *)calloc(table->capacity, sizeof(SymbolSlot));
+    table->idCapacity = SYMBOL_TABLE_INITIAL_CAPACITY;
+    table->byId = (SymbolEntry **)calloc(table->idCapacity, sizeof(SymbolEntry *));
+    table->logCapacity = SYMBOL_TABLE_INITIAL_CAPACITY;
+    table->scopeLog = (int *)malloc(table->logCapacity * sizeof(int));
+    table->marksCapacity = SCOPE_STACK_INITIAL_CAPACITY;
+    table->scopeMarks = (int *)malloc(table->marksCapacity * sizeof(int));
+    if (!table->slots || !table->byId || !table->scopeLog || !table->scopeMarks) {
+        free(table->slots);
+        free(table->byId);
+        free(table->scopeLog);
+        free(table->scopeMarks);
+        free(table);
+        return NULL;
+    }
     table->nextId = 0;
+    table->logCount = 0;
+    table->scopeDepth = 0;
     return table;
 }
 
-void insertSymbol(SymbolTable *table, const char *name, const char *type, 
+void insertSymbol(SymbolTable *table, StringId name, int type,
                  const char *value, int scopeLevel, bool isConst, bool isInitialized) {
-    if (!table || !name || !type) {
+    if (!table) {
         return;
     }
 
+    // Grow the id index and the slots before touching them
+    if (table->nextId == table->idCapacity) {
+        int idCapacity = 2 * table->idCapacity;
+        SymbolEntry **byId = (SymbolEntry **)realloc(table->byId, idCapacity * sizeof(SymbolEntry *));
+        if (!byId) {
+            return;
+        }
+        memset(byId + table->idCapacity, 0, (idCapacity - table->idCapacity) * sizeof(SymbolEntry *));
+        table->byId = byId;
+        table->idCapacity = idCapacity;
+    }
+    if (table->logCount == table->logCapacity) {
+        int logCapacity = 2 * table->logCapacity;
+        int *scopeLog = (int *)realloc(table->scopeLog, logCapacity * sizeof(int));
+        if (!scopeLog) {
+            return;
+        }
+        table->scopeLog = scopeLog;
+        table->logCapacity = logCapacity;
+    }
+    if (table->count + 1 > table->capacity * SYMBOL_TABLE_MAX_LOAD) {
+        resizeSymbolTable(table, 2 * table->capacity);
+    }
+
     // Create new entry
     SymbolEntry *entry = (SymbolEntry *)malloc(sizeof(SymbolEntry));
     if (!entry) {
@@ -39,184 +165,164 @@ void insertSymbol(SymbolTable *table, const char *name, const char *type,
     entry->isConst = isConst;
     entry->isInitialized = isInitialized;
 
-    strncpy(entry->name, name, MAX_NAME_LENGTH - 1);
-    strncpy(entry->type, type, MAX_TYPE_LENGTH - 1);
-    
-    if (value) {
-        strncpy(entry->value, value, MAX_NAME_LENGTH - 1);
+    entry->name = name;
+    entry->type = (signed char)type;
+    entry->value = internString(value);
+
+    // Insert into table : a known name keeps its chain sorted innermost
+    // scope first, so the new entry normally becomes the head
+    table->byId[entry->id] = entry;
+    table->scopeLog[table->logCount++] = entry->id;
+    int index = findSlot(table, name);
+    if (index >= 0) {
+        SymbolEntry **link = &table->slots[index].entry;
+        while (*link && (*link)->scopeLevel > scopeLevel) {
+            link = &(*link)->next;
+        }
+        entry->next = *link;
+        *link = entry;
+    } else {
+        placeSlot(table, entry);
+        table->count++;
     }
+}
 
-    // Insert into table
-    unsigned int index = hash(name);
-    entry->next = table->buckets[index];
-    table->buckets[index] = entry;
+// reinsertion d'une entree avec son id d'origine (cache de compilation) :
+// les ids doivent arriver en ordre croissant, les trous restent vides
+void restoreSymbol(SymbolTable *table, int id, StringId name, int type,
+                   const char *value, int scopeLevel, bool isConst, bool isInitialized) {
+    if (!table || id < table->nextId) {
+        return;
+    }
+    if (id >= table->idCapacity) {
+        int idCapacity = table->idCapacity;
+        while (id >= idCapacity) {
+            idCapacity *= 2;
+        }
+        SymbolEntry **byId = (SymbolEntry **)realloc(table->byId, idCapacity * sizeof(SymbolEntry *));
+        if (!byId) {
+            return;
+        }
+        memset(byId + table->idCapacity, 0, (idCapacity - table->idCapacity) * sizeof(SymbolEntry *));
+        table->byId = byId;
+        table->idCapacity = idCapacity;
+    }
+    table->nextId = id;
+    insertSymbol(table, name, type, value, scopeLevel, isConst, isInitialized);
 }
 
-SymbolEntry *lookupSymbolByName(SymbolTable *table, const char *name, int scopeLevel) {
-    if (!table || !name) {
+SymbolEntry *lookupSymbolByName(SymbolTable *table, StringId name, int scopeLevel) {
+    if (!table) {
         return NULL;
     }
 
-    unsigned int index = hash(name);
-    SymbolEntry *entry = table->buckets[index];
-
-    while (entry) {
-        if (strcmp(entry->name, name) == 0 && entry->scopeLevel == scopeLevel) {
-            return entry;
-        }
-        entry = entry->next;
+    int index = findSlot(table, name);
+    if (index < 0) {
+        return NULL;
     }
 
-    if (scopeLevel == 1) {
-        // Check global scope
-        entry = table->buckets[index];
-        while (entry) {
-            if (strcmp(entry->name, name) == 0 && entry->scopeLevel == 0) {
-                return entry;
-            }
-            entry = entry->next;
-        }
+    // innermost binding visible from scopeLevel : the head of the chain
+    // unless the name is also bound in a deeper scope
+    SymbolEntry *entry = table->slots[index].entry;
+    while (entry && entry->scopeLevel > scopeLevel) {
+        entry = entry->next;
     }
-
-    return NULL;
+    return entry;
 }
 
 SymbolEntry *lookupSymbolById(SymbolTable *table, int id, int scopeLevel) {
-    if (!table) {
+    if (!table || id < 0 || id >= table->nextId) {
         return NULL;
     }
 
-    for (int i = 0; i < HASH_TABLE_SIZE; i++) {
-        SymbolEntry *entry = table->buckets[i];
-        while (entry) {
-            if (entry->id == id && 
-                (entry->scopeLevel == scopeLevel || 
-                 (scopeLevel == 1 && entry->scopeLevel == 0))) {
-                return entry;
-            }
-            entry = entry->next;
-        }
+    SymbolEntry *entry = table->byId[id];
+    if (entry && entry->scopeLevel <= scopeLevel) {
+        return entry;
     }
     return NULL;
 }
 
+void freeSymbolEntry(SymbolEntry *entry) {
+    free(entry);
+}
+
 void clearSymbolTable(SymbolTable *table) {
     if (!table) {
         return;
     }
 
-    for (int i = 0; i < HASH_TABLE_SIZE; i++) {
-        SymbolEntry *current = table->buckets[i];
-        while (current) {
-            SymbolEntry *next = current->next;
-            free(current);
-            current = next;
-        }
-        table->buckets[i] = NULL;
+    for (int id = 0; id < table->nextId; id++) {
+        freeSymbolEntry(table->byId[id]);
+        table->byId[id] = NULL;
     }
+    memset(table->slots, 0, table->capacity * sizeof(SymbolSlot));
+    table->count = 0;
     table->nextId = 0;
+    table->logCount = 0;
+    table->scopeDepth = 0;
 }
 
 void freeSymbolTable(SymbolTable *table) {
     if (table) {
         clearSymbolTable(table);
+        free(table->slots);
+        free(table->byId);
+        free(table->scopeLog);
+        free(table->scopeMarks);
         free(table);
     }
 }
 
-void deleteSymbolByName(SymbolTable *table, const char *name) {
-    if (!table || !name) {
+void deleteSymbolByName(SymbolTable *table, StringId name) {
+    if (!table) {
         return;
     }
 
-    unsigned int index = hash(name);
-    SymbolEntry *current = table->buckets[index];
-    SymbolEntry *prev = NULL;
-
-    while (current) {
-        if (strcmp(current->name, name) == 0) {
-            if (prev) {
-                prev->next = current->next;
-            } else {
-                table->buckets[index] = current->next;
-            }
-            free(current);
-            return;
-        }
-        prev = current;
-        current = current->next;
+    int index = findSlot(table, name);
+    if (index < 0) {
+        return;
     }
+
+    SymbolEntry *entry = table->slots[index].entry;
+    unlinkEntry(table, entry);
+    freeSymbolEntry(entry);
 }
 
 void deleteSymbolById(SymbolTable *table, int id) {
-    if (!table) {
+    if (!table || id < 0 || id >= table->nextId || !table->byId[id]) {
         return;
     }
 
-    for (int i = 0; i < HASH_TABLE_SIZE; i++) {
-        SymbolEntry *current = table->buckets[i];
-        SymbolEntry *prev = NULL;
-
-        while (current) {
-            if (current->id == id) {
-                if (prev) {
-                    prev->next = current->next;
-                } else {
-                    table->buckets[i] = current->next;
-                }
-                free(current);
-                return;
-            }
-            prev = current;
-            current = current->next;
-        }
-    }
+    SymbolEntry *entry = table->byId[id];
+    unlinkEntry(table, entry);
+    freeSymbolEntry(entry);
 }
 
 void listAllSymbols(SymbolTable *table) {
+    printSymbolTable(stdout, table);
+}
+
+void printSymbolTable(FILE *out, SymbolTable *table) {
     if (!table) {
         return;
     }
 
-    printf("\nSymbol Table Contents:\n");
-    printf("ID\tName\tType\tScope\tValue\n");
-    printf("----------------------------------------\n");
-
-    for (int i = 0; i < HASH_TABLE_SIZE; i++) {
-        SymbolEntry *current = table->buckets[i];
-        while (current) {
-            if (strncmp(current->type, "array", 5) == 0) {
-                // Print array values in a formatted way
-                printf("%d\t%s\t%s\t%d\t", 
-                    current->id,
-                    current->name,
-                    current->type,
-                    current->scopeLevel);
-                
-                // Parse and print array values from the quadruplet
-                char *value = current->value;
-                char *token = strtok(value, ",");
-                int first = 1;
-                
-                while (token != NULL) {
-                    if (!first) {
-                        printf(",");
-                    }
-                    printf("%s", token);
-                    first = 0;
-                    token = strtok(NULL, ",");
-                }
-                
-            } else {
-                printf("%d\t%s\t%s\t%d\t%s\n",
-                    current->id,
-                    current->name,
-                    current->type,
-                    current->scopeLevel,
-                    current->isInitialized ? current->value : "(uninitialized)");
-            }
-            current = current->next;
+    fprintf(out, "\nSymbol Table Contents:\n");
+    fprintf(out, "ID\tName\tType\tScope\tValue\n");
+    fprintf(out, "----------------------------------------\n");
+
+    for (int id = 0; id < table->nextId; id++) {
+        SymbolEntry *current = table->byId[id];
+        if (!current) {
+            continue;
         }
+        // arrays are always listed with their literal, even when empty
+        fprintf(out, "%d\t%s\t%s\t%d\t%s\n",
+            current->id,
+            internedString(current->name),
+            symbolTypeName(current->type),
+            current->scopeLevel,
+            current->isInitialized || current->type == TYPE_ARRAY ? symbolValue(current) : "(uninitialized)");
     }
 }
 
@@ -231,17 +337,143 @@ void updateSymbolValue(SymbolTable *table, int id, const char *newValue, int sco
         return;
     }
 
-    strncpy(entry->value, newValue, MAX_NAME_LENGTH - 1);
-    entry->value[MAX_NAME_LENGTH - 1] = '\0';
+    entry->value = internString(newValue);
     entry->isInitialized = true;
 }
 
-int symbolExistsByName(SymbolTable *table, const char *name, int scopeLevel) {
+const char *symbolValue(SymbolEntry *entry) {
+    return internedString(entry->value);
+}
+
+// noms affiches des types (indices TYPE_BOOLEAN ... TYPE_DICT)
+static const char *const typeNames[] = { "bool", "int", "float", "string", "array", "dict" };
+
+const char *symbolTypeName(int type) {
+    if (type < TYPE_BOOLEAN || type > TYPE_DICT) {
+        return "unknown";
+    }
+    return typeNames[type];
+}
+
+int symbolTypeFromName(const char *name) {
+    if (strcmp(name, "str") == 0) {
+        return TYPE_STRING;
+    }
+    for (int type = TYPE_BOOLEAN; type <= TYPE_DICT; type++) {
+        if (strcmp(name, typeNames[type]) == 0) {
+            return type;
+        }
+    }
+    return TYPE_UNKNOWN;
+}
+
+int symbolExistsByName(SymbolTable *table, StringId name, int scopeLevel) {
     return lookupSymbolByName(table, name, scopeLevel) != NULL;
 }
 
+int symbolExistsById(SymbolTable *table, int id, int scopeLevel) {
+    return lookupSymbolById(table, id, scopeLevel) != NULL;
+}
+
+// vrai si le nom est lie dans cette portee precise (redeclaration)
+int symbolExistsInScope(SymbolTable *table, StringId name, int scopeLevel) {
+    SymbolEntry *entry = lookupSymbolByName(table, name, scopeLevel);
+    return entry != NULL && entry->scopeLevel == scopeLevel;
+}
+
+int currentScope(SymbolTable *table) {
+    return table ? table->scopeDepth : 0;
+}
+
+// entree dans une portee : on retient seulement la position du journal
+void pushScope(SymbolTable *table) {
+    if (!table) {
+        return;
+    }
+    if (table->scopeDepth == table->marksCapacity) {
+        int marksCapacity = 2 * table->marksCapacity;
+        int *scopeMarks = (int *)realloc(table->scopeMarks, marksCapacity * sizeof(int));
+        if (!scopeMarks) {
+            return;
+        }
+        table->scopeMarks = scopeMarks;
+        table->marksCapacity = marksCapacity;
+    }
+    table->scopeMarks[table->scopeDepth++] = table->logCount;
+}
+
+// sortie de portee : on defait les insertions journalisees depuis l'entree,
+// chaque liaison retiree demasque la liaison englobante de meme nom
+void popScope(SymbolTable *table) {
+    if (!table || table->scopeDepth == 0) {
+        return;
+    }
+    int mark = table->scopeMarks[--table->scopeDepth];
+    while (table->logCount > mark) {
+        SymbolEntry *entry = table->byId[table->scopeLog[--table->logCount]];
+        if (entry) {
+            unlinkEntry(table, entry);
+            freeSymbolEntry(entry);
+        }
+    }
+}
 
 
+// nombre d'entrees vivantes et longueur de sondage (cases visitees) des noms
+void symbolTableStats(SymbolTable *table, int *symbols, double *averageProbe, int *maxProbe) {
+    *symbols = 0;
+    *averageProbe = 0;
+    *maxProbe = 0;
+    if (!table) {
+        return;
+    }
+
+    for (int id = 0; id < table->nextId; id++) {
+        *symbols += table->byId[id] != NULL;
+    }
+    long total = 0;
+    for (int i = 0; i < table->capacity; i++) {
+        if (table->slots[i].entry) {
+            int probe = (int)table->slots[i].distance + 1;
+            total += probe;
+            if (probe > *maxProbe) {
+                *maxProbe = probe;
+            }
+        }
+    }
+    if (table->count > 0) {
+        *averageProbe = (double)total / table->count;
+    }
+}
+
+// rehachage dans une table de newSize cases (arrondi a la puissance de 2
+// superieure, et jamais en dessous du facteur de charge maximal)
 void resizeSymbolTable(SymbolTable *table, int newSize) {
-    (void)newSize;
-}
\ No newline at end of file
+    if (!table) {
+        return;
+    }
+
+    int capacity = SYMBOL_TABLE_INITIAL_CAPACITY;
+    while (capacity < newSize || table->count > capacity * SYMBOL_TABLE_MAX_LOAD) {
+        capacity *= 2;
+    }
+    if (capacity == table->capacity) {
+        return;
+    }
+
+    SymbolSlot *slots = (SymbolSlot *)calloc(capacity, sizeof(SymbolSlot));
+    if (!slots) {
+        return;
+    }
+
+    SymbolSlot *old = table->slots;
+    int oldCapacity = table->capacity;
+    table->slots = slots;
+    table->capacity = capacity;
+    for (int i = 0; i < oldCapacity; i++) {
+        if (old[i].entry) {
+            placeSlot(table, old[i].entry);
+        }
+    }
+    free(old);
+}
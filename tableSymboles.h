@@ -5,6 +5,8 @@
 #include <string.h> 
 #include <stdio.h> 
 #include <stdbool.h>  
+#include <stdint.h>
+#include "interner.h"
 
 #define TYPE_BOOLEAN 0
 #define TYPE_INTEGER 1
@@ -12,49 +14,105 @@
 #define TYPE_STRING 3
 #define TYPE_ARRAY 4
 #define TYPE_DICT 5
+#define TYPE_UNKNOWN -1
 #define MAX_NAME_LENGTH 64  
 #define MAX_TYPE_LENGTH 32
 #define MAX_VALUE_LENGTH 100  
-#define HASH_TABLE_SIZE 101 
+#define SYMBOL_TABLE_INITIAL_CAPACITY 128   // puissance de 2
+#define SYMBOL_TABLE_MAX_LOAD 0.75          // facteur de charge declenchant le rehachage
+#define SCOPE_STACK_INITIAL_CAPACITY 16
 
 typedef struct ArrayType ArrayType;
+typedef struct DictType DictType;
 
+// Tableau connu a la compilation. Un tableau homogene d'entiers, de reels
+// ou de booleens range ses elements dans un tampon contigu aligne sur 64
+// octets (voir vecteurs.h) ; les autres (chaines, tableaux imbriques, types
+// melanges, tableau vide) gardent le texte de chaque element
 typedef struct ArrayType {
-    size_t length;     
-    size_t capacity;    
-    char** data;
+    size_t length;
+    size_t capacity;
+    int elementType;    // TYPE_INTEGER, TYPE_FLOAT, TYPE_BOOLEAN : tampon type ;
+                        // TYPE_STRING, TYPE_ARRAY, TYPE_UNKNOWN : data.text
+    union {
+        int64_t *i;
+        double *f;
+        bool *b;
+        char **text;    // tel que l'ecrit formatValue (chaines entre guillemets)
+    } data;
+    struct ArrayType *previousLive;     // valeurs de l'analyse (voir freeParseValues)
+    struct ArrayType *nextLive;
 } ArrayType;
 
+// Dictionnaire connu a la compilation : cles dans l'ordre du litteral,
+// valeur de keys[k] en values element k
+typedef struct DictType {
+    size_t length;
+    StringId *keys;
+    ArrayType *values;
+    struct DictType *previousLive;
+    struct DictType *nextLive;
+} DictType;
 
+
+// Entree compacte (32 octets) : type entier, valeur hors ligne dans le pool
+// de chaines (longueur arbitraire), indicateurs sur un bit
 typedef struct SymbolEntry {
     int id;
-    char name[MAX_NAME_LENGTH];
-    char type[MAX_TYPE_LENGTH];
-    char value[MAX_NAME_LENGTH];
-    bool isConst;
-    bool isInitialized;
+    StringId name;
+    StringId value;
     int scopeLevel;
-    struct SymbolEntry *next;
+    signed char type;           // TYPE_BOOLEAN ... TYPE_DICT
+    unsigned char isConst : 1;
+    unsigned char isInitialized : 1;
+    unsigned char isKnown : 1;  // const initialise par une constante : valeur sure a la compilation
+    struct SymbolEntry *next;   // liaison de meme nom masquee (portee englobante)
 } SymbolEntry;
 
+// Case de la table a adressage ouvert (hachage Robin Hood)
+typedef struct SymbolSlot {
+    SymbolEntry *entry;         // NULL si la case est libre
+    unsigned int distance;      // distance a la case ideale du nom
+} SymbolSlot;
+
 // Structure representant la table des symboles
 typedef struct SymbolTable {
-    SymbolEntry *buckets[HASH_TABLE_SIZE];
+    SymbolSlot *slots;          // une case par nom distinct
+    int capacity;               // nombre de cases (puissance de 2)
+    int count;                  // nombre de cases occupees
+    SymbolEntry **byId;         // index dense id -> entree (NULL si supprimee)
+    int idCapacity;
     int nextId;
+    int *scopeLog;              // ids inseres, dans l'ordre (journal d'annulation)
+    int logCount;
+    int logCapacity;
+    int *scopeMarks;            // position du journal a l'entree de chaque portee
+    int scopeDepth;             // portee courante (0 = globale)
+    int marksCapacity;
 } SymbolTable;
 
 SymbolTable *createSymbolTable();
-void insertSymbol(SymbolTable *table, const char *name, const char *type, const char *value, int scopeLevel, bool isConst, bool isInitialized);
-SymbolEntry *lookupSymbolByName(SymbolTable *table, const char *name, int scopeLevel);
+void insertSymbol(SymbolTable *table, StringId name, int type, const char *value, int scopeLevel, bool isConst, bool isInitialized);
+void restoreSymbol(SymbolTable *table, int id, StringId name, int type, const char *value, int scopeLevel, bool isConst, bool isInitialized);
+SymbolEntry *lookupSymbolByName(SymbolTable *table, StringId name, int scopeLevel);
 SymbolEntry *lookupSymbolById(SymbolTable *table, int id, int scopeLevel);
 void deleteSymbolById(SymbolTable *table, int id);
-void deleteSymbolByName(SymbolTable *table, const char *name);
+void deleteSymbolByName(SymbolTable *table, StringId name);
 void freeSymbolTable(SymbolTable *table);
 void clearSymbolTable(SymbolTable *table);
-int symbolExistsByName(SymbolTable *table, const char *name, int scopeLevel);
+int symbolExistsByName(SymbolTable *table, StringId name, int scopeLevel);
 int symbolExistsById(SymbolTable *table, int id, int scopeLevel);
+int symbolExistsInScope(SymbolTable *table, StringId name, int scopeLevel);
+void pushScope(SymbolTable *table);
+void popScope(SymbolTable *table);
+int currentScope(SymbolTable *table);
 void listAllSymbols(SymbolTable *table);
+void printSymbolTable(FILE *out, SymbolTable *table);
 void updateSymbolValue(SymbolTable *table, int id,const char *newValue, int scopeLevel);
 void freeSymbolEntry(SymbolEntry *entry);
 void resizeSymbolTable(SymbolTable *table, int newSize);
+const char *symbolTypeName(int type);
+int symbolTypeFromName(const char *name);
+const char *symbolValue(SymbolEntry *entry);
+void symbolTableStats(SymbolTable *table, int *symbols, double *averageProbe, int *maxProbe);
 #endif 
\ No newline at end of file
@@ -0,0 +1,358 @@
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tempalloc.h"
+#include "cfg.h"
+#include "bitset.h"
+#include "semantic.h"
+
+enum { NOM_AUTRE, NOM_TEMPORAIRE, NOM_EXCLU };
+
+#define TYPE_INDEFINI -2            // temporaire pas encore ecrit
+#define CLASSES (TYPE_DICT + 2)     // une par type, plus TYPE_UNKNOWN
+
+typedef struct Allocation {
+    Cfg cfg;
+    SymbolTable *table;
+    int words;
+    unsigned char *etat;    // par nom : NOM_AUTRE, NOM_TEMPORAIRE ou NOM_EXCLU
+    uint64_t *masque;       // temporaires renommes
+    uint64_t *in;           // noms vivants a l'entree de chaque bloc
+    int *debut;             // intervalle de vie de chaque temporaire
+    int *fin;
+    int *caseDe;
+    signed char *type;      // type statique de chaque temporaire
+} Allocation;
+
+// nom produit par le parseur pour un temporaire : $t suivi de chiffres
+static int nomTemporaire(StringId id) {
+    const char *text = internedString(id);
+    if (text[0] != '$' || text[1] != 't' || !text[2]) {
+        return 0;
+    }
+    for (text += 2; *text; text++) {
+        if (!isdigit((unsigned char)*text)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void classerNoms(Allocation *a) {
+    Cfg *cfg = &a->cfg;
+    for (int i = 0; i < cfg->quads->taille; i++) {
+        int n = cfgName(cfg, cfgDef(cfg, i));
+        if (n >= 0 && a->etat[n] != NOM_EXCLU) {
+            int calcul = cfg->kinds[i] == QUAD_COPY || cfg->kinds[i] == QUAD_PURE || cfg->kinds[i] == QUAD_TRAP;
+            a->etat[n] = calcul && nomTemporaire(cfg->nameIds[n]) ? NOM_TEMPORAIRE : NOM_EXCLU;
+        }
+        if (cfg->kinds[i] == QUAD_ARRAY) {
+            for (int k = cfg->arrayUseStart[i]; k < cfg->arrayUseStart[i + 1]; k++) {
+                a->etat[cfg->arrayUses[k]] = NOM_EXCLU;
+            }
+        }
+    }
+}
+
+// parcours d'un bloc de la sortie vers l'entree ; avec vivants, compte les
+// temporaires vivants, etend leurs intervalles et retourne le maximum
+static int parcourir(Allocation *a, int b, uint64_t *live, int vivants) {
+    Cfg *cfg = &a->cfg;
+    int pic = vivants;
+    for (int i = cfg->blocks[b].last - 1; i >= cfg->blocks[b].first; i--) {
+        if (cfg->kinds[i] == QUAD_REMOVED) {
+            continue;
+        }
+        int n = cfgName(cfg, cfgDef(cfg, i));
+        if (n >= 0) {
+            if (vivants >= 0 && bitsetHas(a->masque, n)) {
+                a->debut[n] = i < a->debut[n] ? i : a->debut[n];
+                a->fin[n] = i > a->fin[n] ? i : a->fin[n];
+                vivants -= bitsetHas(live, n);
+            }
+            bitsetRemove(live, n);
+        }
+        StringId *fields[CFG_MAX_USES];
+        int uses = cfgUseFields(cfg, i, fields);
+        for (int k = 0; k < uses; k++) {
+            int u = cfgName(cfg, *fields[k]);
+            if (u < 0) {
+                continue;
+            }
+            if (vivants >= 0 && bitsetHas(a->masque, u)) {
+                a->debut[u] = i < a->debut[u] ? i : a->debut[u];
+                a->fin[u] = i > a->fin[u] ? i : a->fin[u];
+                vivants += !bitsetHas(live, u);
+            }
+            bitsetAdd(live, u);
+        }
+        if (cfg->kinds[i] == QUAD_ARRAY) {
+            for (int k = cfg->arrayUseStart[i]; k < cfg->arrayUseStart[i + 1]; k++) {
+                bitsetAdd(live, cfg->arrayUses[k]);
+            }
+        }
+        pic = vivants > pic ? vivants : pic;
+    }
+    return pic;
+}
+
+static void sortie(Allocation *a, int b, uint64_t *live) {
+    bitsetClearAll(live, a->words);
+    for (int s = 0; s < 2; s++) {
+        int succ = a->cfg.blocks[b].succ[s];
+        if (succ >= 0) bitsetUnion(live, a->in + (size_t)succ * a->words, a->words);
+    }
+}
+
+// temporaires vivants dans live (parmi masque) : leur intervalle couvre
+// l'indice i ; retourne leur nombre
+static int couvrir(Allocation *a, const uint64_t *live, int i) {
+    int compte = 0;
+    for (int w = 0; w < a->words; w++) {
+        uint64_t bits = live[w] & a->masque[w];
+        while (bits) {
+            int n = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            a->debut[n] = i < a->debut[n] ? i : a->debut[n];
+            a->fin[n] = i > a->fin[n] ? i : a->fin[n];
+            compte++;
+        }
+    }
+    return compte;
+}
+
+static int vivacite(Allocation *a, TempReport *report) {
+    Cfg *cfg = &a->cfg;
+    uint64_t *live = (uint64_t *)malloc(a->words * sizeof(uint64_t));
+    if (!live) {
+        return -1;
+    }
+    int change = 1;
+    while (change) {
+        change = 0;
+        for (int b = cfg->blockCount - 1; b >= 0; b--) {
+            sortie(a, b, live);
+            parcourir(a, b, live, -1);
+            if (!bitsetEqual(live, a->in + (size_t)b * a->words, a->words)) {
+                bitsetCopy(a->in + (size_t)b * a->words, live, a->words);
+                change = 1;
+            }
+        }
+    }
+    // un temporaire lu avant d'etre ecrit garde son nom
+    for (int n = 0; n < cfg->nameCount; n++) {
+        if (a->etat[n] == NOM_TEMPORAIRE && (cfg->blockCount == 0 || !bitsetHas(a->in, n))) {
+            bitsetAdd(a->masque, n);
+            report->temps++;
+        }
+    }
+    for (int b = 0; b < cfg->blockCount; b++) {
+        BasicBlock *bloc = &cfg->blocks[b];
+        if (bloc->first == bloc->last) {
+            continue;
+        }
+        sortie(a, b, live);
+        int pic = parcourir(a, b, live, couvrir(a, live, bloc->last - 1));
+        couvrir(a, live, bloc->first);
+        report->peak = pic > report->peak ? pic : report->peak;
+    }
+    free(live);
+    return 0;
+}
+
+static int typeOperande(const Allocation *a, StringId id) {
+    const char *text = internedString(id);
+    if (cfgIsLiteral(id)) {
+        if (text[0] == '"') return TYPE_STRING;
+        if (text[0] == '[') return TYPE_ARRAY;
+        if (text[0] == '{') return TYPE_DICT;
+        if (text[0] == 't' || text[0] == 'f') return TYPE_BOOLEAN;
+        return strpbrk(text, ".eE") ? TYPE_FLOAT : TYPE_INTEGER;
+    }
+    int n = cfgName(&a->cfg, id);
+    if (n >= 0 && bitsetHas(a->masque, n)) {
+        return a->type[n] == TYPE_INDEFINI ? TYPE_UNKNOWN : a->type[n];
+    }
+    SymbolEntry *symbol = a->table ? lookupSymbolByName(a->table, id, currentScope(a->table)) : NULL;
+    return symbol ? symbol->type : TYPE_UNKNOWN;
+}
+
+// types des temporaires, dans l'ordre du programme, par les regles du
+// repliement (quadResultType) : une case n'est partagee qu'entre
+// temporaires du meme type, ce qui garde les operations specialisees de la
+// machine virtuelle
+static void typer(Allocation *a) {
+    Cfg *cfg = &a->cfg;
+    for (int i = 0; i < cfg->quads->taille; i++) {
+        int n = cfgName(cfg, cfgDef(cfg, i));
+        if (n < 0 || !bitsetHas(a->masque, n)) {
+            continue;
+        }
+        quad *q = &cfg->quads->quads[i];
+        int type = cfg->kinds[i] == QUAD_COPY ? typeOperande(a, q->operande1) :
+                   quadResultType(internedString(q->operateur), typeOperande(a, q->operande1),
+                                  typeOperande(a, q->operande2));
+        a->type[n] = (signed char)(a->type[n] == TYPE_INDEFINI || a->type[n] == type ? type : TYPE_UNKNOWN);
+    }
+    for (int n = 0; n < cfg->nameCount; n++) {
+        if (a->type[n] == TYPE_INDEFINI) {
+            a->type[n] = TYPE_UNKNOWN;
+        }
+    }
+}
+
+// balayage lineaire, par type : a chaque quad, les cases des intervalles
+// finis au quad precedent sont rendues, puis les intervalles qui
+// commencent en prennent une du meme type (la derniere rendue d'abord)
+static int balayer(Allocation *a) {
+    Cfg *cfg = &a->cfg;
+    int taille = cfg->quads->taille;
+    int *parDebut = (int *)malloc((taille + 1) * sizeof(int));
+    int *parFin = (int *)malloc((taille + 1) * sizeof(int));
+    int *suivantDebut = (int *)malloc((cfg->nameCount + 1) * sizeof(int));
+    int *suivantFin = (int *)malloc((cfg->nameCount + 1) * sizeof(int));
+    int *suivantLibre = (int *)malloc((cfg->nameCount + 1) * sizeof(int));
+    int libres[CLASSES];
+    int cases = -1;
+    if (!parDebut || !parFin || !suivantDebut || !suivantFin || !suivantLibre) {
+        goto fin;
+    }
+    for (int i = 0; i < taille; i++) {
+        parDebut[i] = parFin[i] = -1;
+    }
+    for (int n = cfg->nameCount - 1; n >= 0; n--) {
+        if (bitsetHas(a->masque, n) && a->fin[n] >= 0) {
+            suivantDebut[n] = parDebut[a->debut[n]];
+            parDebut[a->debut[n]] = n;
+            suivantFin[n] = parFin[a->fin[n]];
+            parFin[a->fin[n]] = n;
+        }
+    }
+    for (int k = 0; k < CLASSES; k++) {
+        libres[k] = -1;
+    }
+    cases = 0;
+    for (int i = 0; i < taille; i++) {
+        for (int n = i > 0 ? parFin[i - 1] : -1; n >= 0; n = suivantFin[n]) {
+            int c = a->caseDe[n], k = a->type[n] + 1;
+            suivantLibre[c] = libres[k];
+            libres[k] = c;
+        }
+        for (int n = parDebut[i]; n >= 0; n = suivantDebut[n]) {
+            int k = a->type[n] + 1;
+            if (libres[k] >= 0) {
+                a->caseDe[n] = libres[k];
+                libres[k] = suivantLibre[libres[k]];
+            } else {
+                a->caseDe[n] = cases++;
+            }
+        }
+    }
+fin:
+    free(parDebut);
+    free(parFin);
+    free(suivantDebut);
+    free(suivantFin);
+    free(suivantLibre);
+    return cases;
+}
+
+// noms "$tK" des cases, sans reprendre un nom qui reste dans le programme
+static int renommer(Allocation *a, int cases) {
+    Cfg *cfg = &a->cfg;
+    tableQuads *t = cfg->quads;
+    StringId *noms = (StringId *)malloc((cases + 1) * sizeof(StringId));
+    IdMap pris;
+    if (!noms || initIdMap(&pris, (uint32_t)(3 * t->taille + cfg->nameCount)) < 0) {
+        free(noms);
+        freeIdMap(&pris);
+        return -1;
+    }
+    for (int n = 0; n < cfg->nameCount; n++) {
+        if (!bitsetHas(a->masque, n)) {
+            idMapPut(&pris, cfg->nameIds[n], 1);
+        }
+    }
+    for (int i = 0; i < t->taille; i++) {
+        StringId champs[3] = { t->quads[i].operande1, t->quads[i].operande2, t->quads[i].resultat };
+        for (int k = 0; k < 3; k++) {
+            int n = cfgName(cfg, champs[k]);
+            if (n < 0 || !bitsetHas(a->masque, n)) {
+                idMapPut(&pris, champs[k], 1);
+            }
+        }
+    }
+    char nom[24];
+    for (int c = 0, k = 1; c < cases; c++) {
+        do {
+            snprintf(nom, sizeof(nom), "$t%d", k++);
+            noms[c] = internString(nom);
+        } while (idMapGet(&pris, noms[c], 0));
+    }
+    for (int i = 0; i < t->taille; i++) {
+        StringId *fields[CFG_MAX_USES + 1];
+        int count = cfgUseFields(cfg, i, fields);
+        StringId *def = cfgDefField(cfg, i);
+        if (def) {
+            fields[count++] = def;
+        }
+        for (int k = 0; k < count; k++) {
+            int n = cfgName(cfg, *fields[k]);
+            if (n >= 0 && bitsetHas(a->masque, n)) {
+                *fields[k] = noms[a->caseDe[n]];
+            }
+        }
+    }
+    free(noms);
+    freeIdMap(&pris);
+    return 0;
+}
+
+int allouerTemporaires(tableQuads *t, SymbolTable *table, TempReport *report) {
+    Allocation a;
+    memset(&a, 0, sizeof(a));
+    a.table = table;
+    memset(report, 0, sizeof(*report));
+    if (cfgBuild(&a.cfg, t) < 0) {
+        cfgFree(&a.cfg);
+        return -1;
+    }
+    int noms = a.cfg.nameCount;
+    a.words = BITSET_WORDS(noms) ? BITSET_WORDS(noms) : 1;
+    a.etat = (unsigned char *)calloc(noms + 1, 1);
+    a.masque = (uint64_t *)calloc(a.words, sizeof(uint64_t));
+    a.in = (uint64_t *)calloc((size_t)(a.cfg.blockCount + 1) * a.words, sizeof(uint64_t));
+    a.debut = (int *)malloc((noms + 1) * sizeof(int));
+    a.fin = (int *)malloc((noms + 1) * sizeof(int));
+    a.caseDe = (int *)malloc((noms + 1) * sizeof(int));
+    a.type = (signed char *)malloc(noms + 1);
+    int status = a.etat && a.masque && a.in && a.debut && a.fin && a.caseDe && a.type ? 0 : -1;
+    if (status == 0) {
+        for (int n = 0; n < noms; n++) {
+            a.debut[n] = t->taille;
+            a.fin[n] = -1;
+            a.type[n] = TYPE_INDEFINI;
+        }
+        classerNoms(&a);
+        status = vivacite(&a, report);
+    }
+    if (status == 0) {
+        typer(&a);
+    }
+    int cases = status == 0 ? balayer(&a) : -1;
+    if (cases >= 0 && cases < report->temps) {
+        status = renommer(&a, cases);
+    } else if (cases < 0) {
+        status = -1;
+    }
+    report->slots = status == 0 ? cases : report->temps;
+    cfgFree(&a.cfg);
+    free(a.etat);
+    free(a.masque);
+    free(a.in);
+    free(a.debut);
+    free(a.fin);
+    free(a.caseDe);
+    free(a.type);
+    return status < 0 ? -1 : report->temps - report->slots;
+}
@@ -0,0 +1,35 @@
+#ifndef TEMPALLOC_H
+#define TEMPALLOC_H
+#include <stdio.h>
+#include "quadruplets.h"
+#include "tableSymboles.h"
+
+// Allocation des temporaires (option -O, apres la resolution des
+// etiquettes).
+//
+// Le parseur cree un temporaire "$tN" par operation : la machine virtuelle
+// leur reserve autant de cases. Apres une analyse de vivacite sur le
+// graphe de flot (cfg.h), chaque temporaire recoit un intervalle de vie
+// (du premier au dernier quad ou il est vivant, dans l'ordre du programme)
+// et un balayage lineaire leur attribue des cases reutilisables : deux
+// temporaires du meme type statique dont les intervalles sont disjoints
+// partagent une case, renommee "$tK". Une case liberee par un quad n'est
+// reprise qu'au quad suivant : le resultat n'ecrase jamais un operande du
+// meme quad.
+//
+// Seuls les noms $tN ecrits par un calcul ou une copie sont concernes : pas
+// ceux des tableaux (ARRAY_DECL, texte "[...]"), d'INPUT, ni ceux lus avant
+// toute ecriture.
+
+typedef struct TempReport {
+    int temps;          // temporaires avant l'allocation
+    int slots;          // cases apres
+    int peak;           // au plus peak temporaires vivants ensemble
+} TempReport;
+
+// renomme les temporaires de t sur place ; table (NULL : types inconnus)
+// donne le type des variables. Retourne le nombre de cases economisees,
+// -1 si la memoire manque (t est alors inchange)
+int allouerTemporaires(tableQuads *t, SymbolTable *table, TempReport *report);
+
+#endif
@@ -0,0 +1,458 @@
+#include <stdlib.h>
+#include <string.h>
+#include "vecteurs.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define VEC_SIMD 1
+#endif
+
+#define NOYAU static inline __attribute__((always_inline))
+
+// ---------------------------------------------------------------------------
+// Vecteurs de 32 octets : un registre AVX2, deux registres SSE2 (decoupage
+// fait par le compilateur)
+
+#define LANES 4             // elements de 64 bits par vecteur
+#define PARTIELLES 8        // sommes partielles des reductions
+
+#ifdef VEC_SIMD
+// les vecteurs ne passent jamais d'une fonction a l'autre : les aides
+// ci-dessous sont toujours developpees
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+typedef uint64_t VecU __attribute__((vector_size(32)));
+typedef int64_t VecI __attribute__((vector_size(32)));
+typedef double VecF __attribute__((vector_size(32)));
+typedef uint8_t VecB __attribute__((vector_size(32)));     // 32 booleens
+typedef int8_t VecM __attribute__((vector_size(LANES)));   // masque de LANES comparaisons
+
+NOYAU VecU chargerU(const int64_t *p) { VecU v; memcpy(&v, p, sizeof(v)); return v; }
+NOYAU VecI chargerI(const int64_t *p) { VecI v; memcpy(&v, p, sizeof(v)); return v; }
+NOYAU VecF chargerF(const double *p) { VecF v; memcpy(&v, p, sizeof(v)); return v; }
+NOYAU VecB chargerB(const bool *p) { VecB v; memcpy(&v, p, sizeof(v)); return v; }
+// macros plutot que fonctions : un vecteur passe en parametre fait
+// signaler par GCC un changement d'ABI, meme pour une fonction developpee
+#define RANGER(p, v) do { __typeof__(v) v_ = (v); memcpy((p), &v_, sizeof(v_)); } while (0)
+
+// masque de comparaison (-1 / 0 par element) -> LANES booleens
+#define RANGER_MASQUE(p, masque) RANGER(p, __builtin_convertvector(masque, VecM) & 1)
+
+// x si le masque est vrai, y sinon
+#define CHOISIR(masque, x, y) (((x) & (masque)) | ((y) & ~(masque)))
+
+#define VECTORIEL(pas, instruction) for (; k + (pas) <= n; k += (pas)) { instruction; }
+#else
+#define VECTORIEL(pas, instruction)
+#endif
+
+static inline int64_t wrapAdd(int64_t x, int64_t y) { return (int64_t)((uint64_t)x + (uint64_t)y); }
+static inline int64_t wrapSub(int64_t x, int64_t y) { return (int64_t)((uint64_t)x - (uint64_t)y); }
+static inline int64_t wrapMul(int64_t x, int64_t y) { return (int64_t)((uint64_t)x * (uint64_t)y); }
+
+// operande de pas 0 : le scalaire repete dans rep, lu comme un vecteur a
+// l'indice 0 (k * 0)
+#define REPETER(p, pas, rep, largeur) \
+    do { \
+        if (!(pas) && (p)) { \
+            for (int l = 0; l < (largeur); l++) (rep)[l] = *(p); \
+            (p) = (rep); \
+        } \
+    } while (0)
+
+// ---------------------------------------------------------------------------
+// Noyaux, compiles une fois par version (voir VEC_PROCEDURES)
+
+NOYAU void noyauInt(VecOp op, int64_t *r, const int64_t *a, int stepA, const int64_t *b, int stepB,
+                    size_t n) {
+    int64_t repA[LANES], repB[LANES];
+    REPETER(a, stepA, repA, LANES);
+    REPETER(b, stepB, repB, LANES);
+    size_t sa = stepA != 0, sb = stepB != 0, k = 0;
+    switch (op) {
+        case VEC_ADD:
+            VECTORIEL(LANES, RANGER(r + k, chargerU(a + k * sa) + chargerU(b + k * sb)))
+            for (; k < n; k++) r[k] = wrapAdd(a[k * sa], b[k * sb]);
+            break;
+        case VEC_SUB:
+            VECTORIEL(LANES, RANGER(r + k, chargerU(a + k * sa) - chargerU(b + k * sb)))
+            for (; k < n; k++) r[k] = wrapSub(a[k * sa], b[k * sb]);
+            break;
+        case VEC_MUL:
+            VECTORIEL(LANES, RANGER(r + k, chargerU(a + k * sa) * chargerU(b + k * sb)))
+            for (; k < n; k++) r[k] = wrapMul(a[k * sa], b[k * sb]);
+            break;
+        case VEC_NEG:
+            VECTORIEL(LANES, RANGER(r + k, -chargerU(a + k * sa)))
+            for (; k < n; k++) r[k] = wrapSub(0, a[k * sa]);
+            break;
+        default:
+            break;
+    }
+}
+
+NOYAU void noyauFloat(VecOp op, double *r, const double *a, int stepA, const double *b, int stepB,
+                      size_t n) {
+    double repA[LANES], repB[LANES];
+    REPETER(a, stepA, repA, LANES);
+    REPETER(b, stepB, repB, LANES);
+    size_t sa = stepA != 0, sb = stepB != 0, k = 0;
+    switch (op) {
+        case VEC_ADD:
+            VECTORIEL(LANES, RANGER(r + k, chargerF(a + k * sa) + chargerF(b + k * sb)))
+            for (; k < n; k++) r[k] = a[k * sa] + b[k * sb];
+            break;
+        case VEC_SUB:
+            VECTORIEL(LANES, RANGER(r + k, chargerF(a + k * sa) - chargerF(b + k * sb)))
+            for (; k < n; k++) r[k] = a[k * sa] - b[k * sb];
+            break;
+        case VEC_MUL:
+            VECTORIEL(LANES, RANGER(r + k, chargerF(a + k * sa) * chargerF(b + k * sb)))
+            for (; k < n; k++) r[k] = a[k * sa] * b[k * sb];
+            break;
+        case VEC_DIV:
+            VECTORIEL(LANES, RANGER(r + k, chargerF(a + k * sa) / chargerF(b + k * sb)))
+            for (; k < n; k++) r[k] = a[k * sa] / b[k * sb];
+            break;
+        case VEC_NEG:
+            VECTORIEL(LANES, RANGER(r + k, -chargerF(a + k * sa)))
+            for (; k < n; k++) r[k] = -a[k * sa];
+            break;
+        default:
+            break;
+    }
+}
+
+// une boucle par comparaison : X vecteurs, x scalaires
+#define COMPARAISONS(charger, T) \
+    switch (op) { \
+        case VEC_EQ: \
+            VECTORIEL(LANES, RANGER_MASQUE(r + k, (VecI)(charger(a + k * sa) == charger(b + k * sb)))) \
+            for (; k < n; k++) r[k] = a[k * sa] == b[k * sb]; \
+            break; \
+        case VEC_NE: \
+            VECTORIEL(LANES, RANGER_MASQUE(r + k, (VecI)(charger(a + k * sa) != charger(b + k * sb)))) \
+            for (; k < n; k++) r[k] = a[k * sa] != b[k * sb]; \
+            break; \
+        case VEC_LT: \
+            VECTORIEL(LANES, RANGER_MASQUE(r + k, (VecI)(charger(a + k * sa) < charger(b + k * sb)))) \
+            for (; k < n; k++) r[k] = a[k * sa] < b[k * sb]; \
+            break; \
+        case VEC_LE: \
+            VECTORIEL(LANES, RANGER_MASQUE(r + k, (VecI)(charger(a + k * sa) <= charger(b + k * sb)))) \
+            for (; k < n; k++) r[k] = a[k * sa] <= b[k * sb]; \
+            break; \
+        case VEC_GT: \
+            VECTORIEL(LANES, RANGER_MASQUE(r + k, (VecI)(charger(a + k * sa) > charger(b + k * sb)))) \
+            for (; k < n; k++) r[k] = a[k * sa] > b[k * sb]; \
+            break; \
+        case VEC_GE: \
+            VECTORIEL(LANES, RANGER_MASQUE(r + k, (VecI)(charger(a + k * sa) >= charger(b + k * sb)))) \
+            for (; k < n; k++) r[k] = a[k * sa] >= b[k * sb]; \
+            break; \
+        default: \
+            break; \
+    }
+
+NOYAU void noyauCompareInt(VecOp op, bool *r, const int64_t *a, int stepA, const int64_t *b, int stepB,
+                           size_t n) {
+    int64_t repA[LANES], repB[LANES];
+    REPETER(a, stepA, repA, LANES);
+    REPETER(b, stepB, repB, LANES);
+    size_t sa = stepA != 0, sb = stepB != 0, k = 0;
+    COMPARAISONS(chargerI, int64_t)
+}
+
+// NaN : seule la difference est vraie (comparaisons ordonnees)
+NOYAU void noyauCompareFloat(VecOp op, bool *r, const double *a, int stepA, const double *b, int stepB,
+                             size_t n) {
+    double repA[LANES], repB[LANES];
+    REPETER(a, stepA, repA, LANES);
+    REPETER(b, stepB, repB, LANES);
+    size_t sa = stepA != 0, sb = stepB != 0, k = 0;
+    COMPARAISONS(chargerF, double)
+}
+
+// booleens : octets 0 ou 1, 32 par vecteur
+NOYAU void noyauLogic(VecOp op, bool *r, const bool *a, int stepA, const bool *b, int stepB, size_t n) {
+    bool repA[32], repB[32];
+    REPETER(a, stepA, repA, 32);
+    REPETER(b, stepB, repB, 32);
+    size_t sa = stepA != 0, sb = stepB != 0, k = 0;
+    switch (op) {
+        case VEC_AND:
+            VECTORIEL(32, RANGER(r + k, chargerB(a + k * sa) & chargerB(b + k * sb)))
+            for (; k < n; k++) r[k] = a[k * sa] & b[k * sb];
+            break;
+        case VEC_OR:
+            VECTORIEL(32, RANGER(r + k, chargerB(a + k * sa) | chargerB(b + k * sb)))
+            for (; k < n; k++) r[k] = a[k * sa] | b[k * sb];
+            break;
+        case VEC_NE:
+            VECTORIEL(32, RANGER(r + k, chargerB(a + k * sa) ^ chargerB(b + k * sb)))
+            for (; k < n; k++) r[k] = a[k * sa] ^ b[k * sb];
+            break;
+        case VEC_EQ:
+            VECTORIEL(32, RANGER(r + k, chargerB(a + k * sa) ^ chargerB(b + k * sb) ^ 1))
+            for (; k < n; k++) r[k] = !(a[k * sa] ^ b[k * sb]);
+            break;
+        case VEC_NOT:
+            VECTORIEL(32, RANGER(r + k, chargerB(a + k * sa) ^ 1))
+            for (; k < n; k++) r[k] = !a[k * sa];
+            break;
+        default:
+            break;
+    }
+}
+
+NOYAU void noyauToFloat(double *r, const int64_t *a, size_t n) {
+    size_t k = 0;
+    VECTORIEL(LANES, RANGER(r + k, __builtin_convertvector(chargerI(a + k), VecF)))
+    for (; k < n; k++) r[k] = (double)a[k];
+}
+
+NOYAU bool noyauHasZero(const double *a, size_t n) {
+    size_t k = 0;
+#ifdef VEC_SIMD
+    VecI zero = { 0, 0, 0, 0 };
+    VECTORIEL(LANES, zero |= (VecI)(chargerF(a + k) == 0.0))
+    for (int l = 0; l < LANES; l++) {
+        if (zero[l]) return true;
+    }
+#endif
+    for (; k < n; k++) {
+        if (a[k] == 0) return true;
+    }
+    return false;
+}
+
+NOYAU int64_t noyauSumInt(const int64_t *a, size_t n) {
+    uint64_t partielles[PARTIELLES] = { 0 };
+    size_t k = 0;
+#ifdef VEC_SIMD
+    VecU s0 = { 0, 0, 0, 0 }, s1 = { 0, 0, 0, 0 };
+    VECTORIEL(PARTIELLES, s0 += chargerU(a + k); s1 += chargerU(a + k + LANES))
+    for (int l = 0; l < LANES; l++) {
+        partielles[l] = s0[l];
+        partielles[l + LANES] = s1[l];
+    }
+#endif
+    for (; k < n; k++) partielles[k % PARTIELLES] += (uint64_t)a[k];
+    uint64_t s = 0;
+    for (int l = 0; l < PARTIELLES; l++) s += partielles[l];
+    return (int64_t)s;
+}
+
+// l'element i va dans la somme i % 8, quelle que soit la version
+NOYAU double noyauSumFloat(const double *a, size_t n) {
+    double p[PARTIELLES] = { 0 };
+    size_t k = 0;
+#ifdef VEC_SIMD
+    VecF s0 = { 0, 0, 0, 0 }, s1 = { 0, 0, 0, 0 };
+    VECTORIEL(PARTIELLES, s0 += chargerF(a + k); s1 += chargerF(a + k + LANES))
+    for (int l = 0; l < LANES; l++) {
+        p[l] = s0[l];
+        p[l + LANES] = s1[l];
+    }
+#endif
+    for (; k < n; k++) p[k % PARTIELLES] += a[k];
+    return ((p[0] + p[4]) + (p[1] + p[5])) + ((p[2] + p[6]) + (p[3] + p[7]));
+}
+
+NOYAU int64_t noyauExtremumInt(const int64_t *a, size_t n, int plusGrand) {
+    int64_t m = a[0];
+    size_t k = 0;
+#ifdef VEC_SIMD
+    VecI v = { m, m, m, m };
+    if (plusGrand) {
+        VECTORIEL(LANES, VecI x = chargerI(a + k); v = CHOISIR(x > v, x, v))
+    } else {
+        VECTORIEL(LANES, VecI x = chargerI(a + k); v = CHOISIR(x < v, x, v))
+    }
+    for (int l = 0; l < LANES; l++) {
+        m = plusGrand ? (v[l] > m ? v[l] : m) : (v[l] < m ? v[l] : m);
+    }
+#endif
+    for (; k < n; k++) {
+        m = plusGrand ? (a[k] > m ? a[k] : m) : (a[k] < m ? a[k] : m);
+    }
+    return m;
+}
+
+// valeur extreme des elements qui ne sont pas NaN (+inf / -inf si aucun) ;
+// le signe d'un zero et le NaN en tete sont regles par vecMinFloat
+NOYAU double noyauExtremumFloat(const double *a, size_t n, int plusGrand) {
+    double m = plusGrand ? -__builtin_inf() : __builtin_inf();
+    size_t k = 0;
+#ifdef VEC_SIMD
+    VecF v = { m, m, m, m };
+    if (plusGrand) {
+        VECTORIEL(LANES, VecF x = chargerF(a + k); v = (VecF)CHOISIR((VecI)(x > v), (VecI)x, (VecI)v))
+    } else {
+        VECTORIEL(LANES, VecF x = chargerF(a + k); v = (VecF)CHOISIR((VecI)(x < v), (VecI)x, (VecI)v))
+    }
+    for (int l = 0; l < LANES; l++) {
+        m = plusGrand ? (v[l] > m ? v[l] : m) : (v[l] < m ? v[l] : m);
+    }
+#endif
+    for (; k < n; k++) {
+        m = plusGrand ? (a[k] > m ? a[k] : m) : (a[k] < m ? a[k] : m);
+    }
+    return m;
+}
+
+// ---------------------------------------------------------------------------
+// Versions et choix a l'execution
+
+// nom, parametres, arguments : noyaux sans resultat ...
+#define VEC_PROCEDURES(X) \
+    X(Int, (VecOp op, int64_t *r, const int64_t *a, int stepA, const int64_t *b, int stepB, size_t n), \
+      (op, r, a, stepA, b, stepB, n)) \
+    X(Float, (VecOp op, double *r, const double *a, int stepA, const double *b, int stepB, size_t n), \
+      (op, r, a, stepA, b, stepB, n)) \
+    X(CompareInt, (VecOp op, bool *r, const int64_t *a, int stepA, const int64_t *b, int stepB, size_t n), \
+      (op, r, a, stepA, b, stepB, n)) \
+    X(CompareFloat, (VecOp op, bool *r, const double *a, int stepA, const double *b, int stepB, size_t n), \
+      (op, r, a, stepA, b, stepB, n)) \
+    X(Logic, (VecOp op, bool *r, const bool *a, int stepA, const bool *b, int stepB, size_t n), \
+      (op, r, a, stepA, b, stepB, n)) \
+    X(ToFloat, (double *r, const int64_t *a, size_t n), (r, a, n))
+
+// ... et avec leur type rendu
+#define VEC_FUNCTIONS(X) \
+    X(HasZero, bool, (const double *a, size_t n), (a, n)) \
+    X(SumInt, int64_t, (const int64_t *a, size_t n), (a, n)) \
+    X(SumFloat, double, (const double *a, size_t n), (a, n)) \
+    X(ExtremumInt, int64_t, (const int64_t *a, size_t n, int plusGrand), (a, n, plusGrand)) \
+    X(ExtremumFloat, double, (const double *a, size_t n, int plusGrand), (a, n, plusGrand))
+
+typedef struct VecKernels {
+    const char *name;
+#define VEC_PROCEDURE_FIELD(nom, params, args) void (*nom) params;
+#define VEC_FUNCTION_FIELD(nom, type, params, args) type (*nom) params;
+    VEC_PROCEDURES(VEC_PROCEDURE_FIELD)
+    VEC_FUNCTIONS(VEC_FUNCTION_FIELD)
+} VecKernels;
+
+// le noyau est developpe dans chaque version (always_inline) : le corps de
+// la version AVX2 est compile pour AVX2
+#define VEC_PROCEDURE(nom, params, args) VEC_TARGET static void VEC_NAME(nom) params { noyau##nom args; }
+#define VEC_FUNCTION(nom, type, params, args) \
+    VEC_TARGET static type VEC_NAME(nom) params { return noyau##nom args; }
+#define VEC_PROCEDURE_ENTRY(nom, params, args) VEC_NAME(nom),
+#define VEC_FUNCTION_ENTRY(nom, type, params, args) VEC_NAME(nom),
+
+#define VEC_TARGET
+#define VEC_NAME(nom) nom##Base
+VEC_PROCEDURES(VEC_PROCEDURE)
+VEC_FUNCTIONS(VEC_FUNCTION)
+#ifdef VEC_SIMD
+static const VecKernels baseKernels = { "sse2", VEC_PROCEDURES(VEC_PROCEDURE_ENTRY) VEC_FUNCTIONS(VEC_FUNCTION_ENTRY) };
+#else
+static const VecKernels baseKernels = { "scalaire", VEC_PROCEDURES(VEC_PROCEDURE_ENTRY) VEC_FUNCTIONS(VEC_FUNCTION_ENTRY) };
+#endif
+#undef VEC_TARGET
+#undef VEC_NAME
+
+#ifdef VEC_SIMD
+#define VEC_TARGET __attribute__((target("avx2")))
+#define VEC_NAME(nom) nom##Avx2
+VEC_PROCEDURES(VEC_PROCEDURE)
+VEC_FUNCTIONS(VEC_FUNCTION)
+static const VecKernels avx2Kernels = { "avx2", VEC_PROCEDURES(VEC_PROCEDURE_ENTRY) VEC_FUNCTIONS(VEC_FUNCTION_ENTRY) };
+#undef VEC_TARGET
+#undef VEC_NAME
+#endif
+
+// HS_SIMD=sse2 impose la version de base (comparaisons, mesures)
+static const VecKernels *kernels(void) {
+#ifdef VEC_SIMD
+    static const VecKernels *chosen;
+    const VecKernels *k = __atomic_load_n(&chosen, __ATOMIC_ACQUIRE);
+    if (!k) {
+        const char *forced = getenv("HS_SIMD");
+        __builtin_cpu_init();
+        k = __builtin_cpu_supports("avx2") && !(forced && strcmp(forced, "sse2") == 0)
+            ? &avx2Kernels : &baseKernels;
+        __atomic_store_n(&chosen, k, __ATOMIC_RELEASE);
+    }
+    return k;
+#else
+    return &baseKernels;
+#endif
+}
+
+const char *vecTarget(void) {
+    return kernels()->name;
+}
+
+// ---------------------------------------------------------------------------
+// Interface
+
+void vecInt(VecOp op, int64_t *r, const int64_t *a, int stepA, const int64_t *b, int stepB, size_t n) {
+    kernels()->Int(op, r, a, stepA, b, stepB, n);
+}
+
+void vecFloat(VecOp op, double *r, const double *a, int stepA, const double *b, int stepB, size_t n) {
+    kernels()->Float(op, r, a, stepA, b, stepB, n);
+}
+
+void vecCompareInt(VecOp op, bool *r, const int64_t *a, int stepA, const int64_t *b, int stepB, size_t n) {
+    kernels()->CompareInt(op, r, a, stepA, b, stepB, n);
+}
+
+void vecCompareFloat(VecOp op, bool *r, const double *a, int stepA, const double *b, int stepB, size_t n) {
+    kernels()->CompareFloat(op, r, a, stepA, b, stepB, n);
+}
+
+void vecLogic(VecOp op, bool *r, const bool *a, int stepA, const bool *b, int stepB, size_t n) {
+    kernels()->Logic(op, r, a, stepA, b, stepB, n);
+}
+
+void vecToFloat(double *r, const int64_t *a, size_t n) {
+    kernels()->ToFloat(r, a, n);
+}
+
+bool vecHasZero(const double *a, size_t n) {
+    return kernels()->HasZero(a, n);
+}
+
+int64_t vecSumInt(const int64_t *a, size_t n) {
+    return kernels()->SumInt(a, n);
+}
+
+double vecSumFloat(const double *a, size_t n) {
+    return kernels()->SumFloat(a, n);
+}
+
+int64_t vecMinInt(const int64_t *a, size_t n) {
+    return kernels()->ExtremumInt(a, n, 0);
+}
+
+int64_t vecMaxInt(const int64_t *a, size_t n) {
+    return kernels()->ExtremumInt(a, n, 1);
+}
+
+// premier element minimal : NaN s'il est en tete, sinon la valeur, et pour
+// un zero le premier zero rencontre (0.0 et -0.0 sont egaux)
+static double extremumFloat(const double *a, size_t n, int plusGrand) {
+    if (a[0] != a[0]) {
+        return a[0];
+    }
+    double m = kernels()->ExtremumFloat(a, n, plusGrand);
+    if (m == 0) {
+        for (size_t k = 0; k < n; k++) {
+            if (a[k] == 0) {
+                return a[k];
+            }
+        }
+    }
+    return m;
+}
+
+double vecMinFloat(const double *a, size_t n) {
+    return extremumFloat(a, n, 0);
+}
+
+double vecMaxFloat(const double *a, size_t n) {
+    return extremumFloat(a, n, 1);
+}
@@ -0,0 +1,68 @@
+#ifndef VECTEURS_H
+#define VECTEURS_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Operations element par element sur des tableaux contigus d'entiers
+// (int64_t), de reels (double) ou de booleens (bool), pour les tableaux
+// homogenes de la machine virtuelle (vm.c) et du repliement (semantic.c).
+//
+// Chaque noyau est ecrit une fois avec les vecteurs de GCC/Clang, puis
+// compile pour AVX2 et pour SSE2 ; le premier appel choisit la version
+// selon le processeur (__builtin_cpu_supports). Ailleurs que sur x86, ou
+// avec un autre compilateur, seules les boucles scalaires existent.
+//
+// Les calculs suivent la machine virtuelle : entiers modulo 2^64, NaN
+// jamais egal ni ordonne. La somme des reels est faite sur 8 sommes
+// partielles (element i dans la somme i % 8) combinees dans un ordre
+// fixe : le resultat ne depend pas de la version choisie. min et max
+// rendent le premier element minimal (maximal) dans l'ordre, comme un
+// parcours qui ne garde un element que s'il est strictement plus petit
+// (grand) : NaN en tete est rendu, ailleurs il est ignore.
+
+#define VEC_ALIGNMENT 64    // alignement des tampons (une ligne de cache)
+
+typedef enum VecOp {
+    VEC_ADD,
+    VEC_SUB,
+    VEC_MUL,
+    VEC_DIV,        // reels seulement ; diviseurs nuls a tester avant (vecHasZero)
+    VEC_NEG,        // unaires : b ignore
+    VEC_NOT,
+    VEC_EQ,
+    VEC_NE,
+    VEC_LT,
+    VEC_LE,
+    VEC_GT,
+    VEC_GE,
+    VEC_AND,
+    VEC_OR
+} VecOp;
+
+// r[k] = a[k] op b[k] pour k < n. Un pas de 0 repete le scalaire *a (ou
+// *b) ; r peut etre l'un des operandes.
+// vecInt : ADD SUB MUL NEG ; vecFloat : ADD SUB MUL DIV NEG
+void vecInt(VecOp op, int64_t *r, const int64_t *a, int stepA, const int64_t *b, int stepB, size_t n);
+void vecFloat(VecOp op, double *r, const double *a, int stepA, const double *b, int stepB, size_t n);
+// EQ NE LT LE GT GE
+void vecCompareInt(VecOp op, bool *r, const int64_t *a, int stepA, const int64_t *b, int stepB, size_t n);
+void vecCompareFloat(VecOp op, bool *r, const double *a, int stepA, const double *b, int stepB, size_t n);
+// AND OR NOT EQ NE
+void vecLogic(VecOp op, bool *r, const bool *a, int stepA, const bool *b, int stepB, size_t n);
+// conversion des entiers en reels (operandes mixtes)
+void vecToFloat(double *r, const int64_t *a, size_t n);
+bool vecHasZero(const double *a, size_t n);
+
+// reductions ; min et max demandent n > 0
+int64_t vecSumInt(const int64_t *a, size_t n);
+double vecSumFloat(const double *a, size_t n);
+int64_t vecMinInt(const int64_t *a, size_t n);
+int64_t vecMaxInt(const int64_t *a, size_t n);
+double vecMinFloat(const double *a, size_t n);
+double vecMaxFloat(const double *a, size_t n);
+
+// "avx2", "sse2" ou "scalaire" : version retenue pour ce processeur
+const char *vecTarget(void);
+
+#endif
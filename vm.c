@@ -0,0 +1,1825 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <sys/types.h>
+#include <math.h>
+#include "vm.h"
+#include "idmap.h"
+#include "vecteurs.h"
+#include "dictionnaire.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(VM_SWITCH_DISPATCH)
+#define VM_COMPUTED_GOTO 1
+#endif
+
+// Codes d'operation. La meme liste produit l'enum et la table des
+// traitements de vmRun, qui restent ainsi dans le meme ordre.
+// Suffixe _II / _FF : operandes entiers / reels connus au chargement
+#define VM_OPCODES(X) \
+    X(HALT) X(MOVE) X(BR) X(BZ) X(BNZ) \
+    X(ADD) X(SUB) X(MUL) X(DIV) X(IDIV) X(MOD) \
+    X(EQ) X(NE) X(LT) X(LE) X(GT) X(GE) \
+    X(ADD_II) X(SUB_II) X(MUL_II) X(IDIV_II) X(MOD_II) \
+    X(ADD_FF) X(SUB_FF) X(MUL_FF) X(DIV_FF) \
+    X(EQ_II) X(NE_II) X(LT_II) X(LE_II) X(GT_II) X(GE_II) \
+    X(AND) X(OR) X(NOT) X(NEG) X(CONCAT) X(ARRAY) X(PRINT) X(INPUT) \
+    X(VADD) X(VSUB) X(VMUL) X(VDIV) X(VIDIV) X(VMOD) \
+    X(VEQ) X(VNE) X(VLT) X(VLE) X(VGT) X(VGE) \
+    X(VAND) X(VOR) X(VNOT) X(VNEG) X(SUM) X(MIN) X(MAX) \
+    X(DICT) X(INDEX) X(SWITCH) X(CASE) X(HASH)
+
+#define VM_ENUM(name) OP_##name,
+enum { VM_OPCODES(VM_ENUM) OP_OPCODE_COUNT };
+
+typedef struct VmOperator {
+    const char *name;
+    int op;
+} VmOperator;
+
+// operateurs des quads produits par syntaxique.y
+static const VmOperator vmOperators[] = {
+    { ":=", OP_MOVE }, { "BR", OP_BR }, { "BZ", OP_BZ }, { "BNZ", OP_BNZ },
+    { "+", OP_ADD }, { "-", OP_SUB }, { "*", OP_MUL }, { "/", OP_DIV },
+    { "DIV", OP_IDIV }, { "MOD", OP_MOD },
+    { "==", OP_EQ }, { "!=", OP_NE }, { "<", OP_LT }, { "<=", OP_LE }, { ">", OP_GT }, { ">=", OP_GE },
+    { "AND", OP_AND }, { "OR", OP_OR }, { "NOT", OP_NOT }, { "UMINUS", OP_NEG },
+    { "CONCAT", OP_CONCAT }, { "ARRAY_DECL", OP_ARRAY }, { "PRINT", OP_PRINT }, { "INPUT", OP_INPUT },
+    { "VADD", OP_VADD }, { "VSUB", OP_VSUB }, { "VMUL", OP_VMUL }, { "VDIV", OP_VDIV },
+    { "VIDIV", OP_VIDIV }, { "VMOD", OP_VMOD },
+    { "VEQ", OP_VEQ }, { "VNE", OP_VNE }, { "VLT", OP_VLT }, { "VLE", OP_VLE }, { "VGT", OP_VGT }, { "VGE", OP_VGE },
+    { "VAND", OP_VAND }, { "VOR", OP_VOR }, { "VNOT", OP_VNOT }, { "VNEG", OP_VNEG },
+    { "SUM", OP_SUM }, { "MIN", OP_MIN }, { "MAX", OP_MAX },
+    { "DICT_DECL", OP_DICT }, { "INDEX", OP_INDEX },
+    { "SWITCH", OP_SWITCH }, { "CASE", OP_CASE }, { "HASH", OP_HASH },
+};
+
+#define VM_OPERATOR_COUNT (int)(sizeof(vmOperators) / sizeof(vmOperators[0]))
+
+// ---------------------------------------------------------------------------
+// Arene : blocs chaines, liberes en une fois
+
+#define VM_CHUNK_SIZE 65536
+
+struct VmChunk {
+    VmChunk *next;
+    size_t used;
+    size_t size;
+    char data[];
+};
+
+static void *vmAlloc(VmChunk **arena, size_t size) {
+    size = (size + 7) & ~(size_t)7;
+    VmChunk *chunk = *arena;
+    if (!chunk || chunk->size - chunk->used < size) {
+        size_t capacity = size > VM_CHUNK_SIZE ? size : VM_CHUNK_SIZE;
+        chunk = (VmChunk *)malloc(sizeof(VmChunk) + capacity);
+        if (!chunk) {
+            return NULL;
+        }
+        chunk->next = *arena;
+        chunk->used = 0;
+        chunk->size = capacity;
+        *arena = chunk;
+    }
+    void *p = chunk->data + chunk->used;
+    chunk->used += size;
+    return p;
+}
+
+static void vmFreeArena(VmChunk **arena) {
+    while (*arena) {
+        VmChunk *next = (*arena)->next;
+        free(*arena);
+        *arena = next;
+    }
+}
+
+static VmString *vmNewString(VmChunk **arena, const char *text, size_t length) {
+    VmString *s = (VmString *)vmAlloc(arena, sizeof(VmString) + length + 1);
+    if (s) {
+        s->length = length;
+        memcpy(s->text, text, length);
+        s->text[length] = '\0';
+    }
+    return s;
+}
+
+// element k d'un tableau, quel que soit son rangement
+static inline VmValue arrayItem(const VmArray *array, int k) {
+    VmValue v;
+    v.type = array->elementType;
+    switch (array->elementType) {
+        case VM_INT:   v.as.i = ((const int64_t *)array->data)[k]; break;
+        case VM_FLOAT: v.as.f = ((const double *)array->data)[k]; break;
+        case VM_BOOL:  v.as.i = ((const bool *)array->data)[k]; break;
+        default:       v = array->items[k]; break;
+    }
+    return v;
+}
+
+// ---------------------------------------------------------------------------
+// Affichage
+
+static void printFloat(FILE *out, double f) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.15g", f);
+    fputs(buffer, out);
+    if (!strpbrk(buffer, ".eEni")) {
+        fputs(".0", out);
+    }
+}
+
+// element d'un tableau ou valeur d'un dictionnaire : chaines entre guillemets
+static void printItem(FILE *out, const VmValue *item) {
+    if (item->type == VM_STRING) {
+        fputc('"', out);
+        vmPrintValue(out, item);
+        fputc('"', out);
+    } else {
+        vmPrintValue(out, item);
+    }
+}
+
+void vmPrintValue(FILE *out, const VmValue *value) {
+    switch (value->type) {
+        case VM_INT:
+            fprintf(out, "%lld", (long long)value->as.i);
+            break;
+        case VM_FLOAT:
+            printFloat(out, value->as.f);
+            break;
+        case VM_BOOL:
+            fputs(value->as.i ? "true" : "false", out);
+            break;
+        case VM_STRING:
+            fwrite(value->as.s->text, 1, value->as.s->length, out);
+            break;
+        case VM_ARRAY:
+            fputc('[', out);
+            for (int i = 0; i < value->as.a->length; i++) {
+                VmValue item = arrayItem(value->as.a, i);
+                if (i > 0) {
+                    fputc(',', out);
+                }
+                printItem(out, &item);
+            }
+            fputc(']', out);
+            break;
+        case VM_DICT: {
+            // dans l'ordre du litteral, comme la table des symboles
+            const VmDictKeys *keys = value->as.d->keys;
+            fputc('{', out);
+            for (int i = 0; i < keys->count; i++) {
+                if (i > 0) {
+                    fputc(',', out);
+                }
+                fputc('"', out);
+                fwrite(keys->keys[i]->text, 1, keys->keys[i]->length, out);
+                fputs("\":", out);
+                printItem(out, &value->as.d->values[i]);
+            }
+            fputc('}', out);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Chargement : quads -> instructions
+
+#define SLOT_OTHER 0        // temporaire, tableau intermediaire, nom inconnu
+#define SLOT_CONSTANT 1
+#define SLOT_DECLARED 2     // variable dont la table des symboles donne le type
+
+typedef struct Loader {
+    VmProgram *prog;
+    SymbolTable *table;
+    FILE *err;
+    int qc;                 // quad en cours de decodage
+    IdMap operators;
+    IdMap names;            // nom ou litteral -> case
+    IdMap labels;           // etiquette -> indice de l'instruction suivante
+    StringId *branchLabels; // etiquette (ou numero de quad) visee par chaque instruction
+    int *firstInstr;        // premiere instruction de chaque quad, pour les cibles numeriques
+    int codeCapacity;
+    unsigned char *types;   // type statique de chaque case
+    unsigned char *kinds;   // SLOT_OTHER, SLOT_CONSTANT ou SLOT_DECLARED
+    int *writers;           // nombre d'instructions qui ecrivent la case
+    int slotCapacity;
+    int elementCapacity;
+    int dictCapacity;
+} Loader;
+
+static int loadError(Loader *l, const char *message, const char *detail) {
+    if (detail) {
+        fprintf(l->err, "Error: %s '%s' (quad %d)\n", message, detail, l->qc);
+    } else {
+        fprintf(l->err, "Error: %s (quad %d)\n", message, l->qc);
+    }
+    return -1;
+}
+
+static int vmTypeOf(int symbolType) {
+    switch (symbolType) {
+        case TYPE_INTEGER: return VM_INT;
+        case TYPE_FLOAT:   return VM_FLOAT;
+        case TYPE_BOOLEAN: return VM_BOOL;
+        case TYPE_STRING:  return VM_STRING;
+        case TYPE_ARRAY:   return VM_ARRAY;
+        case TYPE_DICT:    return VM_DICT;
+        default:           return VM_NONE;
+    }
+}
+
+static int newSlot(Loader *l, VmValue value, int kind) {
+    VmProgram *prog = l->prog;
+    if (prog->slotCount == l->slotCapacity) {
+        int capacity = l->slotCapacity ? 2 * l->slotCapacity : 64;
+        VmValue *initial = (VmValue *)realloc(prog->initial, capacity * sizeof(VmValue));
+        if (initial) prog->initial = initial;
+        unsigned char *types = (unsigned char *)realloc(l->types, capacity);
+        if (types) l->types = types;
+        unsigned char *kinds = (unsigned char *)realloc(l->kinds, capacity);
+        if (kinds) l->kinds = kinds;
+        int *writers = (int *)realloc(l->writers, capacity * sizeof(int));
+        if (writers) l->writers = writers;
+        if (!initial || !types || !kinds || !writers) {
+            return -1;
+        }
+        l->slotCapacity = capacity;
+    }
+    int slot = prog->slotCount++;
+    prog->initial[slot] = value;
+    l->types[slot] = (unsigned char)value.type;
+    l->kinds[slot] = (unsigned char)kind;
+    l->writers[slot] = 0;
+    return slot;
+}
+
+// valeur par defaut d'une variable du type donne (voir createValueString)
+static int zeroValue(Loader *l, int type, VmValue *value) {
+    memset(value, 0, sizeof(*value));
+    value->type = type;
+    if (type == VM_STRING) {
+        value->as.s = vmNewString(&l->prog->constants, "", 0);
+        return value->as.s ? 0 : -1;
+    }
+    if (type == VM_ARRAY) {
+        value->as.a = (VmArray *)vmAlloc(&l->prog->constants, sizeof(VmArray));
+        if (!value->as.a) {
+            return -1;
+        }
+        value->as.a->length = 0;
+        value->as.a->elementType = VM_NONE;
+        value->as.a->data = NULL;
+    }
+    if (type == VM_DICT) {
+        // aucune cle, une seule case d'index, libre
+        VmDictKeys *keys = (VmDictKeys *)vmAlloc(&l->prog->constants, sizeof(VmDictKeys) + sizeof(int32_t));
+        value->as.d = (VmDict *)vmAlloc(&l->prog->constants, sizeof(VmDict));
+        if (!keys || !value->as.d) {
+            return -1;
+        }
+        memset(keys, 0, sizeof(*keys));
+        keys->capacity = 1;
+        keys->index = (int32_t *)(keys + 1);
+        keys->index[0] = -1;
+        value->as.d->keys = keys;
+    }
+    return 0;
+}
+
+// 1 si text est un litteral (voir valuePlace), 0 si c'est un nom
+static int parseLiteral(Loader *l, const char *text, size_t length, VmValue *value) {
+    memset(value, 0, sizeof(*value));
+    if (length >= 2 && text[0] == '"' && text[length - 1] == '"') {
+        value->type = VM_STRING;
+        value->as.s = vmNewString(&l->prog->constants, text + 1, length - 2);
+        return value->as.s ? 1 : -1;
+    }
+    if ((length == 4 && memcmp(text, "true", 4) == 0) || (length == 5 && memcmp(text, "false", 5) == 0)) {
+        value->type = VM_BOOL;
+        value->as.i = text[0] == 't';
+        return 1;
+    }
+    if (length == 0 || !isdigit((unsigned char)text[0])) {
+        return 0;
+    }
+    char buffer[64];
+    if (length >= sizeof(buffer)) {
+        return -1;
+    }
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+    if (strpbrk(buffer, ".eE")) {
+        value->type = VM_FLOAT;
+        value->as.f = strtod(buffer, NULL);
+    } else {
+        value->type = VM_INT;
+        value->as.i = strtoll(buffer, NULL, 10);
+    }
+    return 1;
+}
+
+static int nameSlot(Loader *l, StringId id) {
+    int slot = idMapGet(&l->names, id, -1);
+    if (slot >= 0) {
+        return slot;
+    }
+    VmValue value;
+    int literal = parseLiteral(l, internedString(id), internedLength(id), &value);
+    if (literal < 0) {
+        return loadError(l, "Invalid literal", internedString(id));
+    }
+    if (literal) {
+        slot = newSlot(l, value, SLOT_CONSTANT);
+    } else {
+        SymbolEntry *symbol = lookupSymbolByName(l->table, id, currentScope(l->table));
+        int type = symbol ? vmTypeOf(symbol->type) : VM_NONE;
+        if (zeroValue(l, type, &value) < 0) {
+            return -1;
+        }
+        slot = newSlot(l, value, symbol && type != VM_NONE ? SLOT_DECLARED : SLOT_OTHER);
+    }
+    if (slot >= 0) {
+        idMapPut(&l->names, id, slot);
+    }
+    return slot;
+}
+
+static int emit(Loader *l, int op, int a, int b, int r) {
+    VmProgram *prog = l->prog;
+    if (prog->length == l->codeCapacity) {
+        int capacity = l->codeCapacity ? 2 * l->codeCapacity : 256;
+        VmInstr *code = (VmInstr *)realloc(prog->code, capacity * sizeof(VmInstr));
+        if (code) prog->code = code;
+        StringId *labels = (StringId *)realloc(l->branchLabels, capacity * sizeof(StringId));
+        if (labels) l->branchLabels = labels;
+        if (!code || !labels) {
+            return -1;
+        }
+        l->codeCapacity = capacity;
+    }
+    int i = prog->length++;
+    VmInstr *instr = &prog->code[i];
+    instr->handler = NULL;
+    instr->op = op;
+    instr->a = a;
+    instr->b = b;
+    instr->r = r;
+    instr->target = -1;
+    instr->qc = l->qc;
+    l->branchLabels[i] = STRING_ID_NONE;
+    if (r >= 0) {
+        l->writers[r]++;
+    }
+    return i;
+}
+
+static int placeSlot(Loader *l, const char *text, size_t length);
+
+// copie count cases a la suite de prog->elements ; retourne l'indice de
+// la premiere
+static int addElements(Loader *l, const int *items, int count) {
+    VmProgram *prog = l->prog;
+    if (prog->elementCount + count > l->elementCapacity) {
+        int needed = prog->elementCount + count;
+        int capacity = l->elementCapacity ? l->elementCapacity : 64;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+        int *grown = (int *)realloc(prog->elements, capacity * sizeof(int));
+        if (!grown) {
+            return -1;
+        }
+        prog->elements = grown;
+        l->elementCapacity = capacity;
+    }
+    int first = prog->elementCount;
+    if (count > 0) {
+        memcpy(prog->elements + first, items, count * sizeof(int));
+    }
+    prog->elementCount += count;
+    return first;
+}
+
+// "[e1,e2,...]" : instruction ARRAY qui construit le tableau dans result
+// (nouvelle case si result < 0) ; les elements peuvent etre des tableaux
+static int arraySlot(Loader *l, const char *text, size_t length, int result) {
+    int *items = NULL;
+    int count = 0, capacity = 0;
+    size_t start = 1;
+    int depth = 0, quoted = 0;
+    for (size_t i = 1; i < length && length > 2; i++) {
+        char c = text[i];
+        if (quoted) {
+            if (c == '\\' && i + 1 < length) i++;
+            else if (c == '"') quoted = 0;
+            continue;
+        }
+        if (c == '"') quoted = 1;
+        else if (c == '[') depth++;
+        else if (c == ']' && depth > 0) depth--;
+        else if ((c == ',' && depth == 0) || i == length - 1) {
+            if (count == capacity) {
+                capacity = capacity ? 2 * capacity : 8;
+                int *grown = (int *)realloc(items, capacity * sizeof(int));
+                if (!grown) {
+                    free(items);
+                    return -1;
+                }
+                items = grown;
+            }
+            int slot = placeSlot(l, text + start, i - start);
+            if (slot < 0) {
+                free(items);
+                return -1;
+            }
+            items[count++] = slot;
+            start = i + 1;
+        }
+    }
+
+    int first = addElements(l, items, count);
+    free(items);
+    if (first < 0) {
+        return -1;
+    }
+
+    if (result < 0) {
+        VmValue none;
+        memset(&none, 0, sizeof(none));
+        result = newSlot(l, none, SLOT_OTHER);
+        if (result < 0) {
+            return -1;
+        }
+    }
+    int i = emit(l, OP_ARRAY, -1, count, result);
+    if (i < 0) {
+        return -1;
+    }
+    l->prog->code[i].target = first;
+    return result;
+}
+
+// entree de la cle dans keys, -1 si elle est absente : une seule case
+// avec le hachage parfait, sondage lineaire sinon
+static int dictFind(const VmDictKeys *keys, const char *text, size_t length, uint64_t h) {
+    int32_t e;
+    if (keys->buckets > 0) {
+        uint32_t bucket = dictBucket(h, (uint32_t)keys->buckets);
+        e = keys->index[dictPerfectSlot(h, keys->seed, keys->displacements[bucket], (uint32_t)keys->count)];
+        return keys->hashes[e] == h && keys->keys[e]->length == length &&
+               memcmp(keys->keys[e]->text, text, length) == 0 ? e : -1;
+    }
+    uint32_t mask = (uint32_t)keys->capacity - 1;
+    for (uint32_t slot = (uint32_t)h & mask; (e = keys->index[slot]) >= 0; slot = (slot + 1) & mask) {
+        if (keys->hashes[e] == h && keys->keys[e]->length == length &&
+            memcmp(keys->keys[e]->text, text, length) == 0) {
+            return e;
+        }
+    }
+    return -1;
+}
+
+// index des cles : hachage parfait si hash donne ses deplacements et sa
+// graine ("[d0,d1,...;graine]", graine 0 si elle manque),
+// adressage ouvert sinon
+static int indexDict(Loader *l, VmDictKeys *keys, StringId hash) {
+    VmChunk **arena = &l->prog->constants;
+    if (hash != STRING_ID_NONE && keys->count > 0) {
+        uint32_t buckets = dictBuckets((uint32_t)keys->count);
+        uint32_t *displacements = (uint32_t *)vmAlloc(arena, buckets * sizeof(uint32_t));
+        keys->index = (int32_t *)vmAlloc(arena, keys->count * sizeof(int32_t));
+        if (!displacements || !keys->index) {
+            return -1;
+        }
+        const char *p = internedString(hash);
+        uint32_t n = 0;
+        while (*p == '[' || *p == ',') {
+            char *end;
+            unsigned long d = strtoul(p + 1, &end, 10);
+            if (end == p + 1 || n == buckets) {
+                return loadError(l, "Invalid dict hash", internedString(hash));
+            }
+            displacements[n++] = (uint32_t)d;
+            p = end;
+        }
+        unsigned long seed = 0;
+        if (n == buckets && *p == ';') {
+            char *end;
+            seed = strtoul(p + 1, &end, 10);
+            p = end == p + 1 || seed >= DICT_MAX_SEEDS ? p : end;
+        }
+        if (n != buckets || *p != ']') {
+            return loadError(l, "Invalid dict hash", internedString(hash));
+        }
+        keys->seed = (uint32_t)seed;
+        keys->buckets = (int)buckets;
+        keys->displacements = displacements;
+        keys->capacity = keys->count;
+        memset(keys->index, -1, keys->count * sizeof(int32_t));
+        for (int k = 0; k < keys->count; k++) {
+            uint64_t h = keys->hashes[k];
+            uint32_t slot = dictPerfectSlot(h, keys->seed, displacements[dictBucket(h, buckets)], (uint32_t)keys->count);
+            if (keys->index[slot] >= 0) {
+                return loadError(l, "Invalid dict hash", internedString(hash));
+            }
+            keys->index[slot] = k;
+        }
+        return 0;
+    }
+    keys->capacity = 1;
+    while (keys->capacity < 2 * keys->count) {
+        keys->capacity *= 2;
+    }
+    keys->index = (int32_t *)vmAlloc(arena, keys->capacity * sizeof(int32_t));
+    if (!keys->index) {
+        return -1;
+    }
+    memset(keys->index, -1, keys->capacity * sizeof(int32_t));
+    uint32_t mask = (uint32_t)keys->capacity - 1;
+    for (int k = 0; k < keys->count; k++) {
+        const VmString *key = keys->keys[k];
+        if (dictFind(keys, key->text, key->length, keys->hashes[k]) >= 0) {
+            return loadError(l, "Duplicate dict key", key->text);
+        }
+        uint32_t slot = (uint32_t)keys->hashes[k] & mask;
+        while (keys->index[slot] >= 0) {
+            slot = (slot + 1) & mask;
+        }
+        keys->index[slot] = k;
+    }
+    return 0;
+}
+
+// "{"k1":p1,...}" : instruction DICT qui construit le dictionnaire dans
+// result ; ses cles vont dans prog->dicts, ses valeurs dans prog->elements
+static int dictSlot(Loader *l, const char *text, size_t length, StringId hash, int result) {
+    VmProgram *prog = l->prog;
+    int *items = NULL;
+    VmString **names = NULL;
+    int count = 0, capacity = 0;
+    size_t start = 1;
+    int quoted = 0;
+    for (size_t i = 1; i < length && length > 2; i++) {
+        char c = text[i];
+        if (quoted) {
+            if (c == '\\' && i + 1 < length) i++;
+            else if (c == '"') quoted = 0;
+            continue;
+        }
+        if (c == '"') {
+            quoted = 1;
+            continue;
+        }
+        if (c != ',' && i != length - 1) {
+            continue;
+        }
+        // "cle":place
+        const char *item = text + start;
+        size_t n = i - start, key = 1;
+        start = i + 1;
+        while (key < n && item[key] != '"') key += item[key] == '\\' ? 2 : 1;
+        if (n == 0 || item[0] != '"' || key + 2 > n || item[key + 1] != ':') {
+            free(items);
+            free(names);
+            return loadError(l, "Invalid dict entry", NULL);
+        }
+        if (count == capacity) {
+            capacity = capacity ? 2 * capacity : 8;
+            int *grown = (int *)realloc(items, capacity * sizeof(int));
+            VmString **grownNames = grown ? (VmString **)realloc(names, capacity * sizeof(VmString *)) : NULL;
+            if (grown) items = grown;
+            if (grownNames) names = grownNames;
+            if (!grown || !grownNames) {
+                free(items);
+                free(names);
+                return -1;
+            }
+        }
+        names[count] = vmNewString(&prog->constants, item + 1, key - 1);
+        int slot = names[count] ? placeSlot(l, item + key + 2, n - key - 2) : -1;
+        if (slot < 0) {
+            free(items);
+            free(names);
+            return -1;
+        }
+        items[count++] = slot;
+    }
+
+    if (prog->dictCount == l->dictCapacity) {
+        int capacity2 = l->dictCapacity ? 2 * l->dictCapacity : 8;
+        VmDictKeys *grown = (VmDictKeys *)realloc(prog->dicts, capacity2 * sizeof(VmDictKeys));
+        if (!grown) {
+            free(items);
+            free(names);
+            return -1;
+        }
+        prog->dicts = grown;
+        l->dictCapacity = capacity2;
+    }
+    VmDictKeys *keys = &prog->dicts[prog->dictCount];
+    memset(keys, 0, sizeof(*keys));
+    keys->count = count;
+    keys->keys = (VmString **)vmAlloc(&prog->constants, (count + 1) * sizeof(VmString *));
+    keys->hashes = (uint64_t *)vmAlloc(&prog->constants, (count + 1) * sizeof(uint64_t));
+    for (int k = 0; keys->keys && keys->hashes && k < count; k++) {
+        keys->keys[k] = names[k];
+        keys->hashes[k] = dictHash(names[k]->text, names[k]->length);
+    }
+    int first = keys->keys && keys->hashes && indexDict(l, keys, hash) == 0 ? addElements(l, items, count) : -1;
+    free(items);
+    free(names);
+    if (first < 0) {
+        return -1;
+    }
+    int i = emit(l, OP_DICT, -1, prog->dictCount++, result);
+    if (i < 0) {
+        return -1;
+    }
+    prog->code[i].target = first;
+    return result;
+}
+
+// operande donne par son texte (element de tableau)
+static int placeSlot(Loader *l, const char *text, size_t length) {
+    if (length > 0 && text[0] == '[') {
+        return arraySlot(l, text, length, -1);
+    }
+    if (length == 0) {
+        return loadError(l, "Empty array element", NULL);
+    }
+    return nameSlot(l, internStringN(text, length));
+}
+
+static int operandSlot(Loader *l, StringId id) {
+    if (id == STRING_ID_NONE) {
+        return loadError(l, "Missing operand", NULL);
+    }
+    const char *text = internedString(id);
+    if (text[0] == '[') {
+        return arraySlot(l, text, internedLength(id), -1);
+    }
+    return nameSlot(l, id);
+}
+
+static int decodeQuad(Loader *l, quad *q) {
+    int op = idMapGet(&l->operators, q->operateur, -1);
+    if (op < 0) {
+        if (q->operande1 == STRING_ID_NONE && q->operande2 == STRING_ID_NONE && q->resultat == STRING_ID_NONE) {
+            // etiquette : designe l'instruction qui suit
+            if (idMapGet(&l->labels, q->operateur, -1) < 0) {
+                idMapPut(&l->labels, q->operateur, l->prog->length);
+            }
+            return 0;
+        }
+        return loadError(l, "Unknown operator", internedString(q->operateur));
+    }
+
+    int a = -1, b = -1, r = -1, i;
+    switch (op) {
+        case OP_BR:
+            i = emit(l, OP_BR, -1, -1, -1);
+            if (i >= 0) l->branchLabels[i] = q->resultat;
+            return i < 0 ? -1 : 0;
+        case OP_BZ:
+        case OP_BNZ:
+            if ((a = operandSlot(l, q->resultat)) < 0) return -1;
+            i = emit(l, op, a, -1, -1);
+            if (i >= 0) l->branchLabels[i] = q->operande1;
+            return i < 0 ? -1 : 0;
+        case OP_CASE:
+            i = emit(l, OP_CASE, -1, -1, -1);
+            if (i >= 0) l->branchLabels[i] = q->operande1;
+            return i < 0 ? -1 : 0;
+        case OP_SWITCH: {
+            // SWITCH selecteur, minimum, n : target garde n, les n CASE qui
+            // suivent forment la table (verifiee par checkSwitches)
+            char *end;
+            long n = strtol(internedString(q->resultat), &end, 10);
+            if (end == internedString(q->resultat) || *end || n < 0 || n > INT32_MAX / 2) {
+                return loadError(l, "Invalid SWITCH table size", internedString(q->resultat));
+            }
+            if ((a = operandSlot(l, q->operande1)) < 0 || (b = operandSlot(l, q->operande2)) < 0) return -1;
+            i = emit(l, OP_SWITCH, a, b, -1);
+            if (i >= 0) l->prog->code[i].target = (int)n;
+            return i < 0 ? -1 : 0;
+        }
+        case OP_ARRAY:
+            // ARRAY_DECL nom, [elements], temporaire
+            if ((r = nameSlot(l, q->operande1)) < 0) return -1;
+            if (internedString(q->operande2)[0] == '[') {
+                return arraySlot(l, internedString(q->operande2), internedLength(q->operande2), r) < 0 ? -1 : 0;
+            }
+            if ((a = operandSlot(l, q->operande2)) < 0) return -1;
+            return emit(l, OP_MOVE, a, -1, r) < 0 ? -1 : 0;
+        case OP_DICT:
+            // DICT_DECL nom, {"cle":valeur,...}, [hachage parfait]
+            if ((r = nameSlot(l, q->operande1)) < 0) return -1;
+            if (internedString(q->operande2)[0] == '{') {
+                return dictSlot(l, internedString(q->operande2), internedLength(q->operande2),
+                                q->resultat, r) < 0 ? -1 : 0;
+            }
+            if ((a = operandSlot(l, q->operande2)) < 0) return -1;
+            return emit(l, OP_MOVE, a, -1, r) < 0 ? -1 : 0;
+        case OP_PRINT:
+            if ((a = operandSlot(l, q->operande1)) < 0) return -1;
+            return emit(l, OP_PRINT, a, -1, -1) < 0 ? -1 : 0;
+        case OP_MOVE:
+        case OP_NOT:
+        case OP_NEG:
+        case OP_INPUT:
+        case OP_VNOT:
+        case OP_VNEG:
+        case OP_SUM:
+        case OP_MIN:
+        case OP_MAX:
+            if ((a = operandSlot(l, q->operande1)) < 0) return -1;
+            break;
+        default:
+            if ((a = operandSlot(l, q->operande1)) < 0 || (b = operandSlot(l, q->operande2)) < 0) return -1;
+            break;
+    }
+    if (q->resultat == STRING_ID_NONE || (r = nameSlot(l, q->resultat)) < 0) {
+        return q->resultat == STRING_ID_NONE ? loadError(l, "Missing result for", internedString(q->operateur)) : -1;
+    }
+    if (l->kinds[r] == SLOT_CONSTANT) {
+        return loadError(l, "Cannot assign to literal", internedString(q->resultat));
+    }
+    return emit(l, op, a, b, r) < 0 ? -1 : 0;
+}
+
+// type du resultat d'une operation generique selon le type de ses
+// operandes ; doit correspondre exactement a ce que produit vmRun
+static int resultType(int op, int ta, int tb) {
+    switch (op) {
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL: {
+            int numericA = ta == VM_INT || ta == VM_FLOAT || ta == VM_BOOL;
+            int numericB = tb == VM_INT || tb == VM_FLOAT || tb == VM_BOOL;
+            if (!numericA || !numericB) return VM_NONE;
+            return ta == VM_FLOAT || tb == VM_FLOAT ? VM_FLOAT : VM_INT;
+        }
+        case OP_DIV:    return VM_FLOAT;
+        case OP_IDIV:
+        case OP_MOD:    return VM_INT;
+        case OP_EQ: case OP_NE: case OP_LT: case OP_LE: case OP_GT: case OP_GE:
+        case OP_AND: case OP_OR: case OP_NOT:
+                        return VM_BOOL;
+        case OP_NEG:    return ta == VM_FLOAT ? VM_FLOAT : ta == VM_INT || ta == VM_BOOL ? VM_INT : VM_NONE;
+        case OP_CONCAT: return VM_STRING;
+        case OP_HASH:   return VM_INT;
+        case OP_MOVE:   return ta;
+        case OP_ARRAY:  return VM_ARRAY;
+        case OP_DICT:   return VM_DICT;
+        case OP_VADD: case OP_VSUB: case OP_VMUL: case OP_VDIV: case OP_VIDIV: case OP_VMOD:
+        case OP_VEQ: case OP_VNE: case OP_VLT: case OP_VLE: case OP_VGT: case OP_VGE:
+        case OP_VAND: case OP_VOR: case OP_VNOT: case OP_VNEG:
+                        return VM_ARRAY;
+        default:        return VM_NONE;     // SUM, MIN, MAX, INDEX : type des elements
+    }
+}
+
+#define TYPE_UNSET 0xff      // case partagee dont aucune ecriture n'est encore typee
+#define INFER_ROUNDS 8      // tours avant de rendre les cases partagees dynamiques
+
+static int joinType(int a, int b) {
+    return a == TYPE_UNSET || a == b ? b : b == TYPE_UNSET ? a : VM_NONE;
+}
+
+// Propagation des types statiques. Un temporaire (une seule ecriture)
+// prend le type de l'operation qui le produit. Une case partagee par
+// plusieurs temporaires (tempalloc.h) part de TYPE_UNSET et prend le type
+// commun de ses ecritures, calcule avec les types du tour precedent ;
+// celles qui restent TYPE_UNSET deviennent dynamiques. Une variable
+// declaree garde le type de la table des symboles tant que toutes ses
+// ecritures le respectent, sinon elle redevient dynamique. On recommence
+// jusqu'a ce que plus rien ne change
+static void inferTypes(Loader *l) {
+    VmProgram *prog = l->prog;
+    // sans memoire, les cases partagees sont dynamiques
+    unsigned char *joint = (unsigned char *)malloc(prog->slotCount + 1);
+    for (int s = 0; s < prog->slotCount; s++) {
+        if (l->kinds[s] == SLOT_OTHER && l->writers[s] > 1) {
+            l->types[s] = joint ? TYPE_UNSET : VM_NONE;
+        }
+    }
+    int changed, rounds = 0;
+    do {
+        changed = 0;
+        for (int s = 0; s < prog->slotCount; s++) {
+            if (l->kinds[s] == SLOT_OTHER && (l->writers[s] <= 1 || !joint)) {
+                l->types[s] = VM_NONE;
+            }
+            if (joint) {
+                joint[s] = TYPE_UNSET;
+            }
+        }
+        for (int i = 0; i < prog->length; i++) {
+            VmInstr *in = &prog->code[i];
+            // INPUT lit une variable declaree avec son type
+            if (in->r < 0 || (in->op == OP_INPUT && l->kinds[in->r] != SLOT_OTHER)) {
+                continue;
+            }
+            int ta = in->a >= 0 ? l->types[in->a] : VM_NONE;
+            int tb = in->b >= 0 && in->op != OP_ARRAY && in->op != OP_DICT ? l->types[in->b] : VM_NONE;
+            int t = ta == TYPE_UNSET || tb == TYPE_UNSET ? TYPE_UNSET :
+                    in->op == OP_INPUT ? VM_NONE : resultType(in->op, ta, tb);
+            if (l->kinds[in->r] != SLOT_OTHER) {
+                if (t != TYPE_UNSET && l->types[in->r] != VM_NONE && l->types[in->r] != t) {
+                    l->types[in->r] = VM_NONE;
+                    changed = 1;
+                }
+            } else if (l->writers[in->r] == 1) {
+                l->types[in->r] = (unsigned char)t;
+            } else if (joint) {
+                joint[in->r] = (unsigned char)joinType(joint[in->r], t);
+            }
+        }
+        int unset = 0;
+        for (int s = 0; joint && s < prog->slotCount; s++) {
+            if (l->kinds[s] == SLOT_OTHER && l->writers[s] > 1) {
+                if (joint[s] != l->types[s]) {
+                    l->types[s] = joint[s];
+                    changed = 1;
+                }
+                unset |= joint[s] == TYPE_UNSET;
+            }
+        }
+        if (joint && (unset || changed) && (!changed || ++rounds == INFER_ROUNDS)) {
+            // point fixe atteint avec des cases jamais typees, ou pas de
+            // point fixe : ces cases deviennent dynamiques
+            for (int s = 0; s < prog->slotCount; s++) {
+                if (l->kinds[s] == SLOT_OTHER && l->writers[s] > 1 &&
+                    (rounds == INFER_ROUNDS || l->types[s] == TYPE_UNSET)) {
+                    l->types[s] = VM_NONE;
+                }
+            }
+            if (rounds == INFER_ROUNDS) {
+                free(joint);
+                joint = NULL;
+            }
+            changed = 1;
+        }
+    } while (changed);
+    free(joint);
+}
+
+static void specialize(Loader *l) {
+    VmProgram *prog = l->prog;
+    for (int i = 0; i < prog->length; i++) {
+        VmInstr *in = &prog->code[i];
+        int ta = in->a >= 0 ? l->types[in->a] : VM_NONE;
+        int tb = in->b >= 0 && in->op != OP_ARRAY && in->op != OP_DICT ? l->types[in->b] : VM_NONE;
+        int ints = ta == VM_INT && tb == VM_INT;
+        int floats = ta == VM_FLOAT && tb == VM_FLOAT;
+        switch (in->op) {
+            case OP_ADD:  in->op = ints ? OP_ADD_II : floats ? OP_ADD_FF : OP_ADD; break;
+            case OP_SUB:  in->op = ints ? OP_SUB_II : floats ? OP_SUB_FF : OP_SUB; break;
+            case OP_MUL:  in->op = ints ? OP_MUL_II : floats ? OP_MUL_FF : OP_MUL; break;
+            case OP_DIV:  in->op = floats ? OP_DIV_FF : OP_DIV; break;
+            case OP_IDIV: in->op = ints ? OP_IDIV_II : OP_IDIV; break;
+            case OP_MOD:  in->op = ints ? OP_MOD_II : OP_MOD; break;
+            case OP_EQ:   in->op = ints ? OP_EQ_II : OP_EQ; break;
+            case OP_NE:   in->op = ints ? OP_NE_II : OP_NE; break;
+            case OP_LT:   in->op = ints ? OP_LT_II : OP_LT; break;
+            case OP_LE:   in->op = ints ? OP_LE_II : OP_LE; break;
+            case OP_GT:   in->op = ints ? OP_GT_II : OP_GT; break;
+            case OP_GE:   in->op = ints ? OP_GE_II : OP_GE; break;
+            // le type declare, meme si la variable est devenue dynamique
+            case OP_INPUT: in->b = l->kinds[in->r] == SLOT_DECLARED ? prog->initial[in->r].type : VM_NONE; break;
+            default: break;
+        }
+    }
+}
+
+// chaque SWITCH est suivi de ses n entrees CASE, sans autre instruction
+// (les etiquettes n'en produisent pas)
+static int checkSwitches(Loader *l) {
+    VmProgram *prog = l->prog;
+    for (int i = 0; i < prog->length; i++) {
+        if (prog->code[i].op != OP_SWITCH) {
+            continue;
+        }
+        int n = prog->code[i].target, k = 1;
+        while (k <= n && i + k < prog->length && prog->code[i + k].op == OP_CASE) {
+            k++;
+        }
+        if (k <= n) {
+            l->qc = prog->code[i].qc;
+            return loadError(l, "SWITCH without its CASE table", NULL);
+        }
+    }
+    return 0;
+}
+
+int vmLoad(VmProgram *prog, tableQuads *quads, SymbolTable *table, FILE *err) {
+    memset(prog, 0, sizeof(*prog));
+    Loader l;
+    memset(&l, 0, sizeof(l));
+    l.prog = prog;
+    l.table = table;
+    l.err = err;
+
+    // borne du nombre de noms : trois par quad plus les elements des tableaux
+    uint32_t names = 16;
+    for (int i = 0; i < quads->taille; i++) {
+        quad *q = &quads->quads[i];
+        StringId operands[3] = { q->operande1, q->operande2, q->resultat };
+        for (int k = 0; k < 3; k++) {
+            const char *text = internedString(operands[k]);
+            names++;
+            if (text[0] == '[' || text[0] == '{') {
+                for (; *text; text++) {
+                    names += *text == ',' || *text == '[';
+                }
+            }
+        }
+    }
+    int status = -1;
+    if (initIdMap(&l.operators, VM_OPERATOR_COUNT) < 0 || initIdMap(&l.names, names) < 0 ||
+        initIdMap(&l.labels, (uint32_t)quads->taille) < 0 ||
+        !(l.firstInstr = (int *)malloc((quads->taille + 1) * sizeof(int)))) {
+        fprintf(err, "Error: Out of memory while loading the program\n");
+        goto fin;
+    }
+    for (int i = 0; i < VM_OPERATOR_COUNT; i++) {
+        idMapPut(&l.operators, internString(vmOperators[i].name), vmOperators[i].op);
+    }
+
+    for (int i = 0; i < quads->taille; i++) {
+        l.qc = quads->quads[i].qc;
+        l.firstInstr[i] = prog->length;
+        if (decodeQuad(&l, &quads->quads[i]) < 0) {
+            goto fin;
+        }
+    }
+    l.qc = quads->premier + quads->taille;
+    l.firstInstr[quads->taille] = prog->length;
+    if (emit(&l, OP_HALT, -1, -1, -1) < 0) {
+        goto fin;
+    }
+
+    for (int i = 0; i < prog->length; i++) {
+        if (l.branchLabels[i] != STRING_ID_NONE) {
+            int cible = indiceCible(quads, l.branchLabels[i]);
+            prog->code[i].target = cible >= 0 ? l.firstInstr[cible] : idMapGet(&l.labels, l.branchLabels[i], -1);
+            if (prog->code[i].target < 0) {
+                l.qc = prog->code[i].qc;
+                loadError(&l, "Undefined label", internedString(l.branchLabels[i]));
+                goto fin;
+            }
+        }
+    }
+    if (checkSwitches(&l) < 0) {
+        goto fin;
+    }
+
+    inferTypes(&l);
+    specialize(&l);
+    prog->slots = (VmValue *)malloc((prog->slotCount + 1) * sizeof(VmValue));
+    status = prog->slots ? 0 : -1;
+    if (status < 0) {
+        fprintf(err, "Error: Out of memory while loading the program\n");
+    }
+
+fin:
+    freeIdMap(&l.operators);
+    freeIdMap(&l.names);
+    freeIdMap(&l.labels);
+    free(l.branchLabels);
+    free(l.firstInstr);
+    free(l.types);
+    free(l.kinds);
+    free(l.writers);
+    if (status < 0) {
+        vmFree(prog);
+    }
+    return status;
+}
+
+void vmFree(VmProgram *prog) {
+    free(prog->code);
+    free(prog->initial);
+    free(prog->slots);
+    free(prog->elements);
+    free(prog->dicts);
+    vmFreeArena(&prog->constants);
+    vmFreeArena(&prog->heap);
+    memset(prog, 0, sizeof(*prog));
+}
+
+// ---------------------------------------------------------------------------
+// Operations generiques : les types sont testes a l'execution. Retournent
+// NULL ou le message d'erreur
+
+static inline int isNumeric(const VmValue *v) {
+    return v->type == VM_INT || v->type == VM_FLOAT || v->type == VM_BOOL;
+}
+
+static inline double toDouble(const VmValue *v) {
+    return v->type == VM_FLOAT ? v->as.f : (double)v->as.i;
+}
+
+// arithmetique entiere modulo 2^64, sans comportement indefini
+static inline int64_t wrapAdd(int64_t x, int64_t y) { return (int64_t)((uint64_t)x + (uint64_t)y); }
+static inline int64_t wrapSub(int64_t x, int64_t y) { return (int64_t)((uint64_t)x - (uint64_t)y); }
+static inline int64_t wrapMul(int64_t x, int64_t y) { return (int64_t)((uint64_t)x * (uint64_t)y); }
+
+static const char *integerDivide(int op, int64_t x, int64_t y, VmValue *r) {
+    if (y == 0) {
+        return op == OP_MOD ? "Modulo by zero" : "Division by zero";
+    }
+    r->type = VM_INT;
+    if (y == -1) {
+        r->as.i = op == OP_MOD ? 0 : wrapSub(0, x);
+    } else {
+        r->as.i = op == OP_MOD ? x % y : x / y;
+    }
+    return NULL;
+}
+
+static const char *arithmetic(int op, const VmValue *a, const VmValue *b, VmValue *r) {
+    if (!isNumeric(a) || !isNumeric(b)) {
+        return "Unsupported operand types for arithmetic";
+    }
+    int real = a->type == VM_FLOAT || b->type == VM_FLOAT;
+    if (!real && (op == OP_IDIV || op == OP_MOD)) {
+        return integerDivide(op, a->as.i, b->as.i, r);
+    }
+    if (!real && op != OP_DIV) {
+        r->type = VM_INT;
+        r->as.i = op == OP_ADD ? wrapAdd(a->as.i, b->as.i)
+                : op == OP_SUB ? wrapSub(a->as.i, b->as.i)
+                               : wrapMul(a->as.i, b->as.i);
+        return NULL;
+    }
+
+    double x = toDouble(a), y = toDouble(b);
+    switch (op) {
+        case OP_ADD: r->type = VM_FLOAT; r->as.f = x + y; return NULL;
+        case OP_SUB: r->type = VM_FLOAT; r->as.f = x - y; return NULL;
+        case OP_MUL: r->type = VM_FLOAT; r->as.f = x * y; return NULL;
+        case OP_DIV:
+            if (y == 0) return "Division by zero";
+            r->type = VM_FLOAT;
+            r->as.f = x / y;
+            return NULL;
+        default: {
+            // DIV et MOD sur des reels : resultat entier, comme a la compilation
+            if (y == 0) return op == OP_MOD ? "Modulo by zero" : "Division by zero";
+            double q = op == OP_MOD ? fmod(x, y) : trunc(x / y);
+            if (!(q > -9.2e18 && q < 9.2e18)) return "Integer overflow";
+            r->type = VM_INT;
+            r->as.i = (int64_t)q;
+            return NULL;
+        }
+    }
+}
+
+static const char *compare(int op, const VmValue *a, const VmValue *b, VmValue *r) {
+    int c;
+    if (a->type == VM_STRING && b->type == VM_STRING) {
+        size_t n = a->as.s->length < b->as.s->length ? a->as.s->length : b->as.s->length;
+        c = memcmp(a->as.s->text, b->as.s->text, n);
+        if (c == 0) {
+            c = (a->as.s->length > b->as.s->length) - (a->as.s->length < b->as.s->length);
+        }
+    } else if (isNumeric(a) && isNumeric(b)) {
+        if (a->type != VM_FLOAT && b->type != VM_FLOAT) {
+            c = (a->as.i > b->as.i) - (a->as.i < b->as.i);
+        } else {
+            double x = toDouble(a), y = toDouble(b);
+            if (x != x || y != y) {
+                // NaN : seule la difference est vraie
+                r->type = VM_BOOL;
+                r->as.i = op == OP_NE;
+                return NULL;
+            }
+            c = (x > y) - (x < y);
+        }
+    } else {
+        return "Cannot compare values of these types";
+    }
+    r->type = VM_BOOL;
+    switch (op) {
+        case OP_EQ: r->as.i = c == 0; break;
+        case OP_NE: r->as.i = c != 0; break;
+        case OP_LT: r->as.i = c < 0; break;
+        case OP_LE: r->as.i = c <= 0; break;
+        case OP_GT: r->as.i = c > 0; break;
+        default:    r->as.i = c >= 0; break;
+    }
+    return NULL;
+}
+
+static const char *concat(VmProgram *prog, const VmValue *a, const VmValue *b, VmValue *r) {
+    if (a->type != VM_STRING || b->type != VM_STRING) {
+        return "CONCAT requires two strings";
+    }
+    size_t length = a->as.s->length + b->as.s->length;
+    VmString *s = (VmString *)vmAlloc(&prog->heap, sizeof(VmString) + length + 1);
+    if (!s) {
+        return "Out of memory";
+    }
+    s->length = length;
+    memcpy(s->text, a->as.s->text, a->as.s->length);
+    memcpy(s->text + a->as.s->length, b->as.s->text, b->as.s->length);
+    s->text[length] = '\0';
+    r->type = VM_STRING;
+    r->as.s = s;
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Tableaux
+
+static size_t typedSize(int elementType) {
+    return elementType == VM_INT ? sizeof(int64_t) : elementType == VM_FLOAT ? sizeof(double) : sizeof(bool);
+}
+
+// tableau de length elements ; VM_INT, VM_FLOAT ou VM_BOOL : tampon aligne
+// pris dans le meme bloc, VM_NONE : une case par element
+static VmArray *newArray(VmChunk **arena, int length, int elementType) {
+    size_t size = elementType == VM_NONE ? (size_t)length * sizeof(VmValue)
+                                         : (size_t)length * typedSize(elementType) + VEC_ALIGNMENT;
+    VmArray *array = (VmArray *)vmAlloc(arena, sizeof(VmArray) + size);
+    if (!array) {
+        return NULL;
+    }
+    array->length = length;
+    array->elementType = elementType;
+    array->data = NULL;
+    if (elementType != VM_NONE) {
+        uintptr_t p = (uintptr_t)array->items;
+        array->data = (void *)((p + VEC_ALIGNMENT - 1) & ~(uintptr_t)(VEC_ALIGNMENT - 1));
+    }
+    return array;
+}
+
+// tableau des valeurs values[index[k]] (values[k] si index est NULL),
+// range dans un tampon type si elles ont toutes le meme type scalaire
+static VmArray *packArray(VmChunk **arena, const VmValue *values, const int *index, int count) {
+    int type = count > 0 ? values[index ? index[0] : 0].type : VM_NONE;
+    if (type != VM_INT && type != VM_FLOAT && type != VM_BOOL) {
+        type = VM_NONE;
+    }
+    for (int k = 1; k < count && type != VM_NONE; k++) {
+        if (values[index ? index[k] : k].type != type) {
+            type = VM_NONE;
+        }
+    }
+    VmArray *array = newArray(arena, count, type);
+    for (int k = 0; array && k < count; k++) {
+        const VmValue *v = &values[index ? index[k] : k];
+        switch (type) {
+            case VM_INT:   ((int64_t *)array->data)[k] = v->as.i; break;
+            case VM_FLOAT: ((double *)array->data)[k] = v->as.f; break;
+            case VM_BOOL:  ((bool *)array->data)[k] = v->as.i != 0; break;
+            default:       array->items[k] = *v; break;
+        }
+    }
+    return array;
+}
+
+static const char *buildArray(VmProgram *prog, const VmInstr *ip, VmValue *slots) {
+    VmArray *array = packArray(&prog->heap, slots, prog->elements + ip->target, ip->b);
+    if (!array) {
+        return "Out of memory";
+    }
+    slots[ip->r].type = VM_ARRAY;
+    slots[ip->r].as.a = array;
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Dictionnaires
+
+static const char *buildDict(VmProgram *prog, const VmInstr *ip, VmValue *slots) {
+    const VmDictKeys *keys = &prog->dicts[ip->b];
+    VmDict *dict = (VmDict *)vmAlloc(&prog->heap, sizeof(VmDict) + keys->count * sizeof(VmValue));
+    if (!dict) {
+        return "Out of memory";
+    }
+    dict->keys = keys;
+    for (int k = 0; k < keys->count; k++) {
+        dict->values[k] = slots[prog->elements[ip->target + k]];
+    }
+    slots[ip->r].type = VM_DICT;
+    slots[ip->r].as.d = dict;
+    return NULL;
+}
+
+static const char *dictGet(const VmValue *d, const VmValue *key, VmValue *r) {
+    if (d->type != VM_DICT || key->type != VM_STRING) {
+        return "INDEX requires a dict and a string key";
+    }
+    const VmString *s = key->as.s;
+    int e = dictFind(d->as.d->keys, s->text, s->length, dictHash(s->text, s->length));
+    if (e < 0) {
+        return "Key not found";
+    }
+    *r = d->as.d->values[e];
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Operations element par element
+
+// operation scalaire sous-jacente a VADD ... VNEG
+static int elementOp(int op) {
+    static const int scalar[][2] = {
+        { OP_VADD, OP_ADD }, { OP_VSUB, OP_SUB }, { OP_VMUL, OP_MUL }, { OP_VDIV, OP_DIV },
+        { OP_VIDIV, OP_IDIV }, { OP_VMOD, OP_MOD }, { OP_VEQ, OP_EQ }, { OP_VNE, OP_NE },
+        { OP_VLT, OP_LT }, { OP_VLE, OP_LE }, { OP_VGT, OP_GT }, { OP_VGE, OP_GE },
+        { OP_VAND, OP_AND }, { OP_VOR, OP_OR }, { OP_VNOT, OP_NOT }, { OP_VNEG, OP_NEG },
+    };
+    for (size_t k = 0; k < sizeof(scalar) / sizeof(scalar[0]); k++) {
+        if (scalar[k][0] == op) {
+            return scalar[k][1];
+        }
+    }
+    return -1;
+}
+
+// un element : memes regles et memes erreurs que l'instruction scalaire
+static const char *elementValue(int op, const VmValue *x, const VmValue *y, VmValue *r) {
+    switch (op) {
+        case OP_EQ: case OP_NE: case OP_LT: case OP_LE: case OP_GT: case OP_GE:
+            return compare(op, x, y, r);
+        case OP_AND:
+        case OP_OR:
+            if (x->type != VM_BOOL || y->type != VM_BOOL) {
+                return op == OP_AND ? "AND requires boolean operands" : "OR requires boolean operands";
+            }
+            r->type = VM_BOOL;
+            r->as.i = op == OP_AND ? x->as.i && y->as.i : x->as.i || y->as.i;
+            return NULL;
+        case OP_NOT:
+            if (x->type != VM_BOOL) {
+                return "NOT requires a boolean operand";
+            }
+            r->type = VM_BOOL;
+            r->as.i = !x->as.i;
+            return NULL;
+        case OP_NEG:
+            if (x->type == VM_FLOAT) {
+                r->type = VM_FLOAT;
+                r->as.f = -x->as.f;
+            } else if (x->type == VM_INT || x->type == VM_BOOL) {
+                r->type = VM_INT;
+                r->as.i = wrapSub(0, x->as.i);
+            } else {
+                return "Unary minus requires a numeric operand";
+            }
+            return NULL;
+        default:
+            return arithmetic(op, x, y, r);
+    }
+}
+
+// Operande d'un noyau : tampon type d'un tableau (pas 1) ou scalaire
+// repete (pas 0) ; type VM_NONE si aucun noyau ne s'applique
+typedef struct VecOperand {
+    int type;
+    int step;
+    const void *data;
+    union { int64_t i; double f; bool b; } scalar;
+    double *converted;      // entiers convertis en reels (operandes mixtes)
+} VecOperand;
+
+static void vecOperand(const VmValue *v, VecOperand *o) {
+    o->converted = NULL;
+    if (v->type == VM_ARRAY) {
+        o->type = v->as.a->elementType;
+        o->step = 1;
+        o->data = v->as.a->data;
+        return;
+    }
+    o->type = v->type == VM_INT || v->type == VM_FLOAT || v->type == VM_BOOL ? v->type : VM_NONE;
+    o->step = 0;
+    o->data = &o->scalar;
+    if (v->type == VM_FLOAT) o->scalar.f = v->as.f;
+    else if (v->type == VM_BOOL) o->scalar.b = v->as.i != 0;
+    else o->scalar.i = v->as.i;
+}
+
+// passe un operande entier en reels ; -1 si la memoire manque
+static int vecReal(VecOperand *o, int n) {
+    if (o->type != VM_INT) {
+        return 0;
+    }
+    size_t count = o->step ? (size_t)n : 1;
+    size_t size = (count * sizeof(double) + VEC_ALIGNMENT - 1) & ~(size_t)(VEC_ALIGNMENT - 1);
+    o->converted = (double *)aligned_alloc(VEC_ALIGNMENT, size ? size : VEC_ALIGNMENT);
+    if (!o->converted) {
+        return -1;
+    }
+    vecToFloat(o->converted, (const int64_t *)o->data, count);
+    o->type = VM_FLOAT;
+    o->data = o->converted;
+    return 0;
+}
+
+// Chemin rapide par les noyaux de vecteurs.h : 1 si *result a ete calcule
+// (ou *error positionne), 0 si les types demandent le cas general
+static int vectorized(VmProgram *prog, int op, const VmValue *a, const VmValue *b, int n,
+                      VmArray **result, const char **error) {
+    static const VecOp vecOps[] = {
+        [OP_ADD] = VEC_ADD, [OP_SUB] = VEC_SUB, [OP_MUL] = VEC_MUL, [OP_DIV] = VEC_DIV,
+        [OP_EQ] = VEC_EQ, [OP_NE] = VEC_NE, [OP_LT] = VEC_LT, [OP_LE] = VEC_LE,
+        [OP_GT] = VEC_GT, [OP_GE] = VEC_GE, [OP_AND] = VEC_AND, [OP_OR] = VEC_OR,
+        [OP_NOT] = VEC_NOT, [OP_NEG] = VEC_NEG,
+    };
+    VecOperand x, y;
+    vecOperand(a, &x);
+    vecOperand(b, &y);
+    int comparison = op == OP_EQ || op == OP_NE || op == OP_LT || op == OP_LE || op == OP_GT || op == OP_GE;
+    int computation = op == OP_ADD || op == OP_SUB || op == OP_MUL || op == OP_DIV || op == OP_NEG;
+    int numeric = (x.type == VM_INT || x.type == VM_FLOAT) && (y.type == VM_INT || y.type == VM_FLOAT);
+    int logic = (op == OP_AND || op == OP_OR || op == OP_NOT || op == OP_EQ || op == OP_NE) &&
+                x.type == VM_BOOL && y.type == VM_BOOL;
+    if (!logic && !(numeric && (comparison || computation))) {
+        return 0;
+    }
+    int ints = x.type == VM_INT && y.type == VM_INT && op != OP_DIV;
+    VmArray *array = newArray(&prog->heap, n, comparison || logic ? VM_BOOL : ints ? VM_INT : VM_FLOAT);
+    if (!array || (!ints && !logic && (vecReal(&x, n) < 0 || vecReal(&y, n) < 0))) {
+        *error = "Out of memory";
+    } else if (logic) {
+        vecLogic(vecOps[op], array->data, x.data, x.step, y.data, y.step, (size_t)n);
+    } else if (ints && comparison) {
+        vecCompareInt(vecOps[op], array->data, x.data, x.step, y.data, y.step, (size_t)n);
+    } else if (ints) {
+        vecInt(vecOps[op], array->data, x.data, x.step, y.data, y.step, (size_t)n);
+    } else if (comparison) {
+        vecCompareFloat(vecOps[op], array->data, x.data, x.step, y.data, y.step, (size_t)n);
+    } else if (op == OP_DIV && n > 0 && vecHasZero(y.data, y.step ? (size_t)n : 1)) {
+        *error = "Division by zero";
+    } else {
+        vecFloat(vecOps[op], array->data, x.data, x.step, y.data, y.step, (size_t)n);
+    }
+    free(x.converted);
+    free(y.converted);
+    *result = array;
+    return 1;
+}
+
+// VADD ... VNEG : element par element, un scalaire etant repete sur toute
+// la longueur ; les unaires recoivent a deux fois
+static const char *elementwise(VmProgram *prog, int op, const VmValue *a, const VmValue *b, VmValue *r) {
+    if (a->type != VM_ARRAY && b->type != VM_ARRAY) {
+        return "Element-wise operation requires an array";
+    }
+    if (a->type == VM_ARRAY && b->type == VM_ARRAY && a->as.a->length != b->as.a->length) {
+        return "Array length mismatch";
+    }
+    int n = a->type == VM_ARRAY ? a->as.a->length : b->as.a->length;
+    op = elementOp(op);
+    const char *error = NULL;
+    VmArray *array = NULL;
+    if (!vectorized(prog, op, a, b, n, &array, &error)) {
+        VmValue *values = (VmValue *)malloc((n > 0 ? n : 1) * sizeof(VmValue));
+        if (!values) {
+            return "Out of memory";
+        }
+        for (int k = 0; k < n && !error; k++) {
+            VmValue x = a->type == VM_ARRAY ? arrayItem(a->as.a, k) : *a;
+            VmValue y = b->type == VM_ARRAY ? arrayItem(b->as.a, k) : *b;
+            error = elementValue(op, &x, &y, &values[k]);
+        }
+        array = error ? NULL : packArray(&prog->heap, values, NULL, n);
+        free(values);
+        if (!error && !array) {
+            error = "Out of memory";
+        }
+    }
+    if (error) {
+        return error;
+    }
+    r->type = VM_ARRAY;
+    r->as.a = array;
+    return NULL;
+}
+
+// SUM : entier pour des entiers, reel des qu'un element est reel ; MIN et
+// MAX : premier element minimal (maximal), compare en reel si les types
+// sont melanges
+static const char *reduce(int op, const VmValue *v, VmValue *r) {
+    const char *notNumbers = op == OP_SUM ? "SUM requires an array of numbers"
+                           : op == OP_MIN ? "MIN requires an array of numbers" : "MAX requires an array of numbers";
+    if (v->type != VM_ARRAY) {
+        return notNumbers;
+    }
+    const VmArray *array = v->as.a;
+    size_t n = (size_t)array->length;
+    if (n == 0) {
+        if (op != OP_SUM) {
+            return op == OP_MIN ? "MIN requires a non-empty array" : "MAX requires a non-empty array";
+        }
+        r->type = VM_INT;
+        r->as.i = 0;
+        return NULL;
+    }
+    if (array->elementType == VM_INT) {
+        const int64_t *x = (const int64_t *)array->data;
+        r->type = VM_INT;
+        r->as.i = op == OP_SUM ? vecSumInt(x, n) : op == OP_MIN ? vecMinInt(x, n) : vecMaxInt(x, n);
+        return NULL;
+    }
+    if (array->elementType == VM_FLOAT) {
+        const double *x = (const double *)array->data;
+        r->type = VM_FLOAT;
+        r->as.f = op == OP_SUM ? vecSumFloat(x, n) : op == OP_MIN ? vecMinFloat(x, n) : vecMaxFloat(x, n);
+        return NULL;
+    }
+    if (array->elementType != VM_NONE) {
+        return notNumbers;
+    }
+    double *values = NULL;
+    if (op == OP_SUM) {
+        size_t size = (n * sizeof(double) + VEC_ALIGNMENT - 1) & ~(size_t)(VEC_ALIGNMENT - 1);
+        if (!(values = (double *)aligned_alloc(VEC_ALIGNMENT, size))) {
+            return "Out of memory";
+        }
+    }
+    VmValue best = array->items[0];
+    for (size_t k = 0; k < n; k++) {
+        const VmValue *item = &array->items[k];
+        if (item->type != VM_INT && item->type != VM_FLOAT) {
+            free(values);
+            return notNumbers;
+        }
+        if (values) {
+            values[k] = toDouble(item);
+        } else if (op == OP_MIN ? toDouble(item) < toDouble(&best) : toDouble(item) > toDouble(&best)) {
+            best = *item;
+        }
+    }
+    if (values) {
+        r->type = VM_FLOAT;
+        r->as.f = vecSumFloat(values, n);
+        free(values);
+    } else {
+        *r = best;
+    }
+    return NULL;
+}
+
+// INPUT : affiche le message, lit une ligne et la convertit au type de la
+// variable (ip->b)
+static const char *input(VmProgram *prog, const VmInstr *ip, VmValue *slots, FILE *in, FILE *out) {
+    vmPrintValue(out, &slots[ip->a]);
+    fflush(out);
+    char *line = NULL;
+    size_t capacity = 0;
+    ssize_t length = in ? getline(&line, &capacity, in) : -1;
+    if (length < 0) {
+        length = 0;
+    }
+    while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+        length--;
+    }
+    const char *text = line ? line : "";
+    if (line) {
+        line[length] = '\0';
+    }
+
+    const char *error = NULL;
+    VmValue *r = &slots[ip->r];
+    char *end;
+    switch (ip->b) {
+        case VM_INT:
+            r->as.i = strtoll(text, &end, 10);
+            if (end == text || *end) error = "Invalid integer input";
+            break;
+        case VM_FLOAT:
+            r->as.f = strtod(text, &end);
+            if (end == text || *end) error = "Invalid float input";
+            break;
+        case VM_BOOL:
+            if (strcmp(text, "true") == 0 || strcmp(text, "false") == 0) r->as.i = text[0] == 't';
+            else error = "Invalid boolean input";
+            break;
+        case VM_ARRAY:
+            error = "Cannot read an array";
+            break;
+        case VM_DICT:
+            error = "Cannot read a dict";
+            break;
+        default: {
+            VmString *s = vmNewString(&prog->heap, text, (size_t)length);
+            if (!s) error = "Out of memory";
+            r->as.s = s;
+            break;
+        }
+    }
+    if (!error) {
+        r->type = ip->b == VM_NONE ? VM_STRING : ip->b;
+    }
+    free(line);
+    return error;
+}
+
+// ---------------------------------------------------------------------------
+// Execution
+
+#define VM_LABEL_ADDRESS(name) &&L_##name,
+
+int vmRun(VmProgram *prog, FILE *in, FILE *out, FILE *err) {
+#ifdef VM_COMPUTED_GOTO
+    static const void *const handlers[OP_OPCODE_COUNT] = { VM_OPCODES(VM_LABEL_ADDRESS) };
+    if (!prog->threaded) {
+        for (int i = 0; i < prog->length; i++) {
+            prog->code[i].handler = handlers[prog->code[i].op];
+        }
+        prog->threaded = 1;
+    }
+#endif
+    vmFreeArena(&prog->heap);
+    memcpy(prog->slots, prog->initial, prog->slotCount * sizeof(VmValue));
+
+    VmValue *s = prog->slots;
+    const VmInstr *code = prog->code;
+    const VmInstr *ip = code;
+    const char *error = NULL;
+    long executed = 0;
+
+#ifdef VM_COMPUTED_GOTO
+#define VM_CASE(name) L_##name:
+#define VM_NEXT() do { ip++; executed++; goto *ip->handler; } while (0)
+#define VM_JUMP(t) do { ip = code + (t); executed++; goto *ip->handler; } while (0)
+    goto *ip->handler;
+    {
+#else
+#define VM_CASE(name) case OP_##name:
+#define VM_NEXT() do { ip++; executed++; goto dispatch; } while (0)
+#define VM_JUMP(t) do { ip = code + (t); executed++; goto dispatch; } while (0)
+dispatch:
+    switch (ip->op) {
+#endif
+
+    VM_CASE(HALT)
+        goto done;
+
+    VM_CASE(MOVE)
+        s[ip->r] = s[ip->a];
+        VM_NEXT();
+
+    VM_CASE(BR)
+        VM_JUMP(ip->target);
+
+    VM_CASE(BZ)
+        if (!s[ip->a].as.i) {
+            VM_JUMP(ip->target);
+        }
+        VM_NEXT();
+
+    VM_CASE(BNZ)
+        if (s[ip->a].as.i) {
+            VM_JUMP(ip->target);
+        }
+        VM_NEXT();
+
+    VM_CASE(SWITCH)
+        // entree selecteur - minimum de la table, ou l'instruction qui la
+        // suit hors de [minimum, minimum + n[
+        if (s[ip->a].type != VM_INT) {
+            error = "SWITCH requires an integer";
+            goto failure;
+        }
+        {
+            uint64_t k = (uint64_t)s[ip->a].as.i - (uint64_t)s[ip->b].as.i;
+            VM_JUMP(k < (uint64_t)ip->target ? ip[1 + k].target : (ip - code) + 1 + ip->target);
+        }
+
+    VM_CASE(CASE)
+        VM_JUMP(ip->target);
+
+    VM_CASE(ADD_II)
+        s[ip->r].type = VM_INT;
+        s[ip->r].as.i = wrapAdd(s[ip->a].as.i, s[ip->b].as.i);
+        VM_NEXT();
+
+    VM_CASE(SUB_II)
+        s[ip->r].type = VM_INT;
+        s[ip->r].as.i = wrapSub(s[ip->a].as.i, s[ip->b].as.i);
+        VM_NEXT();
+
+    VM_CASE(MUL_II)
+        s[ip->r].type = VM_INT;
+        s[ip->r].as.i = wrapMul(s[ip->a].as.i, s[ip->b].as.i);
+        VM_NEXT();
+
+    VM_CASE(IDIV_II)
+    VM_CASE(MOD_II)
+        error = integerDivide(ip->op == OP_MOD_II ? OP_MOD : OP_IDIV, s[ip->a].as.i, s[ip->b].as.i, &s[ip->r]);
+        if (error) goto failure;
+        VM_NEXT();
+
+    VM_CASE(ADD_FF)
+        s[ip->r].type = VM_FLOAT;
+        s[ip->r].as.f = s[ip->a].as.f + s[ip->b].as.f;
+        VM_NEXT();
+
+    VM_CASE(SUB_FF)
+        s[ip->r].type = VM_FLOAT;
+        s[ip->r].as.f = s[ip->a].as.f - s[ip->b].as.f;
+        VM_NEXT();
+
+    VM_CASE(MUL_FF)
+        s[ip->r].type = VM_FLOAT;
+        s[ip->r].as.f = s[ip->a].as.f * s[ip->b].as.f;
+        VM_NEXT();
+
+    VM_CASE(DIV_FF)
+        if (s[ip->b].as.f == 0) {
+            error = "Division by zero";
+            goto failure;
+        }
+        s[ip->r].type = VM_FLOAT;
+        s[ip->r].as.f = s[ip->a].as.f / s[ip->b].as.f;
+        VM_NEXT();
+
+    VM_CASE(EQ_II)
+        s[ip->r].type = VM_BOOL;
+        s[ip->r].as.i = s[ip->a].as.i == s[ip->b].as.i;
+        VM_NEXT();
+
+    VM_CASE(NE_II)
+        s[ip->r].type = VM_BOOL;
+        s[ip->r].as.i = s[ip->a].as.i != s[ip->b].as.i;
+        VM_NEXT();
+
+    VM_CASE(LT_II)
+        s[ip->r].type = VM_BOOL;
+        s[ip->r].as.i = s[ip->a].as.i < s[ip->b].as.i;
+        VM_NEXT();
+
+    VM_CASE(LE_II)
+        s[ip->r].type = VM_BOOL;
+        s[ip->r].as.i = s[ip->a].as.i <= s[ip->b].as.i;
+        VM_NEXT();
+
+    VM_CASE(GT_II)
+        s[ip->r].type = VM_BOOL;
+        s[ip->r].as.i = s[ip->a].as.i > s[ip->b].as.i;
+        VM_NEXT();
+
+    VM_CASE(GE_II)
+        s[ip->r].type = VM_BOOL;
+        s[ip->r].as.i = s[ip->a].as.i >= s[ip->b].as.i;
+        VM_NEXT();
+
+    VM_CASE(ADD)
+    VM_CASE(SUB)
+    VM_CASE(MUL)
+    VM_CASE(DIV)
+    VM_CASE(IDIV)
+    VM_CASE(MOD)
+        error = arithmetic(ip->op, &s[ip->a], &s[ip->b], &s[ip->r]);
+        if (error) goto failure;
+        VM_NEXT();
+
+    VM_CASE(EQ)
+    VM_CASE(NE)
+    VM_CASE(LT)
+    VM_CASE(LE)
+    VM_CASE(GT)
+    VM_CASE(GE)
+        error = compare(ip->op, &s[ip->a], &s[ip->b], &s[ip->r]);
+        if (error) goto failure;
+        VM_NEXT();
+
+    VM_CASE(AND)
+        if (s[ip->a].type != VM_BOOL || s[ip->b].type != VM_BOOL) {
+            error = "AND requires boolean operands";
+            goto failure;
+        }
+        s[ip->r].type = VM_BOOL;
+        s[ip->r].as.i = s[ip->a].as.i && s[ip->b].as.i;
+        VM_NEXT();
+
+    VM_CASE(OR)
+        if (s[ip->a].type != VM_BOOL || s[ip->b].type != VM_BOOL) {
+            error = "OR requires boolean operands";
+            goto failure;
+        }
+        s[ip->r].type = VM_BOOL;
+        s[ip->r].as.i = s[ip->a].as.i || s[ip->b].as.i;
+        VM_NEXT();
+
+    VM_CASE(NOT)
+        if (s[ip->a].type != VM_BOOL) {
+            error = "NOT requires a boolean operand";
+            goto failure;
+        }
+        s[ip->r].type = VM_BOOL;
+        s[ip->r].as.i = !s[ip->a].as.i;
+        VM_NEXT();
+
+    VM_CASE(NEG)
+        if (s[ip->a].type == VM_FLOAT) {
+            s[ip->r].type = VM_FLOAT;
+            s[ip->r].as.f = -s[ip->a].as.f;
+        } else if (s[ip->a].type == VM_INT || s[ip->a].type == VM_BOOL) {
+            s[ip->r].type = VM_INT;
+            s[ip->r].as.i = wrapSub(0, s[ip->a].as.i);
+        } else {
+            error = "Unary minus requires a numeric operand";
+            goto failure;
+        }
+        VM_NEXT();
+
+    VM_CASE(CONCAT)
+        error = concat(prog, &s[ip->a], &s[ip->b], &s[ip->r]);
+        if (error) goto failure;
+        VM_NEXT();
+
+    VM_CASE(ARRAY)
+        error = buildArray(prog, ip, s);
+        if (error) goto failure;
+        VM_NEXT();
+
+    VM_CASE(VADD)
+    VM_CASE(VSUB)
+    VM_CASE(VMUL)
+    VM_CASE(VDIV)
+    VM_CASE(VIDIV)
+    VM_CASE(VMOD)
+    VM_CASE(VEQ)
+    VM_CASE(VNE)
+    VM_CASE(VLT)
+    VM_CASE(VLE)
+    VM_CASE(VGT)
+    VM_CASE(VGE)
+    VM_CASE(VAND)
+    VM_CASE(VOR)
+        error = elementwise(prog, ip->op, &s[ip->a], &s[ip->b], &s[ip->r]);
+        if (error) goto failure;
+        VM_NEXT();
+
+    VM_CASE(VNOT)
+    VM_CASE(VNEG)
+        error = elementwise(prog, ip->op, &s[ip->a], &s[ip->a], &s[ip->r]);
+        if (error) goto failure;
+        VM_NEXT();
+
+    VM_CASE(SUM)
+    VM_CASE(MIN)
+    VM_CASE(MAX)
+        error = reduce(ip->op, &s[ip->a], &s[ip->r]);
+        if (error) goto failure;
+        VM_NEXT();
+
+    VM_CASE(DICT)
+        error = buildDict(prog, ip, s);
+        if (error) goto failure;
+        VM_NEXT();
+
+    VM_CASE(INDEX)
+        error = dictGet(&s[ip->a], &s[ip->b], &s[ip->r]);
+        if (error) goto failure;
+        VM_NEXT();
+
+    VM_CASE(HASH)
+        // case d'une chaine dans une table de m cases (Switch sur chaines)
+        if (s[ip->a].type != VM_STRING) {
+            error = "HASH requires a string";
+            goto failure;
+        }
+        s[ip->r].type = VM_INT;
+        s[ip->r].as.i = dictBucket(dictHash(s[ip->a].as.s->text, s[ip->a].as.s->length),
+                                   (uint32_t)s[ip->b].as.i);
+        VM_NEXT();
+
+    VM_CASE(PRINT)
+        vmPrintValue(out, &s[ip->a]);
+        fputc('\n', out);
+        VM_NEXT();
+
+    VM_CASE(INPUT)
+        error = input(prog, ip, s, in, out);
+        if (error) goto failure;
+        VM_NEXT();
+
+    }
+#undef VM_CASE
+#undef VM_NEXT
+#undef VM_JUMP
+
+failure:
+    fprintf(err, "Runtime error (quad %d): %s\n", ip->qc, error);
+    prog->executed = executed;
+    return 1;
+
+done:
+    prog->executed = executed;
+    return 0;
+}
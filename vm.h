@@ -0,0 +1,125 @@
+#ifndef VM_H
+#define VM_H
+#include <stdio.h>
+#include <stdint.h>
+#include "tableSymboles.h"
+#include "quadruplets.h"
+
+// Machine virtuelle : execution des quadruplets (option --run).
+//
+// Au chargement (vmLoad), les quads sont decodes en un flot dense
+// d'instructions : l'operateur devient un code, chaque operande une case
+// (variable, temporaire ou constante prechargee), les etiquettes
+// disparaissent et les branchements pointent directement sur l'indice de
+// l'instruction visee (etiquette, ou numero de quad apres -O). Les types connus a la compilation (constantes,
+// variables declarees, temporaires qui en derivent) permettent de
+// specialiser les operations : ADD_II additionne deux entiers sans tester
+// l'etiquette de type des cases.
+//
+// L'execution (vmRun) enchaine les instructions par goto calcule (une
+// branche indirecte par instruction) avec GCC/Clang, par switch sinon ou si
+// VM_SWITCH_DISPATCH est defini.
+//
+// Les chaines et tableaux crees a l'execution sont alloues dans une arene
+// rendue en une fois a la fin de l'execution. Les operations element par
+// element (VADD ... VNEG) et les reductions (SUM, MIN, MAX) passent par les
+// noyaux vectoriels de vecteurs.h quand les tableaux sont homogenes. Un
+// dictionnaire (DICT_DECL) trouve une cle (INDEX) en une seule case grace
+// au hachage parfait calcule a la compilation (dictionnaire.h). Un SWITCH
+// saute directement par la table des instructions CASE qui le suivent.
+
+typedef enum VmType {
+    VM_NONE,        // type inconnu au chargement / case jamais ecrite
+    VM_INT,
+    VM_FLOAT,
+    VM_BOOL,        // stocke dans as.i (0 ou 1)
+    VM_STRING,
+    VM_ARRAY,
+    VM_DICT
+} VmType;
+
+typedef struct VmString {
+    size_t length;
+    char text[];
+} VmString;
+
+typedef struct VmArray VmArray;
+typedef struct VmDict VmDict;
+
+typedef struct VmValue {
+    int type;                   // VmType
+    union {
+        int64_t i;
+        double f;
+        VmString *s;
+        VmArray *a;
+        VmDict *d;
+    } as;
+} VmValue;
+
+// Un tableau dont les elements sont tous entiers, tous reels ou tous
+// booleens les range dans un tampon contigu aligne (voir vecteurs.h) ;
+// les autres gardent une case par element
+struct VmArray {
+    int length;
+    int elementType;            // VM_INT (int64_t), VM_FLOAT (double), VM_BOOL (bool)
+                                // : elements dans data ; VM_NONE : dans items
+    void *data;
+    VmValue items[];
+};
+
+// Cles d'un dictionnaire, fixees au chargement et partagees par toutes les
+// valeurs que construit le meme quad. index donne l'entree de chaque case
+// (-1 : libre). Avec le hachage parfait du litteral (buckets > 0), index a
+// une case par cle et celle d'une cle se calcule directement ; sinon c'est
+// une table a adressage ouvert (sondage lineaire, capacite puissance de 2
+// au moins double du nombre de cles)
+typedef struct VmDictKeys {
+    int count;
+    int capacity;               // cases de index
+    int buckets;
+    uint32_t seed;              // graine globale du hachage parfait
+    const uint32_t *displacements;
+    VmString **keys;            // dans l'ordre du litteral
+    uint64_t *hashes;
+    int32_t *index;
+} VmDictKeys;
+
+struct VmDict {
+    const VmDictKeys *keys;
+    VmValue values[];           // valeur de keys->keys[k]
+};
+
+typedef struct VmInstr {
+    const void *handler;        // adresse du traitement (goto calcule)
+    int op;
+    int a, b, r;                // cases des operandes et du resultat
+    int target;                 // BR/BZ/BNZ/CASE : instruction visee ; ARRAY, DICT : premier
+                                // element ; SWITCH : nombre d'entrees CASE qui le suivent
+    int qc;                     // quad d'origine (messages d'erreur)
+} VmInstr;
+
+typedef struct VmChunk VmChunk;
+
+typedef struct VmProgram {
+    VmInstr *code;
+    int length;
+    VmValue *initial;           // contenu des cases au depart
+    VmValue *slots;
+    int slotCount;
+    int *elements;              // cases des elements des tableaux (ARRAY) et des
+    int elementCount;           // valeurs des dictionnaires (DICT)
+    VmDictKeys *dicts;          // cles de chaque DICT (indice dans b)
+    int dictCount;
+    VmChunk *constants;         // chaines des constantes (duree du programme)
+    VmChunk *heap;              // valeurs creees a l'execution
+    int threaded;               // handlers resolus pour le goto calcule
+    long executed;              // instructions executees au dernier vmRun
+} VmProgram;
+
+int vmLoad(VmProgram *prog, tableQuads *quads, SymbolTable *table, FILE *err);
+int vmRun(VmProgram *prog, FILE *in, FILE *out, FILE *err);
+void vmFree(VmProgram *prog);
+void vmPrintValue(FILE *out, const VmValue *value);
+
+#endif